@@ -9,7 +9,13 @@
 #include <set>
 #include <glib.h>
 #include <stdexcept>
+#include <deque>
+#include <map>
+#include <stdint.h>
 #include <boost/thread.hpp>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace { // anonymous namespace
 
@@ -53,10 +59,95 @@ SPC_BYTE = " ";
 //const char *
 //URL_VALID_SYM_CHARS = "-._~:/?#[]@!$&'()*+,;=";
 
+// unicode types of the 7-bit code points, looked up once from glib
+struct ascii_types_t {
+    GUnicodeType type[0x80];
+    ascii_types_t() {
+        for (gunichar uch = 0; uch < 0x80; ++uch)
+            type[uch] = g_unichar_type(uch);
+    }
+} ASCII_TYPES;
+
+inline GUnicodeType
+unichar_type(gunichar uch) {
+    return uch < 0x80 ? ASCII_TYPES.type[uch] : g_unichar_type(uch);
+}
+
+// no byte in the span has its high bit set, checked 16 bytes at a time under SSE2
+inline bool
+ascii_span_p(const char *pt, std::size_t len) {
+    const char *ep = pt + len;
+#ifdef __SSE2__
+    for ( ; ep - pt >= 16; pt += 16)
+        if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)pt)))
+            return false;
+#endif
+    for ( ; ep - pt >= 8; pt += 8) {
+        uint64_t word;
+        std::memcpy(&word,pt,sizeof(word));
+        if (word & 0x8080808080808080ULL)
+            return false;
+    }
+    for ( ; pt < ep; ++pt)
+        if (*pt & 0x80)
+            return false;
+    return true;
+}
+
+// same result as g_utf8_to_ucs4_fast for a span already known to be ascii
+inline gunichar *
+ascii_to_ucs4(const char *pt, glong len, glong *ulen) {
+    gunichar *ucs4 = g_new(gunichar,len+1); // g_free
+    glong ii = 0;
+    for ( ; ii < len && pt[ii]; ++ii)
+        ucs4[ii] = gunichar((unsigned char)pt[ii]);
+    ucs4[ii] = 0;
+    if (ulen)
+        *ulen = ii;
+    return ucs4;
+}
+
+// a tranche of consecutive input lines and their tokenizations
+struct chunk_t {
+    std::size_t seq;
+    std::vector<std::string> lines;
+    std::vector<std::string> results;
+};
+
+// blocking fifo of bounded length linking reader, workers and writer
+template <typename T>
+class bounded_fifo {
+    std::deque<T> items;
+    std::size_t limit;
+    boost::mutex mtx;
+    boost::condition_variable not_empty;
+    boost::condition_variable not_full;
+public:
+    explicit bounded_fifo(std::size_t _limit) : limit(_limit) {}
+
+    void push(const T& item) {
+        boost::unique_lock<boost::mutex> lock(mtx);
+        while (items.size() >= limit)
+            not_full.wait(lock);
+        items.push_back(item);
+        not_empty.notify_one();
+    }
+
+    T pop() {
+        boost::unique_lock<boost::mutex> lock(mtx);
+        while (items.empty())
+            not_empty.wait(lock);
+        T item = items.front();
+        items.pop_front();
+        not_full.notify_one();
+        return item;
+    }
+};
+
 inline bool
 class_follows_p(gunichar *s, gunichar *e, GUnicodeType gclass) {
     while (s < e) {
-        GUnicodeType tclass = g_unichar_type(*s);
+        GUnicodeType tclass = unichar_type(*s);
         if (tclass == gclass)
             return true;
         switch (tclass) {
@@ -369,7 +460,7 @@ get_entity(gunichar *ptr, size_t len) {
         } catch (...) {
             ech = 0;
         }
-    } else if (g_unichar_type(ptr[1]) == G_UNICODE_DECIMAL_NUMBER) {
+    } else if (unichar_type(ptr[1]) == G_UNICODE_DECIMAL_NUMBER) {
         std::wstringstream wss;
         int wch = 0;
         try {
@@ -948,7 +1039,10 @@ Tokenizer::quik_tokenize(const std::string& buf)
     while (pt < ep && *pt >= 0 && *pt <= ' ')
         ++pt;
     glong ulen(0);
-    gunichar *usrc(g_utf8_to_ucs4_fast((const gchar *)pt,ep - pt, &ulen)); // g_free
+    // plain ascii lines skip utf8 decoding
+    gunichar *usrc(ascii_span_p(pt,ep - pt)
+                   ? ascii_to_ucs4(pt,ep - pt,&ulen)
+                   : g_utf8_to_ucs4_fast((const gchar *)pt,ep - pt, &ulen)); // g_free
     gunichar *ucs4(usrc);
     gunichar *lim4(ucs4 + ulen);
 
@@ -961,7 +1055,7 @@ Tokenizer::quik_tokenize(const std::string& buf)
     gunichar curr_uch(0);
 
     GUnicodeType curr_type(G_UNICODE_UNASSIGNED);
-    GUnicodeType next_type((ucs4 && *ucs4) ? g_unichar_type(*ucs4) : G_UNICODE_UNASSIGNED);
+    GUnicodeType next_type((ucs4 && *ucs4) ? unichar_type(*ucs4) : G_UNICODE_UNASSIGNED);
     GUnicodeType prev_type(G_UNICODE_UNASSIGNED);
 
     bool post_break_p = false;
@@ -982,7 +1076,7 @@ Tokenizer::quik_tokenize(const std::string& buf)
             next_type = G_UNICODE_UNASSIGNED;
         } else {
             next_uch = *nxt4;
-            next_type = g_unichar_type(next_uch);
+            next_type = unichar_type(next_uch);
         }
 
         if (url_p) {
@@ -1183,7 +1277,7 @@ Tokenizer::quik_tokenize(const std::string& buf)
                         gunichar *eptr = nxt4;
                         GUnicodeType eptr_type(G_UNICODE_UNASSIGNED);
                         for (++eptr; eptr < lim4 && *eptr != gunichar(L';'); ++eptr) {
-                            eptr_type = g_unichar_type(*eptr);
+                            eptr_type = unichar_type(*eptr);
                             if (eptr_type != G_UNICODE_LOWERCASE_LETTER
                                 && eptr_type != G_UNICODE_UPPERCASE_LETTER
                                 && eptr_type != G_UNICODE_DECIMAL_NUMBER)
@@ -1192,11 +1286,11 @@ Tokenizer::quik_tokenize(const std::string& buf)
                         gunichar ech(0);
                         if (*eptr == gunichar(L';') && (ech = get_entity(ucs4,eptr-ucs4+1))) {
                             curr_uch = ech;
-                            curr_type = g_unichar_type(ech);
+                            curr_type = unichar_type(ech);
                             ucs4 = eptr;
                             nxt4 = ++eptr;
                             next_uch = *nxt4;
-                            next_type = nxt4 < lim4 ? g_unichar_type(next_uch) : G_UNICODE_UNASSIGNED;
+                            next_type = nxt4 < lim4 ? unichar_type(next_uch) : G_UNICODE_UNASSIGNED;
                             goto retry;
                         }
                     }
@@ -1217,10 +1311,10 @@ Tokenizer::quik_tokenize(const std::string& buf)
                         *uptr++ = gunichar(L' ');
                         pre_break_p = post_break_p = false;
                         curr_uch = *ucs4;
-                        curr_type = ucs4 < lim4 ? g_unichar_type(curr_uch) : G_UNICODE_UNASSIGNED;
+                        curr_type = ucs4 < lim4 ? unichar_type(curr_uch) : G_UNICODE_UNASSIGNED;
                         nxt4 = ++cur4;
                         next_uch = *nxt4;
-                        next_type = nxt4 < lim4 ? g_unichar_type(next_uch) : G_UNICODE_UNASSIGNED;
+                        next_type = nxt4 < lim4 ? unichar_type(next_uch) : G_UNICODE_UNASSIGNED;
                         goto retry;
                     }
 
@@ -1292,7 +1386,7 @@ Tokenizer::quik_tokenize(const std::string& buf)
                                         // non-breaking before numeric
                                     } else if (k.find(curr_uch) != std::wstring::npos) {
                                         if (since_start > 1) {
-                                            GUnicodeType tclass = g_unichar_type(*(uptr-2));
+                                            GUnicodeType tclass = unichar_type(*(uptr-2));
                                             switch (tclass) {
                                             case G_UNICODE_UPPERCASE_LETTER:
                                             case G_UNICODE_LOWERCASE_LETTER:
@@ -1304,7 +1398,7 @@ Tokenizer::quik_tokenize(const std::string& buf)
                                         }
                                         // terminal isolated letter does not break
                                     } else if (class_follows_p(nxt4,lim4,G_UNICODE_LOWERCASE_LETTER) ||
-                                               g_unichar_type(*nxt4) == G_UNICODE_DASH_PUNCTUATION) {
+                                               unichar_type(*nxt4) == G_UNICODE_DASH_PUNCTUATION) {
                                         // lower-case look-ahead does not break
                                     } else {
                                         pre_break_p = true;
@@ -1557,82 +1651,134 @@ Tokenizer::tokenize(std::istream& is, std::ostream& os)
 {
     std::size_t line_no = 0;
     std::size_t perchunk = chunksize ? chunksize : 2000;
-    std::vector< std::vector< std::string > > lines(nthreads);
-    std::vector< std::vector< std::string > > results(nthreads);
-    std::vector< boost::thread > workers(nthreads);
-    bool done_p = !(is.good() && os.good());
-
-
-    for (std::size_t tranche = 0; !done_p; ++tranche) {
 
-        // for loop starting threads for chunks of input
-        for (std::size_t ithread = 0; ithread < nthreads; ++ithread) {
-
-            lines[ithread].resize(perchunk);
-            std::size_t line_pos = 0;
-
-            for ( ; line_pos < perchunk; ++line_pos) {
-
-                std::string istr;
-                std::getline(is,istr);
-
-                if (skip_alltags_p) {
-                    RE2::GlobalReplace(&istr,genl_tags_x,SPC_BYTE);
-                    istr = trim(istr);
-                }
-                line_no++;
-
-                if (istr.empty()) {
-                    if (is.eof()) {
-                        done_p = true;
-                        lines[ithread].resize(line_pos);
-                        results[ithread].resize(line_pos);
-                        break;
-                    }
-                    lines[ithread][line_pos].clear();
-                } else if (skip_xml_p &&
-                           (RE2::FullMatch(istr,tag_line_x) || RE2::FullMatch(istr,white_line_x))) {
-                    lines[ithread][line_pos].clear();
-                } else {
-                    lines[ithread][line_pos] =
-                        std::string(SPC_BYTE).append(istr).append(SPC_BYTE);
+    // the reader, nthreads workers and the writer run concurrently; the fixed
+    // pool of chunks bounds memory and makes the reader wait on the writer
+    std::size_t nchunks = 2 * nthreads + 1;
+    std::vector<chunk_t> pool(nchunks);
+    bounded_fifo<chunk_t *> idle(nchunks);
+    bounded_fifo<chunk_t *> todo(nchunks + nthreads);
+    for (auto &chunk : pool)
+        idle.push(&chunk);
+
+    // finished chunks wait here until every earlier one is written
+    std::map<std::size_t,chunk_t *> done;
+    std::size_t nseq = 0;
+    bool eof_p = false;
+    std::string error;
+    boost::mutex done_mtx;
+    boost::condition_variable done_cv;
+
+    std::vector<boost::thread> workers;
+    for (std::size_t ithread = 0; ithread < nthreads; ++ithread) {
+        workers.push_back(boost::thread([&]() {
+            for (chunk_t *chunk = todo.pop(); chunk; chunk = todo.pop()) {
+                std::vector<std::string>& in(chunk->lines);
+                std::vector<std::string>& out(chunk->results);
+                out.resize(in.size());
+                try {
+                    for (std::size_t ii = 0; ii < in.size(); ++ii)
+                        if (in[ii].empty())
+                            out[ii].clear();
+                        else if (penn_p)
+                            out[ii] = penn_tokenize(in[ii]);
+                        else
+                            out[ii] = quik_tokenize(in[ii]);
+                } catch (const std::exception& ex) {
+                    boost::lock_guard<boost::mutex> lock(done_mtx);
+                    if (error.empty())
+                        error = ex.what();
                 }
+                boost::lock_guard<boost::mutex> lock(done_mtx);
+                done[chunk->seq] = chunk;
+                done_cv.notify_all();
             }
+        }));
+    }
 
-            if (line_pos) {
-                workers[ithread] =
-                    boost::thread(VectorTokenizerCallable(this,lines[ithread],results[ithread]));
+    boost::thread writer([&]() {
+        for (std::size_t seq = 0; ; ++seq) {
+            chunk_t *chunk = 0;
+            {
+                boost::unique_lock<boost::mutex> lock(done_mtx);
+                while (done.find(seq) == done.end() && !(eof_p && seq == nseq))
+                    done_cv.wait(lock);
+                if (eof_p && seq == nseq)
+                    return;
+                chunk = done[seq];
+                done.erase(seq);
             }
-        } // end for loop starting threads
+            for (auto &result : chunk->results)
+                os << result << '\n';
+            os.flush();
+            idle.push(chunk);
+        }
+    });
 
-        for (std::size_t ithread = 0; ithread < nthreads; ++ithread) {
-            if (!workers[ithread].joinable())
-                continue;
+    bool done_p = !(is.good() && os.good());
 
-            workers[ithread].join();
+    while (!done_p) {
+        chunk_t *chunk = idle.pop();
+        std::vector<std::string>& lines(chunk->lines);
+        lines.resize(perchunk);
+        std::size_t line_pos = 0;
 
-            std::size_t nres = results[ithread].size();
-            std::size_t nlin = lines[ithread].size();
+        for ( ; line_pos < perchunk; ++line_pos) {
 
-            if (nlin != nres) {
-                std::ostringstream emsg;
-                emsg << "Tranche " << tranche
-                     << " worker " << ithread << "/" << nthreads
-                     << " |lines|==" << nlin << " != |results|==" << nres;
-                throw std::runtime_error(emsg.str());
+            std::string istr;
+            std::getline(is,istr);
+
+            if (skip_alltags_p) {
+                RE2::GlobalReplace(&istr,genl_tags_x,SPC_BYTE);
+                istr = trim(istr);
             }
+            line_no++;
 
-            for (std::size_t ires = 0; ires < nres; ++ires)
-                os << results[ithread][ires] << std::endl;
+            if (istr.empty()) {
+                if (is.eof()) {
+                    done_p = true;
+                    lines.resize(line_pos);
+                    break;
+                }
+                lines[line_pos].clear();
+            } else if (skip_xml_p &&
+                       (RE2::FullMatch(istr,tag_line_x) || RE2::FullMatch(istr,white_line_x))) {
+                lines[line_pos].clear();
+            } else {
+                lines[line_pos] =
+                    std::string(SPC_BYTE).append(istr).append(SPC_BYTE);
+            }
+        }
 
-        } // end loop over joined results
+        if (line_pos) {
+            {
+                boost::lock_guard<boost::mutex> lock(done_mtx);
+                chunk->seq = nseq++;
+            }
+            todo.push(chunk);
+        } else {
+            idle.push(chunk);
+        }
 
         if (verbose_p) {
             std::cerr << line_no << ' ';
             std::cerr.flush();
         }
+    }
+
+    for (std::size_t ithread = 0; ithread < nthreads; ++ithread)
+        todo.push(0);
+    for (auto &worker : workers)
+        worker.join();
+    {
+        boost::lock_guard<boost::mutex> lock(done_mtx);
+        eof_p = true;
+        done_cv.notify_all();
+    }
+    writer.join();
 
-    } // end loop over chunks
+    if (!error.empty())
+        throw std::runtime_error(error);
 
     return line_no;
 }
@@ -1789,7 +1935,7 @@ Tokenizer::splitter(const std::string &istr, bool *continuation_ptr) {
 
     for (; icp <= ncp; ++icp) {
         currwc = wchar_t(ucs4[icp]);
-        curr_type = g_unichar_type(currwc);
+        curr_type = unichar_type(currwc);
         prev_class = curr_class;
         //prev_word_p = curr_word_p;
 
@@ -1908,7 +2054,7 @@ Tokenizer::splitter(const std::string &istr, bool *continuation_ptr) {
                         acro_p = true;
                     } else if (acro_p) {
                         if (uout[ii] != L'.' && uout[ii] != L'-') {
-                            GUnicodeType i_type = g_unichar_type(uout[ii]);
+                            GUnicodeType i_type = unichar_type(uout[ii]);
                             if (i_type != G_UNICODE_UPPERCASE_LETTER) {
                                 acro_p = false;
                             } else {
@@ -1927,7 +2073,7 @@ Tokenizer::splitter(const std::string &istr, bool *continuation_ptr) {
                     int state = (curr_class == pinit || curr_class == quote) ? 1 : 0;
                     bool num_p = true;
                     while (fcp < ncp) {
-                        GUnicodeType f_type = g_unichar_type(ucs4[fcp]);
+                        GUnicodeType f_type = unichar_type(ucs4[fcp]);
                         bool f_white = g_unichar_isgraph(ucs4[fcp]);
                         switch (state) {
                         case 0:
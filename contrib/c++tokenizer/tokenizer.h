@@ -91,32 +91,6 @@ protected:
     // in-place 1 line tokenizer, replaces input string, depends on wrapper to set-up invariants
     void protected_tokenize(std::string& inplace);
 
-    // used for boost::thread
-    struct VectorTokenizerCallable {
-        Tokenizer *tokenizer;
-        std::vector<std::string>& in;
-        std::vector<std::string>& out;
-
-        VectorTokenizerCallable(Tokenizer *_tokenizer,
-                                std::vector<std::string>& _in,
-                                std::vector<std::string>& _out)
-        : tokenizer(_tokenizer)
-        , in(_in)
-        , out(_out) {
-        };
-
-        void operator()() {
-            out.resize(in.size());
-            for (std::size_t ii = 0; ii < in.size(); ++ii)
-                if (in[ii].empty())
-                    out[ii] = in[ii];
-                else if (tokenizer->penn_p)
-                    out[ii] = tokenizer->penn_tokenize(in[ii]);
-                else
-                    out[ii] = tokenizer->quik_tokenize(in[ii]);
-        };
-    };
-
 public:
 
     Tokenizer(); // UNIMPL
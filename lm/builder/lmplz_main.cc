@@ -4,6 +4,7 @@
 #include "lm/lm_exception.hh"
 #include "util/file.hh"
 #include "util/file_piece.hh"
+#include "util/read_compressed.hh"
 #include "util/usage.hh"
 
 #include <iostream>
@@ -80,6 +81,7 @@ int main(int argc, char *argv[]) {
     discount_fallback_default.push_back("1");
     discount_fallback_default.push_back("1.5");
     bool verbose_header;
+    std::size_t decompress_threads;
 
     options.add_options()
       ("help,h", po::bool_switch(), "Show this help message")
@@ -99,6 +101,7 @@ int main(int argc, char *argv[]) {
       ("vocab_pad", po::value<uint64_t>(&pipeline.vocab_size_for_unk)->default_value(0), "If the vocabulary is smaller than this value, pad with <unk> to reach this size. Requires --interpolate_unigrams")
       ("verbose_header", po::bool_switch(&verbose_header), "Add a verbose header to the ARPA file that includes information such as token count, smoothing type, etc.")
       ("text", po::value<std::string>(&text), "Read text from a file instead of stdin")
+      ("decompress_threads", po::value<std::size_t>(&decompress_threads)->default_value(0), "Decompress compressed text on this many background threads.  Several threads help for bgzip and multi-block xz files.")
       ("arpa", po::value<std::string>(&arpa), "Write ARPA to a file instead of stdout")
       ("intermediate", po::value<std::string>(&intermediate), "Write ngrams to intermediate files.  Turns off ARPA output (which can be reactivated by --arpa file).  Forces --renumber on.")
       ("renumber", po::bool_switch(&pipeline.renumber_vocabulary), "Rrenumber the vocabulary identifiers so that they are monotone with the hash of each string.  This is consistent with the ordering used by the trie data structure.")
@@ -139,6 +142,7 @@ int main(int argc, char *argv[]) {
     }
 
     po::notify(vm);
+    util::ReadCompressed::SetBackgroundThreads(decompress_threads);
 
     // required() appeared in Boost 1.42.0.
 #if BOOST_VERSION < 104200
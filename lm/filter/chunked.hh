@@ -0,0 +1,267 @@
+#ifndef LM_FILTER_CHUNKED_H
+#define LM_FILTER_CHUNKED_H
+/* Filtering straight from a memory-mapped model.  The input is split into
+ * line-aligned chunks that workers tokenize and filter on their own, so there
+ * is no serial reader.  Output lines are StringPieces into the mapping and
+ * are written in chunk order by a single output thread, one n-gram order at
+ * a time.
+ */
+
+#include "lm/filter/format.hh"
+#include "lm/filter/thread.hh"
+#include "lm/lm_exception.hh"
+#include "lm/read_arpa.hh"
+#include "util/exception.hh"
+#include "util/file.hh"
+#include "util/file_piece.hh"
+#include "util/mmap.hh"
+#include "util/read_compressed.hh"
+#include "util/string_piece.hh"
+#include "util/tokenize_piece.hh"
+
+#include <boost/noncopyable.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <stack>
+#include <vector>
+
+#include <cctype>
+#include <cstring>
+#include <stdint.h>
+
+namespace lm {
+
+// Read-only mapping of an uncompressed model file.
+class MappedInput : boost::noncopyable {
+  public:
+    explicit MappedInput(const char *name) : file_(util::OpenReadOrThrow(name)) {
+      uint64_t size = util::SizeOrThrow(file_.get());
+      UTIL_THROW_IF(!size, util::EndOfFileException, " in empty file " << name);
+      util::MapRead(util::LAZY, file_.get(), 0, size, mem_);
+      UTIL_THROW_IF(size >= util::ReadCompressed::kMagicSize && util::ReadCompressed::DetectCompressedMagic(mem_.get()),
+          util::Exception, "mmap mode needs an uncompressed file but " << name << " is compressed.");
+    }
+
+    const char *begin() const { return static_cast<const char*>(mem_.get()); }
+    const char *end() const { return begin() + mem_.size(); }
+
+  private:
+    util::scoped_fd file_;
+    util::scoped_memory mem_;
+};
+
+// Line parsing for each format, matching ReadNGrams and ReadCount.
+struct ARPAChunkLine {
+  static bool NGram(const StringPiece &line, StringPiece &ngram) {
+    util::TokenIter<util::SingleCharacter> tabber(line, '\t');
+    if (!tabber) throw ARPAInputException("blank line", line);
+    if (!++tabber) throw ARPAInputException("no tab", line);
+    ngram = *tabber;
+    return true;
+  }
+};
+
+struct CountChunkLine {
+  static bool NGram(const StringPiece &line, StringPiece &ngram) {
+    util::TokenIter<util::SingleCharacter> tabber(line, '\t');
+    if (!tabber) {
+      std::cerr << "Warning: empty n-gram count line being removed\n";
+      return false;
+    }
+    ngram = *tabber;
+    return true;
+  }
+};
+
+// A chunk of the mapping and the filter output for it.
+template <class OutputBuffer, class Line> class ChunkBatch {
+  public:
+    ChunkBatch() : sequence_(0), ngrams_(0) {}
+
+    // Controller thread.
+    void Fill(uint64_t sequence, const StringPiece &chunk) {
+      sequence_ = sequence;
+      chunk_ = chunk;
+      ngrams_ = 0;
+    }
+
+    // Filter worker thread.
+    template <class Filter> void CallFilter(Filter &filter) {
+      const char *i = chunk_.data();
+      const char *const end = chunk_.data() + chunk_.size();
+      StringPiece ngram;
+      while (i != end) {
+        const char *newline = static_cast<const char*>(std::memchr(i, '\n', end - i));
+        if (!newline) newline = end;
+        StringPiece line(i, newline - i);
+        if (!line.empty() && line.data()[line.size() - 1] == '\r') line.set(line.data(), line.size() - 1);
+        i = (newline == end) ? end : newline + 1;
+        if (!Line::NGram(line, ngram)) continue;
+        filter.AddNGram(ngram, line, output_);
+        ++ngrams_;
+      }
+    }
+
+    uint64_t Sequence() const { return sequence_; }
+
+    uint64_t NGrams() const { return ngrams_; }
+
+    // File writing thread.
+    template <class RealOutput> void Flush(RealOutput &output) {
+      output_.Flush(output);
+    }
+
+  private:
+    StringPiece chunk_;
+    OutputBuffer output_;
+
+    uint64_t sequence_;
+    uint64_t ngrams_;
+};
+
+template <class Filter, class OutputBuffer, class RealOutput, class Line> class ChunkedController : boost::noncopyable {
+  private:
+    typedef ChunkBatch<OutputBuffer, Line> Batch;
+
+  public:
+    ChunkedController(size_t chunk_size, size_t queue, size_t workers, const Filter &filter, RealOutput &output)
+      : chunk_size_(chunk_size), queue_size_(queue),
+        batches_(queue),
+        to_read_(queue),
+        output_(queue, 1, boost::in_place(boost::ref(output), boost::ref(to_read_)), NULL),
+        filter_(queue, workers, boost::in_place(boost::ref(filter), boost::ref(output_.In())), NULL),
+        sequence_(0), ngrams_(0) {
+      for (size_t i = 0; i < queue; ++i) {
+        local_read_.push(&batches_[i]);
+      }
+    }
+
+    // Filter [begin, end), which must consist of whole lines, and wait until
+    // all of it has been written.  Returns the number of n-grams seen.
+    uint64_t Run(const char *begin, const char *end) {
+      for (const char *i = begin; i != end;) {
+        const char *split = (static_cast<size_t>(end - i) <= chunk_size_) ? end : i + chunk_size_;
+        if (split != end) {
+          split = static_cast<const char*>(std::memchr(split, '\n', end - split));
+          split = split ? split + 1 : end;
+        }
+        if (local_read_.empty()) MoveRead();
+        local_read_.top()->Fill(sequence_++, StringPiece(i, split - i));
+        filter_.Produce(local_read_.top());
+        local_read_.pop();
+        i = split;
+      }
+      while (local_read_.size() < queue_size_) {
+        MoveRead();
+      }
+      uint64_t ret = ngrams_;
+      ngrams_ = 0;
+      return ret;
+    }
+
+  private:
+    void MoveRead() {
+      Batch *got = to_read_.Consume();
+      ngrams_ += got->NGrams();
+      got->Fill(0, StringPiece());
+      local_read_.push(got);
+    }
+
+    const size_t chunk_size_;
+    const size_t queue_size_;
+
+    std::vector<Batch> batches_;
+
+    util::PCQueue<Batch*> to_read_;
+    std::stack<Batch*> local_read_;
+    util::ThreadPool<OutputWorker<Batch, RealOutput> > output_;
+    util::ThreadPool<FilterWorker<Batch, Filter> > filter_;
+
+    uint64_t sequence_;
+    uint64_t ngrams_;
+};
+
+namespace detail {
+
+inline bool EntirelyWhiteSpace(const StringPiece &line) {
+  for (const char *i = line.data(); i != line.data() + line.size(); ++i) {
+    if (!isspace(*i)) return false;
+  }
+  return true;
+}
+
+// Next line that is not entirely whitespace, without the newline.
+inline StringPiece NextContentLine(const char *&from, const char *end) {
+  while (from != end) {
+    const char *newline = static_cast<const char*>(std::memchr(from, '\n', end - from));
+    if (!newline) newline = end;
+    StringPiece line(from, newline - from);
+    from = (newline == end) ? end : newline + 1;
+    if (!EntirelyWhiteSpace(line)) return line;
+  }
+  return StringPiece();
+}
+
+// ARPA n-gram lines begin with a probability, so the next section starts at
+// the first line beginning with a backslash.  Backslashes are rare enough that
+// memchr skips over almost all of the file.
+inline const char *FindSectionEnd(const char *from, const char *begin, const char *end) {
+  const char *i = from;
+  while (i != end) {
+    i = static_cast<const char*>(std::memchr(i, '\\', end - i));
+    if (!i) return end;
+    if (i == begin || i[-1] == '\n') return i;
+    ++i;
+  }
+  return end;
+}
+
+} // namespace detail
+
+template <class Format> struct Chunked;
+
+template <> struct Chunked<ARPAFormat> {
+  // header is positioned at the beginning of the same file as mapped.  It is
+  // only used to read the counts.
+  template <class Filter, class OutputBuffer, class Output> static void RunFilter(util::FilePiece &header, const MappedInput &mapped, size_t chunk_size, size_t threads, const Filter &filter, Output &output) {
+    std::vector<uint64_t> number;
+    ReadARPACounts(header, number);
+    UTIL_THROW_IF(header.Offset() > static_cast<uint64_t>(mapped.end() - mapped.begin()), FormatLoadException, "ARPA header is longer than the mapped file");
+    output.ReserveForCounts(SizeNeededForCounts(number));
+    ChunkedController<Filter, OutputBuffer, Output, ARPAChunkLine> controller(chunk_size, threads * 2, threads, filter, output);
+    const char *position = mapped.begin() + header.Offset();
+    for (unsigned int i = 0; i < number.size(); ++i) {
+      std::stringstream expected;
+      expected << '\\' << (i + 1) << "-grams:";
+      StringPiece line = detail::NextContentLine(position, mapped.end());
+      UTIL_THROW_IF(line != expected.str(), FormatLoadException, "Was expecting n-gram header " << expected.str() << " but got " << line << " instead");
+      const char *section_end = detail::FindSectionEnd(position, mapped.begin(), mapped.end());
+      // Blank lines separate sections.
+      const char *content_end = section_end;
+      while (content_end != position && isspace(content_end[-1])) --content_end;
+      if (content_end != position && content_end != section_end) ++content_end;
+      output.BeginLength(i + 1);
+      uint64_t got = controller.Run(position, content_end);
+      UTIL_THROW_IF(got != number[i], FormatLoadException, "The header says there are " << number[i] << ' ' << (i + 1) << "-grams but the file has " << got);
+      output.EndLength(i + 1);
+      position = section_end;
+    }
+    StringPiece line = detail::NextContentLine(position, mapped.end());
+    UTIL_THROW_IF(line != "\\end\\", FormatLoadException, "Expected \\end\\ but the ARPA file has " << line);
+    line = detail::NextContentLine(position, mapped.end());
+    UTIL_THROW_IF(!line.empty(), FormatLoadException, "Trailing line " << line);
+    output.Finish();
+  }
+};
+
+template <> struct Chunked<CountFormat> {
+  template <class Filter, class OutputBuffer, class Output> static void RunFilter(util::FilePiece &, const MappedInput &mapped, size_t chunk_size, size_t threads, const Filter &filter, Output &output) {
+    ChunkedController<Filter, OutputBuffer, Output, CountChunkLine> controller(chunk_size, threads * 2, threads, filter, output);
+    controller.Run(mapped.begin(), mapped.end());
+  }
+};
+
+} // namespace lm
+
+#endif // LM_FILTER_CHUNKED_H
@@ -2,6 +2,7 @@
 #include "lm/filter/format.hh"
 #include "lm/filter/phrase.hh"
 #ifndef NTHREAD
+#include "lm/filter/chunked.hh"
 #include "lm/filter/thread.hh"
 #endif
 #include "lm/filter/vocab.hh"
@@ -21,7 +22,7 @@ namespace {
 
 void DisplayHelp(const char *name) {
   std::cerr
-    << "Usage: " << name << " mode [context] [phrase] [raw|arpa] [threads:m] [batch_size:m] (vocab|model):input_file output_file\n\n"
+    << "Usage: " << name << " mode [context] [phrase] [raw|arpa] [threads:m] [batch_size:m] [mmap] [chunk_size:m] (vocab|model):input_file output_file\n\n"
     "copy mode just copies, but makes the format nicer for e.g. irstlm's broken\n"
     "    parser.\n"
     "single mode treats the entire input as a single sentence.\n"
@@ -42,7 +43,11 @@ void DisplayHelp(const char *name) {
 #ifndef NTHREAD
     "threads:m sets m threads (default: conccurrency detected by boost)\n"
     "batch_size:m sets the batch size for threading.  Expect memory usage from this\n"
-    "    of 2*threads*batch_size n-grams.\n\n"
+    "    of 2*threads*batch_size n-grams.\n"
+    "mmap maps the model instead of reading it.  Workers split the file into\n"
+    "    line-aligned chunks and tokenize them in parallel, so there is no serial\n"
+    "    reader.  The model must be an uncompressed file given as model:.\n"
+    "chunk_size:m sets the size of each chunk in bytes for mmap (default 16777216).\n\n"
 #else
     "This binary was compiled with -DNTHREAD, disabling threading.  If you wanted\n"
     "    threading, compile without this flag against Boost >=1.42.0.\n\n"
@@ -62,6 +67,9 @@ struct Config {
 #ifndef NTHREAD
   batch_size(25000),
   threads(boost::thread::hardware_concurrency()),
+  mmap(false),
+  chunk_size(16777216),
+  model_name(NULL),
 #endif
   phrase(false),
   context(false),
@@ -75,6 +83,9 @@ struct Config {
 #ifndef NTHREAD
   size_t batch_size;
   size_t threads;
+  bool mmap;
+  size_t chunk_size;
+  const char *model_name;
 #endif
   bool phrase;
   bool context;
@@ -84,7 +95,10 @@ struct Config {
 
 template <class Format, class Filter, class OutputBuffer, class Output> void RunThreadedFilter(const Config &config, util::FilePiece &in_lm, Filter &filter, Output &output) {
 #ifndef NTHREAD
-  if (config.threads == 1) {
+  if (config.mmap) {
+    MappedInput mapped(config.model_name);
+    Chunked<Format>::template RunFilter<Filter, OutputBuffer, Output>(in_lm, mapped, config.chunk_size, config.threads, filter, output);
+  } else if (config.threads == 1) {
 #endif
     Format::RunFilter(in_lm, filter, output);
 #ifndef NTHREAD
@@ -198,6 +212,14 @@ int main(int argc, char *argv[]) {
           std::cerr << "Batch size must be at least one and should probably be >= 5000" << std::endl;
           if (!config.batch_size) return 1;
         }
+      } else if (!std::strcmp(str, "mmap")) {
+        config.mmap = true;
+      } else if (!std::strncmp(str, "chunk_size:", 11)) {
+        config.chunk_size = boost::lexical_cast<size_t>(str + 11);
+        if (!config.chunk_size) {
+          std::cerr << "Chunk size must be at least one byte." << std::endl;
+          return 1;
+        }
 #endif
       } else {
         lm::DisplayHelp(argv[0]);
@@ -228,6 +250,15 @@ int main(int argc, char *argv[]) {
     } else {
       std::cerr << "Assuming that " << cmd_input << " is a model file" << std::endl;
     }
+#ifndef NTHREAD
+    if (config.mmap) {
+      if (!cmd_is_model) {
+        std::cerr << "mmap needs the model to be a file given as model:, with the vocabulary on stdin." << std::endl;
+        return 1;
+      }
+      config.model_name = cmd_input;
+    }
+#endif
     std::ifstream cmd_file;
     std::istream *vocab;
     if (cmd_is_model) {
@@ -14,7 +14,8 @@ void Usage(const char *name) {
     "-b: Do not buffer output.\n"
     "-n: Do not wrap the input in <s> and </s>.\n"
     "-v summary|sentence|word: Level of verbosity\n"
-    "-l lazy|populate|read|parallel: Load lazily, with populate, or malloc+read\n"
+    "-l lazy|populate|read|parallel|direct: Load lazily, with populate, or malloc+read\n"
+    "  (direct reads in parallel without going through the page cache)\n"
     "The default loading method is populate on Linux and read on others.\n";
   exit(1);
 }
@@ -57,6 +58,8 @@ int main(int argc, char *argv[]) {
           config.load_method = util::READ;
         } else if (!strcmp(optarg, "parallel")) {
           config.load_method = util::PARALLEL_READ;
+        } else if (!strcmp(optarg, "direct")) {
+          config.load_method = util::DIRECT_READ;
         } else {
           Usage(argv[0]);
         }
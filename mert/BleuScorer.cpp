@@ -9,6 +9,7 @@
 #include <stdexcept>
 
 #include "util/exception.hh"
+#include "util/murmur_hash.hh"
 #include "Ngram.h"
 #include "Reference.h"
 #include "Util.h"
@@ -27,6 +28,25 @@ const char REFLEN_AVERAGE[] = "average";
 const char REFLEN_SHORTEST[] = "shortest";
 const char REFLEN_CLOSEST[] = "closest";
 
+// Hash of an n-gram of the hypothesis and where it starts.
+typedef std::pair<uint64_t, const int*> HashedNgram;
+
+// Orders by hash, then by the n-grams themselves so that n-grams whose
+// hashes collide don't end up in one run.
+class HashedNgramLess
+{
+public:
+  explicit HashedNgramLess(std::size_t order) : m_order(order) {}
+
+  bool operator()(const HashedNgram& a, const HashedNgram& b) const {
+    if (a.first != b.first) return a.first < b.first;
+    return std::lexicographical_compare(a.second, a.second + m_order, b.second, b.second + m_order);
+  }
+
+private:
+  std::size_t m_order;
+};
+
 } // namespace
 
 namespace MosesTuning
@@ -35,7 +55,8 @@ namespace MosesTuning
 
 BleuScorer::BleuScorer(const string& config)
   : StatisticsBasedScorer("BLEU", config),
-    m_ref_length_type(CLOSEST)
+    m_ref_length_type(CLOSEST),
+    m_cache_sid(0)
 {
   const string reflen = getConfig(KEY_REFLEN, REFLEN_CLOSEST);
   if (reflen == REFLEN_AVERAGE) {
@@ -91,6 +112,7 @@ void BleuScorer::setReferenceFiles(const vector<string>& referenceFiles)
 {
   // Make sure reference data is clear
   m_references.reset();
+  ClearCaches();
   mert::VocabularyFactory::GetVocabulary()->clear();
 
   //load reference data
@@ -107,6 +129,7 @@ void BleuScorer::setReferenceFiles(const vector<string>& referenceFiles)
 bool BleuScorer::OpenReferenceStream(istream* is, size_t file_id)
 {
   if (is == NULL) return false;
+  ClearCaches();
 
   string line;
   size_t sid = 0;
@@ -162,10 +185,98 @@ bool BleuScorer::GetNextReferenceFromStreams(std::vector<boost::shared_ptr<std::
   return true;
 }
 
+void BleuScorer::ClearCaches()
+{
+  m_reference_hashes.clear();
+  m_stats_cache.clear();
+  m_cache_sid = 0;
+}
+
 void BleuScorer::prepareStats(size_t sid, const string& text, ScoreStats& entry)
 {
   UTIL_THROW_IF2(sid >= m_references.size(), "Sentence id (" << sid << ") not found in reference set");
-  CalcBleuStats(*(m_references[sid]), text, entry);
+
+  if (sid != m_cache_sid) {
+    m_stats_cache.clear();
+    m_cache_sid = sid;
+  }
+  const string sentence = preprocessSentence(text);
+  boost::unordered_map<string, vector<ScoreStatsType> >::const_iterator cached = m_stats_cache.find(sentence);
+  if (cached != m_stats_cache.end()) {
+    entry.set(cached->second);
+    return;
+  }
+
+  if (m_reference_hashes.size() < m_references.size()) {
+    m_reference_hashes.resize(m_references.size());
+  }
+  boost::shared_ptr<NgramHashCounts>& refHashes = m_reference_hashes[sid];
+  if (!refHashes) {
+    refHashes.reset(new NgramHashCounts);
+    HashReferenceNgrams(*(m_references[sid]), *refHashes);
+  }
+
+  vector<int> tokens;
+  TokenizeAndEncodeTesting(sentence, tokens);
+  vector<ScoreStatsType>& stats = m_stats_cache[sentence];
+  CalcBleuStats(*(m_references[sid]), *refHashes, tokens, stats);
+  entry.set(stats);
+}
+
+uint64_t BleuScorer::HashNgram(const int* begin, size_t order)
+{
+  return util::MurmurHashNative(begin, order * sizeof(int), order);
+}
+
+void BleuScorer::HashReferenceNgrams(const Reference& ref, NgramHashCounts& out)
+{
+  const NgramCounts& counts = *ref.get_counts();
+  out.clear();
+  out.rehash(counts.size());
+  for (NgramCounts::const_iterator i = counts.begin(); i != counts.end(); ++i) {
+    // On a collision the first n-gram keeps the slot; the other one is
+    // found by CalcBleuStats through the exact lookup.
+    out.insert(make_pair(HashNgram(&i->first[0], i->first.size()), i));
+  }
+}
+
+void BleuScorer::CalcBleuStats(const Reference& ref, const NgramHashCounts& refHashes,
+                               const vector<int>& tokens, vector<ScoreStatsType>& stats) const
+{
+  stats.assign(kBleuNgramOrder * 2, 0);
+  const size_t length = tokens.size();
+  vector<HashedNgram> hashes;
+  hashes.reserve(length);
+  for (size_t order = 1; order <= kBleuNgramOrder && order <= length; ++order) {
+    hashes.clear();
+    for (size_t i = 0; i + order <= length; ++i) {
+      hashes.push_back(HashedNgram(HashNgram(&tokens[i], order), &tokens[i]));
+    }
+    // Equal n-grams are adjacent after sorting, so each distinct n-gram is
+    // clipped against the reference once.
+    const HashedNgramLess less(order);
+    sort(hashes.begin(), hashes.end(), less);
+    for (vector<HashedNgram>::const_iterator run = hashes.begin(); run != hashes.end();) {
+      vector<HashedNgram>::const_iterator run_end = run;
+      while (run_end != hashes.end() && !less(*run, *run_end)) ++run_end;
+      const NgramCounts::Value guess = run_end - run;
+      const int* ngram = run->second;
+      NgramHashCounts::const_iterator found = refHashes.find(run->first);
+      if (found != refHashes.end()) {
+        const NgramCounts::Key& key = found->second->first;
+        NgramCounts::Value count = found->second->second;
+        if (key.size() == order && equal(ngram, ngram + order, key.begin())) {
+          stats[order * 2 - 2] += min(count, guess);
+        } else if (ref.get_counts()->Lookup(NgramCounts::Key(ngram, ngram + order), &count)) {
+          // hash collision
+          stats[order * 2 - 2] += min(count, guess);
+        }
+      }
+      stats[order * 2 - 1] += guess;
+      run = run_end;
+    }
+  }
+  stats.push_back(CalcReferenceLength(ref, length));
 }
 
 void BleuScorer::CalcBleuStats(const Reference& ref, const std::string& text, ScoreStats& entry) const
@@ -5,6 +5,8 @@
 #include <vector>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <stdint.h>
 
 #include "Ngram.h"
 #include "Reference.h"
@@ -44,6 +46,26 @@ public:
 
   void CalcBleuStats(const Reference& ref, const std::string& text, ScoreStats& entry) const;
 
+  /**
+   * Hashes of the reference n-grams, mapped to their entry in the reference
+   * counts.  Hits are checked against the entry's n-gram, so a collision
+   * can't be counted as a match.
+   */
+  typedef boost::unordered_map<uint64_t, NgramCounts::const_iterator> NgramHashCounts;
+
+  static uint64_t HashNgram(const int* begin, std::size_t order);
+
+  static void HashReferenceNgrams(const Reference& ref, NgramHashCounts& out);
+
+  /**
+   * Same statistics as CalcBleuStats, for an already encoded hypothesis.
+   * All n-grams of one order are hashed, sorted and matched in one pass
+   * instead of being counted in a map keyed by token vectors.  N-grams
+   * are compared whenever their hashes are equal.
+   */
+  void CalcBleuStats(const Reference& ref, const NgramHashCounts& refHashes,
+                     const std::vector<int>& tokens, std::vector<ScoreStatsType>& stats) const;
+
   int CalcReferenceLength(const Reference& ref, std::size_t length) const;
 
   ReferenceLengthType GetReferenceLengthType() const {
@@ -83,8 +105,21 @@ protected:
   // reference translations.
   ScopedVector<Reference> m_references;
 
+  // Hashed n-grams of each reference, built on the first prepareStats()
+  // for that sentence.
+  std::vector<boost::shared_ptr<NgramHashCounts> > m_reference_hashes;
+
+  // n-best lists repeat hypotheses (same string, different derivation), so
+  // the statistics for the sentence currently being prepared are kept by
+  // hypothesis text.
+  std::size_t m_cache_sid;
+  boost::unordered_map<std::string, std::vector<ScoreStatsType> > m_stats_cache;
+
+  void ClearCaches();
+
   // constructor used by subclasses
-  BleuScorer(const std::string& name, const std::string& config): StatisticsBasedScorer(name,config) {}
+  BleuScorer(const std::string& name, const std::string& config)
+    : StatisticsBasedScorer(name,config), m_cache_sid(0) {}
 
   // no copying allowed
   BleuScorer(const BleuScorer&);
@@ -4,6 +4,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <cmath>
+#include <sstream>
 #include "Ngram.h"
 #include "Vocabulary.h"
 #include "Util.h"
@@ -232,6 +233,59 @@ BOOST_AUTO_TEST_CASE(bleu_clipped_counts)
   BOOST_CHECK_EQUAL(entry.get(7), 3);  // fourgram
 }
 
+BOOST_AUTO_TEST_CASE(bleu_prepare_stats_matches_ngram_counts)
+{
+  BleuScorer scorer;
+  SetUpReferences(scorer);
+  const char* lines[] = {
+    "the security of the security of this airport",
+    "israeli officials responsibility of airport safety",
+    "the security of the security of this airport",
+    "unknown words unknown words"
+  };
+  for (std::size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); ++i) {
+    ScoreStats prepared, counted;
+    scorer.prepareStats(0, lines[i], prepared);
+    scorer.CalcBleuStats(*scorer.GetReferences()[0], lines[i], counted);
+    BOOST_CHECK(prepared == counted);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(bleu_prepare_stats_hash_collisions)
+{
+  BleuScorer scorer;
+  SetUpReferences(scorer);
+  const std::string line("israeli officials responsibility of airport safety");
+  const Reference& ref = *scorer.GetReferences()[0];
+  const NgramCounts& counts = *ref.get_counts();
+  std::vector<int> tokens;
+  std::istringstream words(line);
+  for (std::string word; words >> word;) {
+    tokens.push_back(Unigram(word).instance[0]);
+  }
+
+  BleuScorer::NgramHashCounts hashes;
+  BleuScorer::HashReferenceNgrams(ref, hashes);
+  // "airport safety" is not in the references; pretend its hash is that of
+  // "airport security".
+  NgramCounts::const_iterator security = counts.find(Bigram("airport", "security").instance);
+  BOOST_REQUIRE(security != counts.end());
+  hashes[BleuScorer::HashNgram(&tokens[4], 2)] = security;
+  // "officials" is, but lost its slot to "israeli".
+  NgramCounts::const_iterator israeli = counts.find(Unigram("israeli").instance);
+  BOOST_REQUIRE(israeli != counts.end());
+  hashes[BleuScorer::HashNgram(&tokens[1], 1)] = israeli;
+
+  std::vector<ScoreStatsType> stats;
+  scorer.CalcBleuStats(ref, hashes, tokens, stats);
+  ScoreStats hashed, counted;
+  hashed.set(stats);
+  scorer.CalcBleuStats(ref, line, counted);
+  BOOST_CHECK(hashed == counted);
+  BOOST_CHECK_EQUAL(hashed.get(0), 5);  // unigram
+  BOOST_CHECK_EQUAL(hashed.get(2), 2);  // bigram
+}
+
 BOOST_AUTO_TEST_CASE(calculate_actual_score)
 {
   BOOST_REQUIRE(4 == kBleuNgramOrder);
@@ -21,12 +21,27 @@
 #include "util/tokenize_piece.hh"
 #include "util/string_piece.hh"
 #include "FeatureDataIterator.h"
+#include "moses/BinaryNBest.h"
 
 using namespace std;
 
 namespace MosesTuning
 {
 
+namespace
+{
+bool IsBinaryNBest(const string &file)
+{
+  util::FilePiece in(file.c_str());
+  try {
+    return in.ReadBytes(sizeof(Moses::BinaryNBest::Magic))
+           == StringPiece(Moses::BinaryNBest::Magic, sizeof(Moses::BinaryNBest::Magic));
+  } catch (util::EndOfFileException &e) {
+    return false;
+  }
+}
+}
+
 Data::Data(Scorer* scorer, const string& sparse_weights_file)
   : m_scorer(scorer),
     m_score_type(m_scorer->getName()),
@@ -139,6 +154,10 @@ void Data::load(const std::string &featfile, const std::string &scorefile)
 void Data::loadNBest(const string &file, bool oneBest)
 {
   TRACE_ERR("loading nbest from " << file << endl);
+  if (IsBinaryNBest(file)) {
+    loadBinaryNBest(file, oneBest);
+    return;
+  }
   util::FilePiece in(file.c_str());
 
   ScoreStats scoreentry;
@@ -195,6 +214,75 @@ void Data::loadNBest(const string &file, bool oneBest)
   }
 }
 
+void Data::loadBinaryNBest(const string &file, bool oneBest)
+{
+  using namespace Moses::BinaryNBest;
+  util::FilePiece in(file.c_str());
+  in.ReadBytes(sizeof(Magic));
+
+  // dense feature names, as InitFeatureMap() makes them from a text n-best list
+  size_t numDense = 0;
+  string features;
+  for (uint32_t numProducers = Read<uint32_t>(in); numProducers; --numProducers) {
+    const string name = ReadString(in).as_string();
+    const uint32_t num = Read<uint32_t>(in);
+    for (uint32_t i = 0; i < num; ++i) {
+      stringstream ss;
+      ss << name << "_" << i << " ";
+      features.append(ss.str());
+    }
+    numDense += num;
+  }
+  if (!existsFeatureNames()) {
+    m_feature_data->setFeatureMap(features);
+  }
+  UTIL_THROW_IF2(Features() != features, "The features of " << file
+                 << " differ from those of the n-best lists loaded before");
+
+  ScoreStats scoreentry;
+  FeatureStats featureentry;
+  string sentence, alignment;
+  uint32_t sentence_index;
+
+  while (true) {
+    try {
+      sentence_index = Read<uint32_t>(in);
+    } catch (util::EndOfFileException &e) {
+      PrintUserTime("Loaded N-best lists");
+      break;
+    }
+    sentence = ReadString(in).as_string();
+
+    featureentry.reset();
+    for (size_t i = 0; i < numDense; ++i) {
+      featureentry.add(Read<float>(in));
+    }
+    // sparse names keep the '=' of the text format, as AddFeatures() does
+    for (uint32_t numSparse = Read<uint32_t>(in); numSparse; --numSparse) {
+      const string name = ReadString(in).as_string() + "=";
+      featureentry.addSparse(name, Read<float>(in));
+    }
+
+    Read<float>(in); // skip model score.
+    alignment = ReadString(in).as_string(); // phrase alignment
+    StringPiece wordAlignment = ReadString(in);
+    if (!wordAlignment.empty()) {
+      alignment = wordAlignment.as_string();
+    }
+
+    if (oneBest && m_score_data->exists(sentence_index)) continue;
+
+    scoreentry.clear();
+    if (m_scorer->useAlignment()) {
+      sentence += "|||";
+      sentence += alignment;
+    }
+    m_scorer->prepareStats(sentence_index, sentence, scoreentry);
+    m_score_data->add(scoreentry, sentence_index);
+    m_feature_data->add(featureentry, sentence_index);
+  }
+}
+
 void Data::save(const std::string &featfile, const std::string &scorefile, bool bin)
 {
   if (bin)
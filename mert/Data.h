@@ -36,6 +36,9 @@ private:
   FeatureDataHandle m_feature_data;
   SparseVector m_sparse_weights;
 
+  // n-best list written by moses -n-best-binary, see moses/BinaryNBest.h
+  void loadBinaryNBest(const std::string &file, bool oneBest);
+
 public:
   explicit Data(Scorer* scorer, const std::string& sparseweightsfile="");
 
@@ -67,6 +70,7 @@ public:
     m_feature_data->Features(f);
   }
 
+  // text or binary n-best list
   void loadNBest(const std::string &file, bool oneBest=false);
 
   void load(const std::string &featfile, const std::string &scorefile);
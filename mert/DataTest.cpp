@@ -6,6 +6,10 @@
 #include <boost/test/unit_test.hpp>
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
+#include "moses/BinaryNBest.h"
 
 using namespace MosesTuning;
 
@@ -75,3 +79,71 @@ BOOST_AUTO_TEST_CASE(add_features_test)
   BOOST_CHECK(IsAlmostEqual(-14.7486f, stats.get(7)));
   BOOST_CHECK(IsAlmostEqual(7.99917f,  stats.get(8)));
 }
+
+BOOST_AUTO_TEST_CASE(load_binary_nbest_test)
+{
+  using namespace Moses::BinaryNBest;
+  namespace fs = boost::filesystem;
+  const fs::path dir = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directories(dir);
+  const std::string ref = (dir / "ref").string();
+  const std::string text = (dir / "nbest.txt").string();
+  const std::string binary = (dir / "nbest.bin").string();
+
+  std::ofstream(ref.c_str()) << "a b c d\ne f\n";
+  std::ofstream(text.c_str())
+      << "0 ||| a b c  ||| lm= -4.5 -3 w= -3 tm_x= 0.5 ||| -1.5\n"
+      << "0 ||| a c  ||| lm= -6 -2 w= -2 ||| -2\n"
+      << "1 ||| e f  ||| lm= -1 -1.25 w= -2 ||| -0.5\n";
+  {
+    std::ofstream out(binary.c_str(), std::ios::binary);
+    out.write(Magic, sizeof(Magic));
+    Write<uint32_t>(out, 2);
+    WriteString(out, "lm");
+    Write<uint32_t>(out, 2);
+    WriteString(out, "w");
+    Write<uint32_t>(out, 1);
+
+    const char *surfaces[] = {"a b c ", "a c ", "e f "};
+    const float dense[][3] = {{-4.5, -3, -3}, {-6, -2, -2}, {-1, -1.25, -2}};
+    for (uint32_t i = 0; i < 3; ++i) {
+      Write<uint32_t>(out, i / 2);
+      WriteString(out, surfaces[i]);
+      for (size_t j = 0; j < 3; ++j) {
+        Write<float>(out, dense[i][j]);
+      }
+      Write<uint32_t>(out, i == 0);
+      if (i == 0) {
+        WriteString(out, "tm_x");
+        Write<float>(out, 0.5);
+      }
+      Write<float>(out, 0);
+      WriteString(out, "");
+      WriteString(out, "");
+    }
+  }
+
+  std::vector<std::string> refs(1, ref);
+  boost::scoped_ptr<Scorer> scorer(ScorerFactory::getScorer("BLEU", ""));
+  scorer->setReferenceFiles(refs);
+  Data fromText(scorer.get());
+  fromText.loadNBest(text);
+  Data fromBinary(scorer.get());
+  fromBinary.loadNBest(binary);
+
+  BOOST_CHECK_EQUAL(fromText.Features(), fromBinary.Features());
+  BOOST_REQUIRE_EQUAL(fromText.getFeatureData()->size(), fromBinary.getFeatureData()->size());
+  for (size_t i = 0; i < fromText.getFeatureData()->size(); ++i) {
+    std::stringstream expected, actual;
+    fromText.getFeatureData()->get(i).savetxt(&expected);
+    fromBinary.getFeatureData()->get(i).savetxt(&actual);
+    BOOST_CHECK_EQUAL(expected.str(), actual.str());
+
+    std::stringstream expectedScores, actualScores;
+    fromText.getScoreData()->get(i).savetxt(&expectedScores, "BLEU");
+    fromBinary.getScoreData()->get(i).savetxt(&actualScores, "BLEU");
+    BOOST_CHECK_EQUAL(expectedScores.str(), actualScores.str());
+  }
+
+  fs::remove_all(dir);
+}
@@ -8,7 +8,9 @@
 
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
 #include "FeatureArray.h"
+#include "FeatureBlock.h"
 #include "FileStream.h"
 #include "Util.h"
 
@@ -38,9 +40,7 @@ void FeatureArray::savebin(ostream* os)
 {
   *os << FEATURES_BIN_BEGIN << " " << m_index << " " << m_array.size()
       << " " << m_num_features << " " << m_features << endl;
-  for (featarray_t::iterator i = m_array.begin(); i != m_array.end(); ++i)
-    i->savebin(os);
-
+  WriteFeatureBlock(*os, m_array, m_num_features);
   *os << FEATURES_BIN_END << endl;
 }
 
@@ -72,7 +72,32 @@ void FeatureArray::save(bool bin)
   save(&cout, bin);
 }
 
-void FeatureArray::loadbin(istream* is, size_t n)
+void FeatureArray::loadbin(istream* is, const SparseVector& sparseWeights, size_t n)
+{
+  char size_buf[kFeatureBlockSizeBytes];
+  is->read(size_buf, kFeatureBlockSizeBytes);
+  string body(ReadFeatureBlockSize(StringPiece(size_buf, is->gcount())), '\0');
+  is->read(&body[0], body.size());
+  if (static_cast<size_t>(is->gcount()) != body.size()) {
+    throw runtime_error("Truncated binary feature block");
+  }
+
+  FeatureBlockReader block(body, n, m_num_features);
+  FeatureStats entry;
+  for (size_t i = 0 ; i < n; i++) {
+    entry.reset();
+    for (size_t j = 0; j < m_num_features; ++j) {
+      entry.add(block.Dense(i, j));
+    }
+    for (size_t k = block.SparseBegin(i); k != block.SparseEnd(i); ++k) {
+      entry.addSparse(block.SparseId(k), block.SparseValue(k));
+    }
+    if (sparseWeights.size()) entry.mergeSparse(sparseWeights);
+    add(entry);
+  }
+}
+
+void FeatureArray::loadbin0(istream* is, size_t n)
 {
   FeatureStats entry(m_num_features);
   for (size_t i = 0 ; i < n; i++) {
@@ -94,7 +119,7 @@ void FeatureArray::loadtxt(istream* is, const SparseVector& sparseWeights, size_
 void FeatureArray::load(istream* is, const SparseVector& sparseWeights)
 {
   size_t number_of_entries = 0;
-  bool binmode = false;
+  bool binmode = false, binmode0 = false;
 
   string substring, stringBuf;
   string::size_type loc;
@@ -109,6 +134,8 @@ void FeatureArray::load(istream* is, const SparseVector& sparseWeights)
       binmode = false;
     } else if ((loc = stringBuf.find(FEATURES_BIN_BEGIN)) == 0) {
       binmode = true;
+    } else if ((loc = stringBuf.find(FEATURES_BIN_BEGIN_0)) == 0) {
+      binmode0 = true;
     } else {
       TRACE_ERR("ERROR: FeatureArray::load(): Wrong header");
       return;
@@ -124,7 +151,9 @@ void FeatureArray::load(istream* is, const SparseVector& sparseWeights)
   }
 
   if (binmode) {
-    loadbin(is, number_of_entries);
+    loadbin(is, sparseWeights, number_of_entries);
+  } else if (binmode0) {
+    loadbin0(is, number_of_entries);
   } else {
     loadtxt(is, sparseWeights, number_of_entries);
   }
@@ -132,7 +161,8 @@ void FeatureArray::load(istream* is, const SparseVector& sparseWeights)
   getline(*is, stringBuf);
   if (!stringBuf.empty()) {
     if ((loc = stringBuf.find(FEATURES_TXT_END)) != 0 &&
-        (loc = stringBuf.find(FEATURES_BIN_END)) != 0) {
+        (loc = stringBuf.find(FEATURES_BIN_END)) != 0 &&
+        (loc = stringBuf.find(FEATURES_BIN_END_0)) != 0) {
       TRACE_ERR("ERROR: FeatureArray::load(): Wrong footer");
       return;
     }
@@ -19,8 +19,12 @@ namespace MosesTuning
 
 const char FEATURES_TXT_BEGIN[] = "FEATURES_TXT_BEGIN_0";
 const char FEATURES_TXT_END[] = "FEATURES_TXT_END_0";
-const char FEATURES_BIN_BEGIN[] = "FEATURES_BIN_BEGIN_0";
-const char FEATURES_BIN_END[] = "FEATURES_BIN_END_0";
+// Version 1 binary blocks also hold sparse features, see FeatureBlock.h
+const char FEATURES_BIN_BEGIN[] = "FEATURES_BIN_BEGIN_1";
+const char FEATURES_BIN_END[] = "FEATURES_BIN_END_1";
+// Version 0 binary blocks only hold the dense features; still read by load()
+const char FEATURES_BIN_BEGIN_0[] = "FEATURES_BIN_BEGIN_0";
+const char FEATURES_BIN_END_0[] = "FEATURES_BIN_END_0";
 
 class FeatureArray
 {
@@ -96,7 +100,8 @@ public:
   void save(bool bin=false);
 
   void loadtxt(std::istream* is, const SparseVector& sparseWeights, std::size_t n);
-  void loadbin(std::istream* is, std::size_t n);
+  void loadbin(std::istream* is, const SparseVector& sparseWeights, std::size_t n);
+  void loadbin0(std::istream* is, std::size_t n);
   void load(std::istream* is, const SparseVector& sparseWeights);
 
   bool check_consistency() const;
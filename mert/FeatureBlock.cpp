@@ -0,0 +1,150 @@
+/*
+ *  FeatureBlock.cpp
+ *  mert - Minimum Error Rate Training
+ *
+ */
+
+#include <cstring>
+#include <map>
+#include <ostream>
+
+#include "util/exception.hh"
+#include "FeatureBlock.h"
+
+using namespace std;
+
+namespace MosesTuning
+{
+
+namespace
+{
+
+template <class T> void Append(string &to, T value)
+{
+  to.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T> T Get(const char *from)
+{
+  T ret;
+  memcpy(&ret, from, sizeof(T));
+  return ret;
+}
+
+// Check that [at, at + bytes) lies inside body before reading it.
+void Need(const StringPiece &body, const char *at, size_t bytes)
+{
+  UTIL_THROW_IF(at < body.data() || static_cast<size_t>(body.data() + body.size() - at) < bytes,
+                util::Exception, "Truncated binary feature block");
+}
+
+const size_t kPairBytes = sizeof(uint32_t) + sizeof(FeatureStatsType);
+
+} // namespace
+
+void WriteFeatureBlock(ostream &out, const featarray_t &entries, size_t num_dense)
+{
+  // global sparse id -> block-local id
+  map<size_t, uint32_t> local;
+  vector<size_t> names;
+  for (featarray_t::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+    const vector<size_t> feats = i->getSparse().feats();
+    for (vector<size_t>::const_iterator f = feats.begin(); f != feats.end(); ++f) {
+      if (local.insert(make_pair(*f, static_cast<uint32_t>(names.size()))).second) {
+        names.push_back(*f);
+      }
+    }
+  }
+
+  string body;
+  Append<uint32_t>(body, names.size());
+  for (vector<size_t>::const_iterator i = names.begin(); i != names.end(); ++i) {
+    // In memory the names keep the '=' that separates them from the value
+    // in the text format; store them as text readers would parse them.
+    string name = SparseVector::decode(*i);
+    if (!name.empty() && name[name.size() - 1] == '=') name.resize(name.size() - 1);
+    Append<uint32_t>(body, name.size());
+    body.append(name);
+  }
+  for (featarray_t::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+    UTIL_THROW_IF(i->size() != num_dense, util::Exception,
+                  "Entry has " << i->size() << " dense features instead of " << num_dense);
+    body.append(reinterpret_cast<const char*>(i->getArray()), i->bytes());
+  }
+  for (featarray_t::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+    Append<uint32_t>(body, i->getSparse().size());
+  }
+  for (featarray_t::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+    const SparseVector &sparse = i->getSparse();
+    const vector<size_t> feats = sparse.feats();
+    for (vector<size_t>::const_iterator f = feats.begin(); f != feats.end(); ++f) {
+      Append<uint32_t>(body, local[*f]);
+      Append<FeatureStatsType>(body, sparse.get(*f));
+    }
+  }
+
+  uint64_t size = body.size();
+  out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  out.write(body.data(), body.size());
+}
+
+uint64_t ReadFeatureBlockSize(StringPiece from)
+{
+  UTIL_THROW_IF(from.size() < kFeatureBlockSizeBytes, util::Exception, "Truncated binary feature block");
+  return Get<uint64_t>(from.data());
+}
+
+FeatureBlockReader::FeatureBlockReader(StringPiece body, size_t num_entries, size_t num_dense)
+  : m_num_dense(num_dense)
+{
+  const char *at = body.data();
+  Need(body, at, sizeof(uint32_t));
+  const uint32_t num_names = Get<uint32_t>(at);
+  at += sizeof(uint32_t);
+  m_ids.reserve(num_names);
+  for (uint32_t i = 0; i < num_names; ++i) {
+    Need(body, at, sizeof(uint32_t));
+    const uint32_t length = Get<uint32_t>(at);
+    at += sizeof(uint32_t);
+    Need(body, at, length);
+    m_ids.push_back(SparseVector::encode(string(at, length)));
+    at += length;
+  }
+
+  m_dense = at;
+  Need(body, at, num_entries * num_dense * sizeof(FeatureStatsType));
+  at += num_entries * num_dense * sizeof(FeatureStatsType);
+
+  Need(body, at, num_entries * sizeof(uint32_t));
+  m_offsets.resize(num_entries + 1);
+  m_offsets[0] = 0;
+  for (size_t i = 0; i < num_entries; ++i, at += sizeof(uint32_t)) {
+    m_offsets[i + 1] = m_offsets[i] + Get<uint32_t>(at);
+  }
+
+  m_sparse = at;
+  Need(body, at, m_offsets.back() * kPairBytes);
+  UTIL_THROW_IF(at + m_offsets.back() * kPairBytes != body.data() + body.size(),
+                util::Exception, "Binary feature block has trailing bytes");
+  for (size_t k = 0; k < m_offsets.back(); ++k) {
+    UTIL_THROW_IF(Get<uint32_t>(m_sparse + k * kPairBytes) >= m_ids.size(),
+                  util::Exception, "Bad sparse feature id in binary feature block");
+  }
+}
+
+FeatureStatsType FeatureBlockReader::Dense(size_t entry, size_t i) const
+{
+  return Get<FeatureStatsType>(m_dense + (entry * m_num_dense + i) * sizeof(FeatureStatsType));
+}
+
+size_t FeatureBlockReader::SparseId(size_t k) const
+{
+  return m_ids[Get<uint32_t>(m_sparse + k * kPairBytes)];
+}
+
+FeatureStatsType FeatureBlockReader::SparseValue(size_t k) const
+{
+  return Get<FeatureStatsType>(m_sparse + k * kPairBytes + sizeof(uint32_t));
+}
+
+}
@@ -0,0 +1,80 @@
+/*
+ *  FeatureBlock.h
+ *  mert - Minimum Error Rate Training
+ *
+ *  Binary encoding of the n-best entries of one sentence, as stored between
+ *  FEATURES_BIN_BEGIN and FEATURES_BIN_END.
+ *
+ */
+
+#ifndef MERT_FEATURE_BLOCK_H_
+#define MERT_FEATURE_BLOCK_H_
+
+#include <iosfwd>
+#include <vector>
+#include <stdint.h>
+
+#include "util/string_piece.hh"
+#include "Types.h"
+#include "FeatureStats.h"
+
+namespace MosesTuning
+{
+
+/**
+ * After the text header line of a binary block come
+ *   uint64  size in bytes of everything that follows, up to the footer line
+ *   uint32  number of sparse feature names used in this block,
+ *           then each name as a uint32 length and its characters, without
+ *           the trailing '=' of the text format
+ *   float   dense features, one row of num_dense values per entry
+ *   uint32  number of sparse features of each entry
+ *   pairs of a uint32 block-local name id and a float value
+ * all in host byte order.  Every block carries its own names, so feature
+ * files can be appended to or concatenated.
+ */
+void WriteFeatureBlock(std::ostream &out, const featarray_t &entries, std::size_t num_dense);
+
+/**
+ * Decodes a block in place, without copying the dense columns out of the
+ * buffer it was read into.
+ */
+class FeatureBlockReader
+{
+public:
+  // body excludes the uint64 size.
+  FeatureBlockReader(StringPiece body, std::size_t num_entries, std::size_t num_dense);
+
+  std::size_t NumEntries() const {
+    return m_offsets.size() - 1;
+  }
+
+  FeatureStatsType Dense(std::size_t entry, std::size_t i) const;
+
+  // Sparse features of entry are [SparseBegin(entry), SparseEnd(entry)).
+  std::size_t SparseBegin(std::size_t entry) const {
+    return m_offsets[entry];
+  }
+  std::size_t SparseEnd(std::size_t entry) const {
+    return m_offsets[entry + 1];
+  }
+  // Id as given by SparseVector::encode.
+  std::size_t SparseId(std::size_t k) const;
+  FeatureStatsType SparseValue(std::size_t k) const;
+
+private:
+  std::size_t m_num_dense;
+  const char *m_dense;
+  const char *m_sparse;
+  std::vector<std::size_t> m_ids;
+  std::vector<std::size_t> m_offsets;
+};
+
+// Size of the uint64 that precedes a block body.
+const std::size_t kFeatureBlockSizeBytes = sizeof(uint64_t);
+
+uint64_t ReadFeatureBlockSize(StringPiece from);
+
+}
+
+#endif  // MERT_FEATURE_BLOCK_H_
@@ -0,0 +1,151 @@
+#include "FeatureArray.h"
+#include "FeatureBlock.h"
+#include "FeatureDataIterator.h"
+
+#define BOOST_TEST_MODULE FeatureBlock
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
+
+using namespace MosesTuning;
+
+namespace
+{
+
+// Entries as extractor makes them: sparse names keep the '=' of the n-best
+// list.  Values are exact in text and in binary.
+FeatureArray MakeArray(int index)
+{
+  FeatureArray ret;
+  ret.setIndex(index);
+  ret.NumberOfFeatures(3);
+  ret.Features("lm_0 tm_0 tm_1");
+
+  FeatureStats first;
+  first.add(-4.5);
+  first.add(0.25);
+  first.add(index);
+  first.addSparse("fa_x=", 1.5);
+  first.addSparse("fb=", -0.25);
+  ret.add(first);
+
+  FeatureStats second;
+  second.add(-6);
+  second.add(0);
+  second.add(2);
+  ret.add(second);
+
+  FeatureStats third;
+  third.add(-1);
+  third.add(-1.25);
+  third.add(3);
+  third.addSparse("fb=", 2);
+  ret.add(third);
+  return ret;
+}
+
+FeatureArray Load(const std::string &saved, const SparseVector &sparseWeights)
+{
+  std::istringstream in(saved);
+  FeatureArray ret;
+  ret.load(&in, sparseWeights);
+  return ret;
+}
+
+std::string Save(FeatureArray array, bool bin)
+{
+  std::ostringstream out;
+  array.save(&out, bin);
+  return out.str();
+}
+
+void CheckSame(const FeatureArray &text, const FeatureArray &bin)
+{
+  BOOST_CHECK_EQUAL(text.getIndex(), bin.getIndex());
+  BOOST_CHECK_EQUAL(text.NumberOfFeatures(), bin.NumberOfFeatures());
+  BOOST_CHECK_EQUAL(text.Features(), bin.Features());
+  BOOST_REQUIRE_EQUAL(text.size(), bin.size());
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    BOOST_CHECK(text.get(i) == bin.get(i));
+    BOOST_CHECK(text.get(i).getSparse() == bin.get(i).getSparse());
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(feature_array_round_trip)
+{
+  const std::string text = Save(MakeArray(7), false);
+  const std::string bin = Save(MakeArray(7), true);
+  BOOST_REQUIRE_EQUAL(0U, bin.find(FEATURES_BIN_BEGIN));
+
+  const SparseVector none;
+  FeatureArray from_text = Load(text, none);
+  FeatureArray from_bin = Load(bin, none);
+  CheckSame(from_text, from_bin);
+  BOOST_REQUIRE_EQUAL(3U, from_bin.size());
+  BOOST_CHECK_EQUAL(-4.5, from_bin.get(0).get(0));
+  BOOST_CHECK_EQUAL(7, from_bin.get(0).get(2));
+  BOOST_CHECK_EQUAL(1.5, from_bin.get(0).getSparse().get(SparseVector::encode("fa_x")));
+  BOOST_CHECK_EQUAL(0U, from_bin.get(1).getSparse().size());
+  BOOST_CHECK_EQUAL(2, from_bin.get(2).getSparse().get(SparseVector::encode("fb")));
+
+  // Sparse features merged into one dense feature.
+  SparseVector weights;
+  weights.set("fa_x", 2);
+  weights.set("fb", 1);
+  from_text = Load(text, weights);
+  from_bin = Load(bin, weights);
+  CheckSame(from_text, from_bin);
+  BOOST_REQUIRE_EQUAL(4U, from_bin.get(0).size());
+  BOOST_CHECK_EQUAL(2.75, from_bin.get(0).get(3));
+  BOOST_CHECK_EQUAL(0, from_bin.get(1).get(3));
+}
+
+BOOST_AUTO_TEST_CASE(feature_data_iterator_round_trip)
+{
+  namespace fs = boost::filesystem;
+  const fs::path dir = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directories(dir);
+  const std::string text = (dir / "features.txt").string();
+  const std::string bin = (dir / "features.bin").string();
+  // Two sentences each, so blocks have to be found one after the other.
+  std::ofstream(text.c_str()) << Save(MakeArray(0), false) << Save(MakeArray(1), false);
+  std::ofstream(bin.c_str(), std::ios::binary) << Save(MakeArray(0), true) << Save(MakeArray(1), true);
+
+  FeatureDataIterator t(text), b(bin);
+  std::size_t sentences = 0;
+  for (; t != FeatureDataIterator::end() && b != FeatureDataIterator::end(); ++t, ++b, ++sentences) {
+    BOOST_REQUIRE_EQUAL(3U, b->size());
+    BOOST_CHECK((*t) == (*b));
+    BOOST_CHECK_EQUAL(2U, (*b)[0].sparse.size());
+    BOOST_CHECK_EQUAL(-0.25, (*b)[0].sparse.get(SparseVector::encode("fb")));
+    BOOST_CHECK_EQUAL(sentences, (*b)[0].dense[2]);
+  }
+  BOOST_CHECK(t == FeatureDataIterator::end());
+  BOOST_CHECK(b == FeatureDataIterator::end());
+  BOOST_CHECK_EQUAL(2U, sentences);
+  fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(load_version_0)
+{
+  // Dense features only, as written before sparse features were added.
+  std::ostringstream out;
+  out << FEATURES_BIN_BEGIN_0 << " 4 2 2 lm_0 w_0" << std::endl;
+  const FeatureStatsType values[] = {-1.5, 2, 0.5, -3};
+  out.write(reinterpret_cast<const char*>(values), sizeof(values));
+  out << FEATURES_BIN_END_0 << std::endl;
+
+  FeatureArray array = Load(out.str(), SparseVector());
+  BOOST_CHECK_EQUAL(4, array.getIndex());
+  BOOST_REQUIRE_EQUAL(2U, array.size());
+  for (std::size_t i = 0; i < 2; ++i) {
+    BOOST_REQUIRE_EQUAL(2U, array.get(i).size());
+    BOOST_CHECK_EQUAL(values[2 * i], array.get(i).get(0));
+    BOOST_CHECK_EQUAL(values[2 * i + 1], array.get(i).get(1));
+    BOOST_CHECK_EQUAL(0U, array.get(i).getSparse().size());
+  }
+}
@@ -24,6 +24,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "util/tokenize_piece.hh"
 
 #include "FeatureArray.h"
+#include "FeatureBlock.h"
 #include "FeatureDataIterator.h"
 
 
@@ -84,7 +85,8 @@ void FeatureDataIterator::readNext()
   m_next.clear();
   try {
     StringPiece marker = m_in->ReadDelimited();
-    if (marker != StringPiece(FEATURES_TXT_BEGIN)) {
+    bool binary = (marker == StringPiece(FEATURES_BIN_BEGIN));
+    if (!binary && marker != StringPiece(FEATURES_TXT_BEGIN)) {
       throw FileFormatException(m_in->FileName(), marker.as_string());
     }
     // size_t sentenceId =
@@ -92,6 +94,10 @@ void FeatureDataIterator::readNext()
     size_t count = m_in->ReadULong();
     size_t length = m_in->ReadULong();
     m_in->ReadLine(); //discard rest of line
+    if (binary) {
+      readBinary(count, length);
+      return;
+    }
     for (size_t i = 0; i < count; ++i) {
       StringPiece line = m_in->ReadLine();
       m_next.push_back(FeatureDataItem());
@@ -124,6 +130,28 @@ void FeatureDataIterator::readNext()
   }
 }
 
+void FeatureDataIterator::readBinary(size_t count, size_t length)
+{
+  // The block is decoded straight from the file buffer.
+  uint64_t size = ReadFeatureBlockSize(m_in->ReadBytes(kFeatureBlockSizeBytes));
+  FeatureBlockReader block(m_in->ReadBytes(size), count, length);
+  m_next.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    FeatureDataItem &item = m_next[i];
+    item.dense.resize(length);
+    for (size_t j = 0; j < length; ++j) {
+      item.dense[j] = block.Dense(i, j);
+    }
+    for (size_t k = block.SparseBegin(i); k != block.SparseEnd(i); ++k) {
+      item.sparse.set(block.SparseId(k), block.SparseValue(k));
+    }
+  }
+  StringPiece line = m_in->ReadLine();
+  if (line != StringPiece(FEATURES_BIN_END)) {
+    throw FileFormatException(m_in->FileName(), line.as_string());
+  }
+}
+
 void FeatureDataIterator::increment()
 {
   readNext();
@@ -95,6 +95,7 @@ private:
   const std::vector<FeatureDataItem>& dereference() const;
 
   void readNext();
+  void readBinary(std::size_t count, std::size_t length);
 
   boost::shared_ptr<util::FilePiece> m_in;
   std::vector<FeatureDataItem> m_next;
@@ -249,6 +249,18 @@ void FeatureStats::addSparse(const string& name, FeatureStatsType v)
   m_map.set(name,v);
 }
 
+void FeatureStats::addSparse(size_t id, FeatureStatsType v)
+{
+  m_map.set(id,v);
+}
+
+void FeatureStats::mergeSparse(const SparseVector& sparseWeights)
+{
+  FeatureStatsType merged = inner_product(sparseWeights, m_map);
+  add(merged);
+  m_map.clear();
+}
+
 void FeatureStats::set(string &theString, const SparseVector& sparseWeights )
 {
   string substring, stringBuf;
@@ -269,8 +281,7 @@ void FeatureStats::set(string &theString, const SparseVector& sparseWeights )
 
   if (sparseWeights.size()) {
     //Merge the sparse features
-    FeatureStatsType merged = inner_product(sparseWeights, m_map);
-    add(merged);
+    mergeSparse(sparseWeights);
     /*
     cerr << "Merged ";
     sparseWeights.write(cerr,"=");
@@ -278,7 +289,6 @@ void FeatureStats::set(string &theString, const SparseVector& sparseWeights )
     map_.write(cerr,"=");
     cerr << " to give " <<  merged << endl;
     */
-    m_map.clear();
   }
   /*
   cerr << "FS: ";
@@ -318,12 +328,6 @@ void FeatureStats::savetxt()
   savetxt(&cout);
 }
 
-void FeatureStats::savebin(ostream* os)
-{
-  os->write(reinterpret_cast<char*>(m_array),
-            static_cast<streamsize>(GetArraySizeWithBytes()));
-}
-
 ostream& operator<<(ostream& o, const FeatureStats& e)
 {
   // print regular features
@@ -92,6 +92,9 @@ public:
   void expand();
   void add(FeatureStatsType v);
   void addSparse(const std::string& name, FeatureStatsType v);
+  void addSparse(std::size_t id, FeatureStatsType v);
+  // Replace the sparse features by one dense feature, their weighted sum.
+  void mergeSparse(const SparseVector& sparseWeights);
 
   void clear() {
     memset((void*)m_array, 0, GetArraySizeWithBytes());
@@ -137,10 +140,10 @@ public:
 
   void savetxt(const std::string &file);
   void savetxt(std::ostream* os);
-  void savebin(std::ostream* os);
   void savetxt();
 
   void loadtxt(std::istream* is, const SparseVector& sparseWeights);
+  // Dense features only, as in version 0 binary blocks
   void loadbin(std::istream* is);
 
   /**
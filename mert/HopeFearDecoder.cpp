@@ -39,6 +39,91 @@ namespace MosesTuning
 
 static const ValType BLEU_RATIO = 5;
 
+namespace
+{
+
+/** One sentence's n-best list, held in memory */
+class NbestView
+{
+public:
+  NbestView(const vector<MiraFeatureVector>& features, const vector<ScoreDataItem>& scores)
+    : features_(features), scores_(scores) {}
+
+  size_t cur_size() const {
+    return features_.size();
+  }
+  const MiraFeatureVector& featuresAt(size_t i) const {
+    return features_[i];
+  }
+  const ScoreDataItem& scoresAt(size_t i) const {
+    return scores_[i];
+  }
+
+private:
+  const vector<MiraFeatureVector>& features_;
+  const vector<ScoreDataItem>& scores_;
+};
+
+/** Hope / fear / model search over one n-best list. Pack is either a
+  * HypPackEnumerator at its current position or an NbestView. */
+template <class Pack> void NbestHopeFear(
+  Pack& pack,
+  Scorer* scorer,
+  bool safe_hope,
+  const vector<ValType>& backgroundBleu,
+  const MiraWeightVector& wv,
+  HopeFearData* hopeFear)
+{
+  // Hope / fear decode
+  ValType hope_scale = 1.0;
+  size_t hope_index=0, fear_index=0, model_index=0;
+  ValType hope_score=0, fear_score=0, model_score=0;
+  for(size_t safe_loop=0; safe_loop<2; safe_loop++) {
+    ValType hope_bleu=0, hope_model=0;
+    for(size_t i=0; i< pack.cur_size(); i++) {
+      const MiraFeatureVector& vec=pack.featuresAt(i);
+      ValType score = wv.score(vec);
+      ValType bleu = scorer->calculateSentenceLevelBackgroundScore(pack.scoresAt(i),backgroundBleu);
+      // Hope
+      if(i==0 || (hope_scale*score + bleu) > hope_score) {
+        hope_score = hope_scale*score + bleu;
+        hope_index = i;
+        hope_bleu = bleu;
+        hope_model = score;
+      }
+      // Fear
+      if(i==0 || (score - bleu) > fear_score) {
+        fear_score = score - bleu;
+        fear_index = i;
+      }
+      // Model
+      if(i==0 || score > model_score) {
+        model_score = score;
+        model_index = i;
+      }
+    }
+    // Outer loop rescales the contribution of model score to 'hope' in antagonistic cases
+    // where model score is having far more influence than BLEU
+    hope_bleu *= BLEU_RATIO; // We only care about cases where model has MUCH more influence than BLEU
+    if(safe_hope && safe_loop==0 && abs(hope_model)>1e-8 && abs(hope_bleu)/abs(hope_model)<hope_scale)
+      hope_scale = abs(hope_bleu) / abs(hope_model);
+    else break;
+  }
+  hopeFear->modelFeatures = pack.featuresAt(model_index);
+  hopeFear->hopeFeatures = pack.featuresAt(hope_index);
+  hopeFear->fearFeatures = pack.featuresAt(fear_index);
+
+  hopeFear->hopeStats = pack.scoresAt(hope_index);
+  hopeFear->hopeBleu = scorer->calculateSentenceLevelBackgroundScore(hopeFear->hopeStats, backgroundBleu);
+  const vector<float>& fear_stats = pack.scoresAt(fear_index);
+  hopeFear->fearBleu = scorer->calculateSentenceLevelBackgroundScore(fear_stats, backgroundBleu);
+
+  hopeFear->modelStats = pack.scoresAt(model_index);
+  hopeFear->hopeFearEqual = (hope_index == fear_index);
+}
+
+} // namespace
+
 std::pair<MiraWeightVector*,size_t>
 InitialiseWeights(const string& denseInitFile, const string& sparseInitFile,
                   const string& type, bool verbose)
@@ -152,13 +237,14 @@ NbestHopeFearDecoder::NbestHopeFearDecoder(
   bool  no_shuffle,
   bool safe_hope,
   Scorer* scorer
-) : safe_hope_(safe_hope)
+) : randomAccess_(NULL), safe_hope_(safe_hope)
 {
   scorer_ = scorer;
   if (streaming) {
     train_.reset(new StreamingHypPackEnumerator(featureFiles, scoreFiles));
   } else {
-    train_.reset(new RandomAccessHypPackEnumerator(featureFiles, scoreFiles, no_shuffle));
+    randomAccess_ = new RandomAccessHypPackEnumerator(featureFiles, scoreFiles, no_shuffle);
+    train_.reset(randomAccess_);
   }
 }
 
@@ -184,54 +270,24 @@ void NbestHopeFearDecoder::HopeFear(
   HopeFearData* hopeFear
 )
 {
+  NbestHopeFear(*train_, scorer_, safe_hope_, backgroundBleu, wv, hopeFear);
+}
 
+size_t NbestHopeFearDecoder::CurrentId()
+{
+  return train_->cur_id();
+}
 
-  // Hope / fear decode
-  ValType hope_scale = 1.0;
-  size_t hope_index=0, fear_index=0, model_index=0;
-  ValType hope_score=0, fear_score=0, model_score=0;
-  for(size_t safe_loop=0; safe_loop<2; safe_loop++) {
-    ValType hope_bleu=0, hope_model=0;
-    for(size_t i=0; i< train_->cur_size(); i++) {
-      const MiraFeatureVector& vec=train_->featuresAt(i);
-      ValType score = wv.score(vec);
-      ValType bleu = scorer_->calculateSentenceLevelBackgroundScore(train_->scoresAt(i),backgroundBleu);
-      // Hope
-      if(i==0 || (hope_scale*score + bleu) > hope_score) {
-        hope_score = hope_scale*score + bleu;
-        hope_index = i;
-        hope_bleu = bleu;
-        hope_model = score;
-      }
-      // Fear
-      if(i==0 || (score - bleu) > fear_score) {
-        fear_score = score - bleu;
-        fear_index = i;
-      }
-      // Model
-      if(i==0 || score > model_score) {
-        model_score = score;
-        model_index = i;
-      }
-    }
-    // Outer loop rescales the contribution of model score to 'hope' in antagonistic cases
-    // where model score is having far more influence than BLEU
-    hope_bleu *= BLEU_RATIO; // We only care about cases where model has MUCH more influence than BLEU
-    if(safe_hope_ && safe_loop==0 && abs(hope_model)>1e-8 && abs(hope_bleu)/abs(hope_model)<hope_scale)
-      hope_scale = abs(hope_bleu) / abs(hope_model);
-    else break;
-  }
-  hopeFear->modelFeatures = train_->featuresAt(model_index);
-  hopeFear->hopeFeatures = train_->featuresAt(hope_index);
-  hopeFear->fearFeatures = train_->featuresAt(fear_index);
-
-  hopeFear->hopeStats = train_->scoresAt(hope_index);
-  hopeFear->hopeBleu = scorer_->calculateSentenceLevelBackgroundScore(hopeFear->hopeStats, backgroundBleu);
-  const vector<float>& fear_stats = train_->scoresAt(fear_index);
-  hopeFear->fearBleu = scorer_->calculateSentenceLevelBackgroundScore(fear_stats, backgroundBleu);
-
-  hopeFear->modelStats = train_->scoresAt(model_index);
-  hopeFear->hopeFearEqual = (hope_index == fear_index);
+void NbestHopeFearDecoder::HopeFearAt(
+  size_t sentenceId,
+  const std::vector<ValType>& backgroundBleu,
+  const MiraWeightVector& wv,
+  HopeFearData* hopeFear
+) const
+{
+  UTIL_THROW_IF(!randomAccess_, util::Exception, "Random access to n-best lists is not possible when streaming");
+  NbestView view(randomAccess_->featuresOf(sentenceId), randomAccess_->scoresOf(sentenceId));
+  NbestHopeFear(view, scorer_, safe_hope_, backgroundBleu, wv, hopeFear);
 }
 
 void NbestHopeFearDecoder::MaxModel(const AvgWeightVector& wv, std::vector<ValType>* stats)
@@ -334,10 +390,26 @@ void HypergraphHopeFearDecoder::HopeFear(
   HopeFearData* hopeFear
 )
 {
-  size_t sentenceId = *sentenceIdIter_;
+  HopeFearAt(*sentenceIdIter_, backgroundBleu, wv, hopeFear);
+}
+
+size_t HypergraphHopeFearDecoder::CurrentId()
+{
+  return *sentenceIdIter_;
+}
+
+void HypergraphHopeFearDecoder::HopeFearAt(
+  size_t sentenceId,
+  const vector<ValType>& backgroundBleu,
+  const MiraWeightVector& wv,
+  HopeFearData* hopeFear
+) const
+{
   SparseVector weights;
   wv.ToSparse(&weights, num_dense_);
-  const Graph& graph = *(graphs_[sentenceId]);
+  GraphColl::const_iterator found = graphs_.find(sentenceId);
+  UTIL_THROW_IF(found == graphs_.end(), util::Exception, "No hypergraph for sentence " << sentenceId);
+  const Graph& graph = *(found->second);
 
   // ValType hope_scale = 1.0;
   HgHypothesis hopeHypo, fearHypo, modelHypo;
@@ -80,6 +80,20 @@ public:
     HopeFearData* hopeFear
   ) = 0;
 
+  /** Id of the sentence at the current position */
+  virtual std::size_t CurrentId() = 0;
+
+  /**
+    * Hope, fear and model hypotheses of the given sentence. This leaves the
+    * iterator alone, so several threads may call it at once.
+    **/
+  virtual void HopeFearAt(
+    std::size_t sentenceId,
+    const std::vector<ValType>& backgroundBleu,
+    const MiraWeightVector& wv,
+    HopeFearData* hopeFear
+  ) const = 0;
+
   /** Max score decoding */
   virtual void MaxModel(const AvgWeightVector& wv, std::vector<ValType>* stats)
   = 0;
@@ -114,10 +128,22 @@ public:
     HopeFearData* hopeFear
   );
 
+  virtual std::size_t CurrentId();
+
+  /** Needs the n-best lists in memory, ie no streaming */
+  virtual void HopeFearAt(
+    std::size_t sentenceId,
+    const std::vector<ValType>& backgroundBleu,
+    const MiraWeightVector& wv,
+    HopeFearData* hopeFear
+  ) const;
+
   virtual void MaxModel(const AvgWeightVector& wv, std::vector<ValType>* stats);
 
 private:
   boost::scoped_ptr<HypPackEnumerator> train_;
+  // Same as train_ unless streaming.
+  RandomAccessHypPackEnumerator* randomAccess_;
   bool safe_hope_;
 
 };
@@ -150,6 +176,15 @@ public:
     HopeFearData* hopeFear
   );
 
+  virtual std::size_t CurrentId();
+
+  virtual void HopeFearAt(
+    std::size_t sentenceId,
+    const std::vector<ValType>& backgroundBleu,
+    const MiraWeightVector& wv,
+    HopeFearData* hopeFear
+  ) const;
+
   virtual void MaxModel(const AvgWeightVector& wv, std::vector<ValType>* stats);
 
 private:
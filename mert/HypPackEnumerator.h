@@ -95,6 +95,14 @@ public:
   virtual const MiraFeatureVector& featuresAt(std::size_t i);
   virtual const ScoreDataItem& scoresAt(std::size_t i);
 
+  // Access by sentence id, independent of the current position
+  const std::vector<MiraFeatureVector>& featuresOf(std::size_t id) const {
+    return m_features[id];
+  }
+  const std::vector<ScoreDataItem>& scoresOf(std::size_t id) const {
+    return m_scores[id];
+  }
+
 private:
   bool m_no_shuffle;
   std::size_t m_cur_index;
@@ -48,3 +48,32 @@ BOOST_AUTO_TEST_CASE(from_sparse)
   BOOST_CHECK_CLOSE(sp2.get("sparse2"), 0.1,1e-5);
 
 }
+
+BOOST_AUTO_TEST_CASE(batch_of_one_update)
+{
+  // kbmira with --batch-size 1 passes each violating sentence's update as a
+  // batch of one; this has to be the sequential update, averaging included.
+  std::vector<std::pair<MiraFeatureVector, ValType> > steps;
+  for (std::size_t i = 0; i < 5; ++i) {
+    SparseVector sp;
+    sp.set("dense0", 0.1 * i - 0.2);
+    sp.set("dense1", 1.0 / (i + 1));
+    sp.set(i % 2 ? "sparse0" : "sparse1", 0.3 * i);
+    steps.push_back(std::make_pair(MiraFeatureVector(sp, 2), 0.01 * (i + 1)));
+  }
+
+  MiraWeightVector sequential, batched;
+  for (std::size_t i = 0; i < steps.size(); ++i) {
+    sequential.update(steps[i].first, steps[i].second);
+    std::vector<std::pair<MiraFeatureVector, ValType> > batch(1, steps[i]);
+    batched.update(batch, 1.0 / batch.size());
+  }
+
+  BOOST_REQUIRE_EQUAL(sequential.avg().size(), batched.avg().size());
+  for (std::size_t i = 0; i < sequential.avg().size(); ++i) {
+    BOOST_CHECK_EQUAL(sequential.avg().weight(i), batched.avg().weight(i));
+  }
+  for (std::size_t i = 0; i < steps.size(); ++i) {
+    BOOST_CHECK_EQUAL(sequential.score(steps[i].first), batched.score(steps[i].first));
+  }
+}
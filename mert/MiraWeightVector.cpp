@@ -44,6 +44,24 @@ void MiraWeightVector::update(const MiraFeatureVector& fv, float tau)
   }
 }
 
+/**
+ * Update the model with the sum of several scaled feature vectors,
+ * counted as one update for averaging
+ * \param fvs   Feature vectors, each with the value to scale it by
+ * \param scale Every FV is also scaled by this value
+ */
+void MiraWeightVector::update(const vector<pair<MiraFeatureVector, ValType> >& fvs, float scale)
+{
+  m_numUpdates++;
+  for(size_t u=0; u<fvs.size(); u++) {
+    const MiraFeatureVector& fv = fvs[u].first;
+    float tau = fvs[u].second * scale;
+    for(size_t i=0; i<fv.size(); i++) {
+      update(fv.feat(i), fv.val(i)*tau);
+    }
+  }
+}
+
 /**
  * Perform an empty update (affects averaging)
  */
@@ -12,6 +12,7 @@
 
 #include <vector>
 #include <iostream>
+#include <utility>
 
 #include "MiraFeatureVector.h"
 
@@ -42,6 +43,14 @@ public:
    */
   void update(const MiraFeatureVector& fv, float tau);
 
+  /**
+   * Update the model with the sum of several scaled feature vectors,
+   * counted as one update for averaging
+   * \param fvs   Feature vectors, each with the value to scale it by
+   * \param scale Every FV is also scaled by this value
+   */
+  void update(const std::vector<std::pair<MiraFeatureVector, ValType> >& fvs, float scale);
+
   /**
    * Perform an empty update (affects averaging)
    */
@@ -16,6 +16,7 @@ You should have received a copy of the GNU Lesser General Public
 License along with this library; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ***********************************************************************/
+#include <cstring>
 #include <iostream>
 
 #include "util/file_piece.hh"
@@ -46,7 +47,8 @@ void ScoreDataIterator::readNext()
   m_next.clear();
   try {
     StringPiece marker = m_in->ReadDelimited();
-    if (marker != StringPiece(SCORES_TXT_BEGIN)) {
+    bool binary = (marker == StringPiece(SCORES_BIN_BEGIN));
+    if (!binary && marker != StringPiece(SCORES_TXT_BEGIN)) {
       throw FileFormatException(m_in->FileName(), marker.as_string());
     }
     // size_t sentenceId =
@@ -54,6 +56,10 @@ void ScoreDataIterator::readNext()
     size_t count = m_in->ReadULong();
     size_t length = m_in->ReadULong();
     m_in->ReadLine(); //ignore rest of line
+    if (binary) {
+      readBinary(count, length);
+      return;
+    }
     for (size_t i = 0; i < count; ++i) {
       StringPiece line = m_in->ReadLine();
       m_next.push_back(ScoreDataItem());
@@ -74,6 +80,24 @@ void ScoreDataIterator::readNext()
   }
 }
 
+void ScoreDataIterator::readBinary(size_t count, size_t length)
+{
+  // Binary statistics are fixed-width rows of length values per entry.
+  StringPiece rows = m_in->ReadBytes(count * length * sizeof(ScoreStatsType));
+  m_next.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    m_next[i].resize(length);
+    if (length) {
+      memcpy(&m_next[i][0], rows.data() + i * length * sizeof(ScoreStatsType),
+             length * sizeof(ScoreStatsType));
+    }
+  }
+  StringPiece line = m_in->ReadLine();
+  if (line != StringPiece(SCORES_BIN_END)) {
+    throw FileFormatException(m_in->FileName(), line.as_string());
+  }
+}
+
 void ScoreDataIterator::increment()
 {
   readNext();
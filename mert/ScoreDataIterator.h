@@ -67,6 +67,7 @@ private:
   const std::vector<ScoreDataItem>& dereference() const;
 
   void readNext();
+  void readBinary(std::size_t count, std::size_t length);
 
   boost::shared_ptr<util::FilePiece> m_in;
   std::vector<ScoreDataItem> m_next;
@@ -23,6 +23,11 @@ de recherches du Canada
   * Output is a weight file that results from running MIRA on these
   * n-btest lists for J iterations. Will return the set that maximizes
   * training BLEU.
+ *
+ * With --batch-size B, hope and fear hypotheses for B sentences are found
+ * against the same weights (in parallel with --threads), and the average of
+ * the B MIRA updates is applied as one update, so the weight averaging counts
+ * one step per mini-batch. B=1 is the original, sequential algorithm.
  **/
 
 #include <cmath>
@@ -38,6 +43,9 @@ de recherches du Canada
 
 #include <boost/program_options.hpp>
 #include <boost/scoped_ptr.hpp>
+#ifdef WITH_THREADS
+#include <boost/thread.hpp>
+#endif
 
 #include "util/exception.hh"
 #include "util/random.hh"
@@ -56,6 +64,79 @@ using namespace MosesTuning;
 
 namespace po = boost::program_options;
 
+namespace
+{
+
+/** Decodes [begin, end) of a mini-batch. Runs in its own thread. */
+class HopeFearShard
+{
+public:
+  HopeFearShard(const HopeFearDecoder& decoder, const vector<size_t>& ids,
+                size_t begin, size_t end, const vector<ValType>& bg,
+                const MiraWeightVector& wv, vector<HopeFearData>* out)
+    : decoder_(decoder), ids_(ids), begin_(begin), end_(end), bg_(bg), wv_(wv), out_(out) {}
+
+  void operator()() {
+    try {
+      for (size_t i = begin_; i < end_; ++i) {
+        decoder_.HopeFearAt(ids_[i], bg_, wv_, &(*out_)[i]);
+      }
+    } catch (const std::exception& e) {
+      error_ = e.what();
+    }
+  }
+
+  const string& error() const {
+    return error_;
+  }
+
+private:
+  const HopeFearDecoder& decoder_;
+  const vector<size_t>& ids_;
+  size_t begin_, end_;
+  const vector<ValType>& bg_;
+  const MiraWeightVector& wv_;
+  vector<HopeFearData>* out_;
+  string error_;
+};
+
+/** Hope / fear decode a mini-batch of sentences against the same weights,
+  * splitting it into one contiguous shard per thread. The results are in
+  * the order of ids, whatever the number of threads.
+  *
+  * This is synchronous mini-batch MIRA, not iterative parameter mixing:
+  * the threads share one weight vector, which is updated after every
+  * batch, rather than each training its own weights on a shard for a whole
+  * epoch before the weights are mixed. */
+void HopeFearBatch(const HopeFearDecoder& decoder, const vector<size_t>& ids,
+                   const vector<ValType>& bg, const MiraWeightVector& wv,
+                   size_t threads, vector<HopeFearData>* out)
+{
+  out->clear();
+  out->resize(ids.size());
+  threads = max<size_t>(1, min(threads, ids.size()));
+  vector<HopeFearShard> shards;
+  for (size_t t = 0; t < threads; ++t) {
+    shards.push_back(HopeFearShard(decoder, ids, ids.size() * t / threads,
+                                   ids.size() * (t + 1) / threads, bg, wv, out));
+  }
+#ifdef WITH_THREADS
+  boost::thread_group group;
+  for (size_t t = 1; t < threads; ++t) {
+    group.create_thread(boost::ref(shards[t]));
+  }
+  shards[0]();
+  group.join_all();
+#else
+  for (size_t t = 0; t < threads; ++t) shards[t]();
+#endif
+  for (size_t t = 0; t < threads; ++t) {
+    UTIL_THROW_IF(!shards[t].error().empty(), util::Exception, shards[t].error());
+  }
+}
+
+}
+
 int main(int argc, char** argv)
 {
   bool help;
@@ -80,6 +161,8 @@ int main(int argc, char** argv)
   bool verbose = false; // Verbose updates
   bool safe_hope = false; // Model score cannot have more than BLEU_RATIO times more influence than BLEU
   size_t hgPruning = 50; //prune hypergraphs to have this many edges per reference word
+  size_t threads = 1; // Threads for hope/fear decoding
+  size_t batchSize = 1; // Sentences per mini-batch
 
   // Command-line processing follows pro.cpp
   po::options_description desc("Allowed options");
@@ -106,6 +189,10 @@ int main(int argc, char** argv)
   ("verbose", po::value(&verbose)->zero_tokens()->default_value(false), "Verbose updates")
   ("safe-hope", po::value(&safe_hope)->zero_tokens()->default_value(false), "Mode score's influence on hope decoding is limited")
   ("hg-prune", po::value<size_t>(&hgPruning), "Prune hypergraphs to have this many edges per reference word")
+#ifdef WITH_THREADS
+  ("threads,T", po::value<size_t>(&threads), "Number of threads for hope/fear decoding within a mini-batch (default 1). Only helps with --batch-size > 1")
+#endif
+  ("batch-size,B", po::value<size_t>(&batchSize), "Sentences decoded against the same weights before their updates are averaged and applied (default 1)")
   ;
 
   po::options_description cmdline_options;
@@ -120,7 +207,13 @@ int main(int argc, char** argv)
     exit(0);
   }
 
-  cerr << "kbmira with c=" << c << " decay=" << decay << " no_shuffle=" << no_shuffle << endl;
+  if (threads == 0) threads = 1;
+  if (batchSize == 0) batchSize = 1;
+  UTIL_THROW_IF(streaming && batchSize > 1, util::Exception, "Mini-batches need the n-best lists in memory, so they cannot be used with --streaming");
+
+  cerr << "kbmira with c=" << c << " decay=" << decay << " no_shuffle=" << no_shuffle;
+  if (batchSize > 1) cerr << " batch_size=" << batchSize << " threads=" << threads;
+  cerr << endl;
 
   if (vm.count("random-seed")) {
     cerr << "Initialising random seed to " << seed << endl;
@@ -163,46 +256,78 @@ int main(int argc, char** argv)
     int iNumUpdates = 0;
     ValType totalLoss = 0.0;
     size_t sentenceIndex = 0;
-    for(decoder->reset(); !decoder->finished(); decoder->next()) {
-      HopeFearData hfd;
-      decoder->HopeFear(bg,*wv,&hfd);
-
-      // Update weights
-      if (!hfd.hopeFearEqual && hfd.hopeBleu  > hfd.fearBleu) {
-        // Vector difference
-        MiraFeatureVector diff = hfd.hopeFeatures - hfd.fearFeatures;
-        // Bleu difference
-        //assert(hfd.hopeBleu + 1e-8 >= hfd.fearBleu);
-        ValType delta = hfd.hopeBleu - hfd.fearBleu;
-        // Loss and update
-        ValType diff_score = wv->score(diff);
-        ValType loss = delta - diff_score;
-        if(verbose) {
-          cerr << "Updating sent " << sentenceIndex << endl;
-          cerr << "Wght: " << *wv << endl;
-          cerr << "Hope: " << hfd.hopeFeatures << " BLEU:" << hfd.hopeBleu << " Score:" << wv->score(hfd.hopeFeatures) << endl;
-          cerr << "Fear: " << hfd.fearFeatures << " BLEU:" << hfd.fearBleu << " Score:" << wv->score(hfd.fearFeatures) << endl;
-          cerr << "Diff: " << diff << " BLEU:" << delta << " Score:" << diff_score << endl;
-          cerr << "Loss: " << loss <<  " Scale: " << 1 << endl;
-          cerr << endl;
+    vector<size_t> batchIds;
+    vector<HopeFearData> batch;
+    // Updates of the current mini-batch, all found against the same weights
+    vector<pair<MiraFeatureVector, ValType> > updates;
+    for(decoder->reset(); !decoder->finished();) {
+      if (batchSize == 1) {
+        batch.resize(1);
+        decoder->HopeFear(bg,*wv,&batch[0]);
+        decoder->next();
+      } else {
+        batchIds.clear();
+        for(; batchIds.size() < batchSize && !decoder->finished(); decoder->next()) {
+          batchIds.push_back(decoder->CurrentId());
         }
-        if(loss > 0) {
-          ValType eta = min(c, loss / diff.sqrNorm());
-          wv->update(diff,eta);
-          totalLoss+=loss;
-          iNumUpdates++;
+        HopeFearBatch(*decoder, batchIds, bg, *wv, threads, &batch);
+      }
+
+      updates.clear();
+      for (size_t b = 0; b < batch.size(); ++b) {
+        const HopeFearData& hfd = batch[b];
+        // Update weights
+        if (!hfd.hopeFearEqual && hfd.hopeBleu  > hfd.fearBleu) {
+          // Vector difference
+          MiraFeatureVector diff = hfd.hopeFeatures - hfd.fearFeatures;
+          // Bleu difference
+          //assert(hfd.hopeBleu + 1e-8 >= hfd.fearBleu);
+          ValType delta = hfd.hopeBleu - hfd.fearBleu;
+          // Loss and update
+          ValType diff_score = wv->score(diff);
+          ValType loss = delta - diff_score;
+          if(verbose) {
+            cerr << "Updating sent " << sentenceIndex << endl;
+            cerr << "Wght: " << *wv << endl;
+            cerr << "Hope: " << hfd.hopeFeatures << " BLEU:" << hfd.hopeBleu << " Score:" << wv->score(hfd.hopeFeatures) << endl;
+            cerr << "Fear: " << hfd.fearFeatures << " BLEU:" << hfd.fearBleu << " Score:" << wv->score(hfd.fearFeatures) << endl;
+            cerr << "Diff: " << diff << " BLEU:" << delta << " Score:" << diff_score << endl;
+            cerr << "Loss: " << loss <<  " Scale: " << 1 << endl;
+            cerr << endl;
+          }
+          if(loss > 0) {
+            ValType eta = min(c, loss / diff.sqrNorm());
+            updates.push_back(make_pair(diff, eta));
+            totalLoss+=loss;
+            iNumUpdates++;
+          }
         }
-        // Update BLEU statistics
-        for(size_t k=0; k<bg.size(); k++) {
-          bg[k]*=decay;
-          if(model_bg)
-            bg[k]+=hfd.modelStats[k];
-          else
-            bg[k]+=hfd.hopeStats[k];
+        iNumExamples++;
+        ++sentenceIndex;
+      }
+
+      // Apply the mini-batch's updates as one update, averaged over the
+      // whole batch: a sentence without a violation contributes a zero
+      // update, so a batch with one violator moves the weights less than
+      // that sentence would on its own.  With one sentence per batch this is
+      // the sequential update.
+      if (!updates.empty()) {
+        wv->update(updates, 1.0 / batch.size());
+      }
+
+      // Update BLEU statistics, in sentence order
+      for (size_t b = 0; b < batch.size(); ++b) {
+        const HopeFearData& hfd = batch[b];
+        if (!hfd.hopeFearEqual && hfd.hopeBleu  > hfd.fearBleu) {
+          for(size_t k=0; k<bg.size(); k++) {
+            bg[k]*=decay;
+            if(model_bg)
+              bg[k]+=hfd.modelStats[k];
+            else
+              bg[k]+=hfd.hopeStats[k];
+          }
         }
       }
-      iNumExamples++;
-      ++sentenceIndex;
       if (streaming_out)
         cout << *wv << endl;
     }
@@ -0,0 +1,57 @@
+// -*- mode: c++; indent-tabs-mode: nil; tab-width: 2 -*-
+#pragma once
+
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <stdint.h>
+#include "util/file_piece.hh"
+#include "util/string_piece.hh"
+
+namespace Moses
+{
+
+/** Compact binary n-best lists (-n-best-binary), read directly by
+ * mert/extractor. Numbers are in host byte order, strings are a uint32
+ * length followed by the bytes.
+ *
+ * file:  Magic, uint32 number of feature functions, then for each its name
+ *        and uint32 number of tuneable dense scores, then the entries.
+ * entry: uint32 sentence id, string surface, float dense scores in the
+ *        order of the header, uint32 number of sparse features, then for
+ *        each its name and float value, float total score, string
+ *        segmentation, string word alignment (both empty unless requested).
+ */
+namespace BinaryNBest
+{
+
+// text n-best lists start with a digit, so the leading NUL tells them apart
+const char Magic[8] = {'\0', 'M', 'N', 'B', 'E', 'S', 'T', '1'};
+
+template<class T> void Write(std::ostream &out, const T &value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+inline void WriteString(std::ostream &out, const StringPiece &str)
+{
+  Write<uint32_t>(out, str.size());
+  out.write(str.data(), str.size());
+}
+
+template<class T> T Read(util::FilePiece &in)
+{
+  T ret;
+  std::memcpy(&ret, in.ReadBytes(sizeof(T)).data(), sizeof(T));
+  return ret;
+}
+
+// valid until the next read from in
+inline StringPiece ReadString(util::FilePiece &in)
+{
+  return in.ReadBytes(Read<uint32_t>(in));
+}
+
+}
+
+}
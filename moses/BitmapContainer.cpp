@@ -200,12 +200,12 @@ BackwardsEdge::~BackwardsEdge()
 }
 
 
-void
+Hypothesis *
 BackwardsEdge::Initialize()
 {
   if(m_hypotheses.size() == 0 || m_translations.size() == 0) {
     m_initialized = true;
-    return;
+    return NULL;
   }
 
   const Bitmap &bm = m_hypotheses[0]->GetWordsBitmap();
@@ -213,23 +213,22 @@ BackwardsEdge::Initialize()
   m_estimatedScore = m_estimatedScores.CalcEstimatedScore(bm, newRange.GetStartPos(), newRange.GetEndPos());
 
   Hypothesis *expanded = CreateHypothesis(*m_hypotheses[0], *m_translations.Get(0));
-  m_parent.Enqueue(0, 0, expanded, this);
   SetSeenPosition(0, 0);
   m_initialized = true;
+  return expanded;
 }
 
 Hypothesis *BackwardsEdge::CreateHypothesis(const Hypothesis &hypothesis, const TranslationOption &transOpt)
 {
-  // create hypothesis and calculate all its scores
+  // create hypothesis, it is scored later with the rest of its batch
   IFVERBOSE(2) {
     hypothesis.GetManager().GetSentenceStats().StartTimeBuildHyp();
   }
   const Bitmap &bitmap = m_parent.GetWordsBitmap();
-  Hypothesis *newHypo = new Hypothesis(hypothesis, transOpt, bitmap, hypothesis.GetManager().GetNextHypoId());
+  Hypothesis *newHypo = hypothesis.GetManager().GetHypothesisPool().Create(hypothesis, transOpt, bitmap, hypothesis.GetManager().GetNextHypoId());
   IFVERBOSE(2) {
     hypothesis.GetManager().GetSentenceStats().StopTimeBuildHyp();
   }
-  newHypo->EvaluateWhenApplied(m_estimatedScore);
 
   return newHypo;
 }
@@ -266,22 +265,32 @@ BackwardsEdge::GetBitmapContainer() const
 void
 BackwardsEdge::PushSuccessors(const size_t x, const size_t y)
 {
-  Hypothesis *newHypo;
+  // both successors are scored as one batch
+  Hypothesis *batch[2];
+  size_t positions[2][2];
+  size_t size = 0;
 
   if(y + 1 < m_translations.size() && !SeenPosition(x, y + 1)) {
     SetSeenPosition(x, y + 1);
-    newHypo = CreateHypothesis(*m_hypotheses[x], *m_translations.Get(y + 1));
-    if(newHypo != NULL) {
-      m_parent.Enqueue(x, y + 1, newHypo, (BackwardsEdge*)this);
-    }
+    batch[size] = CreateHypothesis(*m_hypotheses[x], *m_translations.Get(y + 1));
+    positions[size][0] = x;
+    positions[size][1] = y + 1;
+    ++size;
   }
 
   if(x + 1 < m_hypotheses.size() && !SeenPosition(x + 1, y)) {
     SetSeenPosition(x + 1, y);
-    newHypo = CreateHypothesis(*m_hypotheses[x + 1], *m_translations.Get(y));
-    if(newHypo != NULL) {
-      m_parent.Enqueue(x + 1, y, newHypo, (BackwardsEdge*)this);
-    }
+    batch[size] = CreateHypothesis(*m_hypotheses[x + 1], *m_translations.Get(y));
+    positions[size][0] = x + 1;
+    positions[size][1] = y;
+    ++size;
+  }
+
+  if (!size) return;
+  Hypothesis::EvaluateWhenAppliedBatch(std::vector<Hypothesis*>(batch, batch + size),
+                                       std::vector<float>(size, m_estimatedScore));
+  for (size_t i = 0; i < size; ++i) {
+    m_parent.Enqueue(positions[i][0], positions[i][1], batch[i], this);
   }
 }
 
@@ -311,7 +320,8 @@ BitmapContainer::~BitmapContainer()
     HypothesisQueueItem *item = m_queue.top();
     m_queue.pop();
 
-    delete item->GetHypothesis();
+    Hypothesis *hypo = item->GetHypothesis();
+    hypo->GetManager().GetHypothesisPool().Release(hypo);
     delete item;
   }
 
@@ -426,15 +436,30 @@ BitmapContainer::AddBackwardsEdge(BackwardsEdge *edge)
 void
 BitmapContainer::InitializeEdges()
 {
+  // the first hypothesis of every edge is scored in one batch
+  std::vector<Hypothesis*> batch;
+  std::vector<float> estimatedScores;
+  std::vector<BackwardsEdge*> edges;
+
   BackwardsEdgeSet::iterator iter = m_edges.begin();
   BackwardsEdgeSet::iterator iterEnd = m_edges.end();
 
   while (iter != iterEnd) {
     BackwardsEdge *edge = *iter;
-    edge->Initialize();
+    Hypothesis *expanded = edge->Initialize();
+    if (expanded) {
+      batch.push_back(expanded);
+      estimatedScores.push_back(edge->m_estimatedScore);
+      edges.push_back(edge);
+    }
 
     ++iter;
   }
+
+  Hypothesis::EvaluateWhenAppliedBatch(batch, estimatedScores);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    Enqueue(0, 0, batch[i], edges[i]);
+  }
 }
 
 void
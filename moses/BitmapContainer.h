@@ -200,7 +200,8 @@ private:
   void SetSeenPosition(const size_t x, const size_t y);
 
 protected:
-  void Initialize();
+  //! returns the first expansion of this edge, not yet scored, or NULL
+  Hypothesis *Initialize();
 
 public:
   BackwardsEdge(const BitmapContainer &prevBitmapContainer
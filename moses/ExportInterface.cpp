@@ -281,8 +281,12 @@ batch_run()
         VERBOSE(1,"[" << HERE << " added trg] " << trg << endl);
         VERBOSE(1,"[" << HERE << " added aln] " << aln << endl);
       }
-    } else pool.Submit(task);
+    } else {
+      ioWrapper->WaitForOutputWindow(source->GetTranslationId());
+      pool.Submit(task);
+    }
 #else
+    ioWrapper->WaitForOutputWindow(source->GetTranslationId());
     pool.Submit(task);
 
 #endif
@@ -1,4 +1,5 @@
 #include "StatefulFeatureFunction.h"
+#include "moses/Hypothesis.h"
 
 namespace Moses
 {
@@ -8,6 +9,7 @@ std::vector<const StatefulFeatureFunction*>  StatefulFeatureFunction::m_stateful
 StatefulFeatureFunction
 ::StatefulFeatureFunction(const std::string &line, bool registerNow)
   : FeatureFunction(line, registerNow)
+  , m_statefulIndex(m_statefulFFs.size())
 {
   m_statefulFFs.push_back(this);
 }
@@ -15,9 +17,19 @@ StatefulFeatureFunction
 StatefulFeatureFunction
 ::StatefulFeatureFunction(size_t numScoreComponents, const std::string &line)
   : FeatureFunction(numScoreComponents, line)
+  , m_statefulIndex(m_statefulFFs.size())
 {
   m_statefulFFs.push_back(this);
 }
 
+void
+StatefulFeatureFunction
+::EvaluateWhenAppliedBatch(const std::vector<Hypothesis*> &batch) const
+{
+  for (size_t i = 0; i < batch.size(); ++i) {
+    batch[i]->EvaluateWhenApplied(*this);
+  }
+}
+
 }
 
@@ -21,6 +21,8 @@ class StatefulFeatureFunction: public FeatureFunction
   //All statefull FFs
   static std::vector<const StatefulFeatureFunction*> m_statefulFFs;
 
+  size_t m_statefulIndex;
+
 public:
   static const std::vector<const StatefulFeatureFunction*>&
   GetStatefulFeatureFunctions() {
@@ -42,6 +44,22 @@ public:
     const FFState* prev_state,
     ScoreComponentCollection* accumulator) const = 0;
 
+  /**
+   * Evaluate hypotheses that were created together: all expansions of one
+   * hypothesis over a span, or the successors of one cube pruning pop.
+   * Every hypothesis must end up with its state and scores exactly as
+   * Hypothesis::EvaluateWhenApplied(const StatefulFeatureFunction&) would
+   * leave them.  The default does just that, one hypothesis at a time;
+   * override it to amortise lookups over the batch.
+   */
+  virtual void EvaluateWhenAppliedBatch(
+    const std::vector<Hypothesis*> &batch) const;
+
+  //! index of this feature function's state in a hypothesis
+  size_t GetStatefulIndex() const {
+    return m_statefulIndex;
+  }
+
   // virtual FFState* EvaluateWhenAppliedWithContext(
   //   ttasksptr const& ttasks,
   //   const Hypothesis& cur_hypo,
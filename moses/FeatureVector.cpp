@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #endif // WITH_THREADS
 
 #include "FeatureVector.h"
+#include "util/inner_product.hh"
 #include "util/string_piece_hash.hh"
 #include "util/string_stream.hh"
 
@@ -809,8 +810,8 @@ FValue FVector::inner_product(const FVector& rhs) const
   for (const_iterator i = cbegin(); i != cend(); ++i) {
     product += ((i->second)*(rhs.get(i->first)));
   }
-  for (size_t i = 0; i < m_coreFeatures.size(); ++i) {
-    product += m_coreFeatures[i]*rhs.m_coreFeatures[i];
+  if (m_coreFeatures.size()) {
+    product += util::InnerProduct(&m_coreFeatures[0], &rhs.m_coreFeatures[0], m_coreFeatures.size());
   }
   return product;
 }
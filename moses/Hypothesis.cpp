@@ -109,7 +109,7 @@ Hypothesis::
   if (m_arcList) {
     ArcList::iterator iter;
     for (iter = m_arcList->begin() ; iter != m_arcList->end() ; ++iter) {
-      delete *iter;
+      m_manager.GetHypothesisPool().Release(*iter);
     }
     m_arcList->clear();
 
@@ -150,6 +150,66 @@ AddArc(Hypothesis *loserHypo)
 void
 Hypothesis::
 EvaluateWhenApplied(float estimatedScore)
+{
+  EvaluateStatelessWhenApplied();
+
+  const StaticData &staticData = StaticData::Instance();
+  const vector<const StatefulFeatureFunction*>& ffs =
+    StatefulFeatureFunction::GetStatefulFeatureFunctions();
+  for (unsigned i = 0; i < ffs.size(); ++i) {
+    const StatefulFeatureFunction &ff = *ffs[i];
+    if(!staticData.IsFeatureFunctionIgnored(ff)) {
+      EvaluateWhenApplied(ff);
+    }
+  }
+
+  EvaluateTotal(estimatedScore);
+}
+
+/***
+ * as above, for hypotheses created together.  Each stateful feature function
+ * sees the whole batch at once so it can amortise its lookups.
+ */
+void
+Hypothesis::
+EvaluateWhenAppliedBatch(const std::vector<Hypothesis*> &batch,
+                         const std::vector<float> &estimatedScores)
+{
+  UTIL_THROW_IF2(batch.size() != estimatedScores.size(),
+                 "Need one estimated score per hypothesis in the batch");
+  if (batch.empty()) return;
+
+  for (size_t j = 0; j < batch.size(); ++j) {
+    batch[j]->EvaluateStatelessWhenApplied();
+  }
+
+  const StaticData &staticData = StaticData::Instance();
+  const vector<const StatefulFeatureFunction*>& ffs =
+    StatefulFeatureFunction::GetStatefulFeatureFunctions();
+  for (unsigned i = 0; i < ffs.size(); ++i) {
+    const StatefulFeatureFunction &ff = *ffs[i];
+    if(!staticData.IsFeatureFunctionIgnored(ff)) {
+      ff.EvaluateWhenAppliedBatch(batch);
+    }
+  }
+
+  for (size_t j = 0; j < batch.size(); ++j) {
+    batch[j]->EvaluateTotal(estimatedScores[j]);
+  }
+}
+
+void
+Hypothesis::
+EvaluateWhenApplied(const StatefulFeatureFunction &sfff)
+{
+  const size_t i = sfff.GetStatefulIndex();
+  FFState const* s = m_prevHypo ? m_prevHypo->m_ffStates[i] : NULL;
+  m_ffStates[i] = sfff.EvaluateWhenApplied(*this, s, &m_currScoreBreakdown);
+}
+
+void
+Hypothesis::
+EvaluateStatelessWhenApplied()
 {
   const StaticData &staticData = StaticData::Instance();
 
@@ -168,17 +228,12 @@ EvaluateWhenApplied(float estimatedScore)
       ff.EvaluateWhenApplied(*this, &m_currScoreBreakdown);
     }
   }
+}
 
-  const vector<const StatefulFeatureFunction*>& ffs =
-    StatefulFeatureFunction::GetStatefulFeatureFunctions();
-  for (unsigned i = 0; i < ffs.size(); ++i) {
-    const StatefulFeatureFunction &ff = *ffs[i];
-    if(!staticData.IsFeatureFunctionIgnored(ff)) {
-      FFState const* s = m_prevHypo ? m_prevHypo->m_ffStates[i] : NULL;
-      m_ffStates[i] = ff.EvaluateWhenApplied(*this, s, &m_currScoreBreakdown);
-    }
-  }
-
+void
+Hypothesis::
+EvaluateTotal(float estimatedScore)
+{
   // FUTURE COST
   m_estimatedScore = estimatedScore;
 
@@ -253,7 +308,7 @@ CleanupArcList(size_t nBestSize, bool distinctNBest)
 
     // delete bad ones
     ArcList::iterator i = m_arcList->begin() + nBestSize;
-    while (i != m_arcList->end()) delete *i++;
+    while (i != m_arcList->end()) m_manager.GetHypothesisPool().Release(*i++);
     m_arcList->erase(m_arcList->begin() + nBestSize, m_arcList->end());
   }
 
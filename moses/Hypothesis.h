@@ -85,6 +85,9 @@ protected:
 
   int m_id; /*! numeric ID of this hypothesis, used for logging */
 
+  void EvaluateStatelessWhenApplied();
+  void EvaluateTotal(float estimatedScore);
+
 public:
   /*! used by initial seeding of the translation process */
   Hypothesis(Manager& manager, InputType const& source, const TranslationOption &initialTransOpt, const Bitmap &bitmap, int id);
@@ -122,6 +125,20 @@ public:
 
   void EvaluateWhenApplied(float estimatedScore);
 
+  /** evaluate hypotheses created together, e.g. the successors of one cube
+   *  pruning pop.  Stateful feature functions get them as one batch. */
+  static void EvaluateWhenAppliedBatch(const std::vector<Hypothesis*> &batch,
+                                       const std::vector<float> &estimatedScores);
+
+  /** evaluate a single stateful feature function and keep its state.
+   *  Used by StatefulFeatureFunction::EvaluateWhenAppliedBatch. */
+  void EvaluateWhenApplied(const StatefulFeatureFunction &sfff);
+
+  //! scores of this hypothesis only, for overrides of EvaluateWhenAppliedBatch
+  ScoreComponentCollection &GetCurrScoreBreakdown() {
+    return m_currScoreBreakdown;
+  }
+
   int GetId()const {
     return m_id;
   }
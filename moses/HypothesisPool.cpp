@@ -0,0 +1,104 @@
+// -*- mode: c++; indent-tabs-mode: nil; tab-width:2  -*-
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <algorithm>
+#include <new>
+#include "HypothesisPool.h"
+#include "Hypothesis.h"
+
+using namespace std;
+
+namespace Moses
+{
+
+namespace
+{
+// first block holds this many hypotheses, each further block twice as many
+const size_t InitialBlockSize = 256;
+const size_t MaxBlockSize = 65536;
+}
+
+HypothesisPool::HypothesisPool()
+  : m_blockSize(0)
+  , m_blockUsed(0)
+  , m_numLive(0)
+{
+}
+
+HypothesisPool::~HypothesisPool()
+{
+  // hypotheses that are still alive belong to a search that is being torn
+  // down together with the Manager. Their memory goes with the blocks.
+  for (size_t i = 0; i < m_blocks.size(); ++i) {
+    ::operator delete(m_blocks[i]);
+  }
+}
+
+void *HypothesisPool::Allocate()
+{
+  ++m_numLive;
+  if (!m_free.empty()) {
+    void *ret = m_free.back();
+    m_free.pop_back();
+    return ret;
+  }
+
+  if (m_blockUsed == m_blockSize) {
+    m_blockSize = m_blocks.empty() ? InitialBlockSize : std::min(m_blockSize * 2, MaxBlockSize);
+    m_blocks.push_back(static_cast<char*>(::operator new(m_blockSize * sizeof(Hypothesis))));
+    m_blockUsed = 0;
+  }
+  return m_blocks.back() + sizeof(Hypothesis) * m_blockUsed++;
+}
+
+Hypothesis *HypothesisPool::Create(Manager& manager, InputType const& source, const TranslationOption &initialTransOpt, const Bitmap &bitmap, int id)
+{
+  void *mem = Allocate();
+  try {
+    return new (mem) Hypothesis(manager, source, initialTransOpt, bitmap, id);
+  } catch (...) {
+    m_free.push_back(mem);
+    --m_numLive;
+    throw;
+  }
+}
+
+Hypothesis *HypothesisPool::Create(const Hypothesis &prevHypo, const TranslationOption &transOpt, const Bitmap &bitmap, int id)
+{
+  void *mem = Allocate();
+  try {
+    return new (mem) Hypothesis(prevHypo, transOpt, bitmap, id);
+  } catch (...) {
+    m_free.push_back(mem);
+    --m_numLive;
+    throw;
+  }
+}
+
+void HypothesisPool::Release(Hypothesis *hypo)
+{
+  if (hypo == NULL) return;
+  // the destructor may release the hypothesis' arcs back into this pool
+  hypo->~Hypothesis();
+  m_free.push_back(hypo);
+  --m_numLive;
+}
+
+}
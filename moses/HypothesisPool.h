@@ -0,0 +1,75 @@
+// -*- mode: c++; indent-tabs-mode: nil; tab-width:2  -*-
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_HypothesisPool_h
+#define moses_HypothesisPool_h
+
+#include <vector>
+#include <cstddef>
+#include <boost/noncopyable.hpp>
+
+namespace Moses
+{
+
+class Hypothesis;
+class Manager;
+class InputType;
+class TranslationOption;
+class Bitmap;
+
+/** Per-sentence storage for phrase-based hypotheses.
+ *  Hypotheses are carved out of large blocks instead of being allocated one
+ *  by one. Released (pruned or recombined away) hypotheses are destroyed
+ *  straight away and their memory goes on a free list for the next Create().
+ *  The blocks themselves are only given back when the pool, which is owned by
+ *  the Manager, is destroyed at the end of the sentence.
+ */
+class HypothesisPool : private boost::noncopyable
+{
+public:
+  HypothesisPool();
+  ~HypothesisPool();
+
+  /*! initial hypothesis */
+  Hypothesis *Create(Manager& manager, InputType const& source, const TranslationOption &initialTransOpt, const Bitmap &bitmap, int id);
+  /*! extension of prevHypo by transOpt */
+  Hypothesis *Create(const Hypothesis &prevHypo, const TranslationOption &transOpt, const Bitmap &bitmap, int id);
+
+  /*! destroy a hypothesis created by this pool and recycle its memory */
+  void Release(Hypothesis *hypo);
+
+  //! number of hypotheses handed out and not released yet
+  size_t GetNumLive() const {
+    return m_numLive;
+  }
+
+private:
+  std::vector<char*> m_blocks;
+  std::vector<void*> m_free;
+  size_t m_blockSize; /*! capacity of the newest block, in hypotheses */
+  size_t m_blockUsed; /*! hypotheses handed out from the newest block */
+  size_t m_numLive;
+
+  void *Allocate();
+};
+
+}
+
+#endif
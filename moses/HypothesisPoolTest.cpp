@@ -0,0 +1,105 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2015- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+#include <vector>
+
+#include "Bitmaps.h"
+#include "Hypothesis.h"
+#include "HypothesisPool.h"
+#include "Manager.h"
+#include "Sentence.h"
+#include "StaticData.h"
+#include "TranslationOption.h"
+#include "TranslationTask.h"
+
+using namespace Moses;
+using namespace std;
+
+namespace
+{
+
+// A sentence, its manager and one option to extend hypotheses with.
+struct PoolFixture {
+  boost::shared_ptr<Sentence> sentence;
+  ttasksptr ttask;
+  boost::shared_ptr<Manager> manager;
+  TranslationOption initialTransOpt;
+  TargetPhrase targetPhrase;
+  boost::shared_ptr<TranslationOption> transOpt;
+
+  PoolFixture() : targetPhrase(NULL) {
+    AllOptions::ptr opts(new AllOptions(*StaticData::Instance().options()));
+    sentence.reset(new Sentence(opts, 0, "a b"));
+    ttask = TranslationTask::create(sentence);
+    manager.reset(new Manager(ttask));
+    manager->ResetSentenceStats(*sentence);
+    targetPhrase.CreateFromString(Input, opts->output.factor_order, "x", NULL);
+    transOpt.reset(new TranslationOption(Range(0, 0), targetPhrase));
+  }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(hypothesis_pool)
+
+BOOST_FIXTURE_TEST_CASE(create_and_release, PoolFixture)
+{
+  HypothesisPool &pool = manager->GetHypothesisPool();
+  Bitmaps bitmaps(sentence->GetSize(), sentence->m_sourceCompleted);
+  const Bitmap &initBitmap = bitmaps.GetInitialBitmap();
+  const Bitmap &nextBitmap = bitmaps.GetBitmap(initBitmap, Range(0, 0));
+
+  Hypothesis *initial = pool.Create(*manager, *sentence, initialTransOpt, initBitmap, 0);
+  BOOST_CHECK_EQUAL(1U, pool.GetNumLive());
+
+  // more than fit in the first block
+  const size_t num = 600;
+  vector<Hypothesis*> hypos;
+  for (size_t i = 0; i < num; ++i) {
+    hypos.push_back(pool.Create(*initial, *transOpt, nextBitmap, i + 1));
+  }
+  BOOST_CHECK_EQUAL(num + 1, pool.GetNumLive());
+  BOOST_CHECK_EQUAL(num, set<Hypothesis*>(hypos.begin(), hypos.end()).size());
+  for (size_t i = 0; i < num; ++i) {
+    BOOST_CHECK_EQUAL(static_cast<int>(i + 1), hypos[i]->GetId());
+    BOOST_CHECK(hypos[i]->GetPrevHypo() == initial);
+    BOOST_CHECK_EQUAL(0U, hypos[i]->GetCurrSourceWordsRange().GetStartPos());
+  }
+
+  // released memory is handed out again before new memory
+  Hypothesis *released = hypos[300];
+  pool.Release(released);
+  BOOST_CHECK_EQUAL(num, pool.GetNumLive());
+  hypos[300] = pool.Create(*initial, *transOpt, nextBitmap, 1000);
+  BOOST_CHECK(hypos[300] == released);
+  BOOST_CHECK_EQUAL(1000, hypos[300]->GetId());
+
+  pool.Release(NULL);
+  BOOST_CHECK_EQUAL(num + 1, pool.GetNumLive());
+  for (size_t i = 0; i < num; ++i) {
+    pool.Release(hypos[i]);
+  }
+  pool.Release(initial);
+  BOOST_CHECK_EQUAL(0U, pool.GetNumLive());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,5 +1,6 @@
 
 #include "HypothesisStack.h"
+#include "Manager.h"
 
 namespace Moses
 {
@@ -22,7 +23,7 @@ void HypothesisStack::Remove(const HypothesisStack::iterator &iter)
 {
   Hypothesis *h = *iter;
   Detach(iter);
-  delete h;
+  m_manager.GetHypothesisPool().Release(h);
 }
 
 
@@ -95,7 +95,7 @@ bool HypothesisStackNormal::AddPrune(Hypothesis *hypo)
   if (hypo->GetFutureScore() == - std::numeric_limits<float>::infinity()) {
     m_manager.GetSentenceStats().AddDiscarded();
     VERBOSE(3,"discarded, constraint" << std::endl);
-    delete hypo;
+    m_manager.GetHypothesisPool().Release(hypo);
     return false;
   }
 
@@ -106,7 +106,7 @@ bool HypothesisStackNormal::AddPrune(Hypothesis *hypo)
              && hypo->GetFutureScore() >= GetWorstScoreForBitmap( hypo->GetWordsBitmap() ) ) ) {
     m_manager.GetSentenceStats().AddDiscarded();
     VERBOSE(3,"discarded, too bad for stack" << std::endl);
-    delete hypo;
+    m_manager.GetHypothesisPool().Release(hypo);
     return false;
   }
 
@@ -148,7 +148,7 @@ bool HypothesisStackNormal::AddPrune(Hypothesis *hypo)
     if (m_nBestIsEnabled) {
       hypoExisting->AddArc(hypo);
     } else {
-      delete hypo;
+      m_manager.GetHypothesisPool().Release(hypo);
     }
     return false;
   }
@@ -208,7 +208,7 @@ void HypothesisStackNormal::PruneToSize(size_t newSize)
   // delete hypotheses that have not been included
   for(size_t i=0; i<hypos.size(); i++) {
     if (! included[i]) {
-      delete hypos[i];
+      m_manager.GetHypothesisPool().Release(hypos[i]);
       m_manager.GetSentenceStats().AddPruning();
     }
   }
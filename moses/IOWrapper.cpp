@@ -70,6 +70,9 @@ IOWrapper::IOWrapper(AllOptions const& opts)
   , m_look_ahead(0)
   , m_look_back(0)
   , m_buffered_ahead(0)
+  , m_outputWindow(opts.output.output_window)
+  , m_submitted(0)
+  , m_oldestUnfinished(0)
   , spe_src(NULL)
   , spe_trg(NULL)
   , spe_aln(NULL)
@@ -101,11 +104,22 @@ IOWrapper::IOWrapper(AllOptions const& opts)
     m_inputStream = m_inputFile;
   }
 
+  UTIL_THROW_IF2(m_options->nbest.binary
+                 && (is_syntax(m_options->search.algo) || m_options->lmbr.enabled),
+                 "Binary n-best lists are only written by phrase-based decoding without lattice MBR");
+  std::ostringstream binaryHeader;
+  if (m_options->nbest.binary) {
+    ScoreComponentCollection::OutputBinaryFeatureHeader(binaryHeader);
+  }
+
   if (nBestSize > 0) {
     m_nBestOutputCollector.reset(new Moses::OutputCollector(nBestFilePath));
     if (m_nBestOutputCollector->OutputIsCout()) {
       m_surpressSingleBestOutput = true;
     }
+    if (m_options->nbest.binary) {
+      m_nBestOutputCollector->WriteHeader(binaryHeader.str());
+    }
   }
 
   std::string path;
@@ -135,6 +149,9 @@ IOWrapper::IOWrapper(AllOptions const& opts)
     if (m_latticeSamplesCollector->OutputIsCout()) {
       m_surpressSingleBestOutput = true;
     }
+    if (m_options->nbest.binary) {
+      m_latticeSamplesCollector->WriteHeader(binaryHeader.str());
+    }
   }
 
   if (!m_surpressSingleBestOutput) {
@@ -246,6 +263,47 @@ ReadInput(boost::shared_ptr<std::vector<std::string> >* cw)
   return source;
 }
 
+void
+IOWrapper::
+WaitForOutputWindow(long translationId)
+{
+#ifdef WITH_THREADS
+  if (m_outputWindow == 0) return;
+  boost::mutex::scoped_lock lock(m_windowLock);
+  size_t const number = m_submitted++;
+  UTIL_THROW_IF2(!m_submissionOrder.insert(std::make_pair(translationId, number)).second,
+                 "Translation id " << translationId << " is submitted twice");
+  while (number >= m_oldestUnfinished + m_outputWindow) {
+    m_windowMoved.wait(lock);
+  }
+#endif
+}
+
+void
+IOWrapper::
+TranslationFinished(long translationId)
+{
+#ifdef WITH_THREADS
+  if (m_outputWindow == 0) return;
+  boost::mutex::scoped_lock lock(m_windowLock);
+  std::map<long, size_t>::iterator submitted = m_submissionOrder.find(translationId);
+  if (submitted == m_submissionOrder.end()) return;
+  size_t const number = submitted->second;
+  m_submissionOrder.erase(submitted);
+  if (number != m_oldestUnfinished) {
+    m_finishedAhead.insert(number);
+    return;
+  }
+  ++m_oldestUnfinished;
+  std::set<size_t>::iterator iter;
+  while ((iter = m_finishedAhead.find(m_oldestUnfinished)) != m_finishedAhead.end()) {
+    m_finishedAhead.erase(iter);
+    ++m_oldestUnfinished;
+  }
+  m_windowMoved.notify_all();
+#endif
+}
+
 boost::shared_ptr<std::vector<std::string> >
 IOWrapper::
 GetCurrentContextWindow() const
@@ -44,6 +44,8 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <ostream>
 #include <vector>
 #include <list>
+#include <map>
+#include <set>
 #include <iomanip>
 #include <limits>
 
@@ -126,6 +128,19 @@ protected:
 
   std::string m_hypergraph_output_filepattern;
 
+  // -output-window. Sentences are numbered in the order they are submitted,
+  // since translation ids need not be contiguous. Keeps the number of the
+  // oldest sentence not yet finished, and of those after it that have.
+  size_t m_outputWindow;
+  size_t m_submitted;
+  size_t m_oldestUnfinished;
+  std::set<size_t> m_finishedAhead;
+  std::map<long, size_t> m_submissionOrder; /// translation id -> number
+#ifdef WITH_THREADS
+  boost::mutex m_windowLock;
+  boost::condition_variable m_windowMoved;
+#endif
+
 public:
   IOWrapper(AllOptions const& opts);
   ~IOWrapper();
@@ -184,6 +199,16 @@ public:
 
   std::string GetHypergraphOutputFileName(size_t const id) const;
 
+  // Counts translationId as the next sentence submitted, and blocks until
+  // it is less than -output-window sentences ahead of the oldest unfinished
+  // one, so that the collectors never hold back the output of more
+  // sentences than that.
+  void WaitForOutputWindow(long translationId);
+
+  // All output of translationId has been handed to the collectors. Ignored
+  // for sentences that did not go through WaitForOutputWindow().
+  void TranslationFinished(long translationId);
+
   // post editing
   std::ifstream *spe_src, *spe_trg, *spe_aln;
 
@@ -17,9 +17,15 @@
 #include "search/context.hh"
 #include "search/edge_generator.hh"
 #include "search/rule.hh"
+#include "search/stats.hh"
 #include "search/vertex_generator.hh"
 
 #include <boost/lexical_cast.hpp>
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
+
+#include <fstream>
 
 namespace Moses
 {
@@ -150,6 +156,7 @@ template <class Model> void Fill<Model>::Add(const TargetPhraseCollection &targe
     edge.SetScore(phrase.GetFutureScore() + below_score);
     // prob and oov were already accounted for.
     search::ScoreRule(context_.LanguageModel(), words, edge.Between());
+    if (search::Stats *stats = context_.GetStats()) ++stats->Count().rules_scored;
 
     search::Note note;
     note.vp = &phrase;
@@ -171,6 +178,7 @@ template <class Model> void Fill<Model>::AddPhraseOOV(TargetPhrase &phrase, std:
   search::PartialEdge edge(edges_.AllocateEdge(0));
   // Appears to be a bug that FutureScore does not already include language model.
   search::ScoreRuleRet scored(search::ScoreRule(context_.LanguageModel(), words, edge.Between()));
+  if (search::Stats *stats = context_.GetStats()) ++stats->Count().rules_scored;
   edge.SetScore(phrase.GetFutureScore() + scored.prob * context_.LMWeight() + static_cast<search::Score>(scored.oov) * oov_weight_);
 
   search::Note note;
@@ -202,6 +210,45 @@ struct ChartCellBaseFactory {
   }
 };
 
+// Destination for incremental-search-stats: one JSON line per sentence and,
+// when the decoder exits, one line with the totals over all sentences.
+class StatsLog
+{
+public:
+  static StatsLog &Instance(const std::string &path) {
+    static StatsLog log(path);
+    return log;
+  }
+
+  void Write(long translationId, const search::Stats &stats) {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
+    m_out << "{\"sentence\":" << translationId << ",\"stats\":";
+    stats.WriteJSON(m_out);
+    m_out << "}\n";
+    m_total.Add(stats);
+  }
+
+  ~StatsLog() {
+    m_out << "{\"aggregate\":";
+    m_total.WriteJSON(m_out);
+    m_out << "}\n";
+  }
+
+private:
+  explicit StatsLog(const std::string &path) : m_out(path.c_str()) {
+    UTIL_THROW_IF2(!m_out, "Could not open " << path << " for search statistics");
+    m_total.KeepCells(false);
+  }
+
+  std::ofstream m_out;
+  search::Stats m_total;
+#ifdef WITH_THREADS
+  boost::mutex m_mutex;
+#endif
+};
+
 } // namespace
 
 Manager::Manager(ttasksptr const& ttask)
@@ -237,6 +284,11 @@ PopulateBest(const Model &model, const std::vector<lm::WordIndex> &words, Best &
   search::Config config(lm_weight * log_10, cpl, search::NBestConfig(nbs));
   search::Context<Model> context(config, model);
 
+  const std::string &statsPath = data.options()->output.incremental_search_stats_filepath;
+  search::Stats stats;
+  search::Stats *const statsPtr = statsPath.empty() ? NULL : &stats;
+  context.SetStats(statsPtr);
+
   size_t size = m_source.GetSize();
   boost::object_pool<search::Vertex> vertex_pool(std::max<size_t>(size * size / 2, 32));
 
@@ -247,16 +299,25 @@ PopulateBest(const Model &model, const std::vector<lm::WordIndex> &words, Best &
         break;
       }
       Range range(startPos, startPos + width - 1);
+      if (statsPtr) statsPtr->BeginCell(range.GetStartPos(), range.GetEndPos());
       Fill<Model> filler(context, words, oov_weight);
       parser_.Create(range, filler);
       filler.Search(out, cells_.MutableBase(range).MutableTargetLabelSet(), vertex_pool);
+      if (statsPtr) statsPtr->EndCell();
     }
   }
 
   Range range(0, size - 1);
+  if (statsPtr) statsPtr->BeginCell(range.GetStartPos(), range.GetEndPos());
   Fill<Model> filler(context, words, oov_weight);
   parser_.Create(range, filler);
-  return filler.RootSearch(out);
+  search::History ret = filler.RootSearch(out);
+  if (statsPtr) {
+    statsPtr->EndCell();
+    statsPtr->EndSentence();
+    StatsLog::Instance(statsPath).Write(m_source.GetTranslationId(), stats);
+  }
+  return ret;
 }
 
 template <class Model> void Manager::LMCallback(const Model &model, const std::vector<lm::WordIndex> &words)
@@ -23,6 +23,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <cstdlib>
 #include <boost/shared_ptr.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "lm/binary_format.hh"
 #include "lm/enumerate_vocab.hh"
@@ -67,6 +69,23 @@ struct KenLMState : public FFState {
 
 };
 
+// Language model state and the first words of a target phrase after it.
+struct PhraseStartKey {
+  lm::ngram::State state;
+  std::vector<lm::WordIndex> words;
+
+  bool operator==(const PhraseStartKey &other) const {
+    return state == other.state && words == other.words;
+  }
+};
+
+size_t hash_value(const PhraseStartKey &key)
+{
+  size_t seed = hash_value(key.state);
+  boost::hash_range(seed, key.words.begin(), key.words.end());
+  return seed;
+}
+
 class MappingBuilder : public lm::EnumerateVocab
 {
 public:
@@ -194,17 +213,8 @@ template <class Model> void LanguageModelKen<Model>::CalcScore(const Phrase &phr
   fullScore = TransformLMScore(fullScore);
 }
 
-template <class Model> FFState *LanguageModelKen<Model>::EvaluateWhenApplied(const Hypothesis &hypo, const FFState *ps, ScoreComponentCollection *out) const
+template <class Model> float LanguageModelKen<Model>::ScorePhraseStart(const lm::ngram::State &in_state, const Hypothesis &hypo, lm::ngram::State &out_state) const
 {
-  const lm::ngram::State &in_state = static_cast<const KenLMState&>(*ps).state;
-
-  std::auto_ptr<KenLMState> ret(new KenLMState());
-
-  if (!hypo.GetCurrTargetLength()) {
-    ret->state = in_state;
-    return ret.release();
-  }
-
   const std::size_t begin = hypo.GetCurrTargetWordsRange().GetStartPos();
   //[begin, end) in STL-like fashion.
   const std::size_t end = hypo.GetCurrTargetWordsRange().GetEndPos() + 1;
@@ -212,7 +222,7 @@ template <class Model> FFState *LanguageModelKen<Model>::EvaluateWhenApplied(con
 
   std::size_t position = begin;
   typename Model::State aux_state;
-  typename Model::State *state0 = &ret->state, *state1 = &aux_state;
+  typename Model::State *state0 = &out_state, *state1 = &aux_state;
 
   float score = m_ngram->Score(in_state, TranslateID(hypo.GetWord(position)), *state0);
   ++position;
@@ -220,20 +230,26 @@ template <class Model> FFState *LanguageModelKen<Model>::EvaluateWhenApplied(con
     score += m_ngram->Score(*state0, TranslateID(hypo.GetWord(position)), *state1);
     std::swap(state0, state1);
   }
+  if (state0 != &out_state) out_state = *state0;
+  return score;
+}
+
+template <class Model> void LanguageModelKen<Model>::FinishWhenApplied(const Hypothesis &hypo, float score, lm::ngram::State &state, ScoreComponentCollection *out) const
+{
+  const std::size_t begin = hypo.GetCurrTargetWordsRange().GetStartPos();
+  const std::size_t end = hypo.GetCurrTargetWordsRange().GetEndPos() + 1;
+  const std::size_t adjust_end = std::min(end, begin + m_ngram->Order() - 1);
 
   if (hypo.IsSourceCompleted()) {
     // Score end of sentence.
     std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
     const lm::WordIndex *last = LastIDs(hypo, &indices.front());
-    score += m_ngram->FullScoreForgotState(&indices.front(), last, m_ngram->GetVocabulary().EndSentence(), ret->state).prob;
+    score += m_ngram->FullScoreForgotState(&indices.front(), last, m_ngram->GetVocabulary().EndSentence(), state).prob;
   } else if (adjust_end < end) {
     // Get state after adding a long phrase.
     std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
     const lm::WordIndex *last = LastIDs(hypo, &indices.front());
-    m_ngram->GetState(&indices.front(), last, ret->state);
-  } else if (state0 != &ret->state) {
-    // Short enough phrase that we can just reuse the state.
-    ret->state = *state0;
+    m_ngram->GetState(&indices.front(), last, state);
   }
 
   score = TransformLMScore(score);
@@ -246,10 +262,66 @@ template <class Model> FFState *LanguageModelKen<Model>::EvaluateWhenApplied(con
   } else {
     out->PlusEquals(this, score);
   }
+}
+
+template <class Model> FFState *LanguageModelKen<Model>::EvaluateWhenApplied(const Hypothesis &hypo, const FFState *ps, ScoreComponentCollection *out) const
+{
+  const lm::ngram::State &in_state = static_cast<const KenLMState&>(*ps).state;
 
+  std::auto_ptr<KenLMState> ret(new KenLMState());
+
+  if (!hypo.GetCurrTargetLength()) {
+    ret->state = in_state;
+    return ret.release();
+  }
+
+  float score = ScorePhraseStart(in_state, hypo, ret->state);
+  FinishWhenApplied(hypo, score, ret->state, out);
   return ret.release();
 }
 
+/* Hypotheses created together often extend the same state with the same
+ * words, e.g. when cube pruning pairs one translation option with previous
+ * hypotheses whose language model states were recombined, or when several
+ * options over a span start alike.  Their phrase starts are scored once.
+ */
+template <class Model> void LanguageModelKen<Model>::EvaluateWhenAppliedBatch(const std::vector<Hypothesis*> &batch) const
+{
+  const std::size_t index = GetStatefulIndex();
+  boost::unordered_map<PhraseStartKey, std::pair<float, lm::ngram::State> > scored;
+  PhraseStartKey key;
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    Hypothesis &hypo = *batch[i];
+    if (!hypo.GetPrevHypo()) {
+      hypo.EvaluateWhenApplied(*this);
+      continue;
+    }
+    const lm::ngram::State &in_state = static_cast<const KenLMState&>(*hypo.GetPrevHypo()->GetFFState(index)).state;
+    std::auto_ptr<KenLMState> ret(new KenLMState());
+    if (!hypo.GetCurrTargetLength()) {
+      ret->state = in_state;
+      hypo.SetFFState(index, ret.release());
+      continue;
+    }
+
+    const std::size_t begin = hypo.GetCurrTargetWordsRange().GetStartPos();
+    const std::size_t end = std::min<std::size_t>(hypo.GetCurrTargetWordsRange().GetEndPos() + 1, begin + m_ngram->Order() - 1);
+    key.state = in_state;
+    key.words.clear();
+    for (std::size_t position = begin; position < end; ++position) {
+      key.words.push_back(TranslateID(hypo.GetWord(position)));
+    }
+    std::pair<typename boost::unordered_map<PhraseStartKey, std::pair<float, lm::ngram::State> >::iterator, bool> found(
+      scored.insert(std::make_pair(key, std::pair<float, lm::ngram::State>())));
+    if (found.second) {
+      found.first->second.first = ScorePhraseStart(in_state, hypo, found.first->second.second);
+    }
+    ret->state = found.first->second.second;
+    FinishWhenApplied(hypo, found.first->second.first, ret->state, &hypo.GetCurrScoreBreakdown());
+    hypo.SetFFState(index, ret.release());
+  }
+}
+
 class LanguageModelChartStateKenLM : public FFState
 {
 public:
@@ -458,7 +530,7 @@ LanguageModel *ConstructKenLM(const std::string &lineOrig)
       } else if (value == "1" || value == "true") {
         load_method = util::LAZY;
       } else {
-        UTIL_THROW2("Can't parse lazyken argument " << value << ".  Also, lazyken is deprecated.  Use load with one of the arguments lazy, populate_or_lazy, populate_or_read, read, or parallel_read.");
+        UTIL_THROW2("Can't parse lazyken argument " << value << ".  Also, lazyken is deprecated.  Use load with one of the arguments lazy, populate_or_lazy, populate_or_read, read, parallel_read, or direct_read.");
       }
     } else if (name == "load") {
       if (value == "lazy") {
@@ -471,6 +543,8 @@ LanguageModel *ConstructKenLM(const std::string &lineOrig)
         load_method = util::READ;
       } else if (value == "parallel_read") {
         load_method = util::PARALLEL_READ;
+      } else if (value == "direct_read") {
+        load_method = util::DIRECT_READ;
       } else {
         UTIL_THROW2("Unknown KenLM load method " << value);
       }
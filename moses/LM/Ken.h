@@ -25,6 +25,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <string>
 #include <boost/shared_ptr.hpp>
 
+#include "lm/state.hh"
 #include "lm/word_index.hh"
 #include "util/mmap.hh"
 
@@ -61,6 +62,8 @@ public:
 
   virtual FFState *EvaluateWhenApplied(const Hypothesis &hypo, const FFState *ps, ScoreComponentCollection *out) const;
 
+  virtual void EvaluateWhenAppliedBatch(const std::vector<Hypothesis*> &batch) const;
+
   virtual FFState *EvaluateWhenApplied(const ChartHypothesis& cur_hypo, int featureID, ScoreComponentCollection *accumulator) const;
 
   virtual FFState *EvaluateWhenApplied(const Syntax::SHyperedge& hyperedge, int featureID, ScoreComponentCollection *accumulator) const;
@@ -92,6 +95,14 @@ private:
   LanguageModelKen();
   LanguageModelKen(const LanguageModelKen<Model> &copy_from);
 
+  // Score the words of the hypothesis' target phrase that are conditioned on
+  // in_state, i.e. at most the first Order() - 1, and the state after them.
+  float ScorePhraseStart(const lm::ngram::State &in_state, const Hypothesis &hypo, lm::ngram::State &out_state) const;
+
+  // Score the end of sentence or fix up the state after a long phrase, then
+  // add score to out.
+  void FinishWhenApplied(const Hypothesis &hypo, float score, lm::ngram::State &state, ScoreComponentCollection *out) const;
+
   // Convert last words of hypothesis into vocab ids, returning an end pointer.
   lm::WordIndex *LastIDs(const Hypothesis &hypo, lm::WordIndex *indices) const {
     lm::WordIndex *index = indices;
@@ -11,6 +11,11 @@
 #include "moses/StaticData.h"
 #include <algorithm>
 #include <set>
+#include <boost/bind.hpp>
+#include <boost/unordered_map.hpp>
+#ifdef WITH_THREADS
+#include <boost/thread.hpp>
+#endif
 
 using namespace std;
 
@@ -35,7 +40,11 @@ void GetOutputWords(const TrellisPath &path, vector <Word> &translation)
 }
 
 
-void extract_ngrams(const vector<Word >& sentence, map < Phrase, int >  & allngrams)
+namespace
+{
+
+template <class NgramCounts>
+void ExtractNgrams(const vector<Word >& sentence, NgramCounts & allngrams)
 {
   for (int k = 0; k < (int)bleu_order; k++) {
     for(int i =0; i < max((int)sentence.size()-k,0); i++) {
@@ -48,32 +57,46 @@ void extract_ngrams(const vector<Word >& sentence, map < Phrase, int >  & allngr
   }
 }
 
+//Score a translation against the ngram posteriors, filling in ngramScores
+template <class PosteriorTable, class NgramCounts>
+float CalcMBRScore(const vector<Word>& words, float mapScore, const PosteriorTable& finalNgramScores,
+                   const vector<float>& thetas, float mapWeight, vector<float>& ngramScores)
+{
+  ngramScores.assign(thetas.size()-1, -10000);
 
+  NgramCounts counts;
+  ExtractNgrams(words,counts);
 
-void NgramScores::addScore(const Hypothesis* node, const Phrase& ngram, float score)
-{
-  set<Phrase>::const_iterator ngramIter = m_ngrams.find(ngram);
-  if (ngramIter == m_ngrams.end()) {
-    ngramIter = m_ngrams.insert(ngram).first;
-  }
-  map<const Phrase*,float>& ngramScores = m_scores[node];
-  map<const Phrase*,float>::iterator scoreIter = ngramScores.find(&(*ngramIter));
-  if (scoreIter == ngramScores.end()) {
-    ngramScores[&(*ngramIter)] = score;
-  } else {
-    ngramScores[&(*ngramIter)] = log_sum(score,scoreIter->second);
+  //Now score this translation
+  float score = thetas[0] * words.size();
+
+  //Calculate the ngramScores, working in log space at first
+  for (typename NgramCounts::const_iterator ngrams = counts.begin(); ngrams != counts.end(); ++ngrams) {
+    float ngramPosterior = UNKNGRAMLOGPROB;
+    typename PosteriorTable::const_iterator ngramPosteriorIt = finalNgramScores.find(ngrams->first);
+    if (ngramPosteriorIt != finalNgramScores.end()) {
+      ngramPosterior = ngramPosteriorIt->second;
+    }
+    size_t ngramSize = ngrams->first.GetSize();
+    ngramScores[ngramSize-1] = log_sum(log((float)ngrams->second) + ngramPosterior,ngramScores[ngramSize-1]);
   }
-}
 
-NgramScores::NodeScoreIterator NgramScores::nodeBegin(const Hypothesis* node)
-{
-  return m_scores[node].begin();
+  //convert from log to probability and create weighted sum
+  for (size_t i = 0; i < ngramScores.size(); ++i) {
+    ngramScores[i] = exp(ngramScores[i]);
+    score += thetas[i+1] * ngramScores[i];
+  }
+
+  //The map score
+  score += mapScore*mapWeight;
+  return score;
 }
 
+}
 
-NgramScores::NodeScoreIterator NgramScores::nodeEnd(const Hypothesis* node)
+void extract_ngrams(const vector<Word >& sentence, map < Phrase, int >  & allngrams)
 {
-  return m_scores[node].end();
+  ExtractNgrams(sentence, allngrams);
 }
 
 LatticeMBRSolution::LatticeMBRSolution(const TrellisPath& path, bool isMap) :
@@ -99,34 +122,14 @@ LatticeMBRSolution::LatticeMBRSolution(const TrellisPath& path, bool isMap) :
 
 void LatticeMBRSolution::CalcScore(map<Phrase, float>& finalNgramScores, const vector<float>& thetas, float mapWeight)
 {
-  m_ngramScores.assign(thetas.size()-1, -10000);
-
-  map < Phrase, int > counts;
-  extract_ngrams(m_words,counts);
-
-  //Now score this translation
-  m_score = thetas[0] * m_words.size();
-
-  //Calculate the ngramScores, working in log space at first
-  for (map < Phrase, int >::iterator ngrams = counts.begin(); ngrams != counts.end(); ++ngrams) {
-    float ngramPosterior = UNKNGRAMLOGPROB;
-    map<Phrase,float>::const_iterator ngramPosteriorIt = finalNgramScores.find(ngrams->first);
-    if (ngramPosteriorIt != finalNgramScores.end()) {
-      ngramPosterior = ngramPosteriorIt->second;
-    }
-    size_t ngramSize = ngrams->first.GetSize();
-    m_ngramScores[ngramSize-1] = log_sum(log((float)ngrams->second) + ngramPosterior,m_ngramScores[ngramSize-1]);
-  }
-
-  //convert from log to probability and create weighted sum
-  for (size_t i = 0; i < m_ngramScores.size(); ++i) {
-    m_ngramScores[i] = exp(m_ngramScores[i]);
-    m_score += thetas[i+1] * m_ngramScores[i];
-  }
-
+  m_score = CalcMBRScore<map<Phrase, float>, map<Phrase, int> >(
+              m_words, m_mapScore, finalNgramScores, thetas, mapWeight, m_ngramScores);
+}
 
-  //The map score
-  m_score += m_mapScore*mapWeight;
+void LatticeMBRSolution::CalcScore(const NgramPosteriorTable& finalNgramScores, const vector<float>& thetas, float mapWeight)
+{
+  m_score = CalcMBRScore<NgramPosteriorTable, boost::unordered_map<Phrase, int> >(
+              m_words, m_mapScore, finalNgramScores, thetas, mapWeight, m_ngramScores);
 }
 
 
@@ -275,112 +278,341 @@ void pruneLatticeFB(Lattice & connectedHyp, map < const Hypothesis*, set <const
 
 }
 
+namespace
+{
+
+// The ngrams of the lattice as integer ids.  An ngram is stored as its
+// prefix (the ngram one word shorter) and its last word, so extending an
+// ngram by one word is a single hash lookup, and Phrases are only built for
+// the final scores.  Id 0 is the empty ngram.
+class NgramIndex
+{
+public:
+  NgramIndex() : m_prefix(1, 0), m_lastWord(1), m_size(1, 0) {}
+
+  size_t Extend(size_t prefix, const Word& word) {
+    std::pair<IdMap::iterator, bool> ret =
+      m_ids.insert(make_pair(make_pair(prefix, word), m_size.size()));
+    if (ret.second) {
+      m_prefix.push_back(prefix);
+      m_lastWord.push_back(word);
+      m_size.push_back(m_size[prefix] + 1);
+    }
+    return ret.first->second;
+  }
+
+  size_t GetSize(size_t ngram) const {
+    return m_size[ngram];
+  }
+
+  //Do the last lastN words of ngram equal the last lastN words of phrase?
+  bool SuffixEquals(size_t ngram, const Phrase& phrase, size_t lastN) const {
+    size_t pos = phrase.GetSize();
+    for (size_t i = 0; i < lastN; ++i, ngram = m_prefix[ngram]) {
+      if (m_lastWord[ngram] != phrase.GetWord(--pos)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void GetPhrase(size_t ngram, Phrase& phrase) const {
+    vector<const Word*> words;
+    for (; ngram != 0; ngram = m_prefix[ngram]) {
+      words.push_back(&m_lastWord[ngram]);
+    }
+    for (vector<const Word*>::reverse_iterator it = words.rbegin(); it != words.rend(); ++it) {
+      phrase.AddWord(**it);
+    }
+  }
+
+private:
+  typedef boost::unordered_map<std::pair<size_t, Word>, size_t> IdMap;
+  IdMap m_ids;
+  vector<size_t> m_prefix;
+  vector<Word> m_lastWord;
+  vector<size_t> m_size;
+};
+
+// Paths through the lattice, as sequences of edge ids, interned the same way
+// as the ngrams.  The score of a path is the forward score of its first tail
+// node plus the scores of its edges.  Id 0 is the empty path.
+class PathIndex
+{
+public:
+  PathIndex() : m_score(1, 0.0f) {}
+
+  size_t Extend(size_t prefix, size_t edge, float edgeScore, float startScore) {
+    std::pair<IdMap::iterator, bool> ret =
+      m_ids.insert(make_pair(make_pair(prefix, edge), m_score.size()));
+    if (ret.second) {
+      m_score.push_back((prefix ? m_score[prefix] : startScore) + edgeScore);
+    }
+    return ret.first->second;
+  }
+
+  float GetScore(size_t path) const {
+    return m_score[path];
+  }
+
+private:
+  typedef boost::unordered_map<std::pair<size_t, size_t>, size_t> IdMap;
+  IdMap m_ids;
+  vector<float> m_score;
+};
+
+// An ngram which ends on an edge, reached along a path ending with that edge.
+// count is the number of times the ngram occurs there.
+struct NgramOccurrence {
+  size_t ngram;
+  size_t path;
+  size_t count;
+};
+
+// Log-sums scores into an array indexed by ngram id, keeping a list of the
+// ngrams seen so that it can be read out and reset without a full scan.
+class NgramAccumulator
+{
+public:
+  void Add(size_t ngram, float score) {
+    if (ngram >= m_scores.size()) {
+      m_scores.resize(ngram + 1);
+      m_seen.resize(ngram + 1, false);
+    }
+    if (m_seen[ngram]) {
+      m_scores[ngram] = log_sum(score, m_scores[ngram]);
+    } else {
+      m_seen[ngram] = true;
+      m_scores[ngram] = score;
+      m_ngrams.push_back(ngram);
+    }
+  }
+
+  //Move the scores to out and reset
+  void Flush(vector<std::pair<size_t, float> >& out) {
+    out.reserve(out.size() + m_ngrams.size());
+    for (size_t i = 0; i < m_ngrams.size(); ++i) {
+      out.push_back(make_pair(m_ngrams[i], m_scores[m_ngrams[i]]));
+      m_seen[m_ngrams[i]] = false;
+    }
+    m_ngrams.clear();
+  }
+
+private:
+  vector<float> m_scores;
+  vector<bool> m_seen;
+  vector<size_t> m_ngrams;
+};
+
+}
+
+// The lattice is laid out as arrays in topological order: nodes are
+// numbered by increasing source coverage, the edges into each node are
+// contiguous, and ngrams and paths are integer ids.  The ngrams ending on
+// each edge are found from the ngrams ending on the edges into its tail, as
+// in Tromble et al 08.
+//
+// Expected counts are summed over all occurrences of each ngram with a
+// forward-backward pass.  Posteriors count an ngram at most once per path, so
+// the per node ngram scores are propagated forward instead, dropping the
+// history's score of an ngram on an edge which introduces it again.
 void calcNgramExpectations(Lattice & connectedHyp, map<const Hypothesis*, vector<Edge> >& incomingEdges,
                            map<Phrase, float>& finalNgramScores, bool posteriors)
 {
 
   sort(connectedHyp.begin(),connectedHyp.end(),ascendingCoverageCmp); //sort by increasing source word cov
 
-  /*cerr << "Lattice:" << endl;
-  for (Lattice::const_iterator i = connectedHyp.begin(); i != connectedHyp.end(); ++i) {
-      const Hypothesis* h = *i;
-      cerr << *h << endl;
-      const vector<Edge>& edges = incomingEdges[h];
-      for (size_t e = 0; e < edges.size(); ++e) {
-          cerr << edges[e];
-      }
-  }*/
+  const size_t numNodes = connectedHyp.size();
+  boost::unordered_map<const Hypothesis*, size_t> nodeIds;
+  for (size_t i = 0; i < numNodes; ++i) {
+    nodeIds[connectedHyp[i]] = i;
+  }
 
-  map<const Hypothesis*, float> forwardScore;
-  forwardScore[connectedHyp[0]] = 0.0f; //forward score of hyp 0 is 1 (or 0 in logprob space)
-  set< const Hypothesis *> finalHyps; //store completed hyps
+  //edges into node i are [edgeBegin[i], edgeBegin[i+1])
+  vector<const Edge*> edges;
+  vector<size_t> edgeTails;
+  vector<size_t> edgeBegin(1, 0);
+  for (size_t i = 0; i < numNodes; ++i) {
+    const vector<Edge>& inEdges = incomingEdges[connectedHyp[i]];
+    for (size_t e = 0; e < inEdges.size(); ++e) {
+      boost::unordered_map<const Hypothesis*, size_t>::const_iterator tail = nodeIds.find(inEdges[e].GetTailNode());
+      UTIL_THROW_IF2(tail == nodeIds.end() || tail->second >= i,
+                     "Lattice edge into hypothesis " << connectedHyp[i]->GetId()
+                     << " does not start at an earlier hypothesis");
+      edges.push_back(&inEdges[e]);
+      edgeTails.push_back(tail->second);
+    }
+    edgeBegin.push_back(edges.size());
+  }
+
+  //forward score of hyp 0 is 1 (or 0 in logprob space)
+  vector<float> forwardScore(numNodes, 0.0f);
+  vector<bool> isFinal(numNodes, false);
+  NgramIndex ngramIndex;
+  PathIndex pathIndex;
+  vector<vector<NgramOccurrence> > occurrences(edges.size());
+  boost::unordered_map<std::pair<size_t, size_t>, size_t> occurrenceIds;
 
-  NgramScores ngramScores;//ngram scores for each hyp
+  //ngram scores for each hyp, and the edge which last introduced each ngram
+  vector<vector<std::pair<size_t, float> > > ngramScores(posteriors ? numNodes : 0);
+  NgramAccumulator nodeScores;
+  vector<size_t> introducedBy;
 
-  for (size_t i = 1; i < connectedHyp.size(); ++i) {
+  for (size_t i = 1; i < numNodes; ++i) {
     const Hypothesis* currHyp = connectedHyp[i];
-    if (currHyp->GetWordsBitmap().IsComplete()) {
-      finalHyps.insert(currHyp);
-    }
+    isFinal[i] = currHyp->GetWordsBitmap().IsComplete();
 
     VERBOSE(3, "Processing hyp: " << currHyp->GetId() << ", num words cov= " << currHyp->GetWordsBitmap().GetNumWordsCovered() <<  endl)
 
-    vector <Edge> & edges = incomingEdges[currHyp];
-    for (size_t e = 0; e < edges.size(); ++e) {
-      const Edge& edge = edges[e];
-      if (forwardScore.find(currHyp) == forwardScore.end()) {
-        forwardScore[currHyp] = forwardScore[edge.GetTailNode()] + edge.GetScore();
-        VERBOSE(3, "Fwd score["<<currHyp->GetId()<<"] = fwdScore["<<edge.GetTailNode()->GetId() << "] + edge Score: " << edge.GetScore() << endl)
-      } else {
-        forwardScore[currHyp] = log_sum(forwardScore[currHyp], forwardScore[edge.GetTailNode()] + edge.GetScore());
-        VERBOSE(3, "Fwd score["<<currHyp->GetId()<<"] += fwdScore["<<edge.GetTailNode()->GetId() << "] + edge Score: " << edge.GetScore() << endl)
-      }
+    for (size_t e = edgeBegin[i]; e < edgeBegin[i+1]; ++e) {
+      const float tailScore = forwardScore[edgeTails[e]] + edges[e]->GetScore();
+      forwardScore[i] = (e == edgeBegin[i]) ? tailScore : log_sum(forwardScore[i], tailScore);
     }
 
-    //Process ngrams now
-    for (size_t j =0 ; j < edges.size(); ++j) {
-      Edge& edge = edges[j];
-      const NgramHistory & incomingPhrases = edge.GetNgrams(incomingEdges);
-
-      //let's first score ngrams introduced by this edge
-      for (NgramHistory::const_iterator it = incomingPhrases.begin(); it != incomingPhrases.end(); ++it) {
-        const Phrase& ngram = it->first;
-        const PathCounts& pathCounts = it->second;
-        VERBOSE(4, "Calculating score for: " << it->first << endl)
-
-        for (PathCounts::const_iterator pathCountIt = pathCounts.begin(); pathCountIt != pathCounts.end(); ++pathCountIt) {
-          //Score of an n-gram is forward score of head node of leftmost edge + all edge scores
-          const Path&  path = pathCountIt->first;
-          //cerr << "path count for " << ngram << " is " << pathCountIt->second << endl;
-          float score = forwardScore[path[0]->GetTailNode()];
-          for (size_t i = 0; i < path.size(); ++i) {
-            score += path[i]->GetScore();
+    for (size_t e = edgeBegin[i]; e < edgeBegin[i+1]; ++e) {
+      const Edge& edge = *edges[e];
+      const Phrase& words = edge.GetWords();
+      const size_t tail = edgeTails[e];
+      vector<NgramOccurrence>& edgeNgrams = occurrences[e];
+      occurrenceIds.clear();
+
+      //Extract the n-grams local to this edge
+      const size_t edgePath = pathIndex.Extend(0, e, edge.GetScore(), forwardScore[tail]);
+      for (size_t start = 0; start < words.GetSize(); ++start) {
+        size_t ngram = 0;
+        for (size_t end = start; end < start + bleu_order && end < words.GetSize(); ++end) {
+          ngram = ngramIndex.Extend(ngram, words.GetWord(end));
+          NgramOccurrence occurrence = {ngram, edgePath, 1};
+          std::pair<boost::unordered_map<std::pair<size_t, size_t>, size_t>::iterator, bool> ret =
+            occurrenceIds.insert(make_pair(make_pair(ngram, edgePath), edgeNgrams.size()));
+          if (ret.second) {
+            edgeNgrams.push_back(occurrence);
+          } else {
+            ++edgeNgrams[ret.first->second].count;
           }
-          //if we're doing expectations, then the number of times the ngram
-          //appears on the path is relevant.
-          size_t count = posteriors ? 1 : pathCountIt->second;
-          for (size_t k = 0; k < count; ++k) {
-            ngramScores.addScore(currHyp,ngram,score);
+        }
+      }
+
+      //add the ngrams straddling prev and curr edge
+      for (size_t prev = edgeBegin[tail]; prev < edgeBegin[tail+1]; ++prev) {
+        const Phrase& prevWords = edges[prev]->GetWords();
+        const vector<NgramOccurrence>& prevNgrams = occurrences[prev];
+        for (size_t j = 0; j < prevNgrams.size(); ++j) {
+          const NgramOccurrence& prevNgram = prevNgrams[j];
+          const size_t prevSize = ngramIndex.GetSize(prevNgram.ngram);
+          //we need the suffix of previous edge
+          if (!ngramIndex.SuffixEquals(prevNgram.ngram, prevWords, min(prevSize, prevWords.GetSize()))) {
+            continue;
           }
+          size_t ngram = prevNgram.ngram;
+          size_t path = 0;
+          for (size_t k = 0; k < words.GetSize() && k + prevSize < bleu_order; ++k) {
+            ngram = ngramIndex.Extend(ngram, words.GetWord(k));
+            if (!path) {
+              path = pathIndex.Extend(prevNgram.path, e, edge.GetScore(), 0.0f);
+            }
+            NgramOccurrence occurrence = {ngram, path, prevNgram.count};
+            std::pair<boost::unordered_map<std::pair<size_t, size_t>, size_t>::iterator, bool> ret =
+              occurrenceIds.insert(make_pair(make_pair(ngram, path), edgeNgrams.size()));
+            if (ret.second) {
+              edgeNgrams.push_back(occurrence);
+            } else {
+              edgeNgrams[ret.first->second].count += prevNgram.count;
+            }
+          }
+        }
+      }
+
+      if (!posteriors) {
+        continue;
+      }
+
+      //let's first score ngrams introduced by this edge, once per path
+      for (size_t j = 0; j < edgeNgrams.size(); ++j) {
+        const size_t ngram = edgeNgrams[j].ngram;
+        nodeScores.Add(ngram, pathIndex.GetScore(edgeNgrams[j].path));
+        if (ngram >= introducedBy.size()) {
+          introducedBy.resize(ngram + 1, 0);
         }
+        introducedBy[ngram] = e + 1;
       }
 
       //Now score ngrams that are just being propagated from the history
-      for (NgramScores::NodeScoreIterator it = ngramScores.nodeBegin(edge.GetTailNode());
-           it != ngramScores.nodeEnd(edge.GetTailNode()); ++it) {
-        const Phrase & currNgram = *(it->first);
-        float currNgramScore = it->second;
-        VERBOSE(4, "Calculating score for: " << currNgram << endl)
-
-        // For posteriors, don't double count ngrams
-        if (!posteriors || incomingPhrases.find(currNgram) == incomingPhrases.end()) {
-          float score = edge.GetScore() + currNgramScore;
-          ngramScores.addScore(currHyp,currNgram,score);
+      const vector<std::pair<size_t, float> >& history = ngramScores[tail];
+      for (size_t j = 0; j < history.size(); ++j) {
+        const size_t ngram = history[j].first;
+        if (ngram >= introducedBy.size() || introducedBy[ngram] != e + 1) {
+          nodeScores.Add(ngram, edge.GetScore() + history[j].second);
         }
       }
+    }
 
+    if (posteriors) {
+      nodeScores.Flush(ngramScores[i]);
     }
   }
 
   float Z = 9999999; //the total score of the lattice
+  for (size_t i = 1; i < numNodes; ++i) {
+    if (isFinal[i]) {
+      Z = (Z == 9999999) ? forwardScore[i] : log_sum(Z, forwardScore[i]);
+    }
+  }
 
-  //Done - Print out ngram posteriors for final hyps
-  for (set< const Hypothesis *>::iterator finalHyp = finalHyps.begin(); finalHyp != finalHyps.end(); ++finalHyp) {
-    const Hypothesis* hyp = *finalHyp;
+  NgramAccumulator totals;
+  if (posteriors) {
+    //sum the ngram scores of the final hyps
+    for (size_t i = 1; i < numNodes; ++i) {
+      if (!isFinal[i]) {
+        continue;
+      }
+      const vector<std::pair<size_t, float> >& finalScores = ngramScores[i];
+      for (size_t j = 0; j < finalScores.size(); ++j) {
+        totals.Add(finalScores[j].first, finalScores[j].second);
+      }
+    }
+  } else {
+    //backward scores to the final hyps, undefined where no final hyp is reachable
+    vector<float> backwardScore(numNodes, 0.0f);
+    vector<bool> reachesFinal(isFinal);
+    for (size_t i = numNodes; i-- > 1; ) {
+      if (!reachesFinal[i]) {
+        continue;
+      }
+      for (size_t e = edgeBegin[i]; e < edgeBegin[i+1]; ++e) {
+        const size_t tail = edgeTails[e];
+        const float score = edges[e]->GetScore() + backwardScore[i];
+        backwardScore[tail] = reachesFinal[tail] ? log_sum(backwardScore[tail], score) : score;
+        reachesFinal[tail] = true;
+      }
+    }
 
-    for (NgramScores::NodeScoreIterator it = ngramScores.nodeBegin(hyp); it != ngramScores.nodeEnd(hyp); ++it) {
-      const Phrase& ngram = *(it->first);
-      if (finalNgramScores.find(ngram) == finalNgramScores.end()) {
-        finalNgramScores[ngram] = it->second;
-      } else {
-        finalNgramScores[ngram] = log_sum(it->second,  finalNgramScores[ngram]);
+    //every occurrence counts, weighted by the paths through it
+    for (size_t i = 1; i < numNodes; ++i) {
+      if (!reachesFinal[i]) {
+        continue;
+      }
+      for (size_t e = edgeBegin[i]; e < edgeBegin[i+1]; ++e) {
+        const vector<NgramOccurrence>& edgeNgrams = occurrences[e];
+        for (size_t j = 0; j < edgeNgrams.size(); ++j) {
+          const float score = pathIndex.GetScore(edgeNgrams[j].path) + backwardScore[i];
+          for (size_t k = 0; k < edgeNgrams[j].count; ++k) {
+            totals.Add(edgeNgrams[j].ngram, score);
+          }
+        }
       }
     }
+  }
 
-    if (Z == 9999999) {
-      Z = forwardScore[hyp];
-    } else {
-      Z = log_sum(Z, forwardScore[hyp]);
+  vector<std::pair<size_t, float> > finalScores;
+  totals.Flush(finalScores);
+  for (size_t j = 0; j < finalScores.size(); ++j) {
+    Phrase ngram(ngramIndex.GetSize(finalScores[j].first));
+    ngramIndex.GetPhrase(finalScores[j].first, ngram);
+    std::pair<map<Phrase, float>::iterator, bool> ret =
+      finalNgramScores.insert(make_pair(ngram, finalScores[j].second));
+    if (!ret.second) {
+      ret.first->second = log_sum(finalScores[j].second, ret.first->second);
     }
   }
 
@@ -395,86 +627,6 @@ void calcNgramExpectations(Lattice & connectedHyp, map<const Hypothesis*, vector
 
 }
 
-const NgramHistory& Edge::GetNgrams(map<const Hypothesis*, vector<Edge> > & incomingEdges)
-{
-
-  if (m_ngrams.size() > 0)
-    return m_ngrams;
-
-  const Phrase& currPhrase = GetWords();
-  //Extract the n-grams local to this edge
-  for (size_t start = 0; start < currPhrase.GetSize(); ++start) {
-    for (size_t end = start; end < start + bleu_order; ++end) {
-      if (end < currPhrase.GetSize()) {
-        Phrase edgeNgram(end-start+1);
-        for (size_t index = start; index <= end; ++index) {
-          edgeNgram.AddWord(currPhrase.GetWord(index));
-        }
-        //cout << "Inserting Phrase : " << edgeNgram << endl;
-        vector<const Edge*> edgeHistory;
-        edgeHistory.push_back(this);
-        storeNgramHistory(edgeNgram, edgeHistory);
-      } else {
-        break;
-      }
-    }
-  }
-
-  map<const Hypothesis*, vector<Edge> >::iterator it = incomingEdges.find(m_tailNode);
-  if (it != incomingEdges.end()) { //node has incoming edges
-    vector<Edge> & inEdges = it->second;
-
-    for (vector<Edge>::iterator edge = inEdges.begin(); edge != inEdges.end(); ++edge) {//add the ngrams straddling prev and curr edge
-      const NgramHistory & edgeIncomingNgrams = edge->GetNgrams(incomingEdges);
-      for (NgramHistory::const_iterator edgeInNgramHist = edgeIncomingNgrams.begin(); edgeInNgramHist != edgeIncomingNgrams.end(); ++edgeInNgramHist) {
-        const Phrase& edgeIncomingNgram = edgeInNgramHist->first;
-        const PathCounts &  edgeIncomingNgramPaths = edgeInNgramHist->second;
-        size_t back = min(edgeIncomingNgram.GetSize(), edge->GetWordsSize());
-        const Phrase&  edgeWords = edge->GetWords();
-        IFVERBOSE(3) {
-          cerr << "Edge: "<< *edge <<endl;
-          cerr << "edgeWords: " << edgeWords << endl;
-          cerr << "edgeInNgram: " << edgeIncomingNgram << endl;
-        }
-
-        Phrase edgeSuffix(ARRAY_SIZE_INCR);
-        Phrase ngramSuffix(ARRAY_SIZE_INCR);
-        GetPhraseSuffix(edgeWords,back,edgeSuffix);
-        GetPhraseSuffix(edgeIncomingNgram,back,ngramSuffix);
-
-        if (ngramSuffix == edgeSuffix) { //we've got the suffix of previous edge
-          size_t  edgeInNgramSize =  edgeIncomingNgram.GetSize();
-
-          for (size_t i = 0; i < GetWordsSize() && i + edgeInNgramSize < bleu_order ; ++i) {
-            Phrase newNgram(edgeIncomingNgram);
-            for (size_t j = 0; j <= i ; ++j) {
-              newNgram.AddWord(GetWords().GetWord(j));
-            }
-            VERBOSE(3, "Inserting New Phrase : " << newNgram << endl)
-
-            for (PathCounts::const_iterator pathIt = edgeIncomingNgramPaths.begin(); pathIt !=  edgeIncomingNgramPaths.end(); ++pathIt) {
-              Path newNgramPath = pathIt->first;
-              newNgramPath.push_back(this);
-              storeNgramHistory(newNgram, newNgramPath, pathIt->second);
-            }
-          }
-        }
-      }
-    }
-  }
-  return m_ngrams;
-}
-
-//Add the last lastN words of origPhrase to targetPhrase
-void Edge::GetPhraseSuffix(const Phrase&  origPhrase, size_t lastN, Phrase& targetPhrase) const
-{
-  size_t origSize = origPhrase.GetSize();
-  size_t startIndex = origSize - lastN;
-  for (size_t index = startIndex; index < origPhrase.GetSize(); ++index) {
-    targetPhrase.AddWord(origPhrase.GetWord(index));
-  }
-}
-
 bool Edge::operator< (const Edge& compare ) const
 {
   if (m_headNode->GetId() < compare.m_headNode->GetId())
@@ -497,6 +649,19 @@ ostream& operator<< (ostream& out, const Edge& edge)
   return out;
 }
 
+namespace
+{
+
+void ScoreSolutions(vector<LatticeMBRSolution>* solutions, size_t begin, size_t end,
+                    const NgramPosteriorTable* posteriors, const vector<float>* thetas, float mapWeight)
+{
+  for (size_t i = begin; i < end; ++i) {
+    (*solutions)[i].CalcScore(*posteriors, *thetas, mapWeight);
+  }
+}
+
+}
+
 bool ascendingCoverageCmp(const Hypothesis* a, const Hypothesis* b)
 {
   return (a->GetWordsBitmap().GetNumWordsCovered()
@@ -541,16 +706,34 @@ void getLatticeMBRNBest(const Manager& manager, const TrellisPathList& nBestList
     VERBOSE(2,endl);
   }
   TrellisPathList::const_iterator iter;
-  size_t ctr = 0;
-  LatticeMBRSolutionComparator comparator;
-  for (iter = nBestList.begin() ; iter != nBestList.end() ; ++iter, ++ctr) {
+  const size_t first = solutions.size();
+  for (iter = nBestList.begin() ; iter != nBestList.end() ; ++iter) {
     const TrellisPath &path = **iter;
     solutions.push_back(LatticeMBRSolution(path,iter==nBestList.begin()));
-    solutions.back().CalcScore(ngramPosteriors, mbrThetas, mapWeight);
-    sort(solutions.begin(), solutions.end(), comparator);
-    while (solutions.size() > n) {
-      solutions.pop_back();
+  }
+
+  //the candidates are scored independently, so split them between threads
+  const NgramPosteriorTable posteriorTable(ngramPosteriors.begin(), ngramPosteriors.end());
+  const size_t numCandidates = solutions.size() - first;
+  const size_t numThreads = max<size_t>(1, min(lmbr.threads, numCandidates));
+#ifdef WITH_THREADS
+  if (numThreads > 1) {
+    boost::thread_group threads;
+    for (size_t t = 0; t < numThreads; ++t) {
+      threads.create_thread(boost::bind(&ScoreSolutions, &solutions,
+                                        first + t * numCandidates / numThreads,
+                                        first + (t + 1) * numCandidates / numThreads,
+                                        &posteriorTable, &mbrThetas, mapWeight));
     }
+    threads.join_all();
+  } else
+#endif
+    ScoreSolutions(&solutions, first, solutions.size(), &posteriorTable, &mbrThetas, mapWeight);
+
+  //keep the n best, ties in n-best list order
+  stable_sort(solutions.begin(), solutions.end(), LatticeMBRSolutionComparator());
+  if (solutions.size() > n) {
+    solutions.erase(solutions.begin() + n, solutions.end());
   }
   VERBOSE(2,"LMBR Score: " << solutions[0].GetScore() << endl);
 }
@@ -597,6 +780,7 @@ const TrellisPath doConsensusDecoding(const Manager& manager, const TrellisPathL
   }
 
   VERBOSE(2,"REF Length: " << ref_length << endl);
+  const NgramPosteriorTable expectationTable(ngramExpectations.begin(), ngramExpectations.end());
 
   //use the ngram expectations to rescore the nbest list.
   TrellisPathList::const_iterator iter;
@@ -606,14 +790,14 @@ const TrellisPath doConsensusDecoding(const Manager& manager, const TrellisPathL
   for (iter = nBestList.begin() ; iter != nBestList.end() ; ++iter) {
     const TrellisPath &path = **iter;
     vector<Word> words;
-    map<Phrase,int> ngrams;
+    boost::unordered_map<Phrase,int> ngrams;
     GetOutputWords(path,words);
     /*for (size_t i = 0; i < words.size(); ++i) {
         cerr << words[i].GetFactor(0)->GetString() << " ";
     }
     cerr << endl;
     */
-    extract_ngrams(words,ngrams);
+    ExtractNgrams(words,ngrams);
 
     vector<float> comps(2*BLEU_ORDER+1);
     float logbleu = 0.0;
@@ -624,10 +808,10 @@ const TrellisPath doConsensusDecoding(const Manager& manager, const TrellisPathL
       comps[2*i+1] = max(hyp_length-i,0);
     }
 
-    for (map<Phrase,int>::const_iterator hyp_iter = ngrams.begin();
+    for (boost::unordered_map<Phrase,int>::const_iterator hyp_iter = ngrams.begin();
          hyp_iter != ngrams.end(); ++hyp_iter) {
-      map<Phrase,float>::const_iterator ref_iter = ngramExpectations.find(hyp_iter->first);
-      if (ref_iter != ngramExpectations.end()) {
+      NgramPosteriorTable::const_iterator ref_iter = expectationTable.find(hyp_iter->first);
+      if (ref_iter != expectationTable.end()) {
         comps[2*(hyp_iter->first.GetSize()-1)] += min(exp(ref_iter->second), (float)(hyp_iter->second));
       }
 
@@ -0,0 +1,186 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2010- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Bitmaps.h"
+#include "Hypothesis.h"
+#include "HypothesisPool.h"
+#include "LatticeMBR.h"
+#include "Manager.h"
+#include "Sentence.h"
+#include "StaticData.h"
+#include "TranslationOption.h"
+#include "TranslationTask.h"
+
+using namespace Moses;
+using namespace std;
+
+namespace
+{
+
+// A small lattice over the three word sentence "a b c":
+//
+//   0 -the-> 1 -cat-> 3 -sat on-> 4
+//   0 -the cat-> 2 -sat on the mat-> 4
+//   1 -cat cat sat-> 5
+//
+// Nodes 4 and 5 cover the whole sentence, so there are three paths.
+struct LatticeFixture {
+  boost::shared_ptr<Sentence> sentence;
+  ttasksptr ttask;
+  boost::shared_ptr<Manager> manager;
+  boost::shared_ptr<Bitmaps> bitmaps;
+  TranslationOption initialTransOpt;
+  vector<boost::shared_ptr<TranslationOption> > transOpts;
+  vector<const Hypothesis*> nodes;
+  map<const Hypothesis*, vector<Edge> > incomingEdges;
+  // the words of each path and its score
+  vector<pair<string, float> > paths;
+
+  LatticeFixture() {
+    AllOptions::ptr opts(new AllOptions(*StaticData::Instance().options()));
+    sentence.reset(new Sentence(opts, 0, "a b c"));
+    ttask = TranslationTask::create(sentence);
+    manager.reset(new Manager(ttask));
+    manager->ResetSentenceStats(*sentence);
+    bitmaps.reset(new Bitmaps(sentence->GetSize(), sentence->m_sourceCompleted));
+
+    HypothesisPool &pool = manager->GetHypothesisPool();
+    nodes.push_back(pool.Create(*manager, *sentence, initialTransOpt, bitmaps->GetInitialBitmap(), 0));
+    Extend(0, Range(0, 0));
+    Extend(0, Range(0, 1));
+    Extend(1, Range(1, 1));
+    Extend(2, Range(2, 2));
+    Extend(1, Range(1, 2));
+
+    AddEdge(0, 1, -0.5f, "the");
+    AddEdge(0, 2, -1.2f, "the cat");
+    AddEdge(1, 3, -0.4f, "cat");
+    AddEdge(3, 4, -0.7f, "sat on");
+    AddEdge(2, 4, -0.3f, "sat on the mat");
+    AddEdge(1, 5, -2.0f, "cat cat sat");
+
+    paths.push_back(make_pair("the cat sat on", -1.6f));
+    paths.push_back(make_pair("the cat sat on the mat", -1.5f));
+    paths.push_back(make_pair("the cat cat sat", -2.5f));
+  }
+
+  ~LatticeFixture() {
+    HypothesisPool &pool = manager->GetHypothesisPool();
+    for (size_t i = nodes.size(); i-- > 0; ) {
+      pool.Release(const_cast<Hypothesis*>(nodes[i]));
+    }
+  }
+
+  void Extend(size_t prev, const Range &range) {
+    const Hypothesis &prevHypo = *nodes[prev];
+    TargetPhrase targetPhrase(NULL);
+    targetPhrase.CreateFromString(Input, sentence->options()->output.factor_order, "x", NULL);
+    transOpts.push_back(boost::shared_ptr<TranslationOption>(new TranslationOption(range, targetPhrase)));
+    const Bitmap &bitmap = bitmaps->GetBitmap(prevHypo.GetWordsBitmap(), range);
+    nodes.push_back(manager->GetHypothesisPool().Create(prevHypo, *transOpts.back(), bitmap, nodes.size()));
+  }
+
+  void AddEdge(size_t from, size_t to, float score, const string &words) {
+    TargetPhrase targetPhrase(NULL);
+    targetPhrase.CreateFromString(Output, sentence->options()->output.factor_order, words, NULL);
+    incomingEdges[nodes[to]].push_back(Edge(nodes[from], nodes[to], score, targetPhrase));
+  }
+};
+
+// The expected count, or posterior, of each ngram up to length 4, summing
+// over the paths directly.
+map<string, float> Enumerate(const vector<pair<string, float> > &paths, bool posteriors)
+{
+  float Z = 0;
+  for (size_t p = 0; p < paths.size(); ++p) {
+    Z += exp(paths[p].second);
+  }
+  map<string, float> ret;
+  for (size_t p = 0; p < paths.size(); ++p) {
+    vector<string> words;
+    istringstream in(paths[p].first);
+    for (string word; in >> word; ) {
+      words.push_back(word);
+    }
+    map<string, size_t> counts;
+    for (size_t start = 0; start < words.size(); ++start) {
+      string ngram;
+      for (size_t end = start; end < start + 4 && end < words.size(); ++end) {
+        ngram += (end == start ? "" : " ") + words[end];
+        ++counts[ngram];
+      }
+    }
+    for (map<string, size_t>::const_iterator it = counts.begin(); it != counts.end(); ++it) {
+      ret[it->first] += exp(paths[p].second) / Z * (posteriors ? 1 : it->second);
+    }
+  }
+  return ret;
+}
+
+void CheckExpectations(LatticeFixture &lattice, bool posteriors)
+{
+  // in no particular order
+  Lattice connectedHyp;
+  const size_t order[] = {4, 0, 3, 5, 1, 2};
+  for (size_t i = 0; i < lattice.nodes.size(); ++i) {
+    connectedHyp.push_back(lattice.nodes[order[i]]);
+  }
+
+  map<Phrase, float> scores;
+  calcNgramExpectations(connectedHyp, lattice.incomingEdges, scores, posteriors);
+
+  const map<string, float> want = Enumerate(lattice.paths, posteriors);
+  const vector<FactorType> factors(1, 0);
+  map<string, float> got;
+  for (map<Phrase, float>::const_iterator it = scores.begin(); it != scores.end(); ++it) {
+    got[it->first.GetStringRep(factors)] = exp(it->second);
+  }
+
+  BOOST_CHECK_EQUAL(want.size(), got.size());
+  for (map<string, float>::const_iterator it = want.begin(); it != want.end(); ++it) {
+    BOOST_TEST_CHECKPOINT(it->first);
+    map<string, float>::const_iterator found = got.find(it->first);
+    BOOST_REQUIRE(found != got.end());
+    BOOST_CHECK_CLOSE(it->second, found->second, 1e-3);
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(lattice_mbr)
+
+BOOST_FIXTURE_TEST_CASE(ngram_posteriors, LatticeFixture)
+{
+  CheckExpectations(*this, true);
+}
+
+BOOST_FIXTURE_TEST_CASE(ngram_expected_counts, LatticeFixture)
+{
+  CheckExpectations(*this, false);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
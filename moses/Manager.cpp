@@ -39,6 +39,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "TranslationOptionCollection.h"
 #include "Timer.h"
 #include "moses/OutputCollector.h"
+#include "moses/BinaryNBest.h"
 #include "moses/FF/DistortionScoreProducer.h"
 #include "moses/LM/Base.h"
 #include "moses/TranslationModel/PhraseDictionary.h"
@@ -1610,6 +1611,11 @@ OutputNBest(std::ostream& out, Moses::TrellisPathList const& nBestList) const
   bool includeSegmentation  = nbo.include_segmentation;
   bool includeWordAlignment = nbo.include_alignment_info;
 
+  if (nbo.binary) {
+    OutputNBestBinary(out, nBestList);
+    return;
+  }
+
   TrellisPathList::const_iterator iter;
   for (iter = nBestList.begin() ; iter != nBestList.end() ; ++iter) {
     const TrellisPath &path = **iter;
@@ -1633,34 +1639,12 @@ OutputNBest(std::ostream& out, Moses::TrellisPathList const& nBestList) const
     //phrase-to-phrase segmentation
     if (includeSegmentation) {
       out << " |||";
-      for (int currEdge = (int)edges.size() - 2 ; currEdge >= 0 ; currEdge--) {
-        const Hypothesis &edge = *edges[currEdge];
-        const Range &sourceRange = edge.GetCurrSourceWordsRange();
-        Range targetRange = path.GetTargetWordsRange(edge);
-        out << " " << sourceRange.GetStartPos();
-        if (sourceRange.GetStartPos() < sourceRange.GetEndPos()) {
-          out << "-" << sourceRange.GetEndPos();
-        }
-        out<< "=" << targetRange.GetStartPos();
-        if (targetRange.GetStartPos() < targetRange.GetEndPos()) {
-          out<< "-" << targetRange.GetEndPos();
-        }
-      }
+      OutputNBestSegmentation(out, path);
     }
 
     if (includeWordAlignment) {
       out << " ||| ";
-      for (int currEdge = (int)edges.size() - 2 ; currEdge >= 0 ; currEdge--) {
-        const Hypothesis &edge = *edges[currEdge];
-        const Range &sourceRange = edge.GetCurrSourceWordsRange();
-        Range targetRange = path.GetTargetWordsRange(edge);
-        const int sourceOffset = sourceRange.GetStartPos();
-        const int targetOffset = targetRange.GetStartPos();
-        const AlignmentInfo &ai = edge.GetCurrTargetPhrase().GetAlignTerm();
-
-        OutputAlignment(out, ai, sourceOffset, targetOffset);
-
-      }
+      OutputNBestAlignment(out, path);
     }
 
     if (options()->output.RecoverPath) {
@@ -1674,6 +1658,81 @@ OutputNBest(std::ostream& out, Moses::TrellisPathList const& nBestList) const
   out << std::flush;
 }
 
+void
+Manager::
+OutputNBestBinary(std::ostream& out, Moses::TrellisPathList const& nBestList) const
+{
+  NBestOptions const& nbo = options()->nbest;
+
+  TrellisPathList::const_iterator iter;
+  for (iter = nBestList.begin() ; iter != nBestList.end() ; ++iter) {
+    const TrellisPath &path = **iter;
+    const std::vector<const Hypothesis *> &edges = path.GetEdges();
+
+    BinaryNBest::Write<uint32_t>(out, m_source.GetTranslationId());
+
+    ostringstream surface;
+    for (int currEdge = (int)edges.size() - 1 ; currEdge >= 0 ; currEdge--) {
+      OutputSurface(surface, *edges[currEdge]);
+    }
+    BinaryNBest::WriteString(out, surface.str());
+
+    path.GetScoreBreakdown()->OutputAllFeatureScoresBinary(out);
+    BinaryNBest::Write<float>(out, path.GetFutureScore());
+
+    ostringstream segmentation;
+    if (nbo.include_segmentation) {
+      OutputNBestSegmentation(segmentation, path);
+    }
+    BinaryNBest::WriteString(out, segmentation.str());
+
+    ostringstream alignment;
+    if (nbo.include_alignment_info) {
+      OutputNBestAlignment(alignment, path);
+    }
+    BinaryNBest::WriteString(out, alignment.str());
+  }
+
+  out << std::flush;
+}
+
+void
+Manager::
+OutputNBestSegmentation(std::ostream& out, const TrellisPath &path) const
+{
+  const std::vector<const Hypothesis *> &edges = path.GetEdges();
+  for (int currEdge = (int)edges.size() - 2 ; currEdge >= 0 ; currEdge--) {
+    const Hypothesis &edge = *edges[currEdge];
+    const Range &sourceRange = edge.GetCurrSourceWordsRange();
+    Range targetRange = path.GetTargetWordsRange(edge);
+    out << " " << sourceRange.GetStartPos();
+    if (sourceRange.GetStartPos() < sourceRange.GetEndPos()) {
+      out << "-" << sourceRange.GetEndPos();
+    }
+    out<< "=" << targetRange.GetStartPos();
+    if (targetRange.GetStartPos() < targetRange.GetEndPos()) {
+      out<< "-" << targetRange.GetEndPos();
+    }
+  }
+}
+
+void
+Manager::
+OutputNBestAlignment(std::ostream& out, const TrellisPath &path) const
+{
+  const std::vector<const Hypothesis *> &edges = path.GetEdges();
+  for (int currEdge = (int)edges.size() - 2 ; currEdge >= 0 ; currEdge--) {
+    const Hypothesis &edge = *edges[currEdge];
+    const Range &sourceRange = edge.GetCurrSourceWordsRange();
+    Range targetRange = path.GetTargetWordsRange(edge);
+    const int sourceOffset = sourceRange.GetStartPos();
+    const int targetOffset = targetRange.GetStartPos();
+    const AlignmentInfo &ai = edge.GetCurrTargetPhrase().GetAlignTerm();
+
+    OutputAlignment(out, ai, sourceOffset, targetOffset);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 /***
  * print surface factor only for the given phrase
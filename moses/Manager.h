@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <list>
 #include "InputType.h"
 #include "Hypothesis.h"
+#include "HypothesisPool.h"
 #include "StaticData.h"
 #include "TranslationOption.h"
 #include "TranslationOptionCollection.h"
@@ -114,6 +115,7 @@ protected:
   // data
   TranslationOptionCollection *m_transOptColl; /**< pre-computed list of translation options for the phrases in this sentence */
   Search *m_search;
+  HypothesisPool m_hypoPool; /**< storage for the hypotheses of this sentence, outlives m_search */
 
   HypothesisStack* actual_hypoStack; /**actual (full expanded) stack of hypotheses*/
   size_t interrupted_flag;
@@ -133,6 +135,9 @@ protected:
   mutable std::ostringstream m_alignmentOut;
 public:
   void OutputNBest(std::ostream& out, const Moses::TrellisPathList &nBestList) const;
+  void OutputNBestBinary(std::ostream& out, const Moses::TrellisPathList &nBestList) const;
+  void OutputNBestSegmentation(std::ostream& out, const TrellisPath &path) const;
+  void OutputNBestAlignment(std::ostream& out, const TrellisPath &path) const;
   void OutputSurface(std::ostream &out,
                      Hypothesis const& edge,
                      bool const recursive=false) const;
@@ -166,6 +171,9 @@ public:
   void GetOutputLanguageModelOrder( std::ostream &out, const Hypothesis *hypo ) const;
   void GetWordGraph(long translationId, std::ostream &outputWordGraphStream) const;
   int GetNextHypoId();
+  HypothesisPool &GetHypothesisPool() {
+    return m_hypoPool;
+  }
 
   void OutputLatticeMBRNBest(std::ostream& out, const std::vector<LatticeMBRSolution>& solutions,long translationId) const;
   void OutputBestHypo(const std::vector<Moses::Word>&  mbrBestHypo, std::ostream& out) const;
@@ -49,8 +49,8 @@ MockHypothesisGuard
   m_manager->ResetSentenceStats(*m_sentence);
 
   const Bitmap &initBitmap = bitmaps.GetInitialBitmap();
-  m_hypothesis = new Hypothesis(*m_manager, *m_sentence, m_initialTransOpt,
-                                initBitmap, m_manager->GetNextHypoId());
+  m_hypothesis = m_manager->GetHypothesisPool().Create(*m_manager, *m_sentence, m_initialTransOpt,
+                 initBitmap, m_manager->GetNextHypoId());
 
   //create the chain
   vector<Alignment>::const_iterator ai = alignments.begin();
@@ -64,8 +64,8 @@ MockHypothesisGuard
     m_targetPhrases.back().CreateFromString(Input, factors, *ti, NULL);
     m_toptions.push_back(new TranslationOption
                          (range,m_targetPhrases.back()));
-    m_hypothesis = new Hypothesis(*prevHypo, *m_toptions.back(), newBitmap,
-                                  m_manager->GetNextHypoId());
+    m_hypothesis = m_manager->GetHypothesisPool().Create(*prevHypo, *m_toptions.back(), newBitmap,
+                   m_manager->GetNextHypoId());
   }
 
 
@@ -76,7 +76,7 @@ MockHypothesisGuard::~MockHypothesisGuard()
   RemoveAllInColl(m_toptions);
   while (m_hypothesis) {
     Hypothesis* prevHypo = const_cast<Hypothesis*>(m_hypothesis->GetPrevHypo());
-    delete m_hypothesis;
+    m_manager->GetHypothesisPool().Release(m_hypothesis);
     m_hypothesis = prevHypo;
   }
 }
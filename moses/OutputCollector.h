@@ -102,6 +102,16 @@ public:
     return (m_outStream == &std::cout);
   }
 
+  /**
+    * Write a file header ahead of the output of all sentences.
+    **/
+  void WriteHeader(const std::string& header) {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
+    *m_outStream << header << std::flush;
+  }
+
   /**
     * Write or cache the output, as appropriate.
     **/
@@ -104,6 +104,7 @@ Parameter::Parameter()
   AddParam(search_opts,"max-trans-opt-per-coverage", "maximum number of translation options per input span (after applying mapping steps)");
   AddParam(search_opts,"max-phrase-length", "maximum phrase length (default 20)");
   AddParam(search_opts,"translation-option-threshold", "tot", "threshold for translation options relative to best for input phrase");
+  AddParam(search_opts,"lazy-translation-options", "look up input spans longer than one word, and create their translation options, only when search first uses them. Future costs of such spans are then composed from shorter spans (default false)");
 
   // miscellaneous search options
   AddParam(search_opts,"disable-discarding", "dd", "disable hypothesis discarding"); // ??? memory management? UG
@@ -139,6 +140,7 @@ Parameter::Parameter()
   AddParam(lmbr_opts,"lmbr-p", "unigram precision value for lattice mbr");
   AddParam(lmbr_opts,"lmbr-r", "ngram precision decay value for lattice mbr");
   AddParam(lmbr_opts,"lmbr-thetas", "theta(s) for lattice mbr calculation");
+  AddParam(lmbr_opts,"lmbr-threads", "number of threads scoring the candidates of one sentence for lattice mbr (default 1)");
   AddParam(mbr_opts,"lmbr-map-weight", "weight given to map solution when doing lattice MBR (default 0)");
   AddParam(mbr_opts,"lmbr-pruning-factor", "average number of nodes/word wanted in pruned lattice");
   AddParam(mbr_opts,"lattice-hypo-set", "to use lattice as hypo set during lattice MBR");
@@ -175,6 +177,8 @@ Parameter::Parameter()
   AddParam(output_opts,"output-factors", "list of factors in the output");
   AddParam(output_opts,"print-all-derivations", "to print all derivations in search graph");
   AddParam(output_opts,"translation-details", "T", "for each best hypothesis, report translation details to the given file");
+  AddParam(output_opts,"incremental-search-stats", "for the incremental search, write per-sentence counters and per-cell timings to the given file as JSON lines, followed by a line aggregated over all sentences");
+  AddParam(output_opts,"output-window", "with several threads, decode at most this many sentences ahead of the oldest unfinished one, which bounds the output held back to be written in order. Default is 0 (unlimited)");
 
   AddParam(output_opts,"output-hypo-score", "Output the hypo score to stdout with the output string. For search error analysis. Default is false");
   AddParam(output_opts,"output-word-graph", "owg", "Output stack info as word graph. Takes filename, 0=only hypos in stack, 1=stack + nbest hypos");
@@ -214,6 +218,7 @@ Parameter::Parameter()
   AddParam(nbest_opts,"include-segmentation-in-n-best", "include phrasal segmentation in the n-best list. default is false");
   AddParam(nbest_opts,"print-alignment-info-in-n-best",
            "Include word-to-word alignment in the n-best list. Word-to-word alignments are taken from the phrase table if any. Default is false");
+  AddParam(nbest_opts,"n-best-binary", "write n-best lists and lattice samples in a compact binary format that mert/extractor reads directly (phrase-based decoding only). Default is false");
 
   ///////////////////////////////////////////////////////////////////////////////////////
   // server options
@@ -258,6 +263,7 @@ Parameter::Parameter()
   AddParam(misc_opts,"no-cache", "Disable all phrase-table caching. Default = false (ie. enable caching)");
   AddParam(misc_opts,"default-non-term-for-empty-range-only", "Don't add [X] to all ranges, just ranges where there isn't a source non-term. Default = false (ie. add [X] everywhere)");
   AddParam(misc_opts,"s2t-parsing-algorithm", "Which S2T parsing algorithm to use. 0=recursive CYK+, 1=scope-3 (default = 0)");
+  AddParam(misc_opts,"s2t-span-threads", "Number of threads that parse and cube-prune the spans of one width in parallel within a sentence, for S2T decoding (default = 1, i.e. the sequential search)");
 
   //AddParam(o,"continue-partial-translation", "cpt", "start from nonempty hypothesis");
   AddParam(misc_opts,"decoding-graph-backoff", "dpb", "only use subsequent decoding paths for unknown spans of given length");
@@ -6,6 +6,7 @@
 #include "util/exception.hh"
 #include "util/string_stream.hh"
 #include "ScoreComponentCollection.h"
+#include "BinaryNBest.h"
 #include "StaticData.h"
 #include "moses/FF/StatelessFeatureFunction.h"
 #include "moses/FF/StatefulFeatureFunction.h"
@@ -346,6 +347,79 @@ OutputAllFeatureScores(std::ostream &out, bool with_labels) const
   }
 }
 
+namespace
+{
+// tuneable feature functions, in the order OutputAllFeatureScores() prints them
+std::vector<const FeatureFunction*> TuneableFeatureFunctions()
+{
+  std::vector<const FeatureFunction*> ret;
+  const vector<const StatefulFeatureFunction*>& sff
+  = StatefulFeatureFunction::GetStatefulFeatureFunctions();
+  for (size_t i = 0; i < sff.size(); ++i) {
+    if (sff[i]->IsTuneable()) ret.push_back(sff[i]);
+  }
+  const vector<const StatelessFeatureFunction*>& slf
+  = StatelessFeatureFunction::GetStatelessFeatureFunctions();
+  for (size_t i = 0; i < slf.size(); ++i) {
+    if (slf[i]->IsTuneable()) ret.push_back(slf[i]);
+  }
+  return ret;
+}
+}
+
+void
+ScoreComponentCollection::
+OutputBinaryFeatureHeader(std::ostream &out)
+{
+  std::vector<const FeatureFunction*> ffs = TuneableFeatureFunctions();
+  std::vector<std::pair<std::string, uint32_t> > dense;
+  for (size_t i = 0; i < ffs.size(); ++i) {
+    if (!ffs[i]->HasTuneableComponents()) continue;
+    uint32_t num = 0;
+    for (size_t j = 0; j < ffs[i]->GetNumScoreComponents(); ++j) {
+      num += ffs[i]->IsTuneableComponent(j);
+    }
+    dense.push_back(std::make_pair(ffs[i]->GetScoreProducerDescription(), num));
+  }
+
+  out.write(BinaryNBest::Magic, sizeof(BinaryNBest::Magic));
+  BinaryNBest::Write<uint32_t>(out, dense.size());
+  for (size_t i = 0; i < dense.size(); ++i) {
+    BinaryNBest::WriteString(out, dense[i].first);
+    BinaryNBest::Write<uint32_t>(out, dense[i].second);
+  }
+}
+
+void
+ScoreComponentCollection::
+OutputAllFeatureScoresBinary(std::ostream &out) const
+{
+  std::vector<const FeatureFunction*> ffs = TuneableFeatureFunctions();
+  std::vector<std::pair<std::string, float> > sparse;
+  for (size_t i = 0; i < ffs.size(); ++i) {
+    const FeatureFunction *ff = ffs[i];
+    if (ff->HasTuneableComponents()) {
+      vector<float> scores = GetScoresForProducer(ff);
+      for (size_t j = 0; j < scores.size(); ++j) {
+        if (ff->IsTuneableComponent(j)) {
+          BinaryNBest::Write<float>(out, scores[j]);
+        }
+      }
+    }
+
+    const FVector scores = GetVectorForProducer(ff);
+    for (FVector::FNVmap::const_iterator iter = scores.cbegin(); iter != scores.cend(); ++iter) {
+      sparse.push_back(std::make_pair(iter->first.name(), float(iter->second)));
+    }
+  }
+
+  BinaryNBest::Write<uint32_t>(out, sparse.size());
+  for (size_t i = 0; i < sparse.size(); ++i) {
+    BinaryNBest::WriteString(out, sparse[i].first);
+    BinaryNBest::Write<float>(out, sparse[i].second);
+  }
+}
+
 void
 ScoreComponentCollection::
 OutputFeatureScores(std::ostream& out, FeatureFunction const* ff,
@@ -445,6 +445,10 @@ public:
   void OutputFeatureScores(std::ostream& out, Moses::FeatureFunction const* ff,
                            std::string &lastName, bool with_labels) const;
 
+  // the same scores in the binary format of moses/BinaryNBest.h
+  static void OutputBinaryFeatureHeader(std::ostream &out);
+  void OutputAllFeatureScoresBinary(std::ostream &out) const;
+
 #ifdef MPI_ENABLE
 public:
   friend class boost::serialization::access;
@@ -50,7 +50,7 @@ public:
 };
 
 SearchCubePruning::
-SearchCubePruning(Manager& manager, TranslationOptionCollection const& transOptColl)
+SearchCubePruning(Manager& manager, TranslationOptionCollection& transOptColl)
   : Search(manager)
   , m_hypoStackColl(manager.GetSource().GetSize() + 1)
   , m_transOptColl(transOptColl)
@@ -78,7 +78,7 @@ void SearchCubePruning::Decode()
 {
   // initial seed hypothesis: nothing translated, no words produced
   const Bitmap &initBitmap = m_bitmaps.GetInitialBitmap();
-  Hypothesis *hypo = new Hypothesis(m_manager, m_source, m_initialTransOpt, initBitmap, m_manager.GetNextHypoId());
+  Hypothesis *hypo = m_manager.GetHypothesisPool().Create(m_manager, m_source, m_initialTransOpt, initBitmap, m_manager.GetNextHypoId());
 
   HypothesisStackCubePruning &firstStack
   = *static_cast<HypothesisStackCubePruning*>(m_hypoStackColl.front());
@@ -20,7 +20,7 @@ class SearchCubePruning: public Search
 protected:
   std::vector < HypothesisStack* > m_hypoStackColl; /**< stacks to store hypotheses (partial translations) */
   // no of elements = no of words in source + 1
-  const TranslationOptionCollection &m_transOptColl; /**< pre-computed list of translation options for the phrases in this sentence */
+  TranslationOptionCollection &m_transOptColl; /**< pre-computed list of translation options for the phrases in this sentence */
 
   //! go thru all bitmaps in 1 stack & create backpointers to bitmaps in the stack
   void CreateForwardTodos(HypothesisStackCubePruning &stack);
@@ -31,7 +31,7 @@ protected:
   void PrintBitmapContainerGraph();
 
 public:
-  SearchCubePruning(Manager& manager, const TranslationOptionCollection &transOptColl);
+  SearchCubePruning(Manager& manager, TranslationOptionCollection &transOptColl);
   ~SearchCubePruning();
 
   void Decode();
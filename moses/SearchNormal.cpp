@@ -16,7 +16,7 @@ namespace Moses
  * /param transOptColl collection of translation options to be used for this sentence
  */
 SearchNormal::
-SearchNormal(Manager& manager, const TranslationOptionCollection &transOptColl)
+SearchNormal(Manager& manager, TranslationOptionCollection &transOptColl)
   : Search(manager)
   , m_hypoStackColl(manager.GetSource().GetSize() + 1)
   , m_transOptColl(transOptColl)
@@ -74,7 +74,7 @@ void SearchNormal::Decode()
 {
   // initial seed hypothesis: nothing translated, no words produced
   const Bitmap &initBitmap = m_bitmaps.GetInitialBitmap();
-  Hypothesis *hypo = new Hypothesis(m_manager, m_source, m_initialTransOpt, initBitmap, m_manager.GetNextHypoId());
+  Hypothesis *hypo = m_manager.GetHypothesisPool().Create(m_manager, m_source, m_initialTransOpt, initBitmap, m_manager.GetNextHypoId());
 
   m_hypoStackColl[0]->AddPrune(hypo);
 
@@ -112,11 +112,10 @@ ProcessOneHypothesis(const Hypothesis &hypothesis)
     for (size_t startPos = hypoFirstGapPos ; startPos < sourceSize ; ++startPos) {
       TranslationOptionList const* tol;
       size_t endPos = startPos;
-      for (tol = m_transOptColl.GetTranslationOptionList(startPos, endPos);
+      for (tol = m_transOptColl.PeekTranslationOptionList(startPos, endPos);
            tol && endPos < sourceSize;
-           tol = m_transOptColl.GetTranslationOptionList(startPos, ++endPos)) {
-        if (tol->size() == 0
-            || hypoBitmap.Overlap(Range(startPos, endPos))
+           tol = m_transOptColl.PeekTranslationOptionList(startPos, ++endPos)) {
+        if (hypoBitmap.Overlap(Range(startPos, endPos))
             || !ReoConstraint.Check(hypoBitmap, startPos, endPos)) {
           continue;
         }
@@ -168,12 +167,12 @@ ProcessOneHypothesis(const Hypothesis &hypothesis)
 
     TranslationOptionList const* tol;
     size_t endPos = startPos;
-    for (tol = m_transOptColl.GetTranslationOptionList(startPos, endPos);
+    // in lazy mode, only spans that are expanded get their options created
+    for (tol = m_transOptColl.PeekTranslationOptionList(startPos, endPos);
          tol && endPos < sourceSize;
-         tol = m_transOptColl.GetTranslationOptionList(startPos, ++endPos)) {
+         tol = m_transOptColl.PeekTranslationOptionList(startPos, ++endPos)) {
       Range extRange(startPos, endPos);
-      if (tol->size() == 0
-          || hypoBitmap.Overlap(extRange)
+      if (hypoBitmap.Overlap(extRange)
           || !ReoConstraint.Check(hypoBitmap, startPos, endPos)
           || (isWordLattice && !m_source.IsCoveragePossible(extRange))) {
         continue;
@@ -233,6 +232,11 @@ void
 SearchNormal::
 ExpandAllHypotheses(const Hypothesis &hypothesis, size_t startPos, size_t endPos)
 {
+  // in lazy mode, this creates the options of a span the first time
+  const TranslationOptionList* tol
+  = m_transOptColl.GetTranslationOptionList(startPos, endPos);
+  if (!tol || tol->size() == 0) return;
+
   // early discarding: check if hypothesis is too bad to build
   // this idea is explained in (Moore&Quirk, MT Summit 2007)
   float expectedScore = 0.0f;
@@ -252,20 +256,43 @@ ExpandAllHypotheses(const Hypothesis &hypothesis, size_t startPos, size_t endPos
     expectedScore += estimatedScore;
   }
 
-  // loop through all translation options
-  const TranslationOptionList* tol
-  = m_transOptColl.GetTranslationOptionList(startPos, endPos);
-  if (!tol || tol->size() == 0) return;
-
   // Create new bitmap
   const TranslationOption &transOpt = **tol->begin();
   const Range &nextRange = transOpt.GetSourceWordsRange();
   const Bitmap &nextBitmap = m_bitmaps.GetBitmap(sourceCompleted, nextRange);
 
   TranslationOptionList::const_iterator iter;
+  if (m_options.search.UseEarlyDiscarding()) {
+    for (iter = tol->begin() ; iter != tol->end() ; ++iter) {
+      const TranslationOption &transOpt = **iter;
+      ExpandHypothesis(hypothesis, transOpt, expectedScore, estimatedScore, nextBitmap);
+    }
+    return;
+  }
+
+  // without early discarding every expansion is built, so stateful feature
+  // functions can score them as one batch
+  SentenceStats &stats = m_manager.GetSentenceStats();
+  std::vector<Hypothesis*> batch;
+  batch.reserve(tol->size());
+  IFVERBOSE(2) {
+    stats.StartTimeBuildHyp();
+  }
   for (iter = tol->begin() ; iter != tol->end() ; ++iter) {
     const TranslationOption &transOpt = **iter;
-    ExpandHypothesis(hypothesis, transOpt, expectedScore, estimatedScore, nextBitmap);
+    batch.push_back(m_manager.GetHypothesisPool().Create(hypothesis, transOpt, nextBitmap, m_manager.GetNextHypoId()));
+  }
+  IFVERBOSE(2) {
+    stats.StopTimeBuildHyp();
+    stats.StartTimeOtherScore();
+  }
+  Hypothesis::EvaluateWhenAppliedBatch(batch, std::vector<float>(batch.size(), estimatedScore));
+  IFVERBOSE(2) {
+    stats.StopTimeOtherScore();
+  }
+
+  for (size_t i = 0; i < batch.size(); ++i) {
+    AddHypothesisToStack(batch[i]);
   }
 }
 
@@ -292,7 +319,7 @@ void SearchNormal::ExpandHypothesis(const Hypothesis &hypothesis,
     IFVERBOSE(2) {
       stats.StartTimeBuildHyp();
     }
-    newHypo = new Hypothesis(hypothesis, transOpt, bitmap, m_manager.GetNextHypoId());
+    newHypo = m_manager.GetHypothesisPool().Create(hypothesis, transOpt, bitmap, m_manager.GetNextHypoId());
     IFVERBOSE(2) {
       stats.StopTimeBuildHyp();
     }
@@ -343,7 +370,7 @@ void SearchNormal::ExpandHypothesis(const Hypothesis &hypothesis,
     IFVERBOSE(2) {
       stats.StartTimeBuildHyp();
     }
-    newHypo = new Hypothesis(hypothesis, transOpt, bitmap, m_manager.GetNextHypoId());
+    newHypo = m_manager.GetHypothesisPool().Create(hypothesis, transOpt, bitmap, m_manager.GetNextHypoId());
     if (newHypo==NULL) return;
     IFVERBOSE(2) {
       stats.StopTimeBuildHyp();
@@ -354,12 +381,22 @@ void SearchNormal::ExpandHypothesis(const Hypothesis &hypothesis,
       IFVERBOSE(2) {
         stats.AddEarlyDiscarded();
       }
-      delete newHypo;
+      m_manager.GetHypothesisPool().Release(newHypo);
       return;
     }
 
   }
 
+  AddHypothesisToStack(newHypo);
+}
+
+/**
+ * Add a newly built and scored hypothesis to the stack for its coverage.
+ */
+void SearchNormal::AddHypothesisToStack(Hypothesis *newHypo)
+{
+  SentenceStats &stats = m_manager.GetSentenceStats();
+
   // logging for the curious
   IFVERBOSE(3) {
     newHypo->PrintHypothesis();
@@ -28,7 +28,7 @@ protected:
   HypothesisStackNormal* actual_hypoStack;
 
   /** pre-computed list of translation options for the phrases in this sentence */
-  const TranslationOptionCollection &m_transOptColl;
+  TranslationOptionCollection &m_transOptColl;
 
   // functions for creating hypotheses
 
@@ -48,8 +48,11 @@ protected:
                    float estimatedScore,
                    const Bitmap &bitmap);
 
+  void
+  AddHypothesisToStack(Hypothesis *newHypo);
+
 public:
-  SearchNormal(Manager& manager, const TranslationOptionCollection &transOptColl);
+  SearchNormal(Manager& manager, TranslationOptionCollection &transOptColl);
   ~SearchNormal();
 
   void Decode();
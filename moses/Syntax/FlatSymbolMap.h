@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include "moses/Factor.h"
+#include "moses/Word.h"
+
+namespace Moses
+{
+namespace Syntax
+{
+
+// Map from symbols to child values for the rule tries, stored as a flat
+// array instead of a node-based hash table.  Like SymbolHasher and
+// SymbolEqualityPred, only the first factor is relevant.
+//
+// Entries are appended in insertion order while a trie is being built (with
+// a hash index once a map grows beyond a few entries) and are sorted by
+// symbol when the map is frozen.  Lookups in a frozen map touch only the
+// contiguous array of keys: small maps are scanned without branches, which
+// the compiler turns into SIMD comparisons, and larger ones are
+// binary-searched.  Inserting into a frozen map is allowed but returns it to
+// the unsorted state.
+//
+// Values are relocated with swap, never copied, so T must provide a swap
+// member function and a cheap default constructor.  References to values are
+// invalidated by insertion and by Freeze.
+template<typename T>
+class FlatSymbolMap
+{
+public:
+  typedef std::pair<Word, T> value_type;
+  typedef typename std::vector<value_type>::iterator iterator;
+  typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+  FlatSymbolMap() : m_index(NULL), m_frozen(false) {}
+
+  FlatSymbolMap(const FlatSymbolMap &other)
+    : m_keys(other.m_keys)
+    , m_entries(other.m_entries)
+    , m_index(other.m_index ? new Index(*other.m_index) : NULL)
+    , m_frozen(other.m_frozen) {}
+
+  ~FlatSymbolMap() {
+    delete m_index;
+  }
+
+  FlatSymbolMap &operator=(const FlatSymbolMap &other) {
+    FlatSymbolMap tmp(other);
+    swap(tmp);
+    return *this;
+  }
+
+  void swap(FlatSymbolMap &other) {
+    m_keys.swap(other.m_keys);
+    m_entries.swap(other.m_entries);
+    std::swap(m_index, other.m_index);
+    std::swap(m_frozen, other.m_frozen);
+  }
+
+  iterator begin() {
+    return m_entries.begin();
+  }
+  const_iterator begin() const {
+    return m_entries.begin();
+  }
+  iterator end() {
+    return m_entries.end();
+  }
+  const_iterator end() const {
+    return m_entries.end();
+  }
+
+  std::size_t size() const {
+    return m_entries.size();
+  }
+
+  bool empty() const {
+    return m_entries.empty();
+  }
+
+  iterator find(const Word &symbol) {
+    return m_entries.begin() + Find(Key(symbol));
+  }
+
+  const_iterator find(const Word &symbol) const {
+    return m_entries.begin() + Find(Key(symbol));
+  }
+
+  // Return the value for symbol, inserting a default-constructed one if there
+  // isn't one already.
+  T &operator[](const Word &symbol) {
+    const std::size_t key = Key(symbol);
+    const std::size_t i = Find(key);
+    if (i != m_keys.size()) {
+      return m_entries[i].second;
+    }
+    Append(symbol, key);
+    return m_entries.back().second;
+  }
+
+  // Sort by symbol, drop the hash index and release spare capacity.
+  void Freeze();
+
+private:
+  typedef boost::unordered_map<std::size_t, std::size_t> Index;
+
+  // Maps up to this size are searched linearly.
+  static const std::size_t kLinearLimit = 16;
+
+  class KeyOrder
+  {
+  public:
+    KeyOrder(const std::vector<std::size_t> &keys) : m_keys(keys) {}
+    bool operator()(std::size_t a, std::size_t b) const {
+      return m_keys[a] < m_keys[b];
+    }
+  private:
+    const std::vector<std::size_t> &m_keys;
+  };
+
+  static std::size_t Key(const Word &symbol) {
+    return reinterpret_cast<std::size_t>(symbol[0]);
+  }
+
+  // Position of key, or size() if it is absent.
+  std::size_t Find(std::size_t key) const;
+
+  void Append(const Word &, std::size_t);
+
+  // Move the entries to storage with the given capacity and the given order.
+  void Relocate(std::size_t capacity, const std::vector<std::size_t> *order);
+
+  std::vector<std::size_t> m_keys;
+  std::vector<value_type> m_entries;
+  Index *m_index;
+  bool m_frozen;
+};
+
+template<typename T>
+std::size_t FlatSymbolMap<T>::Find(std::size_t key) const
+{
+  const std::size_t n = m_keys.size();
+  if (m_frozen) {
+    if (n <= kLinearLimit) {
+      // Count the smaller keys without branching.
+      std::size_t pos = 0;
+      for (std::size_t i = 0; i < n; ++i) {
+        pos += (m_keys[i] < key);
+      }
+      return (pos < n && m_keys[pos] == key) ? pos : n;
+    }
+    std::vector<std::size_t>::const_iterator p =
+      std::lower_bound(m_keys.begin(), m_keys.end(), key);
+    return (p != m_keys.end() && *p == key) ? p - m_keys.begin() : n;
+  }
+  if (m_index) {
+    Index::const_iterator p = m_index->find(key);
+    return (p == m_index->end()) ? n : p->second;
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    if (m_keys[i] == key) {
+      return i;
+    }
+  }
+  return n;
+}
+
+template<typename T>
+void FlatSymbolMap<T>::Append(const Word &symbol, std::size_t key)
+{
+  m_frozen = false;
+  if (m_entries.size() == m_entries.capacity()) {
+    Relocate(std::max<std::size_t>(2, 2 * m_entries.size()), NULL);
+  }
+  m_entries.push_back(value_type(symbol, T()));
+  m_keys.push_back(key);
+  if (m_index) {
+    m_index->insert(std::make_pair(key, m_keys.size()-1));
+  } else if (m_keys.size() > kLinearLimit) {
+    m_index = new Index();
+    for (std::size_t i = 0; i < m_keys.size(); ++i) {
+      m_index->insert(std::make_pair(m_keys[i], i));
+    }
+  }
+}
+
+template<typename T>
+void FlatSymbolMap<T>::Freeze()
+{
+  delete m_index;
+  m_index = NULL;
+  std::vector<std::size_t> order(m_keys.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), KeyOrder(m_keys));
+  Relocate(m_entries.size(), &order);
+  m_frozen = true;
+}
+
+template<typename T>
+void FlatSymbolMap<T>::Relocate(std::size_t capacity,
+                                const std::vector<std::size_t> *order)
+{
+  std::vector<std::size_t> keys;
+  std::vector<value_type> entries;
+  keys.reserve(capacity);
+  entries.reserve(capacity);
+  for (std::size_t i = 0; i < m_entries.size(); ++i) {
+    const std::size_t j = order ? (*order)[i] : i;
+    keys.push_back(m_keys[j]);
+    entries.push_back(value_type(m_entries[j].first, T()));
+    entries.back().second.swap(m_entries[j].second);
+  }
+  m_keys.swap(keys);
+  m_entries.swap(entries);
+}
+
+}  // namespace Syntax
+}  // namespace Moses
@@ -0,0 +1,140 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2015- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "moses/FactorCollection.h"
+#include "FlatSymbolMap.h"
+
+using namespace Moses;
+using namespace Moses::Syntax;
+using namespace std;
+
+namespace
+{
+
+struct Value {
+  Value() : v(-1) {}
+  void swap(Value &other) {
+    std::swap(v, other.v);
+  }
+  int v;
+};
+
+typedef FlatSymbolMap<Value> Map;
+
+Word MakeWord(size_t i)
+{
+  ostringstream s;
+  s << "flat_symbol_map_" << i;
+  Word ret;
+  ret[0] = FactorCollection::Instance().AddFactor(s.str());
+  return ret;
+}
+
+// Inserts words 0 .. size-1 in a scrambled order, with value i for word i.
+void Fill(Map &map, size_t size)
+{
+  for (size_t j = 0; j < size; ++j) {
+    size_t i = (j * 7) % size;
+    if (size % 7 == 0) i = j;
+    map[MakeWord(i)].v = i;
+  }
+}
+
+void CheckLookups(const Map &map, size_t size)
+{
+  BOOST_REQUIRE_EQUAL(size, map.size());
+  for (size_t i = 0; i < size; ++i) {
+    Map::const_iterator p = map.find(MakeWord(i));
+    BOOST_REQUIRE(p != map.end());
+    BOOST_CHECK_EQUAL(static_cast<int>(i), p->second.v);
+    BOOST_CHECK(p->first == MakeWord(i));
+  }
+  BOOST_CHECK(map.find(MakeWord(size)) == map.end());
+  BOOST_CHECK(map.find(MakeWord(size + 1000)) == map.end());
+}
+
+bool NotBefore(const Map::value_type &a, const Map::value_type &b)
+{
+  return !(a.first[0] < b.first[0]);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(flat_symbol_map)
+
+// Unfrozen maps are scanned up to 16 entries and hashed above that; frozen
+// ones are scanned up to 16 entries and binary-searched above that.
+BOOST_AUTO_TEST_CASE(lookup_across_threshold)
+{
+  const size_t sizes[] = {0, 1, 2, 15, 16, 17, 18, 40};
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    const size_t size = sizes[s];
+    BOOST_TEST_CHECKPOINT("size " << size);
+    Map map;
+    Fill(map, size);
+    CheckLookups(map, size);
+
+    map.Freeze();
+    CheckLookups(map, size);
+    BOOST_CHECK(std::adjacent_find(map.begin(), map.end(), NotBefore) == map.end());
+
+    // inserting unfreezes the map, and nothing goes missing
+    map[MakeWord(size)].v = size;
+    CheckLookups(map, size + 1);
+    map.Freeze();
+    CheckLookups(map, size + 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(existing_entries_are_not_duplicated)
+{
+  Map map;
+  Fill(map, 20);
+  map.Freeze();
+  map[MakeWord(3)].v = 100;
+  BOOST_CHECK_EQUAL(20U, map.size());
+  BOOST_CHECK_EQUAL(100, map.find(MakeWord(3))->second.v);
+}
+
+BOOST_AUTO_TEST_CASE(copy_and_swap)
+{
+  Map map;
+  Fill(map, 30);
+  Map copy(map);
+  CheckLookups(copy, 30);
+  copy[MakeWord(30)].v = 30;
+
+  Map other;
+  Fill(other, 3);
+  other.swap(copy);
+  CheckLookups(other, 31);
+  CheckLookups(copy, 3);
+  CheckLookups(map, 30);
+
+  map = other;
+  CheckLookups(map, 31);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
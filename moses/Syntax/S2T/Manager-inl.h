@@ -4,6 +4,11 @@
 #include <iostream>
 #include <sstream>
 
+#include <boost/bind.hpp>
+#ifdef WITH_THREADS
+#include <boost/thread.hpp>
+#endif
+
 #include "moses/DecodeGraph.h"
 #include "moses/StaticData.h"
 #include "moses/Syntax/BoundedPriorityContainer.h"
@@ -36,6 +41,7 @@ Manager<Parser>::Manager(ttasksptr const& ttask)
   : Syntax::Manager(ttask)
   , m_pchart(m_source.GetSize(), Parser::RequiresCompressedChart())
   , m_schart(m_source.GetSize())
+  , m_maxOovWidth(0)
 { }
 
 template<typename Parser>
@@ -63,6 +69,27 @@ void Manager<Parser>::InitializeCharts()
 template<typename Parser>
 void Manager<Parser>::InitializeParsers(PChart &pchart,
                                         std::size_t ruleLimit)
+{
+  // Check for OOVs and synthesize an additional rule trie if necessary.
+  m_oovs.clear();
+  std::size_t maxOovWidth = 0;
+  FindOovs(pchart, m_oovs, maxOovWidth);
+  if (!m_oovs.empty()) {
+    // FIXME Add a hidden RuleTableFF for unknown words(?)
+    const std::vector<RuleTableFF*> &ffs = RuleTableFF::Instances();
+    OovHandler<typename Parser::RuleTrie> oovHandler(*ffs[0]);
+    m_oovRuleTrie = oovHandler.SynthesizeRuleTrie(m_oovs.begin(), m_oovs.end());
+  }
+  m_maxOovWidth = maxOovWidth;
+
+  CreateParsers(pchart, m_parsers);
+}
+
+// Create one parser per rule table, plus one for the OOV rule trie if
+// InitializeParsers synthesized it.  Parsers hold per-span scratch space, so
+// each thread of the width-parallel search gets its own set.
+template<typename Parser>
+void Manager<Parser>::CreateParsers(PChart &pchart, ParserList &parsers)
 {
   const std::vector<RuleTableFF*> &ffs = RuleTableFF::Instances();
 
@@ -87,22 +114,14 @@ void Manager<Parser>::InitializeParsers(PChart &pchart,
       dynamic_cast<typename Parser::RuleTrie*>(nonConstTable);
     assert(trie);
     parser.reset(new Parser(pchart, *trie, maxChartSpan));
-    m_parsers.push_back(parser);
+    parsers.push_back(parser);
   }
 
-  // Check for OOVs and synthesize an additional rule trie + parser if
-  // necessary.
-  m_oovs.clear();
-  std::size_t maxOovWidth = 0;
-  FindOovs(pchart, m_oovs, maxOovWidth);
   if (!m_oovs.empty()) {
-    // FIXME Add a hidden RuleTableFF for unknown words(?)
-    OovHandler<typename Parser::RuleTrie> oovHandler(*ffs[0]);
-    m_oovRuleTrie = oovHandler.SynthesizeRuleTrie(m_oovs.begin(), m_oovs.end());
     // Create a parser for the OOV rule trie.
     boost::shared_ptr<Parser> parser(
-      new Parser(pchart, *m_oovRuleTrie, maxOovWidth));
-    m_parsers.push_back(parser);
+      new Parser(pchart, *m_oovRuleTrie, m_maxOovWidth));
+    parsers.push_back(parser);
   }
 }
 
@@ -163,7 +182,6 @@ void Manager<Parser>::Decode()
   // Get various pruning-related constants.
   const std::size_t popLimit = options()->cube.pop_limit;
   const std::size_t ruleLimit = options()->syntax.rule_limit;
-  const std::size_t stackLimit = options()->search.stack_size;
 
   // Initialise the PChart and SChart.
   InitializeCharts();
@@ -171,6 +189,14 @@ void Manager<Parser>::Decode()
   // Initialize the parsers.
   InitializeParsers(m_pchart, ruleLimit);
 
+#ifdef WITH_THREADS
+  const std::size_t spanThreads = options()->syntax.s2t_span_threads;
+  if (spanThreads > 1) {
+    DecodeByWidth(spanThreads);
+    return;
+  }
+#endif
+
   // Create a callback to process the PHyperedges produced by the parsers.
   typename Parser::CallbackType callback(m_schart, ruleLimit);
 
@@ -189,8 +215,8 @@ void Manager<Parser>::Decode()
       // each one to a SHyperedgeBundle (via the callback).  The callback
       // prunes the SHyperedgeBundles and keeps the best ones (up to ruleLimit).
       callback.InitForRange(range);
-      for (typename std::vector<boost::shared_ptr<Parser> >::iterator
-           p = m_parsers.begin(); p != m_parsers.end(); ++p) {
+      for (typename ParserList::iterator p = m_parsers.begin();
+           p != m_parsers.end(); ++p) {
         (*p)->EnumerateHyperedges(range, callback);
       }
 
@@ -202,8 +228,6 @@ void Manager<Parser>::Decode()
       // Collect the SHyperedges into buffers, one for each category.
       CubeQueue cubeQueue(bundles.Begin(), bundles.End());
       std::size_t count = 0;
-      typedef boost::unordered_map<Word, std::vector<SHyperedge*>,
-              SymbolHasher, SymbolEqualityPred > BufferMap;
       BufferMap buffers;
       while (count < popLimit && !cubeQueue.IsEmpty()) {
         SHyperedge *hyperedge = cubeQueue.Pop();
@@ -221,28 +245,7 @@ void Manager<Parser>::Decode()
         ++count;
       }
 
-      // Recombine SVertices and sort into stacks.
-      for (BufferMap::const_iterator p = buffers.begin(); p != buffers.end();
-           ++p) {
-        const Word &category = p->first;
-        const std::vector<SHyperedge*> &buffer = p->second;
-        std::pair<SChart::Cell::NMap::Iterator, bool> ret =
-          scell.nonTerminalStacks.Insert(category, SVertexStack());
-        assert(ret.second);
-        SVertexStack &stack = ret.first->second;
-        RecombineAndSort(buffer, stack);
-      }
-
-      // Prune stacks.
-      if (stackLimit > 0) {
-        for (SChart::Cell::NMap::Iterator p = scell.nonTerminalStacks.Begin();
-             p != scell.nonTerminalStacks.End(); ++p) {
-          SVertexStack &stack = p->second;
-          if (stack.size() > stackLimit) {
-            stack.resize(stackLimit);
-          }
-        }
-      }
+      FillStacks(buffers, scell);
 
       // Prune the PChart cell for this span by removing vertices for
       // categories that don't occur in the SChart.
@@ -252,6 +255,178 @@ void Manager<Parser>::Decode()
   }
 }
 
+#ifdef WITH_THREADS
+// Alternative to the search in Decode that visits the chart width by width.
+// All spans of one width depend only on narrower spans, so parsing and cube
+// pruning run concurrently across them, each worker thread using its own
+// parsers and callback and leaving both charts untouched.  The popped
+// SHyperedges are then merged into PChart and SChart on this thread, one span
+// at a time, so the charts see the same sequence of insertions for any
+// number of threads.
+//
+// The worker threads are started once per sentence.  This thread works on
+// the spans too, and meets the workers at a barrier before and after each
+// width.
+template<typename Parser>
+void Manager<Parser>::DecodeByWidth(std::size_t numThreads)
+{
+  const std::size_t ruleLimit = options()->syntax.rule_limit;
+  const std::size_t size = m_source.GetSize();
+  numThreads = std::min(numThreads, size);
+
+  std::vector<SpanWorker> workers(numThreads);
+  for (std::size_t i = 0; i < numThreads; ++i) {
+    CreateParsers(m_pchart, workers[i].parsers);
+    workers[i].callback.reset(
+      new typename Parser::CallbackType(m_schart, ruleLimit));
+  }
+
+  // popped[start] holds the SHyperedges popped for [start,start+width-1], in
+  // the order that cube pruning produced them.
+  std::vector<std::vector<SHyperedge*> > popped;
+  std::size_t width = 0;
+  std::size_t nextStart = 0;
+  boost::mutex mutex;
+  boost::barrier barrier(numThreads);
+
+  boost::thread_group threads;
+  for (std::size_t i = 1; i < numThreads; ++i) {
+    threads.create_thread(boost::bind(&Manager<Parser>::RunSpanWorker, this,
+                                      boost::ref(workers[i]),
+                                      boost::cref(width),
+                                      boost::ref(nextStart),
+                                      boost::ref(mutex), boost::ref(barrier),
+                                      boost::ref(popped)));
+  }
+
+  for (width = 1; width <= size; ++width) {
+    const std::size_t numSpans = size - width + 1;
+    popped.clear();
+    popped.resize(numSpans);
+    nextStart = 0;
+
+    barrier.wait();
+    SearchSpans(workers[0], width, nextStart, mutex, popped);
+    barrier.wait();
+
+    // Merge in the same right-to-left order as the sequential search.
+    for (int start = numSpans-1; start >= 0; --start) {
+      const std::size_t end = start + width - 1;
+      Range range(start, end);
+      BufferMap buffers;
+      const std::vector<SHyperedge*> &hyperedges = popped[start];
+      for (std::vector<SHyperedge*>::const_iterator p = hyperedges.begin();
+           p != hyperedges.end(); ++p) {
+        SHyperedge *hyperedge = *p;
+        // See the HACK in Decode.
+        const Word &lhs = hyperedge->label.translation->GetTargetLHS();
+        hyperedge->head->pvertex = &m_pchart.AddVertex(PVertex(range, lhs));
+        buffers[lhs].push_back(hyperedge);
+      }
+      FillStacks(buffers, m_schart.GetCell(start, end));
+    }
+  }
+
+  // A width of zero tells the workers to finish.
+  width = 0;
+  barrier.wait();
+  threads.join_all();
+}
+
+// Thread body for DecodeByWidth: search the spans of each width that
+// DecodeByWidth sets, until it sets a width of zero.
+template<typename Parser>
+void Manager<Parser>::RunSpanWorker(
+  SpanWorker &worker,
+  const std::size_t &width,
+  std::size_t &nextStart,
+  boost::mutex &mutex,
+  boost::barrier &barrier,
+  std::vector<std::vector<SHyperedge*> > &popped)
+{
+  while (true) {
+    barrier.wait();
+    if (width == 0) {
+      return;
+    }
+    SearchSpans(worker, width, nextStart, mutex, popped);
+    barrier.wait();
+  }
+}
+
+// Worker loop for DecodeByWidth: claim the next unprocessed span of the given
+// width, enumerate its PHyperedges and run cube pruning over them.
+template<typename Parser>
+void Manager<Parser>::SearchSpans(
+  SpanWorker &worker,
+  std::size_t width,
+  std::size_t &nextStart,
+  boost::mutex &mutex,
+  std::vector<std::vector<SHyperedge*> > &popped)
+{
+  const std::size_t popLimit = options()->cube.pop_limit;
+  typename Parser::CallbackType &callback = *worker.callback;
+
+  while (true) {
+    std::size_t start;
+    {
+      boost::mutex::scoped_lock lock(mutex);
+      if (nextStart == popped.size()) {
+        return;
+      }
+      start = nextStart++;
+    }
+    Range range(start, start+width-1);
+
+    callback.InitForRange(range);
+    for (typename ParserList::iterator p = worker.parsers.begin();
+         p != worker.parsers.end(); ++p) {
+      (*p)->EnumerateSpanHyperedges(range, callback);
+    }
+
+    const BoundedPriorityContainer<SHyperedgeBundle> &bundles =
+      callback.GetContainer();
+    CubeQueue cubeQueue(bundles.Begin(), bundles.End());
+    std::vector<SHyperedge*> &hyperedges = popped[start];
+    while (hyperedges.size() < popLimit && !cubeQueue.IsEmpty()) {
+      hyperedges.push_back(cubeQueue.Pop());
+    }
+  }
+}
+#endif
+
+// Recombine the buffered SHyperedges for a span into SVertex stacks, one per
+// category, and prune the stacks.
+template<typename Parser>
+void Manager<Parser>::FillStacks(const BufferMap &buffers,
+                                 SChart::Cell &scell)
+{
+  const std::size_t stackLimit = options()->search.stack_size;
+
+  // Recombine SVertices and sort into stacks.
+  for (typename BufferMap::const_iterator p = buffers.begin();
+       p != buffers.end(); ++p) {
+    const Word &category = p->first;
+    const std::vector<SHyperedge*> &buffer = p->second;
+    std::pair<SChart::Cell::NMap::Iterator, bool> ret =
+      scell.nonTerminalStacks.Insert(category, SVertexStack());
+    assert(ret.second);
+    SVertexStack &stack = ret.first->second;
+    RecombineAndSort(buffer, stack);
+  }
+
+  // Prune stacks.
+  if (stackLimit > 0) {
+    for (SChart::Cell::NMap::Iterator p = scell.nonTerminalStacks.Begin();
+         p != scell.nonTerminalStacks.End(); ++p) {
+      SVertexStack &stack = p->second;
+      if (stack.size() > stackLimit) {
+        stack.resize(stackLimit);
+      }
+    }
+  }
+}
+
 template<typename Parser>
 const SHyperedge *Manager<Parser>::GetBestSHyperedge() const
 {
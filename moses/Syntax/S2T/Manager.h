@@ -4,11 +4,18 @@
 #include <vector>
 
 #include <boost/shared_ptr.hpp>
+#ifdef WITH_THREADS
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/mutex.hpp>
+#endif
+#include <boost/unordered_map.hpp>
 
 #include "moses/InputType.h"
 #include "moses/Syntax/KBestExtractor.h"
 #include "moses/Syntax/Manager.h"
 #include "moses/Syntax/SVertexStack.h"
+#include "moses/Syntax/SymbolEqualityPred.h"
+#include "moses/Syntax/SymbolHasher.h"
 #include "moses/Word.h"
 
 #include "OovHandler.h"
@@ -45,12 +52,39 @@ public:
   void OutputDetailedTranslationReport(OutputCollector *collector) const;
 
 private:
+  typedef std::vector<boost::shared_ptr<Parser> > ParserList;
+
+  typedef boost::unordered_map<Word, std::vector<SHyperedge*>,
+          SymbolHasher, SymbolEqualityPred > BufferMap;
+
+  // Per-thread state for the width-parallel search: a private set of parsers
+  // and a callback, which both carry per-span scratch space.
+  struct SpanWorker {
+    ParserList parsers;
+    boost::shared_ptr<typename Parser::CallbackType> callback;
+  };
+
   void FindOovs(const PChart &, boost::unordered_set<Word> &, std::size_t);
 
   void InitializeCharts();
 
   void InitializeParsers(PChart &, std::size_t);
 
+  void CreateParsers(PChart &, ParserList &);
+
+#ifdef WITH_THREADS
+  void DecodeByWidth(std::size_t);
+
+  void RunSpanWorker(SpanWorker &, const std::size_t &, std::size_t &,
+                     boost::mutex &, boost::barrier &,
+                     std::vector<std::vector<SHyperedge*> > &);
+
+  void SearchSpans(SpanWorker &, std::size_t, std::size_t &, boost::mutex &,
+                   std::vector<std::vector<SHyperedge*> > &);
+#endif
+
+  void FillStacks(const BufferMap &, SChart::Cell &);
+
   void RecombineAndSort(const std::vector<SHyperedge*> &, SVertexStack &);
 
   void PrunePChart(const SChart::Cell &, PChart::Cell &);
@@ -58,7 +92,8 @@ private:
   PChart m_pchart;
   SChart m_schart;
   boost::shared_ptr<typename Parser::RuleTrie> m_oovRuleTrie;
-  std::vector<boost::shared_ptr<Parser> > m_parsers;
+  std::size_t m_maxOovWidth;
+  ParserList m_parsers;
 };
 
 }  // S2T
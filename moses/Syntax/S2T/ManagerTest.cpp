@@ -0,0 +1,156 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2015- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+// Loads its own moses.ini into StaticData, so it is a test module of its
+// own rather than part of moses_test.
+#define BOOST_TEST_MODULE S2TManager
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "moses/Parameter.h"
+#include "moses/Sentence.h"
+#include "moses/StaticData.h"
+#include "moses/TranslationTask.h"
+#include "moses/Syntax/KBestExtractor.h"
+#include "moses/Syntax/S2T/Manager.h"
+#include "moses/Syntax/S2T/Parsers/RecursiveCYKPlusParser/RecursiveCYKPlusParser.h"
+#include "util/exception.hh"
+
+using namespace Moses;
+using namespace Moses::Syntax;
+using namespace std;
+
+namespace
+{
+
+namespace fs = boost::filesystem;
+
+typedef S2T::RecursiveCYKPlusParser<S2T::EagerParserCallback> Parser;
+
+// A rule table, glue grammar and configuration in a directory that goes
+// away with it.  The pop limit is low enough for cube pruning to matter.
+struct LoadedModel {
+  fs::path dir;
+  Parameter param;
+
+  LoadedModel() : dir(fs::temp_directory_path() / fs::unique_path()) {
+    fs::create_directories(dir);
+    const string rules = (dir / "rule-table").string();
+    ofstream(rules.c_str())
+        << "a [X] ||| A [NP] ||| 0.5 ||| ||| \n"
+        << "b [X] ||| B [NP] ||| 0.5 ||| ||| \n"
+        << "b c [X] ||| C B [NP] ||| 0.7 ||| ||| \n"
+        << "c [X] ||| C [NP] ||| 0.5 ||| ||| \n"
+        << "d [X] ||| D [NP] ||| 0.6 ||| ||| \n"
+        << "d e [X] ||| E D [NP] ||| 0.4 ||| ||| \n"
+        << "e [X] ||| E [NP] ||| 0.5 ||| ||| \n"
+        << "[X][NP] [X][NP] [X] ||| [X][NP] [X][NP] [NP] ||| 0.3 ||| 0-0 1-1 ||| \n"
+        << "[X][NP] [X][NP] [X] ||| [X][NP] [X][NP] [S] ||| 0.2 ||| 0-1 1-0 ||| \n"
+        << "a [X][NP] [X] ||| [X][NP] A [S] ||| 0.4 ||| 1-0 ||| \n";
+
+    const string glue = (dir / "glue-grammar").string();
+    ofstream(glue.c_str())
+        << "<s> [X] ||| <s> [Q] ||| 1 ||| ||| \n"
+        << "[X][Q] [X][S] [X] ||| [X][Q] [X][S] [Q] ||| 1 ||| 0-0 1-1 ||| \n"
+        << "[X][Q] [X][NP] [X] ||| [X][Q] [X][NP] [Q] ||| 0.5 ||| 0-0 1-1 ||| \n"
+        << "[X][Q] [X][X] [X] ||| [X][Q] [X][X] [Q] ||| 0.5 ||| 0-0 1-1 ||| \n"
+        << "[X][Q] </s> [X] ||| [X][Q] </s> [Q] ||| 1 ||| 0-0 ||| \n";
+
+    const string ini = (dir / "moses.ini").string();
+    ofstream(ini.c_str())
+        << "[search-algorithm]\n6\n"
+        << "[input-factors]\n0\n"
+        << "[mapping]\n0 T 0\n1 T 1\n"
+        << "[cube-pruning-pop-limit]\n8\n"
+        << "[non-terminals]\nX\n"
+        << "[verbose]\n0\n"
+        << "[feature]\n"
+        << "UnknownWordPenalty\nWordPenalty\nPhrasePenalty\n"
+        << "RuleTable name=TM0 num-features=1 path=" << rules
+        << " input-factor=0 output-factor=0\n"
+        << "RuleTable name=Glue num-features=1 path=" << glue
+        << " input-factor=0 output-factor=0\n"
+        << "[weight]\n"
+        << "UnknownWordPenalty0= 1\nWordPenalty0= -0.5\nPhrasePenalty0= 0.2\n"
+        << "TM0= 0.5\nGlue= 1\n";
+
+    UTIL_THROW_IF2(!param.LoadParam(ini), "Cannot load " << ini);
+    UTIL_THROW_IF2(!StaticData::LoadDataStatic(&param, ini), "Cannot load static data from " << ini);
+  }
+
+  ~LoadedModel() {
+    fs::remove_all(dir);
+  }
+};
+
+BOOST_GLOBAL_FIXTURE(LoadedModel);
+
+// The k best derivations as "<yield> <score>".
+vector<string> Decode(const string &text, size_t spanThreads)
+{
+  AllOptions *opts = new AllOptions(*StaticData::Instance().options());
+  opts->syntax.s2t_span_threads = spanThreads;
+  boost::shared_ptr<Sentence> sentence(new Sentence(AllOptions::ptr(opts), 0, text));
+  ttasksptr ttask = TranslationTask::create(sentence);
+  S2T::Manager<Parser> manager(ttask);
+  manager.Decode();
+
+  vector<boost::shared_ptr<KBestExtractor::Derivation> > kBest;
+  manager.ExtractKBest(20, kBest);
+  const vector<FactorType> factors(1, 0);
+  vector<string> ret;
+  for (size_t i = 0; i < kBest.size(); ++i) {
+    ostringstream desc;
+    desc << KBestExtractor::GetOutputPhrase(*kBest[i]).GetStringRep(factors)
+         << " " << kBest[i]->score;
+    ret.push_back(desc.str());
+  }
+  return ret;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(span_threads_match_sequential)
+{
+  // "f" is unknown
+  const string text = "a b c d e f a d b";
+  const vector<string> want = Decode(text, 1);
+  BOOST_REQUIRE(want.size() > 1);
+
+  // including more threads than spans of the widest widths
+  const size_t threads[] = {2, 3, 16};
+  for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t) {
+    BOOST_TEST_CHECKPOINT(threads[t] << " threads");
+    const vector<string> got = Decode(text, threads[t]);
+    BOOST_CHECK_EQUAL_COLLECTIONS(want.begin(), want.end(), got.begin(), got.end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(single_word)
+{
+  const vector<string> want = Decode("a", 1);
+  BOOST_REQUIRE(!want.empty());
+  const vector<string> got = Decode("a", 4);
+  BOOST_CHECK_EQUAL_COLLECTIONS(want.begin(), want.end(), got.begin(), got.end());
+}
@@ -39,6 +39,8 @@ boost::shared_ptr<RuleTrie> OovHandler<RuleTrie>::SynthesizeRuleTrie(
     }
   }
 
+  Freeze(*trie);
+
   return trie;
 }
 
@@ -21,6 +21,11 @@ public:
   virtual ~Parser() {}
 
   virtual void EnumerateHyperedges(const Range &, Callback &) = 0;
+
+  // Enumerate only the PHyperedges whose head covers exactly the given span,
+  // reading nothing from the chart but cells for strictly smaller spans.
+  // This is what the width-parallel search in S2T::Manager requires.
+  virtual void EnumerateSpanHyperedges(const Range &, Callback &) = 0;
 protected:
   PChart &m_chart;
 };
@@ -17,6 +17,7 @@ RecursiveCYKPlusParser<Callback>::RecursiveCYKPlusParser(
   : Parser<Callback>(chart)
   , m_ruleTable(trie)
   , m_maxChartSpan(maxChartSpan)
+  , m_minEnd(0)
   , m_callback(NULL)
 {
   m_hyperedge.head = 0;
@@ -31,6 +32,7 @@ void RecursiveCYKPlusParser<Callback>::EnumerateHyperedges(
   const std::size_t end = range.GetEndPos();
   m_callback = &callback;
   const RuleTrie::Node &rootNode = m_ruleTable.GetRootNode();
+  m_minEnd = 0;
   m_maxEnd = std::min(Base::m_chart.GetWidth()-1, start+m_maxChartSpan-1);
   m_hyperedge.tail.clear();
 
@@ -45,6 +47,34 @@ void RecursiveCYKPlusParser<Callback>::EnumerateHyperedges(
   }
 }
 
+// Unlike EnumerateHyperedges, which finds every hyperedge whose first incoming
+// vertex begins the span (and so relies on all chart rows to the right being
+// complete), this finds exactly the hyperedges covering [start,end].  Every
+// first vertex is tried, but rules are only extended up to end and only
+// passed to the callback if they finish there.
+template<typename Callback>
+void RecursiveCYKPlusParser<Callback>::EnumerateSpanHyperedges(
+  const Range &range,
+  Callback &callback)
+{
+  const std::size_t start = range.GetStartPos();
+  const std::size_t end = range.GetEndPos();
+  m_callback = &callback;
+  const RuleTrie::Node &rootNode = m_ruleTable.GetRootNode();
+  m_minEnd = end;
+  m_maxEnd = std::min(end, std::min(Base::m_chart.GetWidth()-1,
+                                    start+m_maxChartSpan-1));
+  m_hyperedge.tail.clear();
+
+  for (std::size_t firstEnd = start; firstEnd <= end; ++firstEnd) {
+    GetTerminalExtension(rootNode, start, firstEnd);
+  }
+
+  if (end > start) {
+    GetNonTerminalExtensions(rootNode, start, start, end-1);
+  }
+}
+
 // Search for all extensions of a partial rule (pointed at by node) that begin
 // with a non-terminal over a span between [start,minEnd] and [start,maxEnd].
 template<typename Callback>
@@ -133,7 +163,8 @@ void RecursiveCYKPlusParser<Callback>::AddAndExtend(
 
   // Add target phrase collection (except if rule is empty or unary).
   TargetPhraseCollection::shared_ptr tpc = node.GetTargetPhraseCollection();
-  if (!tpc->IsEmpty() && !IsNonLexicalUnary(m_hyperedge)) {
+  if (end >= m_minEnd && !tpc->IsEmpty() &&
+      !IsNonLexicalUnary(m_hyperedge)) {
     m_hyperedge.label.translations = tpc;
     (*m_callback)(m_hyperedge, end);
   }
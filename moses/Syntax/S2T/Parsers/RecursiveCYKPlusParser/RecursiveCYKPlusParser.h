@@ -37,6 +37,8 @@ public:
 
   void EnumerateHyperedges(const Range &, Callback &);
 
+  void EnumerateSpanHyperedges(const Range &, Callback &);
+
 private:
 
   void GetTerminalExtension(const RuleTrie::Node &, std::size_t, std::size_t);
@@ -50,6 +52,7 @@ private:
 
   const RuleTrie &m_ruleTable;
   const std::size_t m_maxChartSpan;
+  std::size_t m_minEnd;
   std::size_t m_maxEnd;
   PHyperedge m_hyperedge;
   Callback *m_callback;
@@ -43,6 +43,11 @@ public:
 
   void EnumerateHyperedges(const Range &, Callback &);
 
+  // Scope-3 parsing is already span-local.
+  void EnumerateSpanHyperedges(const Range &range, Callback &callback) {
+    EnumerateHyperedges(range, callback);
+  }
+
 private:
   void Init();
   void InitRuleApplicationVector();
@@ -34,6 +34,10 @@ private:
                                     const Word *sourceLHS) = 0;
 
   virtual void SortAndPrune(std::size_t) = 0;
+
+  // Switch the trie to its compact, read-optimized layout once all rules have
+  // been added.  Further additions are possible but slower.
+  virtual void Freeze() = 0;
 };
 
 }  // namespace S2T
@@ -33,7 +33,9 @@ void RuleTrieCYKPlus::Node::Prune(std::size_t tableLimit)
   }
 
   // prune TargetPhraseCollection in this node
-  m_targetPhraseCollection->Prune(true, tableLimit);
+  if (m_targetPhraseCollection) {
+    m_targetPhraseCollection->Prune(true, tableLimit);
+  }
 }
 
 void RuleTrieCYKPlus::Node::Sort(std::size_t tableLimit)
@@ -49,7 +51,31 @@ void RuleTrieCYKPlus::Node::Sort(std::size_t tableLimit)
   }
 
   // prune TargetPhraseCollection in this node
-  m_targetPhraseCollection->Sort(true, tableLimit);
+  if (m_targetPhraseCollection) {
+    m_targetPhraseCollection->Sort(true, tableLimit);
+  }
+}
+
+void RuleTrieCYKPlus::Node::Freeze()
+{
+  m_sourceTermMap.Freeze();
+  m_nonTermMap.Freeze();
+  for (SymbolMap::iterator p = m_sourceTermMap.begin();
+       p != m_sourceTermMap.end(); ++p) {
+    p->second.Freeze();
+  }
+  for (SymbolMap::iterator p = m_nonTermMap.begin();
+       p != m_nonTermMap.end(); ++p) {
+    p->second.Freeze();
+  }
+}
+
+const TargetPhraseCollection::shared_ptr &
+RuleTrieCYKPlus::Node::EmptyTargetPhraseCollection()
+{
+  static const TargetPhraseCollection::shared_ptr empty(
+    new TargetPhraseCollection);
+  return empty;
 }
 
 RuleTrieCYKPlus::Node *RuleTrieCYKPlus::Node::GetOrCreateChild(
@@ -134,6 +160,11 @@ void RuleTrieCYKPlus::SortAndPrune(std::size_t tableLimit)
   }
 }
 
+void RuleTrieCYKPlus::Freeze()
+{
+  m_root.Freeze();
+}
+
 bool RuleTrieCYKPlus::HasPreterminalRule(const Word &w) const
 {
   const Node::SymbolMap &map = m_root.GetTerminalMap();
@@ -7,8 +7,7 @@
 #include <boost/unordered_map.hpp>
 #include <boost/version.hpp>
 
-#include "moses/Syntax/SymbolEqualityPred.h"
-#include "moses/Syntax/SymbolHasher.h"
+#include "moses/Syntax/FlatSymbolMap.h"
 #include "moses/TargetPhrase.h"
 #include "moses/TargetPhraseCollection.h"
 #include "moses/Terminal.h"
@@ -30,19 +29,25 @@ public:
   class Node
   {
   public:
-    typedef boost::unordered_map<Word, Node, SymbolHasher,
-            SymbolEqualityPred> SymbolMap;
+    typedef FlatSymbolMap<Node> SymbolMap;
 
     bool IsLeaf() const {
       return m_sourceTermMap.empty() && m_nonTermMap.empty();
     }
 
     bool HasRules() const {
-      return !m_targetPhraseCollection->IsEmpty();
+      return m_targetPhraseCollection && !m_targetPhraseCollection->IsEmpty();
     }
 
     void Prune(std::size_t tableLimit);
     void Sort(std::size_t tableLimit);
+    void Freeze();
+
+    void swap(Node &other) {
+      m_sourceTermMap.swap(other.m_sourceTermMap);
+      m_nonTermMap.swap(other.m_nonTermMap);
+      m_targetPhraseCollection.swap(other.m_targetPhraseCollection);
+    }
 
     Node *GetOrCreateChild(const Word &sourceTerm);
     Node *GetOrCreateNonTerminalChild(const Word &targetNonTerm);
@@ -50,13 +55,19 @@ public:
     const Node *GetChild(const Word &sourceTerm) const;
     const Node *GetNonTerminalChild(const Word &targetNonTerm) const;
 
+    // Most nodes are only prefixes of rules, so the collection is created on
+    // demand and nodes without one share an empty collection.
     TargetPhraseCollection::shared_ptr
     GetTargetPhraseCollection() const {
-      return m_targetPhraseCollection;
+      return m_targetPhraseCollection ? m_targetPhraseCollection
+                                      : EmptyTargetPhraseCollection();
     }
 
     TargetPhraseCollection::shared_ptr
     GetTargetPhraseCollection() {
+      if (!m_targetPhraseCollection) {
+        m_targetPhraseCollection.reset(new TargetPhraseCollection);
+      }
       return m_targetPhraseCollection;
     }
 
@@ -68,9 +79,10 @@ public:
       return m_nonTermMap;
     }
 
-    Node() : m_targetPhraseCollection(new TargetPhraseCollection) {}
-
   private:
+    static const TargetPhraseCollection::shared_ptr &
+    EmptyTargetPhraseCollection();
+
     SymbolMap m_sourceTermMap;
     SymbolMap m_nonTermMap;
     TargetPhraseCollection::shared_ptr m_targetPhraseCollection;
@@ -94,6 +106,8 @@ private:
 
   void SortAndPrune(std::size_t);
 
+  void Freeze();
+
   Node m_root;
 };
 
@@ -19,6 +19,11 @@ protected:
     trie.SortAndPrune(limit);
   }
 
+  // Provide access to RuleTrie's private Freeze function.
+  void Freeze(RuleTrie &trie) {
+    trie.Freeze();
+  }
+
   // Provide access to RuleTrie's private GetOrCreateTargetPhraseCollection
   // function.
   TargetPhraseCollection::shared_ptr
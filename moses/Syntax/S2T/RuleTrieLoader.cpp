@@ -144,6 +144,8 @@ bool RuleTrieLoader::Load(Moses::AllOptions const& opts,
     SortAndPrune(trie, ff.GetTableLimit());
   }
 
+  Freeze(trie);
+
   return true;
 }
 
@@ -54,15 +54,23 @@ void RuleTrieScope3::Node::Sort(std::size_t tableLimit)
   }
 }
 
+void RuleTrieScope3::Node::Freeze()
+{
+  m_terminalMap.Freeze();
+  for (TerminalMap::iterator p = m_terminalMap.begin();
+       p != m_terminalMap.end(); ++p) {
+    p->second.Freeze();
+  }
+  if (m_gapNode) {
+    m_gapNode->Freeze();
+  }
+}
+
 RuleTrieScope3::Node *RuleTrieScope3::Node::GetOrCreateTerminalChild(
   const Word &sourceTerm)
 {
   assert(!sourceTerm.IsNonTerminal());
-  std::pair<TerminalMap::iterator, bool> result;
-  result = m_terminalMap.insert(std::make_pair(sourceTerm, Node()));
-  const TerminalMap::iterator &iter = result.first;
-  Node &child = iter->second;
-  return &child;
+  return &m_terminalMap[sourceTerm];
 }
 
 RuleTrieScope3::Node *RuleTrieScope3::Node::GetOrCreateNonTerminalChild(
@@ -146,6 +154,11 @@ void RuleTrieScope3::SortAndPrune(std::size_t tableLimit)
   }
 }
 
+void RuleTrieScope3::Freeze()
+{
+  m_root.Freeze();
+}
+
 bool RuleTrieScope3::HasPreterminalRule(const Word &w) const
 {
   const Node::TerminalMap &map = m_root.GetTerminalMap();
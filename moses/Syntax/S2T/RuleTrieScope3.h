@@ -7,8 +7,7 @@
 #include <boost/unordered_map.hpp>
 #include <boost/version.hpp>
 
-#include "moses/Syntax/SymbolEqualityPred.h"
-#include "moses/Syntax/SymbolHasher.h"
+#include "moses/Syntax/FlatSymbolMap.h"
 #include "moses/TargetPhrase.h"
 #include "moses/TargetPhraseCollection.h"
 #include "moses/Util.h"
@@ -31,8 +30,7 @@ public:
   public:
     typedef std::vector<std::vector<Word> > LabelTable;
 
-    typedef boost::unordered_map<Word, Node, SymbolHasher,
-            SymbolEqualityPred> TerminalMap;
+    typedef FlatSymbolMap<Node> TerminalMap;
 
     typedef boost::unordered_map<std::vector<int>,
             TargetPhraseCollection::shared_ptr> LabelMap;
@@ -74,9 +72,18 @@ public:
 
     void Prune(std::size_t tableLimit);
     void Sort(std::size_t tableLimit);
+    void Freeze();
+
+    void swap(Node &other) {
+      m_labelTable.swap(other.m_labelTable);
+      m_labelMap.swap(other.m_labelMap);
+      m_terminalMap.swap(other.m_terminalMap);
+      std::swap(m_gapNode, other.m_gapNode);
+    }
 
   private:
     friend class RuleTrieScope3;
+    friend class FlatSymbolMap<Node>;
 
     Node() : m_gapNode(NULL) {}
 
@@ -116,6 +123,8 @@ private:
 
   void SortAndPrune(std::size_t);
 
+  void Freeze();
+
   Node m_root;
 };
 
@@ -58,6 +58,21 @@ void RuleTrie::Node::Sort(std::size_t tableLimit)
   }
 }
 
+void RuleTrie::Node::Freeze()
+{
+  m_sourceTermMap.Freeze();
+  m_nonTermMap.Freeze();
+  m_targetPhraseCollections.Freeze();
+  for (SymbolMap::iterator p = m_sourceTermMap.begin();
+       p != m_sourceTermMap.end(); ++p) {
+    p->second.Freeze();
+  }
+  for (SymbolMap::iterator p = m_nonTermMap.begin();
+       p != m_nonTermMap.end(); ++p) {
+    p->second.Freeze();
+  }
+}
+
 RuleTrie::Node*
 RuleTrie::Node::
 GetOrCreateChild(const Word &sourceTerm)
@@ -148,6 +163,11 @@ void RuleTrie::SortAndPrune(std::size_t tableLimit)
   }
 }
 
+void RuleTrie::Freeze()
+{
+  m_root.Freeze();
+}
+
 }  // namespace T2S
 }  // namespace Syntax
 }  // namespace Moses
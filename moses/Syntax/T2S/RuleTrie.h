@@ -7,9 +7,8 @@
 #include <boost/unordered_map.hpp>
 #include <boost/version.hpp>
 
+#include "moses/Syntax/FlatSymbolMap.h"
 #include "moses/Syntax/RuleTable.h"
-#include "moses/Syntax/SymbolEqualityPred.h"
-#include "moses/Syntax/SymbolHasher.h"
 #include "moses/TargetPhrase.h"
 #include "moses/TargetPhraseCollection.h"
 #include "moses/Terminal.h"
@@ -29,11 +28,9 @@ public:
   class Node
   {
   public:
-    typedef boost::unordered_map<Word, Node, SymbolHasher,
-            SymbolEqualityPred> SymbolMap;
+    typedef FlatSymbolMap<Node> SymbolMap;
 
-    typedef boost::unordered_map<Word, TargetPhraseCollection::shared_ptr,
-            SymbolHasher, SymbolEqualityPred> TPCMap;
+    typedef FlatSymbolMap<TargetPhraseCollection::shared_ptr> TPCMap;
 
     bool IsLeaf() const {
       return m_sourceTermMap.empty() && m_nonTermMap.empty();
@@ -45,6 +42,13 @@ public:
 
     void Prune(std::size_t tableLimit);
     void Sort(std::size_t tableLimit);
+    void Freeze();
+
+    void swap(Node &other) {
+      m_sourceTermMap.swap(other.m_sourceTermMap);
+      m_nonTermMap.swap(other.m_nonTermMap);
+      m_targetPhraseCollections.swap(other.m_targetPhraseCollections);
+    }
 
     Node *GetOrCreateChild(const Word &sourceTerm);
     Node *GetOrCreateNonTerminalChild(const Word &targetNonTerm);
@@ -94,6 +98,8 @@ private:
 
   void SortAndPrune(std::size_t);
 
+  void Freeze();
+
   Node m_root;
 };
 
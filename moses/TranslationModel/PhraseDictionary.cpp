@@ -29,6 +29,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "moses/InputPath.h"
 #include "util/exception.hh"
 
+#ifdef WITH_THREADS
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#endif
+
 using namespace std;
 
 namespace Moses
@@ -164,6 +169,57 @@ GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const
   }
 }
 
+namespace
+{
+void
+LookupComponentRange(ttasksptr const& ttask,
+                     std::vector<PhraseDictionary*> const& pds,
+                     std::vector<const Phrase*> const& phrases,
+                     size_t first, size_t step,
+                     std::vector<std::vector<TargetPhraseCollection::shared_ptr> > &colls)
+{
+  for (size_t i = first; i < pds.size(); i += step) {
+    for (size_t j = 0; j < phrases.size(); ++j) {
+      colls[i][j] = pds[i]->GetTargetPhraseCollectionLEGACY(ttask, *phrases[j]);
+    }
+  }
+}
+}
+
+void
+PhraseDictionary::
+LookupComponents(ttasksptr const& ttask,
+                 std::vector<PhraseDictionary*> const& pds,
+                 InputPathList const& inputPathQueue, size_t numThreads,
+                 std::vector<std::vector<TargetPhraseCollection::shared_ptr> > &colls)
+{
+  std::vector<const Phrase*> phrases;
+  InputPathList::const_iterator iter;
+  for (iter = inputPathQueue.begin(); iter != inputPathQueue.end(); ++iter) {
+    phrases.push_back(&(*iter)->GetPhrase());
+  }
+  colls.assign(pds.size(),
+               std::vector<TargetPhraseCollection::shared_ptr>(phrases.size()));
+
+  numThreads = std::min(numThreads, pds.size());
+#ifdef WITH_THREADS
+  if (numThreads > 1) {
+    // table t is looked up by thread t % numThreads, the decoding thread
+    // takes its share too
+    boost::thread_group threads;
+    for (size_t t = 1; t < numThreads; ++t) {
+      threads.create_thread(boost::bind(&LookupComponentRange, ttask,
+                                        boost::cref(pds), boost::cref(phrases),
+                                        t, numThreads, boost::ref(colls)));
+    }
+    LookupComponentRange(ttask, pds, phrases, 0, numThreads, colls);
+    threads.join_all();
+    return;
+  }
+#endif
+  LookupComponentRange(ttask, pds, phrases, 0, 1, colls);
+}
+
 // reduce presistent cache by half of maximum size
 void PhraseDictionary::ReduceCache() const
 {
@@ -168,6 +168,17 @@ protected:
 
   bool SatisfyBackoff(const InputPath &inputPath) const;
 
+  // Look up the phrase of every input path in each of the component tables,
+  // for tables that combine others.  colls[i][j] is the collection of table
+  // i for the j-th path.  With numThreads > 1 the tables are queried
+  // concurrently, which is only safe for tables that keep no per-thread
+  // sentence state.
+  static void
+  LookupComponents(ttasksptr const& ttask,
+                   std::vector<PhraseDictionary*> const& pds,
+                   InputPathList const& inputPathQueue, size_t numThreads,
+                   std::vector<std::vector<TargetPhraseCollection::shared_ptr> > &colls);
+
   // cache
   size_t m_maxCacheSize; // 0 = no caching
 
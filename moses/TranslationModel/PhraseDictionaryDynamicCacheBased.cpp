@@ -34,6 +34,7 @@ namespace Moses
 {
 std::map< const std::string, PhraseDictionaryDynamicCacheBased * > PhraseDictionaryDynamicCacheBased::s_instance_map;
 PhraseDictionaryDynamicCacheBased *PhraseDictionaryDynamicCacheBased::s_instance = NULL;
+const size_t PhraseDictionaryDynamicCacheBased::kCacheShards;
 
 //! contructor
 PhraseDictionaryDynamicCacheBased::PhraseDictionaryDynamicCacheBased(const std::string &line)
@@ -50,6 +51,11 @@ PhraseDictionaryDynamicCacheBased::PhraseDictionaryDynamicCacheBased(const std::
   m_name = "default";
   m_constant = false;
 
+  boost::shared_ptr<CacheVersion> empty(new CacheVersion);
+  empty->shards.resize(kCacheShards);
+  empty->epoch = 0;
+  m_cacheTM = empty;
+
   ReadParameters();
 
   UTIL_THROW_IF2(s_instance_map.find(m_name) != s_instance_map.end(), "Only 1 PhraseDictionaryDynamicCacheBased feature named " + m_name + " is allowed");
@@ -118,15 +124,22 @@ void PhraseDictionaryDynamicCacheBased::Load_Single_File(const std::string file)
   std::string line;
   std::vector<std::string> words;
 
-  while (getline(cacheFile, line)) {
-    std::vector<std::string> vecStr = TokenizeMultiCharSeparator( line , "||||" );
-    if (vecStr.size() >= 2) {
-      std::string ageString = vecStr[0];
-      vecStr.erase(vecStr.begin());
-      Update(vecStr,ageString);
-    } else {
-      UTIL_THROW_IF2(false, "The format of the loaded file is wrong: " << line);
+  {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_writeLock);
+#endif
+    CacheBatch batch = BeginBatch();
+    while (getline(cacheFile, line)) {
+      std::vector<std::string> vecStr = TokenizeMultiCharSeparator( line , "||||" );
+      if (vecStr.size() >= 2) {
+        std::string ageString = vecStr[0];
+        vecStr.erase(vecStr.begin());
+        Update(batch,vecStr,ageString);
+      } else {
+        UTIL_THROW_IF2(false, "The format of the loaded file is wrong: " << line);
+      }
     }
+    Publish(batch);
   }
   IFVERBOSE(2) Print();
 }
@@ -162,19 +175,28 @@ void PhraseDictionaryDynamicCacheBased::InitializeForInput(ttasksptr const& ttas
 
 TargetPhraseCollection::shared_ptr PhraseDictionaryDynamicCacheBased::GetTargetPhraseCollection(const Phrase &source) const
 {
-#ifdef WITH_THREADS
-  boost::shared_lock<boost::shared_mutex> read_lock(m_cacheLock);
-#endif
+  // takes no lock: the version stays valid while we hold it
+  CacheVersionPtr version = boost::atomic_load(&m_cacheTM);
   TargetPhraseCollection::shared_ptr tpc;
-  cacheMap::const_iterator it = m_cacheTM.find(source);
-  if(it != m_cacheTM.end()) {
-    tpc.reset(new TargetPhraseCollection(*(boost::get<0>(it->second))));
-
-    std::vector<const TargetPhrase*>::const_iterator it2 = tpc->begin();
-
-    while (it2 != tpc->end()) {
-      ((TargetPhrase*) *it2)->EvaluateInIsolation(source, GetFeaturesToApply());
-      it2++;
+  const boost::shared_ptr<cacheMap> &shard = version->shards[hash_value(source) % kCacheShards];
+  if (!shard) {
+    return tpc;
+  }
+  cacheMap::const_iterator it = shard->find(source);
+  if(it != shard->end()) {
+    const CacheItems &items = it->second;
+    for (size_t i = 0; i < items.size(); ++i) {
+      long age = version->epoch - items[i].birth;
+      if (age > (long) m_maxAge) {
+        continue;
+      }
+      if (!tpc) {
+        tpc.reset(new TargetPhraseCollection);
+      }
+      TargetPhrase *tp = new TargetPhrase(*items[i].targetPhrase);
+      tp->GetScoreBreakdown().Assign(this, 0, GetPreComputedScores(age)[0]);
+      tp->EvaluateInIsolation(source, GetFeaturesToApply());
+      tpc->Add(tp);
     }
   }
   if (tpc)  {
@@ -204,7 +226,7 @@ ChartRuleLookupManager* PhraseDictionaryDynamicCacheBased::CreateRuleLookupManag
 void PhraseDictionaryDynamicCacheBased::SetScoreType(size_t type)
 {
 #ifdef WITH_THREADS
-  boost::shared_lock<boost::shared_mutex> read_lock(m_cacheLock);
+  boost::mutex::scoped_lock lock(m_writeLock);
 #endif
 
   m_score_type = type;
@@ -226,7 +248,7 @@ void PhraseDictionaryDynamicCacheBased::SetScoreType(size_t type)
 void PhraseDictionaryDynamicCacheBased::SetMaxAge(unsigned int age)
 {
 #ifdef WITH_THREADS
-  boost::shared_lock<boost::shared_mutex> read_lock(m_cacheLock);
+  boost::mutex::scoped_lock lock(m_writeLock);
 #endif
   m_maxAge = age;
   VERBOSE(2, "PhraseDictionaryCache MaxAge:  " << m_maxAge << std::endl);
@@ -274,7 +296,7 @@ void PhraseDictionaryDynamicCacheBased::SetPreComputedScores(const unsigned int
 {
   VERBOSE(2, "PhraseDictionaryDynamicCacheBased SetPreComputedScores:  " << m_maxAge << std::endl);
 #ifdef WITH_THREADS
-  boost::shared_lock<boost::shared_mutex> lock(m_cacheLock);
+  boost::mutex::scoped_lock lock(m_writeLock);
 #endif
   float sc;
   for (size_t i=0; i<=m_maxAge; i++) {
@@ -300,7 +322,7 @@ void PhraseDictionaryDynamicCacheBased::SetPreComputedScores(const unsigned int
   VERBOSE(3, "SetPreComputedScores(const unsigned int): lower_age:|" << m_maxAge << "| lower_score:|" << m_lower_score << "|" << std::endl);
 }
 
-Scores PhraseDictionaryDynamicCacheBased::GetPreComputedScores(const unsigned int age)
+Scores PhraseDictionaryDynamicCacheBased::GetPreComputedScores(const unsigned int age) const
 {
   if (age < m_maxAge) {
     return precomputedScores.at(age);
@@ -324,6 +346,10 @@ void PhraseDictionaryDynamicCacheBased::ClearEntries(std::vector<std::string> en
   VERBOSE(3,"PhraseDictionaryDynamicCacheBased::ClearEntries(std::vector<std::string> entries)" << std::endl);
   std::vector<std::string> pp;
 
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_writeLock);
+#endif
+  CacheBatch batch = BeginBatch();
   std::vector<std::string>::iterator it;
   for(it = entries.begin(); it!=entries.end(); it++) {
     pp.clear();
@@ -331,14 +357,14 @@ void PhraseDictionaryDynamicCacheBased::ClearEntries(std::vector<std::string> en
     VERBOSE(3,"pp[0]:|" << pp[0] << "|" << std::endl);
     VERBOSE(3,"pp[1]:|" << pp[1] << "|" << std::endl);
 
-    ClearEntries(pp[0], pp[1]);
+    ClearEntries(batch, pp[0], pp[1]);
   }
+  Publish(batch);
 }
 
-void PhraseDictionaryDynamicCacheBased::ClearEntries(std::string sourcePhraseString, std::string targetPhraseString)
+void PhraseDictionaryDynamicCacheBased::ClearEntries(CacheBatch &batch, std::string sourcePhraseString, std::string targetPhraseString)
 {
   VERBOSE(3,"PhraseDictionaryDynamicCacheBased::ClearEntries(std::string sourcePhraseString, std::string targetPhraseString)" << std::endl);
-  const StaticData &staticData = StaticData::Instance();
   Phrase sourcePhrase(0);
   Phrase targetPhrase(0);
 
@@ -356,38 +382,27 @@ void PhraseDictionaryDynamicCacheBased::ClearEntries(std::string sourcePhraseStr
   sourcePhrase.CreateFromString(Input, m_inputFactorsVec,
                                 sourcePhraseString, /*factorDelimiter,*/ NULL);
   VERBOSE(3, "sourcePhrase:|" << sourcePhrase << "|" << std::endl);
-  ClearEntries(sourcePhrase, targetPhrase);
+  ClearEntries(batch, sourcePhrase, targetPhrase);
 
 }
 
-void PhraseDictionaryDynamicCacheBased::ClearEntries(Phrase sp, Phrase tp)
+void PhraseDictionaryDynamicCacheBased::ClearEntries(CacheBatch &batch, Phrase sp, Phrase tp)
 {
   VERBOSE(3,"PhraseDictionaryDynamicCacheBased::ClearEntries(Phrase sp, Phrase tp)" << std::endl);
-#ifdef WITH_THREADS
-  boost::shared_lock<boost::shared_mutex> lock(m_cacheLock);
-#endif
   VERBOSE(3, "PhraseDictionaryCache deleting sp:|" << sp << "| tp:|" << tp << "|" << std::endl);
 
-  cacheMap::const_iterator it = m_cacheTM.find(sp);
+  cacheMap &shard = WritableShard(batch, sp);
+  cacheMap::iterator it = shard.find(sp);
   VERBOSE(3,"sp:|" << sp << "|" << std::endl);
-  if(it!=m_cacheTM.end()) {
+  if(it!=shard.end()) {
     VERBOSE(3,"sp:|" << sp << "| FOUND" << std::endl);
     // sp is found
-    // here we have to remove the target phrase from targetphrasecollection and from the TargetAgeMap
-    // and then add new entry
-
-    TargetCollectionPair TgtCollPair = it->second;
-    TargetPhraseCollection::shared_ptr  tpc = boost::get<0>(TgtCollPair);
-    AgeCollection* ac = boost::get<1>(TgtCollPair);
-    Scores* sc = boost::get<2>(TgtCollPair);
-    const Phrase* p_ptr = NULL;
-    TargetPhrase* tp_ptr = NULL;
+    // here we have to remove the target phrase from the cache items
+    CacheItems &items = it->second;
     bool found = false;
     size_t tp_pos=0;
-    while (!found && tp_pos < tpc->GetSize()) {
-      tp_ptr = (TargetPhrase*) tpc->GetTargetPhrase(tp_pos);
-      p_ptr = (const Phrase*) tp_ptr;
-      if (tp == *p_ptr) {
+    while (!found && tp_pos < items.size()) {
+      if (tp == (const Phrase&) *items[tp_pos].targetPhrase) {
         found = true;
         continue;
       }
@@ -399,23 +414,14 @@ void PhraseDictionaryDynamicCacheBased::ClearEntries(Phrase sp, Phrase tp)
     } else {
       VERBOSE(3,"tp:|" << tp << "| FOUND" << std::endl);
 
-      tpc->Remove(tp_pos); //delete entry in the Target Phrase Collection
-      ac->erase(ac->begin() + tp_pos); //delete entry in the Age Collection
-      // no need to delete scores here
+      items.erase(items.begin() + tp_pos); //delete entry in the cache items
       m_entries--;
-      VERBOSE(3,"tpc size:|" << tpc->GetSize() << "|" << std::endl);
-      VERBOSE(3,"ac size:|" << ac->size() << "|" << std::endl);
-      VERBOSE(3,"sc size:|" << sc->size() << "|" << std::endl);
+      VERBOSE(3,"items size:|" << items.size() << "|" << std::endl);
       VERBOSE(3,"tp:|" << tp << "| DELETED" << std::endl);
     }
-    if (tpc->GetSize() == 0) {
-      // delete the entry from m_cacheTM in case it points to an empty TargetPhraseCollection and AgeCollection
-      ac->clear();
-      sc->clear();
-      tpc.reset();
-      delete ac;
-      delete sc;
-      m_cacheTM.erase(sp);
+    if (items.empty()) {
+      // delete the entry from the cache in case it has no target phrases left
+      shard.erase(it);
     }
 
   } else {
@@ -433,53 +439,48 @@ void PhraseDictionaryDynamicCacheBased::ClearSource(std::string &entries)
     VERBOSE(3,"entries:|" << entries << "|" << std::endl);
     std::vector<std::string> elements = TokenizeMultiCharSeparator(entries, "||||");
     VERBOSE(3,"elements.size() after:|" << elements.size() << "|" << std::endl);
-    ClearEntries(elements);
+    ClearSource(elements);
   }
 }
 
 void PhraseDictionaryDynamicCacheBased::ClearSource(std::vector<std::string> entries)
 {
   VERBOSE(3,"entries.size():|" << entries.size() << "|" << std::endl);
-  const StaticData &staticData = StaticData::Instance();
   Phrase sourcePhrase(0);
 
-  std::vector<std::string>::iterator it;
-  for(it = entries.begin(); it!=entries.end(); it++) {
+  {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_writeLock);
+#endif
+    CacheBatch batch = BeginBatch();
+    std::vector<std::string>::iterator it;
+    for(it = entries.begin(); it!=entries.end(); it++) {
 
-    sourcePhrase.Clear();
-    VERBOSE(3, "sourcePhraseString:|" << (*it) << "|" << std::endl);
-    sourcePhrase.CreateFromString(Input, m_inputFactorsVec,
-                                  *it, /*factorDelimiter,*/ NULL);
-    VERBOSE(3, "sourcePhrase:|" << sourcePhrase << "|" << std::endl);
+      sourcePhrase.Clear();
+      VERBOSE(3, "sourcePhraseString:|" << (*it) << "|" << std::endl);
+      sourcePhrase.CreateFromString(Input, m_inputFactorsVec,
+                                    *it, /*factorDelimiter,*/ NULL);
+      VERBOSE(3, "sourcePhrase:|" << sourcePhrase << "|" << std::endl);
 
-    ClearSource(sourcePhrase);
+      ClearSource(batch, sourcePhrase);
+    }
+    Publish(batch);
   }
 
   IFVERBOSE(2) Print();
 }
 
-void PhraseDictionaryDynamicCacheBased::ClearSource(Phrase sp)
+void PhraseDictionaryDynamicCacheBased::ClearSource(CacheBatch &batch, Phrase sp)
 {
   VERBOSE(3,"void PhraseDictionaryDynamicCacheBased::ClearSource(Phrase sp) sp:|" << sp << "|" << std::endl);
-  cacheMap::const_iterator it = m_cacheTM.find(sp);
-  if (it != m_cacheTM.end()) {
+  cacheMap &shard = WritableShard(batch, sp);
+  cacheMap::iterator it = shard.find(sp);
+  if (it != shard.end()) {
     VERBOSE(3,"found:|" << sp << "|" << std::endl);
     //sp is found
 
-    TargetCollectionPair TgtCollPair = it->second;
-    TargetPhraseCollection::shared_ptr  tpc = boost::get<0>(TgtCollPair);
-    AgeCollection* ac = boost::get<1>(TgtCollPair);
-    Scores* sc = boost::get<2>(TgtCollPair);
-
-    m_entries-=tpc->GetSize(); //reduce the total amount of entries of the cache
-
-    // delete the entry from m_cacheTM in case it points to an empty TargetPhraseCollection and AgeCollection
-    ac->clear();
-    sc->clear();
-    tpc.reset();
-    delete ac;
-    delete sc;
-    m_cacheTM.erase(sp);
+    m_entries-=it->second.size(); //reduce the total amount of entries of the cache
+    shard.erase(it);
   } else {
     //do nothing
   }
@@ -498,15 +499,23 @@ void PhraseDictionaryDynamicCacheBased::Insert(std::string &entries)
 void PhraseDictionaryDynamicCacheBased::Insert(std::vector<std::string> entries)
 {
   VERBOSE(3,"entries.size():|" << entries.size() << "|" << std::endl);
-  if (m_constant == false) {
-    Decay();
+  {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_writeLock);
+#endif
+    // the decay and the new entries become visible together
+    CacheBatch batch = BeginBatch();
+    if (m_constant == false) {
+      Decay(batch);
+    }
+    Update(batch, entries, "1");
+    Publish(batch);
   }
-  Update(entries, "1");
   IFVERBOSE(3) Print();
 }
 
 
-void PhraseDictionaryDynamicCacheBased::Update(std::vector<std::string> entries, std::string ageString)
+void PhraseDictionaryDynamicCacheBased::Update(CacheBatch &batch, std::vector<std::string> entries, std::string ageString)
 {
   VERBOSE(3,"PhraseDictionaryDynamicCacheBased::Update(std::vector<std::string> entries, std::string ageString)" << std::endl);
   std::vector<std::string> pp;
@@ -522,12 +531,12 @@ void PhraseDictionaryDynamicCacheBased::Update(std::vector<std::string> entries,
     if (pp.size() > 3) {
       VERBOSE(3,"pp[2]:|" << pp[2] << "|" << std::endl);
       VERBOSE(3,"pp[3]:|" << pp[3] << "|" << std::endl);
-      Update(pp[0], pp[1], ageString, pp[2], pp[3]);
+      Update(batch, pp[0], pp[1], ageString, pp[2], pp[3]);
     } else if (pp.size() > 2) {
       VERBOSE(3,"pp[2]:|" << pp[2] << "|" << std::endl);
-      Update(pp[0], pp[1], ageString, pp[2]);
+      Update(batch, pp[0], pp[1], ageString, pp[2]);
     } else {
-      Update(pp[0], pp[1], ageString);
+      Update(batch, pp[0], pp[1], ageString);
     }
   }
 }
@@ -544,10 +553,9 @@ Scores PhraseDictionaryDynamicCacheBased::Conv2VecFloats(std::string& s)
   return n;
 }
 
-void PhraseDictionaryDynamicCacheBased::Update(std::string sourcePhraseString, std::string targetPhraseString, std::string ageString, std::string scoreString, std::string waString)
+void PhraseDictionaryDynamicCacheBased::Update(CacheBatch &batch, std::string sourcePhraseString, std::string targetPhraseString, std::string ageString, std::string scoreString, std::string waString)
 {
   VERBOSE(3,"PhraseDictionaryDynamicCacheBased::Update(std::string sourcePhraseString, std::string targetPhraseString, std::string ageString, std::string waString)" << std::endl);
-  const StaticData &staticData = StaticData::Instance();
   Phrase sourcePhrase(0);
   TargetPhrase targetPhrase(0);
 
@@ -574,38 +582,43 @@ void PhraseDictionaryDynamicCacheBased::Update(std::string sourcePhraseString, s
 
   if (!waString.empty()) VERBOSE(3, "waString:|" << waString << "|" << std::endl);
 
-  Update(sourcePhrase, targetPhrase, age, scores, waString);
+  Update(batch, sourcePhrase, targetPhrase, age, scores, waString);
 }
 
-void PhraseDictionaryDynamicCacheBased::Update(Phrase sp, TargetPhrase tp, int age, Scores scores, std::string waString)
+void PhraseDictionaryDynamicCacheBased::Update(CacheBatch &batch, Phrase sp, TargetPhrase tp, int age, Scores scores, std::string waString)
 {
   VERBOSE(3,"PhraseDictionaryDynamicCacheBased::Update(Phrase sp, TargetPhrase tp, int age, std::string waString)" << std::endl);
-#ifdef WITH_THREADS
-  boost::shared_lock<boost::shared_mutex> lock(m_cacheLock);
-#endif
   VERBOSE(3, "PhraseDictionaryCache inserting sp:|" << sp << "| tp:|" << tp << "| age:|" << age << "| word-alignment |" << waString << "|" << std::endl);
 
-  cacheMap::const_iterator it = m_cacheTM.find(sp);
+  // scoreVec is a composition of decay_score and the feature scores.  The
+  // decay score is replaced on lookup according to the age at that time.
+  Scores scoreVec;
+  scoreVec.push_back(GetPreComputedScores(age)[0]);
+  for (unsigned int i=0; i<scores.size(); i++) {
+    scoreVec.push_back(scores[i]);
+  }
+  if(scoreVec.size() != m_numScoreComponents) {
+    VERBOSE(1, "Scores do not match number of score components for phrase : "<< sp <<" ||| " << tp <<endl);
+    VERBOSE(1, "Debugging: Press Enter to continue..." <<endl);
+    std::cin.ignore();
+  }
+
+  CacheItem item;
+  item.birth = batch.next->epoch - age;
+
+  cacheMap &shard = WritableShard(batch, sp);
+  cacheMap::iterator it = shard.find(sp);
   VERBOSE(3,"sp:|" << sp << "|" << std::endl);
-  if(it!=m_cacheTM.end()) {
+  if(it!=shard.end()) {
     VERBOSE(3,"sp:|" << sp << "| FOUND" << std::endl);
     // sp is found
-    // here we have to remove the target phrase from targetphrasecollection and from the TargetAgeMap
-    // and then add new entry
-
-    TargetCollectionPair TgtCollPair = it->second;
-    TargetPhraseCollection::shared_ptr  tpc = boost::get<0>(TgtCollPair);
-    AgeCollection* ac = boost::get<1>(TgtCollPair);
-    Scores* sc = boost::get<2>(TgtCollPair);
-//    const TargetPhrase* p_ptr = NULL;
-    const Phrase* p_ptr = NULL;
-    TargetPhrase* tp_ptr = NULL;
+    // here we have to replace the target phrase if it is there already,
+    // or add a new entry
+    CacheItems &items = it->second;
     bool found = false;
     size_t tp_pos=0;
-    while (!found && tp_pos < tpc->GetSize()) {
-      tp_ptr = (TargetPhrase*) tpc->GetTargetPhrase(tp_pos);
-      p_ptr = (const TargetPhrase*) tp_ptr;
-      if ((Phrase) tp == *p_ptr) {
+    while (!found && tp_pos < items.size()) {
+      if ((Phrase) tp == (const Phrase&) *items[tp_pos].targetPhrase) {
         found = true;
         continue;
       }
@@ -613,147 +626,104 @@ void PhraseDictionaryDynamicCacheBased::Update(Phrase sp, TargetPhrase tp, int a
     }
     if (!found) {
       VERBOSE(3,"tp:|" << tp << "| NOT FOUND" << std::endl);
-      std::auto_ptr<TargetPhrase> targetPhrase(new TargetPhrase(tp));
-      Scores scoreVec;
-      scoreVec.push_back(GetPreComputedScores(age)[0]);
-      for (unsigned int i=0; i<scores.size(); i++) {
-        scoreVec.push_back(scores[i]);
-      }
-      if(scoreVec.size() != m_numScoreComponents) {
-        VERBOSE(1, "Scores does not match number of score components for phrase : "<< sp.ToString() <<" ||| " << tp.ToString() <<endl);
-        VERBOSE(1, "Debugging: Press Enter to continue..." <<endl);
-        std::cin.ignore();
-      }
+      TargetPhrase *targetPhrase = new TargetPhrase(tp);
+      item.targetPhrase.reset(targetPhrase);
       targetPhrase->GetScoreBreakdown().Assign(this, scoreVec);
-//      targetPhrase->GetScoreBreakdown().Assign(this, GetPreComputedScores(age));
       if (!waString.empty()) targetPhrase->SetAlignmentInfo(waString);
 
-      tpc->Add(targetPhrase.release());
-
-      tp_pos = tpc->GetSize()-1;
-      ac->push_back(age);
-      sc = &scores;
+      items.push_back(item);
       m_entries++;
       VERBOSE(3,"sp:|" << sp << "tp:|" << tp << "| INSERTED" << std::endl);
     } else {
-      Scores scoreVec;
-      scoreVec.push_back(GetPreComputedScores(age)[0]);
-      for (unsigned int i=0; i<scores.size(); i++) {
-        scoreVec.push_back(scores[i]);
-      }
-      if(scoreVec.size() != m_numScoreComponents) {
-        VERBOSE(1, "Scores does not match number of score components for phrase : "<< sp.ToString() <<" ||| " << tp.ToString() <<endl);
-        VERBOSE(1, "Debugging: Press Enter to continue..." <<endl);
-        std::cin.ignore();
-      }
-      tp_ptr->GetScoreBreakdown().Assign(this, scoreVec);
-//      tp_ptr->GetScoreBreakdown().Assign(this, GetPreComputedScores(age));
-      if (!waString.empty()) tp_ptr->SetAlignmentInfo(waString);
-      ac->at(tp_pos) = age;
+      // the published phrase may be in use by readers, so replace it by a
+      // modified copy
+      TargetPhrase *targetPhrase = new TargetPhrase(*items[tp_pos].targetPhrase);
+      item.targetPhrase.reset(targetPhrase);
+      targetPhrase->GetScoreBreakdown().Assign(this, scoreVec);
+      if (!waString.empty()) targetPhrase->SetAlignmentInfo(waString);
+      items[tp_pos] = item;
       VERBOSE(3,"sp:|" << sp << "tp:|" << tp << "| UPDATED" << std::endl);
     }
   } else {
     VERBOSE(3,"sp:|" << sp << "| NOT FOUND" << std::endl);
     // p is not found
-    // create target collection
-    // we have to create new target collection age pair and add new entry to target collection age pair
-
-    TargetPhraseCollection::shared_ptr tpc(new TargetPhraseCollection);
-    AgeCollection* ac = new AgeCollection();
-    Scores* sc = new Scores();
-    m_cacheTM.insert(make_pair(sp,boost::make_tuple(tpc,ac,sc)));
-
-    //tp is not found
-    std::auto_ptr<TargetPhrase> targetPhrase(new TargetPhrase(tp));
-    // scoreVec is a composition of decay_score and the feature scores
-    Scores scoreVec;
-    scoreVec.push_back(GetPreComputedScores(age)[0]);
-    for (unsigned int i=0; i<scores.size(); i++) {
-      scoreVec.push_back(scores[i]);
-    }
-    if(scoreVec.size() != m_numScoreComponents) {
-      VERBOSE(1, "Scores do not match number of score components for phrase : "<< sp <<" ||| " << tp <<endl);
-      VERBOSE(1, "Debugging: Press Enter to continue..." <<endl);
-      std::cin.ignore();
-    }
+    // create a new entry with the target phrase
+    TargetPhrase *targetPhrase = new TargetPhrase(tp);
+    item.targetPhrase.reset(targetPhrase);
     targetPhrase->GetScoreBreakdown().Assign(this, scoreVec);
     if (!waString.empty()) targetPhrase->SetAlignmentInfo(waString);
 
-    tpc->Add(targetPhrase.release());
-    ac->push_back(age);
-    sc = &scores;
+    shard[sp].push_back(item);
     m_entries++;
     VERBOSE(3,"sp:|" << sp << "| tp:|" << tp << "| INSERTED" << std::endl);
   }
 }
 
-void PhraseDictionaryDynamicCacheBased::Decay()
+void PhraseDictionaryDynamicCacheBased::Decay(CacheBatch &batch)
 {
-#ifdef WITH_THREADS
-  boost::shared_lock<boost::shared_mutex> lock(m_cacheLock);
-#endif
-  cacheMap::iterator it;
-  for(it = m_cacheTM.begin(); it!=m_cacheTM.end(); it++) {
-    Decay((*it).first);
-  }
+  // Ages are relative to the epoch, so this does not touch the entries.  The
+  // expired ones are removed one shard per call, so each is dropped at most
+  // kCacheShards decays after it expired.
+  ++batch.next->epoch;
+  Sweep(batch, batch.next->epoch % kCacheShards);
 }
 
-void PhraseDictionaryDynamicCacheBased::Decay(Phrase sp)
+void PhraseDictionaryDynamicCacheBased::Sweep(CacheBatch &batch, size_t shardInd)
 {
-  VERBOSE(3,"void PhraseDictionaryDynamicCacheBased::Decay(Phrase sp) sp:|" << sp << "|" << std::endl);
-  cacheMap::iterator it = m_cacheTM.find(sp);
-  if (it != m_cacheTM.end()) {
-    VERBOSE(3,"found:|" << sp << "|" << std::endl);
-    //sp is found
-
-    TargetCollectionPair TgtCollPair = it->second;
-    TargetPhraseCollection::shared_ptr  tpc = boost::get<0>(TgtCollPair);
-    AgeCollection* ac = boost::get<1>(TgtCollPair);
-    Scores* sc = boost::get<2>(TgtCollPair);
-
-    //loop in inverted order to allow a correct deletion of std::vectors tpc and ac
-    for (int tp_pos = tpc->GetSize() - 1 ; tp_pos >= 0; tp_pos--) {
-      unsigned int tp_age = ac->at(tp_pos); //increase the age by 1
-      tp_age++; //increase the age by 1
-      VERBOSE(3,"sp:|" << sp << "| " << " new tp_age:|" << tp_age << "|" << std::endl);
-
-      TargetPhrase* tp_ptr = (TargetPhrase*) tpc->GetTargetPhrase(tp_pos);
-
-      if (tp_age > m_maxAge) {
-        VERBOSE(3,"tp_age:|" << tp_age << "| TOO BIG" << std::endl);
-        tpc->Remove(tp_pos); //delete entry in the Target Phrase Collection
-        ac->erase(ac->begin() + tp_pos); //delete entry in the Age Collection
-        // no need to change scores here
+  if (!batch.next->shards[shardInd]) {
+    return;
+  }
+  if (!batch.copied[shardInd]) {
+    batch.next->shards[shardInd].reset(new cacheMap(*batch.next->shards[shardInd]));
+    batch.copied[shardInd] = true;
+  }
+  cacheMap &shard = *batch.next->shards[shardInd];
+  const long oldest = batch.next->epoch - m_maxAge;
+
+  cacheMap::iterator it = shard.begin();
+  while (it != shard.end()) {
+    CacheItems &items = it->second;
+    //loop in inverted order to allow a correct deletion
+    for (int tp_pos = items.size() - 1 ; tp_pos >= 0; tp_pos--) {
+      if (items[tp_pos].birth < oldest) {
+        VERBOSE(3,"sp:|" << it->first << "| tp_age:|" << batch.next->epoch - items[tp_pos].birth << "| TOO BIG" << std::endl);
+        items.erase(items.begin() + tp_pos);
         m_entries--;
-      } else {
-        VERBOSE(3,"tp_age:|" << tp_age << "| STILL GOOD" << std::endl);
-        // scoreVec is a composition of decay_score and the feature scores
-        size_t idx=0;
-        tp_ptr->GetScoreBreakdown().Assign(this, idx, GetPreComputedScores(tp_age)[0]);
-//        tp_ptr->GetScoreBreakdown().Assign(this, GetPreComputedScores(tp_age));
-        ac->at(tp_pos) = tp_age;
       }
     }
-    if (tpc->GetSize() == 0) {
-      // delete the entry from m_cacheTM in case it points to an empty TargetPhraseCollection and AgeCollection
-      // clear age collection
-      ac->clear();
-      // clear score collection
-      sc->clear();
-      // delete age collection
-      delete ac;
-      // delete score collection
-      delete sc;
-      // reset the target phrase collectio
-      tpc.reset();
-      m_cacheTM.erase(sp);
+    if (items.empty()) {
+      // delete the entry from the cache in case it has no target phrases left
+      shard.erase(it++);
+    } else {
+      ++it;
     }
-  } else {
-    //do nothing
-    VERBOSE(3,"sp:|" << sp << "| NOT FOUND" << std::endl);
   }
+}
+
+PhraseDictionaryDynamicCacheBased::CacheBatch PhraseDictionaryDynamicCacheBased::BeginBatch() const
+{
+  CacheBatch batch;
+  batch.next.reset(new CacheVersion(*boost::atomic_load(&m_cacheTM)));
+  batch.copied.resize(kCacheShards, false);
+  return batch;
+}
+
+void PhraseDictionaryDynamicCacheBased::Publish(const CacheBatch &batch)
+{
+  CacheVersionPtr next = batch.next;
+  boost::atomic_store(&m_cacheTM, next);
+}
 
-  //put here the removal of entries with age greater than m_maxAge
+PhraseDictionaryDynamicCacheBased::cacheMap &PhraseDictionaryDynamicCacheBased::WritableShard(CacheBatch &batch, const Phrase &sp) const
+{
+  size_t shardInd = hash_value(sp) % kCacheShards;
+  boost::shared_ptr<cacheMap> &shard = batch.next->shards[shardInd];
+  if (!batch.copied[shardInd]) {
+    // copy on first write, the published shard may be read concurrently
+    shard.reset(shard ? new cacheMap(*shard) : new cacheMap);
+    batch.copied[shardInd] = true;
+  }
+  return *shard;
 }
 
 void PhraseDictionaryDynamicCacheBased::Execute(std::string command)
@@ -785,22 +755,14 @@ void PhraseDictionaryDynamicCacheBased::Execute_Single_Command(std::string comma
 void PhraseDictionaryDynamicCacheBased::Clear()
 {
 #ifdef WITH_THREADS
-  boost::shared_lock<boost::shared_mutex> lock(m_cacheLock);
+  boost::mutex::scoped_lock lock(m_writeLock);
 #endif
-  cacheMap::iterator it;
-  for(it = m_cacheTM.begin(); it!=m_cacheTM.end(); it++) {
-    // clear age collection
-    (boost::get<1>((*it).second))->clear();
-    // clear score collection
-    (boost::get<2>((*it).second))->clear();
-    // delete age collection
-    delete boost::get<1>((*it).second);
-    // delete score collection
-    delete boost::get<2>((*it).second);
-    // reset the target phrase collection
-    (boost::get<0>(it->second)).reset();
-  }
-  m_cacheTM.clear();
+  // keep the epoch, so that ages stay consistent with later loads
+  CacheBatch batch = BeginBatch();
+  for (size_t i = 0; i < kCacheShards; ++i) {
+    batch.next->shards[i].reset();
+  }
+  Publish(batch);
   m_entries = 0;
 }
 
@@ -831,19 +793,24 @@ void PhraseDictionaryDynamicCacheBased::ExecuteDlt(std::map<std::string, std::st
 void PhraseDictionaryDynamicCacheBased::Print() const
 {
   VERBOSE(2,"PhraseDictionaryDynamicCacheBased::Print()" << std::endl);
-#ifdef WITH_THREADS
-  boost::shared_lock<boost::shared_mutex> read_lock(m_cacheLock);
-#endif
-  cacheMap::const_iterator it;
-  for(it = m_cacheTM.begin(); it!=m_cacheTM.end(); it++) {
-    std::string source = (it->first).ToString();
-    TargetPhraseCollection::shared_ptr  tpc = boost::get<0>(it->second);
-    TargetPhraseCollection::iterator itr;
-    for(itr = tpc->begin(); itr != tpc->end(); itr++) {
-      std::string target = (*itr)->ToString();
-      std::cout << source << " ||| " << target << std::endl;
+  CacheVersionPtr version = boost::atomic_load(&m_cacheTM);
+  for (size_t i = 0; i < kCacheShards; ++i) {
+    if (!version->shards[i]) {
+      continue;
+    }
+    cacheMap::const_iterator it;
+    for(it = version->shards[i]->begin(); it!=version->shards[i]->end(); it++) {
+      std::string source = (it->first).ToString();
+      const CacheItems &items = it->second;
+      for (size_t j = 0; j < items.size(); ++j) {
+        if (version->epoch - items[j].birth > (long) m_maxAge) {
+          continue;
+        }
+        std::string target = items[j].targetPhrase->ToString();
+        std::cout << source << " ||| " << target << std::endl;
+      }
+      source.clear();
     }
-    source.clear();
   }
 }
 
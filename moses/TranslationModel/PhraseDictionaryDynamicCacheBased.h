@@ -25,12 +25,10 @@
 #include "moses/TypeDef.h"
 #include "moses/TranslationModel/PhraseDictionary.h"
 
-#include <boost/tuple/tuple.hpp>
-#include <boost/tuple/tuple_io.hpp>
+#include <boost/shared_ptr.hpp>
 
 #ifdef WITH_THREADS
-#include <boost/thread/shared_mutex.hpp>
-#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 #endif
 
 #define CBTM_SCORE_TYPE_UNDEFINED (-1)
@@ -55,29 +53,54 @@ class ChartRuleLookupManager;
 class PhraseDictionaryDynamicCacheBased : public PhraseDictionary
 {
 
-//  typedef std::vector<unsigned int> AgeCollection;
-  typedef std::vector<unsigned int> AgeCollection;
-  typedef boost::tuple<TargetPhraseCollection::shared_ptr , AgeCollection*, Scores*> TargetCollectionPair;
-  typedef std::map<Phrase, TargetCollectionPair> cacheMap;
+  // One target phrase of a cache entry.  The decay score is not stored: the
+  // age of the phrase is the current epoch minus its birth, and every Decay
+  // only advances the epoch.  Phrases older than m_maxAge are skipped by the
+  // readers and dropped by the writers when they next sweep the shard.
+  struct CacheItem {
+    boost::shared_ptr<const TargetPhrase> targetPhrase;
+    long birth;
+  };
+  typedef std::vector<CacheItem> CacheItems;
+  typedef std::map<Phrase, CacheItems> cacheMap;
+
+  // A published version of the cache is never modified.  Writers copy the
+  // shards they change into a new version and publish it with a single
+  // pointer store, so lookups never wait for an update and see either all of
+  // a batch or none of it.
+  struct CacheVersion {
+    std::vector<boost::shared_ptr<cacheMap> > shards;
+    long epoch;
+  };
+  typedef boost::shared_ptr<const CacheVersion> CacheVersionPtr;
+
+  // A version under construction and the shards already copied into it.
+  struct CacheBatch {
+    boost::shared_ptr<CacheVersion> next;
+    std::vector<bool> copied;
+  };
+
+  static const size_t kCacheShards = 64;
 
   // factored translation
   std::vector<FactorType> m_inputFactorsVec, m_outputFactorsVec;
 
-  // data structure for the cache
-  cacheMap m_cacheTM;
+  // data structure for the cache, accessed with boost::atomic_load and
+  // boost::atomic_store
+  CacheVersionPtr m_cacheTM;
   std::vector<Scores> precomputedScores;
   unsigned int m_maxAge;
   unsigned int m_numscorecomponent;
   size_t m_score_type; //scoring type of the match
-  size_t m_entries; //total number of entries in the cache
+  size_t m_entries; //total number of entries in the cache, including expired ones not swept yet
   float m_lower_score; //lower_bound_score for no match
   bool m_constant; //flag for setting a non-decaying cache
   std::string m_initfiles; // vector of files loaded in the initialization phase
   std::string m_name; // internal name to identify this instance of the Cache-based phrase table
 
 #ifdef WITH_THREADS
-  //multiple readers - single writer lock
-  mutable boost::shared_mutex m_cacheLock;
+  // serializes the writers; readers do not take it
+  mutable boost::mutex m_writeLock;
 #endif
 
   friend std::ostream& operator<<(std::ostream&, const PhraseDictionaryDynamicCacheBased&);
@@ -162,25 +185,30 @@ protected:
   Scores Conv2VecFloats(std::string&);
   void Insert(std::vector<std::string> entries);
 
-  void Decay();   // traverse through the cache and decay each entry
-  void Decay(Phrase p);   // traverse through the cache and decay each entry for a given Phrase
-  void Update(std::vector<std::string> entries, std::string ageString);
-  void Update(std::string sourceString, std::string targetString, std::string ageString, std::string ScoreString="", std::string waString="");
-  void Update(Phrase p, TargetPhrase tp, int age, Scores scores, std::string waString="");
+  // Writers call these under m_writeLock with the batch to publish.
+  CacheBatch BeginBatch() const;
+  void Publish(const CacheBatch &batch);
+  cacheMap &WritableShard(CacheBatch &batch, const Phrase &sp) const;
+  void Sweep(CacheBatch &batch, size_t shard);
+
+  void Decay(CacheBatch &batch);   // advance the age of every entry by one
+  void Update(CacheBatch &batch, std::vector<std::string> entries, std::string ageString);
+  void Update(CacheBatch &batch, std::string sourceString, std::string targetString, std::string ageString, std::string ScoreString="", std::string waString="");
+  void Update(CacheBatch &batch, Phrase p, TargetPhrase tp, int age, Scores scores, std::string waString="");
 
   void ClearEntries(std::vector<std::string> entries);
-  void ClearEntries(std::string sourceString, std::string targetString);
-  void ClearEntries(Phrase p, Phrase tp);
+  void ClearEntries(CacheBatch &batch, std::string sourceString, std::string targetString);
+  void ClearEntries(CacheBatch &batch, Phrase p, Phrase tp);
 
   void ClearSource(std::vector<std::string> entries);
-  void ClearSource(Phrase sp);
+  void ClearSource(CacheBatch &batch, Phrase sp);
 
   void Execute(std::vector<std::string> commands);
   void Execute_Single_Command(std::string command);
 
 
   void SetPreComputedScores(const unsigned int numScoreComponent);
-  Scores GetPreComputedScores(const unsigned int age);
+  Scores GetPreComputedScores(const unsigned int age) const;
 
   void Load_Multiple_Files(std::vector<std::string> files);
   void Load_Single_File(const std::string file);
@@ -0,0 +1,192 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+// Loads its own moses.ini into StaticData, so it is a test module of its
+// own rather than part of moses_test.
+#define BOOST_TEST_MODULE PhraseDictionaryDynamicCacheBased
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "moses/Parameter.h"
+#include "moses/StaticData.h"
+#include "moses/TargetPhrase.h"
+#include "moses/TargetPhraseCollection.h"
+#include "moses/TranslationModel/PhraseDictionaryDynamicCacheBased.h"
+#include "util/exception.hh"
+
+using namespace Moses;
+using namespace std;
+
+namespace
+{
+
+namespace fs = boost::filesystem;
+
+// A configuration with one cache, whose entries expire after three inserts.
+struct LoadedModel {
+  fs::path dir;
+  Parameter param;
+
+  LoadedModel() : dir(fs::temp_directory_path() / fs::unique_path()) {
+    fs::create_directories(dir);
+    const string ini = (dir / "moses.ini").string();
+    ofstream(ini.c_str())
+        << "[input-factors]\n0\n"
+        << "[mapping]\n0 T 0\n"
+        << "[verbose]\n0\n"
+        << "[feature]\n"
+        << "PhraseDictionaryDynamicCacheBased name=CBTM0 num-features=1 "
+        << "input-factor=0 output-factor=0 cbtm-name=test cbtm-max-age=3 cbtm-score-type=0\n"
+        << "[weight]\n"
+        << "CBTM0= 1\n";
+
+    UTIL_THROW_IF2(!param.LoadParam(ini), "Cannot load " << ini);
+    UTIL_THROW_IF2(!StaticData::LoadDataStatic(&param, ini), "Cannot load static data from " << ini);
+  }
+
+  ~LoadedModel() {
+    fs::remove_all(dir);
+  }
+};
+
+BOOST_GLOBAL_FIXTURE(LoadedModel);
+
+// The cache, emptied for each test.
+struct Cache {
+  PhraseDictionaryDynamicCacheBased &cache;
+
+  Cache() : cache(*PhraseDictionaryDynamicCacheBased::InstanceNonConst("test")) {
+    cache.Clear();
+  }
+
+  void Insert(string entries) {
+    cache.Insert(entries);
+  }
+
+  TargetPhraseCollection::shared_ptr Lookup(const string &source) const {
+    Phrase phrase(0);
+    phrase.CreateFromString(Input, vector<FactorType>(1, 0), source, NULL);
+    return cache.GetTargetPhraseCollection(phrase);
+  }
+
+  // The target and decay score of each phrase, or nothing if there is none.
+  vector<string> Describe(const string &source) const {
+    vector<string> ret;
+    TargetPhraseCollection::shared_ptr tpc = Lookup(source);
+    if (!tpc) {
+      return ret;
+    }
+    for (size_t i = 0; i < tpc->GetSize(); ++i) {
+      const TargetPhrase &tp = *tpc->GetTargetPhrase(i);
+      ostringstream desc;
+      desc << tp.GetStringRep(vector<FactorType>(1, 0)) << " "
+           << tp.GetScoreBreakdown().GetScoresForProducer(&cache)[0];
+      ret.push_back(desc.str());
+    }
+    sort(ret.begin(), ret.end());
+    return ret;
+  }
+};
+
+vector<string> Strings(const char *a = NULL, const char *b = NULL)
+{
+  vector<string> ret;
+  if (a) ret.push_back(a);
+  if (b) ret.push_back(b);
+  return ret;
+}
+
+#define CHECK_PHRASES(want, got) do { \
+    vector<string> want_ = (want), got_ = (got); \
+    BOOST_CHECK_EQUAL_COLLECTIONS(want_.begin(), want_.end(), got_.begin(), got_.end()); \
+  } while (0)
+
+// "a" is reinserted with every batch, so it must always be there with age 1,
+// whatever version is read.
+void Read(const Cache *cache, size_t *errors)
+{
+  for (size_t i = 0; i < 2000; ++i) {
+    if (cache->Describe("a") != Strings("x 0")) {
+      ++*errors;
+    }
+  }
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(insert_and_decay, Cache)
+{
+  CHECK_PHRASES(Strings(), Describe("a"));
+
+  Insert("a ||| x |||| b c ||| y z |||| a ||| w");
+  CHECK_PHRASES(Strings("w 0", "x 0"), Describe("a"));
+  CHECK_PHRASES(Strings("y z 0"), Describe("b c"));
+  CHECK_PHRASES(Strings(), Describe("b"));
+
+  // hyperbola: 1/age - 1
+  Insert("d ||| v");
+  CHECK_PHRASES(Strings("w -0.5", "x -0.5"), Describe("a"));
+  Insert("d ||| v |||| a ||| x");
+  CHECK_PHRASES(Strings("w -0.666667", "x 0"), Describe("a"));
+  Insert("d ||| v");
+  CHECK_PHRASES(Strings("x -0.5"), Describe("a"));
+  CHECK_PHRASES(Strings(), Describe("b c"));
+  CHECK_PHRASES(Strings("v 0"), Describe("d"));
+}
+
+BOOST_FIXTURE_TEST_CASE(clear, Cache)
+{
+  Insert("f ||| p |||| f ||| q |||| g ||| r");
+  string entries = "f ||| p";
+  cache.ClearEntries(entries);
+  CHECK_PHRASES(Strings("q 0"), Describe("f"));
+
+  string sources = "f";
+  cache.ClearSource(sources);
+  CHECK_PHRASES(Strings(), Describe("f"));
+  CHECK_PHRASES(Strings("r 0"), Describe("g"));
+
+  cache.Clear();
+  CHECK_PHRASES(Strings(), Describe("g"));
+}
+
+BOOST_FIXTURE_TEST_CASE(readers_see_whole_batches, Cache)
+{
+  Insert("a ||| x");
+  vector<size_t> errors(3, 0);
+  boost::thread_group readers;
+  for (size_t i = 0; i < errors.size(); ++i) {
+    readers.create_thread(boost::bind(&Read, this, &errors[i]));
+  }
+  for (size_t i = 0; i < 500; ++i) {
+    Insert("a ||| x |||| b ||| y");
+  }
+  readers.join_all();
+  for (size_t i = 0; i < errors.size(); ++i) {
+    BOOST_CHECK_EQUAL(0U, errors[i]);
+  }
+  CHECK_PHRASES(Strings("y 0"), Describe("b"));
+}
@@ -22,6 +22,7 @@
 #include <boost/foreach.hpp>
 #include <boost/unordered_map.hpp>
 
+#include "moses/TranslationTask.h"
 #include "util/exception.hh"
 
 using namespace std;
@@ -41,7 +42,8 @@ PhraseDictionaryGroup::PhraseDictionaryGroup(const string &line)
     m_haveDefaultScores(false),
     m_defaultAverageOthers(false),
     m_scoresPerModel(0),
-    m_haveMmsaptLrFunc(false)
+    m_haveMmsaptLrFunc(false),
+    m_lookupThreads(1)
 {
   ReadParameters();
 }
@@ -68,6 +70,8 @@ void PhraseDictionaryGroup::SetParameter(const string& key, const string& value)
     m_defaultAverageOthers = Scan<bool>(value);
   } else if (key =="mmsapt-lr-func") {
     m_haveMmsaptLrFunc = true;
+  } else if (key =="lookup-threads") {
+    m_lookupThreads = Scan<size_t>(value);
   } else {
     PhraseDictionary::SetParameter(key, value);
   }
@@ -152,12 +156,31 @@ void PhraseDictionaryGroup::GetTargetPhraseCollectionBatch(
       pd->PrefixExists(ttask, phrase);
     }
   }
-  // Look up each input in each model
+  if (m_lookupThreads <= 1) {
+    // Look up each input in each model
+    BOOST_FOREACH(InputPath* inputPath, inputPathQueue) {
+      const Phrase &phrase = inputPath->GetPhrase();
+      TargetPhraseCollection::shared_ptr  targetPhrases =
+        this->GetTargetPhraseCollectionLEGACY(ttask, phrase);
+      inputPath->SetTargetPhrases(*this, targetPhrases, NULL);
+    }
+    return;
+  }
+  // Look up all inputs in the member models concurrently, then combine
+  vector<vector<TargetPhraseCollection::shared_ptr> > colls;
+  LookupComponents(ttask, m_memberPDs, inputPathQueue, m_lookupThreads, colls);
+  vector<TargetPhraseCollection::shared_ptr> memberColls(m_numModels);
+  size_t j = 0;
   BOOST_FOREACH(InputPath* inputPath, inputPathQueue) {
-    const Phrase &phrase = inputPath->GetPhrase();
+    for (size_t i = 0; i < m_numModels; ++i) {
+      memberColls[i] = colls[i][j];
+    }
     TargetPhraseCollection::shared_ptr  targetPhrases =
-      this->GetTargetPhraseCollectionLEGACY(ttask, phrase);
+      CreateTargetPhraseCollection(inputPath->GetPhrase(), memberColls);
+    targetPhrases->NthElement(m_tableLimit); // sort the phrases for pruning later
+    CacheForCleanup(ttask, targetPhrases);
     inputPath->SetTargetPhrases(*this, targetPhrases, NULL);
+    ++j;
   }
 }
 
@@ -174,13 +197,25 @@ GetTargetPhraseCollectionLEGACY(const ttasksptr& ttask, const Phrase& src) const
   TargetPhraseCollection::shared_ptr ret
   = CreateTargetPhraseCollection(ttask, src);
   ret->NthElement(m_tableLimit); // sort the phrases for pruning later
-  const_cast<PhraseDictionaryGroup*>(this)->CacheForCleanup(ret);
+  CacheForCleanup(ttask, ret);
   return ret;
 }
 
 TargetPhraseCollection::shared_ptr
 PhraseDictionaryGroup::
 CreateTargetPhraseCollection(const ttasksptr& ttask, const Phrase& src) const
+{
+  vector<TargetPhraseCollection::shared_ptr> memberColls(m_numModels);
+  for (size_t i = 0; i < m_numModels; ++i) {
+    memberColls[i] = m_memberPDs[i]->GetTargetPhraseCollectionLEGACY(ttask, src);
+  }
+  return CreateTargetPhraseCollection(src, memberColls);
+}
+
+TargetPhraseCollection::shared_ptr
+PhraseDictionaryGroup::
+CreateTargetPhraseCollection(const Phrase& src,
+                             const vector<TargetPhraseCollection::shared_ptr>& memberColls) const
 {
   // Aggregation of phrases and corresponding statistics (scores, models seen by)
   vector<TargetPhrase*> phraseList;
@@ -193,8 +228,7 @@ CreateTargetPhraseCollection(const ttasksptr& ttask, const Phrase& src) const
 
     // Collect phrases from this table
     const PhraseDictionary& pd = *m_memberPDs[i];
-    TargetPhraseCollection::shared_ptr
-    ret_raw = pd.GetTargetPhraseCollectionLEGACY(ttask, src);
+    TargetPhraseCollection::shared_ptr ret_raw = memberColls[i];
 
     if (ret_raw != NULL) {
       // Process each phrase from table
@@ -374,18 +408,38 @@ CreateRuleLookupManager(const ChartParser &,
   UTIL_THROW(util::Exception, "Phrase table used in chart decoder");
 }
 
-//copied from PhraseDictionaryCompact; free memory allocated to TargetPhraseCollection (and each TargetPhrase) at end of sentence
-void PhraseDictionaryGroup::CacheForCleanup(TargetPhraseCollection::shared_ptr  tpc)
+// keep the TargetPhraseCollection (and each TargetPhrase) alive until the end of the task
+void PhraseDictionaryGroup::CacheForCleanup(const ttasksptr& ttask,
+    TargetPhraseCollection::shared_ptr  tpc) const
 {
-  PhraseCache &ref = GetPhraseCache();
-  ref.push_back(tpc);
+  boost::shared_ptr<PhraseCache> cache
+    = ttask->GetScope()->get<PhraseCache>(this, true);
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(cache->m_lock);
+#endif
+  cache->m_collections[ttask.get()].push_back(tpc);
+}
+
+void
+PhraseDictionaryGroup::
+CleanUpAfterSentenceProcessing(const ttasksptr& ttask)
+{
+  // Release the collections of this task in one go
+  boost::shared_ptr<PhraseCache> cache
+    = ttask->GetScope()->get<PhraseCache>(this);
+  if (cache) {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(cache->m_lock);
+#endif
+    cache->m_collections.erase(ttask.get());
+  }
+  CleanUpAfterSentenceProcessing(*ttask->GetSource());
 }
 
 void
 PhraseDictionaryGroup::
 CleanUpAfterSentenceProcessing(const InputType &source)
 {
-  GetPhraseCache().clear();
   CleanUpComponentModels(source);
 }
 
@@ -22,7 +22,7 @@
 
 #include <boost/dynamic_bitset.hpp>
 #include <boost/unordered_map.hpp>
-#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "moses/StaticData.h"
 #include "moses/TargetPhrase.h"
@@ -67,10 +67,15 @@ public:
   TargetPhraseCollection::shared_ptr
   CreateTargetPhraseCollection(const ttasksptr& ttask,
                                const Phrase& src) const;
+  TargetPhraseCollection::shared_ptr
+  CreateTargetPhraseCollection(const Phrase& src,
+                               const std::vector<TargetPhraseCollection::shared_ptr>& memberColls) const;
   std::vector<std::vector<float> > getWeights(size_t numWeights,
       bool normalize) const;
-  void CacheForCleanup(TargetPhraseCollection::shared_ptr  tpc);
+  void CacheForCleanup(const ttasksptr& ttask,
+                       TargetPhraseCollection::shared_ptr  tpc) const;
   void CleanUpAfterSentenceProcessing(const InputType& source);
+  void CleanUpAfterSentenceProcessing(const ttasksptr& ttask);
   void CleanUpComponentModels(const InputType& source);
   // functions below override the base class
   void GetTargetPhraseCollectionBatch(const ttasksptr& ttask,
@@ -109,32 +114,19 @@ protected:
   bool m_haveMmsaptLrFunc;
   // pointers to pointers since member mmsapts may not load these until later
   std::vector<LexicalReordering**> m_mmsaptLrFuncs;
-
-  typedef std::vector<TargetPhraseCollection::shared_ptr > PhraseCache;
-#ifdef WITH_THREADS
-  boost::shared_mutex m_lock_cache;
-  typedef std::map<boost::thread::id, PhraseCache> SentenceCache;
-#else
-  typedef PhraseCache SentenceCache;
-#endif
-  SentenceCache m_sentenceCache;
-
-  PhraseCache& GetPhraseCache() {
+  // lookup-threads option
+  size_t m_lookupThreads;
+
+  // Collections created by translation tasks, kept in their ContextScope
+  // by task and released together at the end of each task.  Scopes may be
+  // shared by concurrent tasks.
+  struct PhraseCache {
+    boost::unordered_map<TranslationTask const*,
+          std::vector<TargetPhraseCollection::shared_ptr> > m_collections;
 #ifdef WITH_THREADS
-    {
-      // first try read-only lock
-      boost::shared_lock<boost::shared_mutex> read_lock(m_lock_cache);
-      SentenceCache::iterator i = m_sentenceCache.find(
-        boost::this_thread::get_id());
-      if (i != m_sentenceCache.end())
-        return i->second;
-    }
-    boost::unique_lock<boost::shared_mutex> lock(m_lock_cache);
-    return m_sentenceCache[boost::this_thread::get_id()];
-#else
-    return m_sentenceCache;
+    boost::mutex m_lock;
 #endif
-  }
+  };
 };
 
 } // end namespace
@@ -20,6 +20,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "util/string_stream.hh"
 
 #include "moses/TranslationModel/PhraseDictionaryMultiModel.h"
+#include "moses/TranslationTask.h"
 
 using namespace std;
 
@@ -30,6 +31,7 @@ namespace Moses
 PhraseDictionaryMultiModel::
 PhraseDictionaryMultiModel(const std::string &line)
   : PhraseDictionary(line, true)
+  , m_lookupThreads(1)
 {
   ReadParameters();
 
@@ -50,6 +52,7 @@ PhraseDictionaryMultiModel(const std::string &line)
 PhraseDictionaryMultiModel::
 PhraseDictionaryMultiModel(int type, const std::string &line)
   :PhraseDictionary(line, true)
+  , m_lookupThreads(1)
 {
   if (type == 1) {
     // PhraseDictionaryMultiModelCounts
@@ -70,6 +73,8 @@ SetParameter(const std::string& key, const std::string& value)
     m_numModels = m_pdStr.size();
   } else if (key == "lambda") {
     m_multimodelweights = Tokenize<float>(value, ",");
+  } else if (key == "lookup-threads") {
+    m_lookupThreads = Scan<size_t>(value);
   } else {
     PhraseDictionary::SetParameter(key, value);
   }
@@ -111,21 +116,93 @@ GetTargetPhraseCollectionLEGACY(const Phrase& src) const
   delete allStats; // ??? Why the detour through malloc? UG
 
   ret->NthElement(m_tableLimit); // sort the phrases for pruning later
-  const_cast<PhraseDictionaryMultiModel*>(this)->CacheForCleanup(ret);
 
   return ret;
 }
 
+TargetPhraseCollection::shared_ptr
+PhraseDictionaryMultiModel::
+GetTargetPhraseCollectionLEGACY(ttasksptr const& ttask, const Phrase& src) const
+{
+  TargetPhraseCollection::shared_ptr ret
+  = GetTargetPhraseCollectionLEGACY(src);
+  CacheForCleanup(ttask, ret);
+  return ret;
+}
+
+void
+PhraseDictionaryMultiModel::
+GetTargetPhraseCollectionBatch(ttasksptr const& ttask,
+                               InputPathList const& inputPathQueue) const
+{
+  InputPathList queue;
+  InputPathList::const_iterator iter;
+  for (iter = inputPathQueue.begin(); iter != inputPathQueue.end(); ++iter) {
+    if (SatisfyBackoff(**iter)) {
+      queue.push_back(*iter);
+    }
+  }
+
+  if (m_lookupThreads <= 1) {
+    for (iter = queue.begin(); iter != queue.end(); ++iter) {
+      InputPath &inputPath = **iter;
+      TargetPhraseCollection::shared_ptr targetPhrases
+      = GetTargetPhraseCollectionLEGACY(ttask, inputPath.GetPhrase());
+      inputPath.SetTargetPhrases(*this, targetPhrases, NULL);
+    }
+    return;
+  }
+
+  // query the component tables for the whole batch at once, then combine
+  std::vector<std::vector<TargetPhraseCollection::shared_ptr> > colls;
+  LookupComponents(ttask, m_pd, queue, m_lookupThreads, colls);
+
+  std::vector<std::vector<float> > multimodelweights;
+  multimodelweights = getWeights(m_numScoreComponents, true);
+  std::vector<TargetPhraseCollection::shared_ptr> componentColls(m_numModels);
+  size_t j = 0;
+  for (iter = queue.begin(); iter != queue.end(); ++iter, ++j) {
+    InputPath &inputPath = **iter;
+    const Phrase &src = inputPath.GetPhrase();
+    for (size_t i = 0; i < m_numModels; ++i) {
+      componentColls[i] = colls[i][j];
+    }
+
+    std::map<std::string, multiModelStats*> allStats;
+    CollectSufficientStatistics(src, componentColls, &allStats);
+    TargetPhraseCollection::shared_ptr ret
+    = CreateTargetPhraseCollectionLinearInterpolation(src, &allStats, multimodelweights);
+    RemoveAllInMap(allStats);
+
+    ret->NthElement(m_tableLimit); // sort the phrases for pruning later
+    CacheForCleanup(ttask, ret);
+    inputPath.SetTargetPhrases(*this, ret, NULL);
+  }
+}
+
 void
 PhraseDictionaryMultiModel::
 CollectSufficientStatistics
 (const Phrase& src, std::map<std::string, multiModelStats*>* allStats) const
+{
+  std::vector<TargetPhraseCollection::shared_ptr> componentColls(m_numModels);
+  for(size_t i = 0; i < m_numModels; ++i) {
+    componentColls[i] = m_pd[i]->GetTargetPhraseCollectionLEGACY(src);
+  }
+  CollectSufficientStatistics(src, componentColls, allStats);
+}
+
+void
+PhraseDictionaryMultiModel::
+CollectSufficientStatistics
+(const Phrase& src,
+ std::vector<TargetPhraseCollection::shared_ptr> const& componentColls,
+ std::map<std::string, multiModelStats*>* allStats) const
 {
   for(size_t i = 0; i < m_numModels; ++i) {
     const PhraseDictionary &pd = *m_pd[i];
 
-    TargetPhraseCollection::shared_ptr ret_raw;
-    ret_raw = pd.GetTargetPhraseCollectionLEGACY(src);
+    TargetPhraseCollection::shared_ptr ret_raw = componentColls[i];
     if (ret_raw != NULL) {
 
       TargetPhraseCollection::const_iterator iterTargetPhrase, iterLast;
@@ -278,28 +355,43 @@ CreateRuleLookupManager(const ChartParser &, const ChartCellCollectionBase&,
 }
 
 
-//copied from PhraseDictionaryCompact; free memory allocated to TargetPhraseCollection (and each TargetPhrase) at end of sentence
+// keep the TargetPhraseCollection (and each TargetPhrase) alive until the end of the task
 void
 PhraseDictionaryMultiModel::
-CacheForCleanup(TargetPhraseCollection::shared_ptr tpc)
+CacheForCleanup(ttasksptr const& ttask,
+                TargetPhraseCollection::shared_ptr tpc) const
 {
-  GetPhraseCache().push_back(tpc);
+  if (!ttask) return;
+  boost::shared_ptr<PhraseCache> cache
+  = ttask->GetScope()->get<PhraseCache>(this, true);
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(cache->m_lock);
+#endif
+  cache->m_collections[ttask.get()].push_back(tpc);
 }
 
 
 void
 PhraseDictionaryMultiModel::
-CleanUpAfterSentenceProcessing(const InputType &source)
+CleanUpAfterSentenceProcessing(ttasksptr const& ttask)
 {
-  // PhraseCache &ref = GetPhraseCache();
-  // for(PhraseCache::iterator it = ref.begin(); it != ref.end(); it++) {
-  //   it->reset();
-  // }
+  // release the combined collections of this task in one go
+  boost::shared_ptr<PhraseCache> cache
+  = ttask->GetScope()->get<PhraseCache>(this);
+  if (cache) {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(cache->m_lock);
+#endif
+    cache->m_collections.erase(ttask.get());
+  }
+  CleanUpAfterSentenceProcessing(*ttask->GetSource());
+}
 
-  // PhraseCache temp;
-  // temp.swap(ref);
-  GetPhraseCache().clear();
 
+void
+PhraseDictionaryMultiModel::
+CleanUpAfterSentenceProcessing(const InputType &source)
+{
   CleanUpComponentModels(source);
 
   std::vector<float> empty_vector;
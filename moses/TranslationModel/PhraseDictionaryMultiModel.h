@@ -25,6 +25,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <boost/unordered_map.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/mutex.hpp>
 #include "moses/StaticData.h"
 #include "moses/TargetPhrase.h"
 #include "moses/Util.h"
@@ -77,6 +78,12 @@ public:
   (const Phrase& src, std::map<std::string,multiModelStats*>* allStats)
   const;
 
+  void
+  CollectSufficientStatistics
+  (const Phrase& src,
+   std::vector<TargetPhraseCollection::shared_ptr> const& componentColls,
+   std::map<std::string,multiModelStats*>* allStats) const;
+
   virtual TargetPhraseCollection::shared_ptr
   CreateTargetPhraseCollectionLinearInterpolation
   (const Phrase& src, std::map<std::string,multiModelStats*>* allStats,
@@ -89,11 +96,15 @@ public:
   normalizeWeights(std::vector<float> &weights) const;
 
   void
-  CacheForCleanup(TargetPhraseCollection::shared_ptr tpc);
+  CacheForCleanup(ttasksptr const& ttask,
+                  TargetPhraseCollection::shared_ptr tpc) const;
 
   void
   CleanUpAfterSentenceProcessing(const InputType &source);
 
+  void
+  CleanUpAfterSentenceProcessing(ttasksptr const& ttask);
+
   virtual void
   CleanUpComponentModels(const InputType &source);
 
@@ -106,6 +117,14 @@ public:
   virtual TargetPhraseCollection::shared_ptr
   GetTargetPhraseCollectionLEGACY(const Phrase& src) const;
 
+  virtual TargetPhraseCollection::shared_ptr
+  GetTargetPhraseCollectionLEGACY(ttasksptr const& ttask,
+                                  const Phrase& src) const;
+
+  virtual void
+  GetTargetPhraseCollectionBatch(ttasksptr const& ttask,
+                                 InputPathList const& inputPathQueue) const;
+
   virtual void
   InitializeForInput(ttasksptr const& ttask) {
     // Don't do anything source specific here as this object is shared
@@ -131,30 +150,20 @@ protected:
   std::vector<PhraseDictionary*> m_pd;
   size_t m_numModels;
   std::vector<float> m_multimodelweights;
-
-  typedef std::vector<TargetPhraseCollection::shared_ptr> PhraseCache;
-#ifdef WITH_THREADS
-  boost::shared_mutex m_lock_cache;
-  typedef std::map<boost::thread::id, PhraseCache> SentenceCache;
-#else
-  typedef PhraseCache SentenceCache;
-#endif
-  SentenceCache m_sentenceCache;
-
-  PhraseCache& GetPhraseCache() {
+  size_t m_lookupThreads; // threads querying the component tables of a batch
+
+  // Combined collections created by translation tasks, kept in their
+  // ContextScope by task, so that nothing is left behind for threads that
+  // have exited.  A scope may be shared by concurrent tasks, so
+  // CleanUpAfterSentenceProcessing(ttask) releases only the collections of
+  // the task that ends.
+  struct PhraseCache {
+    boost::unordered_map<TranslationTask const*,
+          std::vector<TargetPhraseCollection::shared_ptr> > m_collections;
 #ifdef WITH_THREADS
-    {
-      // first try read-only lock
-      boost::shared_lock<boost::shared_mutex> read_lock(m_lock_cache);
-      SentenceCache::iterator i = m_sentenceCache.find(boost::this_thread::get_id());
-      if (i != m_sentenceCache.end()) return i->second;
-    }
-    boost::unique_lock<boost::shared_mutex> lock(m_lock_cache);
-    return m_sentenceCache[boost::this_thread::get_id()];
-#else
-    return m_sentenceCache;
+    boost::mutex m_lock;
 #endif
-  }
+  };
 
 #ifdef WITH_THREADS
   //reader-writer lock
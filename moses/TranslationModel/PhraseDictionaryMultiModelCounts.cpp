@@ -71,6 +71,8 @@ void PhraseDictionaryMultiModelCounts::SetParameter(const std::string& key, cons
                    "Number of scores for lexical probability p(e|f) incorrectly specified");
   } else if (key == "target-table") {
     m_targetTable = Tokenize(value, ",");
+  } else if (key == "lookup-threads") {
+    UTIL_THROW2("lookup-threads is not supported by PhraseDictionaryMultiModelCounts");
   } else {
     PhraseDictionaryMultiModel::SetParameter(key, value);
   }
@@ -139,7 +141,6 @@ TargetPhraseCollection::shared_ptr PhraseDictionaryMultiModelCounts::GetTargetPh
   = CreateTargetPhraseCollectionCounts(src, fs, allStats, multimodelweights);
 
   ret->NthElement(m_tableLimit); // sort the phrases for pruning later
-  const_cast<PhraseDictionaryMultiModelCounts*>(this)->CacheForCleanup(ret);
   return ret;
 }
 
@@ -97,14 +97,15 @@ void ProbingPT::Load(AllOptions::ptr const& opts)
 
 void ProbingPT::CreateAlignmentMap(const std::string path)
 {
-  const std::vector< std::vector<unsigned char> > &probingAlignColl = m_engine->getAlignments();
-  m_aligns.resize(probingAlignColl.size(), NULL);
+  // read straight from the mapped file
+  m_aligns.resize(m_engine->getNumAlignments(), NULL);
 
-  for (size_t i = 0; i < probingAlignColl.size(); ++i) {
+  for (size_t i = 0; i < m_aligns.size(); ++i) {
     AlignmentInfo::CollType aligns;
 
-    const std::vector<unsigned char> &probingAligns = probingAlignColl[i];
-    for (size_t j = 0; j < probingAligns.size(); j += 2) {
+    size_t size;
+    const unsigned char *probingAligns = m_engine->getAlignment(i, size);
+    for (size_t j = 0; j < size; j += 2) {
       size_t startPos = probingAligns[j];
       size_t endPos = probingAligns[j+1];
       //cerr << "startPos=" << startPos << " " << endPos << endl;
@@ -130,6 +131,8 @@ void ProbingPT::SetParameter(const std::string& key, const std::string& value)
       load_method = util::READ;
     } else if (value == "parallel_read") {
       load_method = util::PARALLEL_READ;
+    } else if (value == "direct_read") {
+      load_method = util::DIRECT_READ;
     } else {
       UTIL_THROW2("load method not supported" << value);
     }
@@ -252,7 +255,8 @@ TargetPhraseCollection *ProbingPT::CreateTargetPhrases(
   query_result = m_engine->query(key);
   //cerr << "key2=" << query_result.second << endl;
 
-  if (query_result.first) {
+  // entries with value NONE only mark a prefix of longer source phrases
+  if (query_result.first && query_result.second != NONE) {
     const char *offset = data + query_result.second;
     uint64_t *numTP = (uint64_t*) offset;
 
@@ -0,0 +1,85 @@
+/***********************************************************************
+ Moses - statistical machine translation system
+ Copyright (C) 2006-2011 University of Edinburgh
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+
+#include "Loader.h"
+
+#include "moses/TargetPhraseCollection.h"
+#include "moses/Word.h"
+#include "util/exception.hh"
+
+#ifdef WITH_THREADS
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#endif
+
+namespace Moses
+{
+
+void RuleTableLoader::ParseAndAdd(RuleTableTrie &ruleTable, size_t numItems,
+                                  const ParseFunc &parse)
+{
+  const size_t numThreads = ruleTable.GetLoadThreads();
+  std::vector<ParsedRules> rules(numThreads);
+  std::vector<std::string> errors(numThreads);
+
+  if (numThreads == 1) {
+    parse(0, numItems, rules[0], errors[0]);
+  } else {
+#ifdef WITH_THREADS
+    const size_t sliceSize = (numItems + numThreads - 1) / numThreads;
+    boost::thread_group threads;
+    for (size_t t = 0; t < numThreads; ++t) {
+      size_t begin = std::min(t * sliceSize, numItems);
+      size_t end = std::min(begin + sliceSize, numItems);
+      threads.create_thread(boost::bind(parse, begin, end,
+                                        boost::ref(rules[t]),
+                                        boost::ref(errors[t])));
+    }
+    threads.join_all();
+#endif
+  }
+
+  // the first error in input order
+  std::string error;
+  for (size_t t = 0; t < numThreads && error.empty(); ++t) {
+    error = errors[t];
+  }
+
+  for (size_t t = 0; t < numThreads; ++t) {
+    for (size_t i = 0; i < rules[t].size(); ++i) {
+      ParsedRule &rule = rules[t][i];
+      if (error.empty()) {
+        TargetPhraseCollection::shared_ptr phraseColl
+        = GetOrCreateTargetPhraseCollection(ruleTable, rule.source,
+                                            *rule.target, rule.sourceLHS);
+        phraseColl->Add(rule.target);
+      } else {
+        delete rule.target;
+      }
+
+      // not implemented correctly in memory pt. just delete it for now
+      delete rule.sourceLHS;
+    }
+  }
+
+  UTIL_THROW_IF2(!error.empty(), error);
+}
+
+}  // namespace Moses
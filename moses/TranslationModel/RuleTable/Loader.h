@@ -20,10 +20,14 @@
 #pragma once
 
 #include "Trie.h"
+#include "moses/Phrase.h"
 #include "moses/TypeDef.h"
 #include "moses/parameters/AllOptions.h"
 
+#include <boost/function.hpp>
+
 #include <istream>
+#include <string>
 #include <vector>
 
 namespace Moses
@@ -44,6 +48,26 @@ public:
                     RuleTableTrie &) = 0;
 
 protected:
+  // A rule parsed by one of the loading threads but not yet in the table.
+  struct ParsedRule {
+    ParsedRule() : target(NULL), sourceLHS(NULL) {}
+
+    Phrase source;
+    TargetPhrase *target;
+    Word *sourceLHS; // owned, may be NULL
+  };
+  typedef std::vector<ParsedRule> ParsedRules;
+
+  // parse(begin, end, rules, error) parses items [begin, end) of the
+  // current batch into rules, and reports a failure through error.
+  typedef boost::function<void (size_t, size_t, ParsedRules&, std::string&)> ParseFunc;
+
+  // Splits items [0, numItems) into one slice per load thread, parses the
+  // slices concurrently, then adds the rules to ruleTable on this thread in
+  // input order, so the table is the same for any number of threads.
+  void ParseAndAdd(RuleTableTrie &ruleTable, size_t numItems,
+                   const ParseFunc &parse);
+
   // Provide access to RuleTableTrie's private SortAndPrune function.
   void SortAndPrune(RuleTableTrie &ruleTable) {
     ruleTable.SortAndPrune();
@@ -180,59 +180,78 @@ bool RuleTableLoaderCompact::LoadRuleSection(
   reader.ReadLine();
   const size_t ruleCount = std::atoi(reader.m_line.c_str());
 
-  // Read rules and add to table.
-  const size_t numScoreComponents = ruleTable.GetNumScoreComponents();
-  std::vector<float> scoreVector(numScoreComponents);
-  std::vector<size_t> tokenPositions;
-  for (size_t i = 0; i < ruleCount; ++i) {
-    reader.ReadLine();
+  // Read rules in batches, which the load threads parse between them, and
+  // add to table.
+  const size_t batchSize = 10000 * ruleTable.GetLoadThreads();
+  std::vector<std::string> lines;
+  for (size_t i = 0; i < ruleCount; i += lines.size()) {
+    const size_t firstLineNum = reader.m_lineNum + 1;
+    lines.resize(std::min(batchSize, ruleCount - i));
+    for (size_t j = 0; j < lines.size(); ++j) {
+      reader.ReadLine();
+      lines[j].swap(reader.m_line);
+    }
 
-    tokenPositions.clear();
-    FindTokens(tokenPositions, reader.m_line);
+    RuleParser parser(*this, vocab, sourcePhrases, targetPhrases, targetLhsIds,
+                      alignmentSets, ruleTable, lines, firstLineNum);
+    ParseAndAdd(ruleTable, lines.size(), parser);
+  }
 
-    const char *charLine = reader.m_line.c_str();
+  return true;
+}
 
-    // The first three tokens are IDs for the source phrase, target phrase,
-    // and alignment set.
-    const int sourcePhraseId = std::atoi(charLine+tokenPositions[0]);
-    const int targetPhraseId = std::atoi(charLine+tokenPositions[1]);
-    const int alignmentSetId = std::atoi(charLine+tokenPositions[2]);
-
-    const Phrase &sourcePhrase = sourcePhrases[sourcePhraseId];
-    const Phrase &targetPhrasePhrase = targetPhrases[targetPhraseId];
-    const Word *targetLhs = new Word(vocab[targetLhsIds[targetPhraseId]]);
-    Word sourceLHS("X"); // TODO not implemented for compact
-    const AlignmentInfo *alignNonTerm = alignmentSets[alignmentSetId];
-
-    // Then there should be one score for each score component.
-    for (size_t j = 0; j < numScoreComponents; ++j) {
-      float score = std::atof(charLine+tokenPositions[3+j]);
-      scoreVector[j] = FloorScore(TransformScore(score));
-    }
-    if (reader.m_line[tokenPositions[3+numScoreComponents]] != ':') {
-      std::cerr << "Size of scoreVector != number ("
-                << scoreVector.size() << "!=" << numScoreComponents
-                << ") of score components on line " << reader.m_lineNum;
-      return false;
-    }
+void RuleTableLoaderCompact::RuleParser::operator()(size_t begin, size_t end,
+    ParsedRules &rules, std::string &error) const
+{
+  const size_t numScoreComponents = m_ruleTable.GetNumScoreComponents();
+  std::vector<float> scoreVector(numScoreComponents);
+  std::vector<size_t> tokenPositions;
+  try {
+    for (size_t i = begin; i < end; ++i) {
+      const std::string &line = m_lines[i];
 
-    // The remaining columns are currently ignored.
+      tokenPositions.clear();
+      m_loader.FindTokens(tokenPositions, line);
 
-    // Create and score target phrase.
-    TargetPhrase *targetPhrase = new TargetPhrase(targetPhrasePhrase, &ruleTable);
-    targetPhrase->SetAlignNonTerm(alignNonTerm);
-    targetPhrase->SetTargetLHS(targetLhs);
+      const char *charLine = line.c_str();
 
-    targetPhrase->EvaluateInIsolation(sourcePhrase, ruleTable.GetFeaturesToApply());
+      // The first three tokens are IDs for the source phrase, target phrase,
+      // and alignment set.
+      const int sourcePhraseId = std::atoi(charLine+tokenPositions[0]);
+      const int targetPhraseId = std::atoi(charLine+tokenPositions[1]);
+      const int alignmentSetId = std::atoi(charLine+tokenPositions[2]);
 
-    // Insert rule into table.
-    TargetPhraseCollection::shared_ptr coll;
-    coll = GetOrCreateTargetPhraseCollection(ruleTable, sourcePhrase,
-           *targetPhrase, &sourceLHS);
-    coll->Add(targetPhrase);
-  }
+      const Phrase &sourcePhrase = m_sourcePhrases[sourcePhraseId];
+      const Phrase &targetPhrasePhrase = m_targetPhrases[targetPhraseId];
+      const AlignmentInfo *alignNonTerm = m_alignmentSets[alignmentSetId];
 
-  return true;
+      // Then there should be one score for each score component.
+      for (size_t j = 0; j < numScoreComponents; ++j) {
+        float score = std::atof(charLine+tokenPositions[3+j]);
+        scoreVector[j] = FloorScore(TransformScore(score));
+      }
+      UTIL_THROW_IF2(line[tokenPositions[3+numScoreComponents]] != ':',
+                     "Size of scoreVector != number ("
+                     << scoreVector.size() << "!=" << numScoreComponents
+                     << ") of score components on line " << m_firstLineNum + i);
+
+      // The remaining columns are currently ignored.
+
+      // Create and score target phrase.
+      rules.push_back(ParsedRule());
+      ParsedRule &rule = rules.back();
+      rule.source = sourcePhrase;
+      rule.sourceLHS = new Word("X"); // TODO not implemented for compact
+      rule.target = new TargetPhrase(targetPhrasePhrase, &m_ruleTable);
+      rule.target->SetAlignNonTerm(alignNonTerm);
+      rule.target->SetTargetLHS(new Word(m_vocab[m_targetLhsIds[targetPhraseId]]));
+
+      rule.target->EvaluateInIsolation(sourcePhrase, m_ruleTable.GetFeaturesToApply());
+    }
+  } catch (const std::exception &e) {
+    // reported by the loading thread
+    error = e.what();
+  }
 }
 
 }
@@ -77,6 +77,38 @@ private:
                        const std::vector<const AlignmentInfo *> &,
                        RuleTableTrie &ruleTable);
 
+  // Parses a slice of a batch of rule lines, see ParseAndAdd().
+  struct RuleParser {
+    typedef void result_type;
+
+    RuleParser(const RuleTableLoaderCompact &loader,
+               const std::vector<Word> &vocab,
+               const std::vector<Phrase> &sourcePhrases,
+               const std::vector<Phrase> &targetPhrases,
+               const std::vector<size_t> &targetLhsIds,
+               const std::vector<const AlignmentInfo *> &alignmentSets,
+               RuleTableTrie &ruleTable,
+               const std::vector<std::string> &lines, size_t firstLineNum)
+      : m_loader(loader), m_vocab(vocab), m_sourcePhrases(sourcePhrases)
+      , m_targetPhrases(targetPhrases), m_targetLhsIds(targetLhsIds)
+      , m_alignmentSets(alignmentSets), m_ruleTable(ruleTable)
+      , m_lines(lines), m_firstLineNum(firstLineNum) {
+    }
+
+    void operator()(size_t begin, size_t end, ParsedRules &rules,
+                    std::string &error) const;
+
+    const RuleTableLoaderCompact &m_loader;
+    const std::vector<Word> &m_vocab;
+    const std::vector<Phrase> &m_sourcePhrases;
+    const std::vector<Phrase> &m_targetPhrases;
+    const std::vector<size_t> &m_targetLhsIds;
+    const std::vector<const AlignmentInfo *> &m_alignmentSets;
+    RuleTableTrie &m_ruleTable;
+    const std::vector<std::string> &m_lines;
+    size_t m_firstLineNum;
+  };
+
   // Like Tokenize() but records starting positions of tokens (instead of
   // copying substrings) and assumes delimiter is ASCII space character.
   void FindTokens(std::vector<size_t> &output, const std::string &str) const {
@@ -149,15 +149,41 @@ bool RuleTableLoaderStandard::Load(AllOptions const& opts, FormatType format
 {
   PrintUserTime(string("Start loading text phrase table. ") + (format==MosesFormat?"Moses":"Hiero") + " format");
 
-  // const StaticData &staticData = StaticData::Instance();
-
-  string lineOrig;
-  size_t count = 0;
-
   std::ostream *progress = NULL;
   IFVERBOSE(1) progress = &std::cerr;
   util::FilePiece in(inFile.c_str(), progress);
 
+  // lines are read in batches, which the load threads parse between them
+  const size_t batchSize = 10000 * ruleTable.GetLoadThreads();
+  vector<string> lines;
+  size_t count = 0;
+  bool more = true;
+  while (more) {
+    lines.clear();
+    while (lines.size() < batchSize) {
+      try {
+        StringPiece line = in.ReadLine();
+        lines.push_back(line.as_string());
+      } catch (const util::EndOfFileException &e) {
+        more = false;
+        break;
+      }
+    }
+
+    LineParser parser(opts, format, input, output, ruleTable, lines, count);
+    ParseAndAdd(ruleTable, lines.size(), parser);
+    count += lines.size();
+  }
+
+  // sort and prune each target phrase collection
+  SortAndPrune(ruleTable);
+
+  return true;
+}
+
+void RuleTableLoaderStandard::LineParser::operator()(size_t begin, size_t end,
+    ParsedRules &rules, std::string &error) const
+{
   // reused variables
   vector<float> scoreVector;
   StringPiece line;
@@ -165,96 +191,84 @@ bool RuleTableLoaderStandard::Load(AllOptions const& opts, FormatType format
 
   double_conversion::StringToDoubleConverter converter(double_conversion::StringToDoubleConverter::NO_FLAGS, NAN, NAN, "inf", "nan");
 
-  while(true) {
-    try {
-      line = in.ReadLine();
-    } catch (const util::EndOfFileException &e) {
-      break;
-    }
-
-    if (format == HieroFormat) { // inefficiently reformat line
-      hiero_before.assign(line.data(), line.size());
-      ReformatHieroRule(hiero_before, hiero_after);
-      line = hiero_after;
-    }
-
-    util::TokenIter<util::MultiCharacter> pipes(line, "|||");
-    StringPiece sourcePhraseString(*pipes);
-    StringPiece targetPhraseString(*++pipes);
-    StringPiece scoreString(*++pipes);
+  try {
+    for (size_t i = begin; i < end; ++i) {
+      const size_t count = m_firstLineNum + i;
+      line = m_lines[i];
 
-    StringPiece alignString;
-    if (++pipes) {
-      StringPiece temp(*pipes);
-      alignString = temp;
-    }
-
-    bool isLHSEmpty = (sourcePhraseString.find_first_not_of(" \t", 0) == string::npos);
-    if (isLHSEmpty && !opts.unk.word_deletion_enabled) {
-      TRACE_ERR( ruleTable.GetFilePath() << ":" << count << ": pt entry contains empty target, skipping\n");
-      continue;
-    }
+      if (m_format == HieroFormat) { // inefficiently reformat line
+        hiero_before.assign(line.data(), line.size());
+        ReformatHieroRule(hiero_before, hiero_after);
+        line = hiero_after;
+      }
 
-    scoreVector.clear();
-    for (util::TokenIter<util::AnyCharacter, true> s(scoreString, " \t"); s; ++s) {
-      int processed;
-      float score = converter.StringToFloat(s->data(), s->length(), &processed);
-      UTIL_THROW_IF2(isnan(score), "Bad score " << *s << " on line " << count);
-      scoreVector.push_back(FloorScore(TransformScore(score)));
-    }
-    const size_t numScoreComponents = ruleTable.GetNumScoreComponents();
-    if (scoreVector.size() != numScoreComponents) {
-      UTIL_THROW2("Size of scoreVector != number (" << scoreVector.size() << "!="
-                  << numScoreComponents << ") of score components on line " << count);
-    }
+      util::TokenIter<util::MultiCharacter> pipes(line, "|||");
+      StringPiece sourcePhraseString(*pipes);
+      StringPiece targetPhraseString(*++pipes);
+      StringPiece scoreString(*++pipes);
 
-    // parse source & find pt node
+      StringPiece alignString;
+      if (++pipes) {
+        StringPiece temp(*pipes);
+        alignString = temp;
+      }
 
-    // constituent labels
-    Word *sourceLHS = NULL;
-    Word *targetLHS;
+      bool isLHSEmpty = (sourcePhraseString.find_first_not_of(" \t", 0) == string::npos);
+      if (isLHSEmpty && !m_opts.unk.word_deletion_enabled) {
+        TRACE_ERR( m_ruleTable.GetFilePath() << ":" << count << ": pt entry contains empty target, skipping\n");
+        continue;
+      }
 
-    // create target phrase obj
-    TargetPhrase *targetPhrase = new TargetPhrase(&ruleTable);
-    targetPhrase->CreateFromString(Output, output, targetPhraseString, &targetLHS);
-    // source
-    Phrase sourcePhrase;
-    sourcePhrase.CreateFromString(Input, input, sourcePhraseString, &sourceLHS);
+      scoreVector.clear();
+      for (util::TokenIter<util::AnyCharacter, true> s(scoreString, " \t"); s; ++s) {
+        int processed;
+        float score = converter.StringToFloat(s->data(), s->length(), &processed);
+        UTIL_THROW_IF2(isnan(score), "Bad score " << *s << " on line " << count);
+        scoreVector.push_back(FloorScore(TransformScore(score)));
+      }
+      const size_t numScoreComponents = m_ruleTable.GetNumScoreComponents();
+      if (scoreVector.size() != numScoreComponents) {
+        UTIL_THROW2("Size of scoreVector != number (" << scoreVector.size() << "!="
+                    << numScoreComponents << ") of score components on line " << count);
+      }
 
-    // rest of target phrase
-    targetPhrase->SetAlignmentInfo(alignString);
-    targetPhrase->SetTargetLHS(targetLHS);
+      // parse source & find pt node
 
-    ++pipes;  // skip over counts field
+      // constituent labels
+      rules.push_back(ParsedRule());
+      ParsedRule &rule = rules.back();
+      Word *targetLHS;
 
-    if (++pipes) {
-      StringPiece sparseString(*pipes);
-      targetPhrase->SetSparseScore(&ruleTable, sparseString);
-    }
+      // create target phrase obj
+      rule.target = new TargetPhrase(&m_ruleTable);
+      TargetPhrase *targetPhrase = rule.target;
+      targetPhrase->CreateFromString(Output, m_output, targetPhraseString, &targetLHS);
+      // source
+      rule.source.CreateFromString(Input, m_input, sourcePhraseString, &rule.sourceLHS);
 
-    if (++pipes) {
-      StringPiece propertiesString(*pipes);
-      targetPhrase->SetProperties(propertiesString);
-    }
+      // rest of target phrase
+      targetPhrase->SetAlignmentInfo(alignString);
+      targetPhrase->SetTargetLHS(targetLHS);
 
-    targetPhrase->GetScoreBreakdown().Assign(&ruleTable, scoreVector);
-    targetPhrase->EvaluateInIsolation(sourcePhrase, ruleTable.GetFeaturesToApply());
+      ++pipes;  // skip over counts field
 
-    TargetPhraseCollection::shared_ptr phraseColl
-    = GetOrCreateTargetPhraseCollection(ruleTable, sourcePhrase,
-                                        *targetPhrase, sourceLHS);
-    phraseColl->Add(targetPhrase);
+      if (++pipes) {
+        StringPiece sparseString(*pipes);
+        targetPhrase->SetSparseScore(&m_ruleTable, sparseString);
+      }
 
-    // not implemented correctly in memory pt. just delete it for now
-    delete sourceLHS;
+      if (++pipes) {
+        StringPiece propertiesString(*pipes);
+        targetPhrase->SetProperties(propertiesString);
+      }
 
-    count++;
+      targetPhrase->GetScoreBreakdown().Assign(&m_ruleTable, scoreVector);
+      targetPhrase->EvaluateInIsolation(rule.source, m_ruleTable.GetFeaturesToApply());
+    }
+  } catch (const std::exception &e) {
+    // reported by the loading thread
+    error = e.what();
   }
-
-  // sort and prune each target phrase collection
-  SortAndPrune(ruleTable);
-
-  return true;
 }
 
 }
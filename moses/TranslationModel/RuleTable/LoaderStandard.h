@@ -43,6 +43,32 @@ public:
             const std::string &inFile,
             size_t tableLimit,
             RuleTableTrie &);
+
+private:
+  // Parses a slice of a batch of rule table lines, see ParseAndAdd().
+  struct LineParser {
+    typedef void result_type;
+
+    LineParser(AllOptions const& opts, FormatType format,
+               const std::vector<FactorType> &input,
+               const std::vector<FactorType> &output,
+               RuleTableTrie &ruleTable,
+               const std::vector<std::string> &lines, size_t firstLineNum)
+      : m_opts(opts), m_format(format), m_input(input), m_output(output)
+      , m_ruleTable(ruleTable), m_lines(lines), m_firstLineNum(firstLineNum) {
+    }
+
+    void operator()(size_t begin, size_t end, ParsedRules &rules,
+                    std::string &error) const;
+
+    AllOptions const& m_opts;
+    FormatType m_format;
+    const std::vector<FactorType> &m_input;
+    const std::vector<FactorType> &m_output;
+    RuleTableTrie &m_ruleTable;
+    const std::vector<std::string> &m_lines;
+    size_t m_firstLineNum;
+  };
 };
 
 }  // namespace Moses
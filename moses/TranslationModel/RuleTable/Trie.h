@@ -41,16 +41,26 @@ class RuleTableTrie : public PhraseDictionary
 {
 public:
   RuleTableTrie(const std::string &line)
-    : PhraseDictionary(line, true) {
+    : PhraseDictionary(line, true)
+    , m_loadThreads(1) {
   }
 
   virtual ~RuleTableTrie();
 
   void Load(AllOptions::ptr const& opts);
 
+  void SetParameter(const std::string& key, const std::string& value);
+
+  //! number of threads parsing the rule table while loading
+  size_t GetLoadThreads() const {
+    return m_loadThreads;
+  }
+
 private:
   friend class RuleTableLoader;
 
+  size_t m_loadThreads;
+
   virtual TargetPhraseCollection::shared_ptr
   GetOrCreateTargetPhraseCollection(const Phrase &source,
                                     const TargetPhrase &target,
@@ -60,6 +60,7 @@ TranslationOptionCollection(ttasksptr const& ttask,
   , m_translationOptionThreshold(ttask->options()->search.trans_opt_threshold)
   , m_max_phrase_length(ttask->options()->search.max_phrase_length)
   , max_partial_trans_opt(ttask->options()->search.max_partial_trans_opt)
+  , m_lazy(false)
 {
   // create 2-d vector
   size_t size = src.GetSize();
@@ -73,6 +74,8 @@ TranslationOptionCollection(ttasksptr const& ttask,
       m_collection[sPos].push_back( TranslationOptionList() );
     }
   }
+  // nothing is pending unless CreateTranslationOptions() defers it
+  m_pending.resize(size);
 }
 
 /** destructor, clears out data structures */
@@ -345,13 +348,15 @@ CreateTranslationOptions()
   // length of the sentence
   const size_t size = m_source.GetSize();
 
+  for (size_t sPos = 0 ; sPos < size; sPos++)
+    m_pending[sPos].assign(m_collection[sPos].size(), false);
+
   // loop over all decoding graphs, each generates translation options
   for (size_t gidx = 0 ; gidx < decodeGraphList.size() ; gidx++) {
     if (decodeGraphList.size() > 1)
       VERBOSE(3,"Creating translation options from decoding graph " << gidx << endl);
 
     const DecodeGraph& dg = *decodeGraphList[gidx];
-    size_t backoff = dg.GetBackoff();
     // iterate over spans
     for (size_t sPos = 0 ; sPos < size; sPos++) {
       size_t maxSize = size - sPos; // don't go over end of sentence
@@ -359,9 +364,11 @@ CreateTranslationOptions()
       maxSize = std::min(maxSize, m_max_phrase_length);
 
       for (size_t ePos = sPos ; ePos < sPos + maxSize ; ePos++) {
-        if (gidx && backoff &&
-            (ePos-sPos+1 <= backoff || // size exceeds backoff limit (HUH? UG) or ...
-             m_collection[sPos][ePos-sPos].size() > 0)) {
+        if (IsDeferred(sPos, ePos)) {
+          m_pending[sPos][ePos-sPos] = true;
+          continue;
+        }
+        if (!UsesDecodeGraph(dg, gidx, sPos, ePos)) {
           VERBOSE(3,"No backoff to graph " << gidx << " for span [" << sPos << ";" << ePos << "]" << endl);
           continue;
         }
@@ -370,6 +377,18 @@ CreateTranslationOptions()
     }
   }
   ProcessUnknownWord();
+  if (m_lazy) {
+    // Future costs of longer spans are composed from the spans created
+    // now, mostly single words, so they do not depend on the lookups left
+    // for later.
+    for (size_t sPos = 0 ; sPos < size; ++sPos) {
+      for (size_t idx = 0 ; idx < m_pending[sPos].size(); ++idx) {
+        if (!m_pending[sPos][idx]) FinishRange(m_collection[sPos][idx]);
+      }
+    }
+    CalcEstimatedScore();
+    return;
+  }
   EvaluateWithSourceContext();
   VERBOSE(3,"Translation Option Collection\n " << *this << endl);
   Prune();
@@ -378,6 +397,81 @@ CreateTranslationOptions()
   CacheLexReordering(); // Cached lex reodering costs
 }
 
+/** Same as EvaluateWithSourceContext(), Prune(), Sort() and
+ * CacheLexReordering() together, for the options of one span.
+ */
+void
+TranslationOptionCollection::
+FinishRange(TranslationOptionList &tol)
+{
+  typedef TranslationOptionList::const_iterator to_iter;
+  for(to_iter i = tol.begin() ; i != tol.end() ; ++i)
+    (*i)->EvaluateWithSourceContext(m_source);
+  EvaluateTranslationOptionListWithSourceContext(tol);
+
+  static float no_th = -std::numeric_limits<float>::infinity();
+  if (m_maxNoTransOptPerCoverage != 0 || m_translationOptionThreshold != no_th) {
+    tol.SelectNBest(m_maxNoTransOptPerCoverage);
+    tol.PruneByThreshold(m_translationOptionThreshold);
+  }
+
+  static TranslationOption::Better cmp;
+  std::sort(tol.begin(), tol.end(), cmp);
+
+  typedef StatefulFeatureFunction sfFF;
+  BOOST_FOREACH(sfFF const* ff, sfFF::GetStatefulFeatureFunctions()) {
+    if (typeid(*ff) != typeid(LexicalReordering)) continue;
+    static_cast<const LexicalReordering&>(*ff).SetCache(tol);
+  }
+}
+
+/** In lazy mode, spans longer than one word are looked up when search
+ * first asks for them. Spans with XML options are not deferred, so that
+ * XML options keep counting towards future costs.
+ */
+bool
+TranslationOptionCollection::
+IsDeferred(size_t sPos, size_t ePos) const
+{
+  return m_lazy && ePos > sPos && !HasXmlOptionsOverlappingRange(sPos, ePos);
+}
+
+/** The part of CreateTranslationOptions() that lazy mode leaves until
+ * search first asks for a span.
+ */
+void
+TranslationOptionCollection::
+CreateDeferredRange(size_t sPos, size_t ePos)
+{
+  LookupRange(sPos, ePos);
+
+  const vector <DecodeGraph*> &decodeGraphList
+  = StaticData::Instance().GetDecodeGraphs();
+  for (size_t gidx = 0 ; gidx < decodeGraphList.size() ; gidx++) {
+    const DecodeGraph& dg = *decodeGraphList[gidx];
+    if (UsesDecodeGraph(dg, gidx, sPos, ePos))
+      CreateTranslationOptionsForRange(dg, sPos, ePos, true, gidx);
+  }
+  FinishRange(m_collection[sPos][ePos - sPos]);
+}
+
+void
+TranslationOptionCollection::
+LookupRange(size_t, size_t)
+{
+  UTIL_THROW2("Lazy translation options are not supported for this input type");
+}
+
+bool
+TranslationOptionCollection::
+UsesDecodeGraph(const DecodeGraph &decodeGraph, size_t gidx,
+                size_t sPos, size_t ePos) const
+{
+  size_t backoff = decodeGraph.GetBackoff();
+  return !(gidx && backoff &&
+           (ePos-sPos+1 <= backoff || // size exceeds backoff limit (HUH? UG) or ...
+            m_collection[sPos][ePos-sPos].size() > 0));
+}
 
 bool
 TranslationOptionCollection::
@@ -633,12 +727,29 @@ GetTranslationOptionList(size_t const sPos, size_t const ePos)
   UTIL_THROW_IF2(sPos >= m_collection.size(), "Out of bound access.");
   vector<TranslationOptionList>& tol = m_collection[sPos];
   size_t idx = ePos - sPos;
-  return idx < tol.size() ? &tol[idx] : NULL;
+  if (idx >= tol.size()) return NULL;
+  if (m_lazy) {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_pendingMutex);
+#endif
+    if (idx < m_pending[sPos].size() && m_pending[sPos][idx]) {
+      CreateDeferredRange(sPos, ePos);
+      m_pending[sPos][idx] = false;
+    }
+  }
+  return &tol[idx];
 }
 
 TranslationOptionList const*
 TranslationOptionCollection::
 GetTranslationOptionList(size_t sPos, size_t ePos) const
+{
+  return PeekTranslationOptionList(sPos, ePos);
+}
+
+TranslationOptionList const*
+TranslationOptionCollection::
+PeekTranslationOptionList(size_t sPos, size_t ePos) const
 {
   UTIL_THROW_IF2(sPos >= m_collection.size(), "Out of bound access.");
   vector<TranslationOptionList> const& tol = m_collection[sPos];
@@ -649,6 +760,13 @@ GetTranslationOptionList(size_t sPos, size_t ePos) const
 void
 TranslationOptionCollection::
 GetTargetPhraseCollectionBatch()
+{
+  GetTargetPhraseCollectionBatch(m_inputPathQueue);
+}
+
+void
+TranslationOptionCollection::
+GetTargetPhraseCollectionBatch(const InputPathList &inputPaths)
 {
   typedef DecodeStepTranslation Tstep;
   const vector <DecodeGraph*> &dgl = StaticData::Instance().GetDecodeGraphs();
@@ -658,7 +776,7 @@ GetTargetPhraseCollectionBatch()
       const Tstep* tstep = dynamic_cast<const Tstep *>(*i);
       if (tstep) {
         const PhraseDictionary &pdict = *tstep->GetPhraseDictionaryFeature();
-        pdict.GetTargetPhraseCollectionBatch(m_ttask.lock(), m_inputPathQueue);
+        pdict.GetTargetPhraseCollectionBatch(m_ttask.lock(), inputPaths);
       }
     }
   }
@@ -34,6 +34,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "DecodeStep.h"
 #include "InputPath.h"
 
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
+
 namespace Moses
 {
 
@@ -75,6 +79,11 @@ protected:
   size_t max_partial_trans_opt;
   std::vector<const Phrase*> m_unksrcs;
   InputPathList m_inputPathQueue;
+  bool m_lazy; /*< look up and create the options of longer spans only when search first asks for them */
+  std::vector< std::vector<bool> > m_pending; /*< spans whose options are not created yet (lazy mode only) */
+#ifdef WITH_THREADS
+  boost::mutex m_pendingMutex; /*< guards creation of pending spans */
+#endif
 
   TranslationOptionCollection(ttasksptr const& ttask, InputType const& src);
 
@@ -94,13 +103,21 @@ protected:
 public:
   // is there any good reason not to make these public? UG
 
-  //! list of trans opt for a particular span
+  //! list of trans opt for a particular span. In lazy mode, creates the
+  //! options of the span if this is the first time it is asked for.
   TranslationOptionList*
   GetTranslationOptionList(size_t startPos, size_t endPos);
 
+  //! as above, but never creates options: in lazy mode, spans that have
+  //! not been asked for through the non-const overload are empty.
   TranslationOptionList const*
   GetTranslationOptionList(size_t startPos, size_t endPos) const;
 
+  //! the list as it is now, even through a non-const collection. Good
+  //! enough to ask whether a span is within the phrase length limit.
+  TranslationOptionList const*
+  PeekTranslationOptionList(size_t startPos, size_t endPos) const;
+
 protected:
   void Add(TranslationOption *translationOption);
 
@@ -113,7 +130,26 @@ protected:
 
   void CacheLexReordering();
 
+  //! evaluation with source context, pruning, sorting and lexical
+  //! reordering cache of the options of one span
+  void FinishRange(TranslationOptionList &tol);
+
+  //! lazy mode: whether the span is left until search asks for it
+  bool IsDeferred(size_t sPos, size_t ePos) const;
+
+  //! lazy mode: look up, create and finish the options of a pending span
+  void CreateDeferredRange(size_t sPos, size_t ePos);
+
+  //! lazy mode: look up the span in the phrase tables. Only subclasses that
+  //! set m_lazy need to implement this.
+  virtual void LookupRange(size_t sPos, size_t ePos);
+
+  //! whether the decode graph gidx is used for the span, given its backoff
+  bool UsesDecodeGraph(const DecodeGraph &decodeGraph, size_t gidx,
+                       size_t sPos, size_t ePos) const;
+
   void GetTargetPhraseCollectionBatch();
+  void GetTargetPhraseCollectionBatch(const InputPathList &inputPaths);
 
   bool CreateTranslationOptionsForRange(
     const DecodeGraph &decodeGraph
@@ -168,6 +204,11 @@ public:
   }
 
   //! list of trans opt for a particular span
+  TranslationOptionList*
+  GetTranslationOptionList(const Range &coverage) {
+    return GetTranslationOptionList(coverage.GetStartPos(), coverage.GetEndPos());
+  }
+
   TranslationOptionList const*
   GetTranslationOptionList(const Range &coverage) const {
     return GetTranslationOptionList(coverage.GetStartPos(), coverage.GetEndPos());
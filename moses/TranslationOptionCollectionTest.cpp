@@ -0,0 +1,161 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+// Loads its own moses.ini into StaticData, so it is a test module of its
+// own rather than part of moses_test.
+#define BOOST_TEST_MODULE TranslationOptionCollection
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Parameter.h"
+#include "Sentence.h"
+#include "StaticData.h"
+#include "TranslationOptionCollection.h"
+#include "TranslationTask.h"
+#include "util/exception.hh"
+
+using namespace Moses;
+using namespace std;
+
+namespace
+{
+
+namespace fs = boost::filesystem;
+
+// A phrase table and configuration in a directory that goes away with it.
+struct LoadedModel {
+  fs::path dir;
+  Parameter param;
+
+  LoadedModel() : dir(fs::temp_directory_path() / fs::unique_path()) {
+    fs::create_directories(dir);
+    const string table = (dir / "phrase-table").string();
+    // "b c d" only exists as a prefix of "b c d e"; "c" and "e" are unknown
+    ofstream(table.c_str())
+        << "a ||| A ||| 0.5 0.5 0.5 0.5 ||| 0-0\n"
+        << "a ||| AA ||| 0.25 0.5 0.25 0.5 ||| 0-0\n"
+        << "a b ||| AB ||| 0.5 0.25 0.5 0.25 ||| 0-0 1-0\n"
+        << "a b ||| A B ||| 0.75 0.5 0.5 0.5 ||| 0-0 1-1\n"
+        << "a b ||| BA ||| 0.125 0.5 0.25 0.5 ||| 0-0 1-0\n"
+        << "a b c ||| ABC ||| 0.5 0.5 0.5 0.5 ||| 0-0 1-0 2-0\n"
+        << "b ||| B ||| 0.5 0.5 0.5 0.5 ||| 0-0\n"
+        << "b c ||| BC ||| 0.5 0.5 0.5 0.5 ||| 0-0 1-0\n"
+        << "b c d e ||| BCDE ||| 0.5 0.5 0.5 0.5 ||| 0-0 1-0 2-0 3-0\n"
+        << "c d ||| CD ||| 0.5 0.5 0.5 0.5 ||| 0-0 1-0\n"
+        << "d ||| D ||| 0.5 0.5 0.5 0.5 ||| 0-0\n";
+
+    const string ini = (dir / "moses.ini").string();
+    ofstream(ini.c_str())
+        << "[input-factors]\n0\n"
+        << "[mapping]\n0 T 0\n"
+        << "[distortion-limit]\n6\n"
+        << "[max-trans-opt-per-coverage]\n2\n"
+        << "[verbose]\n0\n"
+        << "[feature]\n"
+        << "UnknownWordPenalty\nWordPenalty\nPhrasePenalty\nDistortion\n"
+        << "PhraseDictionaryMemory name=TranslationModel0 num-features=4 path="
+        << table << " input-factor=0 output-factor=0 table-limit=20\n"
+        << "[weight]\n"
+        << "UnknownWordPenalty0= 1\nWordPenalty0= -0.5\nPhrasePenalty0= 0.2\n"
+        << "Distortion0= 0.3\nTranslationModel0= 0.2 0.2 0.2 0.2\n";
+
+    UTIL_THROW_IF2(!param.LoadParam(ini), "Cannot load " << ini);
+    UTIL_THROW_IF2(!StaticData::LoadDataStatic(&param, ini), "Cannot load static data from " << ini);
+  }
+
+  ~LoadedModel() {
+    fs::remove_all(dir);
+  }
+};
+
+BOOST_GLOBAL_FIXTURE(LoadedModel);
+
+struct Collection {
+  boost::shared_ptr<Sentence> sentence;
+  ttasksptr ttask;
+  boost::scoped_ptr<TranslationOptionCollection> coll;
+
+  Collection(const string &text, bool lazy) {
+    AllOptions *opts = new AllOptions(*StaticData::Instance().options());
+    opts->search.lazy_trans_opt = lazy;
+    sentence.reset(new Sentence(AllOptions::ptr(opts), 0, text));
+    ttask = TranslationTask::create(sentence);
+    coll.reset(sentence->CreateTranslationOptionCollection(ttask));
+    coll->CreateTranslationOptions();
+  }
+};
+
+vector<string> Describe(const TranslationOptionList &tol)
+{
+  const vector<FactorType> factors(1, 0);
+  vector<string> ret;
+  for (size_t i = 0; i < tol.size(); ++i) {
+    const TranslationOption &to = *tol.Get(i);
+    ostringstream desc;
+    desc << to.GetTargetPhrase().GetStringRep(factors) << " " << to.GetFutureScore();
+    ret.push_back(desc.str());
+  }
+  return ret;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(lazy_matches_eager)
+{
+  const string text = "a b c d e";
+  Collection eager(text, false);
+  Collection lazy(text, true);
+  const size_t size = 5;
+
+  // Nothing longer than a word has been looked up yet, and future costs of
+  // longer spans are composed from single words.
+  const SquareMatrix &eagerScores = eager.coll->GetEstimatedScores();
+  const SquareMatrix &lazyScores = lazy.coll->GetEstimatedScores();
+  for (size_t s = 0; s < size; ++s) {
+    BOOST_CHECK_EQUAL(eagerScores.GetScore(s, s), lazyScores.GetScore(s, s));
+    for (size_t e = s + 1; e < size; ++e) {
+      BOOST_CHECK_EQUAL(0U, lazy.coll->PeekTranslationOptionList(s, e)->size());
+    }
+  }
+  BOOST_CHECK_CLOSE(lazyScores.GetScore(0, 0) + lazyScores.GetScore(1, 1),
+                    lazyScores.GetScore(0, 1), 1e-4);
+
+  // Longest spans first, so lookups have to fill in the prefixes.
+  for (size_t s = size; s-- > 0; ) {
+    for (size_t e = size; e-- > s; ) {
+      BOOST_TEST_CHECKPOINT("span " << s << "-" << e);
+      const TranslationOptionList *want = eager.coll->GetTranslationOptionList(s, e);
+      const TranslationOptionList *got = lazy.coll->GetTranslationOptionList(s, e);
+      BOOST_REQUIRE(want && got);
+      vector<string> wantDesc = Describe(*want), gotDesc = Describe(*got);
+      BOOST_CHECK_EQUAL_COLLECTIONS(wantDesc.begin(), wantDesc.end(), gotDesc.begin(), gotDesc.end());
+    }
+  }
+
+  // pruned to the best two, and the prefix-only span has none
+  BOOST_CHECK_EQUAL(2U, lazy.coll->GetTranslationOptionList(0, 1)->size());
+  BOOST_CHECK_EQUAL(1U, lazy.coll->GetTranslationOptionList(1, 4)->size());
+  BOOST_CHECK_EQUAL(0U, lazy.coll->GetTranslationOptionList(1, 3)->size());
+}
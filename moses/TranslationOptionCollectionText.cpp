@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "FactorCollection.h"
 #include "Range.h"
 #include <list>
+#include <algorithm>
 #include "TranslationTask.h"
 
 using namespace std;
@@ -39,6 +40,7 @@ TranslationOptionCollectionText(ttasksptr const& ttask, Sentence const &input)
   : TranslationOptionCollection(ttask,input)
   // , maxNoTransOptPerCoverage, translationOptionThreshold)
 {
+  m_lazy = ttask->options()->search.lazy_trans_opt;
   size_t maxNoTransOptPerCoverage
   = ttask->options()->search.max_trans_opt_per_cov;
   float translationOptionThreshold
@@ -167,10 +169,56 @@ InputPath &TranslationOptionCollectionText::GetInputPath(size_t startPos, size_t
 
 void TranslationOptionCollectionText::CreateTranslationOptions()
 {
-  GetTargetPhraseCollectionBatch();
+  if (!m_lazy) {
+    GetTargetPhraseCollectionBatch();
+  } else {
+    // only the spans that are not deferred, mostly single words
+    size_t size = m_inputPathMatrix.size();
+    m_lookedUp.resize(size);
+    for (size_t startPos = 0; startPos < size; ++startPos) {
+      m_lookedUp[startPos].assign(m_inputPathMatrix[startPos].size(), false);
+    }
+    InputPathList inputPaths;
+    for (size_t startPos = 0; startPos < size; ++startPos) {
+      size_t maxSize = std::min(size - startPos, m_max_phrase_length);
+      for (size_t endPos = startPos; endPos < startPos + maxSize; ++endPos) {
+        if (!IsDeferred(startPos, endPos)) {
+          AddLookups(startPos, endPos, inputPaths);
+        }
+      }
+    }
+    GetTargetPhraseCollectionBatch(inputPaths);
+  }
   TranslationOptionCollection::CreateTranslationOptions();
 }
 
+/** Adds the paths of the span and of its prefixes that have not been looked
+ * up yet, shortest first: phrase tables may continue from the lookup of the
+ * path one word shorter.
+ */
+void
+TranslationOptionCollectionText::
+AddLookups(size_t startPos, size_t endPos, InputPathList &inputPaths)
+{
+  vector<bool> &lookedUp = m_lookedUp[startPos];
+  for (size_t pos = startPos; pos <= endPos; ++pos) {
+    if (lookedUp[pos - startPos]) continue;
+    lookedUp[pos - startPos] = true;
+    inputPaths.push_back(&GetInputPath(startPos, pos));
+  }
+}
+
+void
+TranslationOptionCollectionText::
+LookupRange(size_t startPos, size_t endPos)
+{
+  InputPathList inputPaths;
+  AddLookups(startPos, endPos, inputPaths);
+  if (!inputPaths.empty()) {
+    GetTargetPhraseCollectionBatch(inputPaths);
+  }
+}
+
 /** create translation options that exactly cover a specific input span.
  * Called by CreateTranslationOptions() and ProcessUnknownWord()
  * \param decodeGraph list of decoding steps
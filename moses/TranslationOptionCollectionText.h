@@ -42,9 +42,13 @@ public:
 
 protected:
   InputPathMatrix	m_inputPathMatrix; /*< contains translation options */
+  std::vector< std::vector<bool> > m_lookedUp; /*< paths already looked up in the phrase tables (lazy mode only) */
 
   InputPath &GetInputPath(size_t startPos, size_t endPos);
 
+  void AddLookups(size_t startPos, size_t endPos, InputPathList &inputPaths);
+  void LookupRange(size_t startPos, size_t endPos);
+
 public:
   void ProcessUnknownWord(size_t sourcePos);
 
@@ -255,6 +255,8 @@ void TranslationTask::Run()
 
   manager->OutputAlignment(io->GetAlignmentInfoCollector());
 
+  io->TranslationFinished(translationId);
+
   // report additional statistics
   manager->CalcDecoderStatistics();
   VERBOSE(1, "Line " << translationId << ": Additional reporting took "
@@ -17,6 +17,7 @@ namespace Moses
     , include_segmentation(false)
     , include_passthrough(false)
     , include_all_factors(false)
+    , binary(false)
   {}
 
 
@@ -44,6 +45,7 @@ init(Parameter const& P)
   P.SetParameter(include_passthrough, "print-passthrough-in-n-best", false );
   P.SetParameter(include_all_factors, "report-all-factors-in-n-best", false );
   P.SetParameter(print_trees, "n-best-trees", false );
+  P.SetParameter(binary, "n-best-binary", false );
 
   enabled = output_file_path.size();
   return true;
@@ -19,6 +19,7 @@ struct NBestOptions : public OptionsBaseClass
   bool include_passthrough;
 
   bool include_all_factors;
+  bool binary; // see moses/BinaryNBest.h
 
   std::string output_file_path;
 
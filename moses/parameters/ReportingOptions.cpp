@@ -22,6 +22,7 @@ namespace Moses {
     , PrintPassThrough(false)
     , include_lhs_in_search_graph(false)
     , lattice_sample_size(0)
+    , output_window(0)
   {
     factor_order.assign(1,0);
     factor_delimiter = "|";
@@ -80,6 +81,9 @@ namespace Moses {
     param.SetParameter(detailed_transrep_filepath, "translation-details", e);
     param.SetParameter(detailed_tree_transrep_filepath, 
                        "tree-translation-details", e);
+    param.SetParameter(incremental_search_stats_filepath,
+                       "incremental-search-stats", e);
+    param.SetParameter<size_t>(output_window, "output-window", 0);
 
     params = param.GetParam("lattice-samples");
     if (params) {
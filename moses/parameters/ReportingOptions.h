@@ -46,10 +46,17 @@ namespace Moses
     std::string detailed_all_transrep_filepath;
     bool include_lhs_in_search_graph;
 
+    // JSON statistics from the incremental search (search-algorithm 5)
+    std::string incremental_search_stats_filepath;
+
     
     std::string lattice_sample_filepath; 
     size_t lattice_sample_size;
 
+    // max. number of sentences decoded ahead of the oldest unfinished one,
+    // bounding the output the collectors hold back; 0: unlimited
+    size_t output_window;
+
     bool init(Parameter const& param);
 
     /// do we need to keep the search graph from decoding?
@@ -18,6 +18,7 @@ namespace Moses
     , consensus(false)
     , early_discarding_threshold(DEFAULT_EARLY_DISCARDING_THRESHOLD)
     , trans_opt_threshold(DEFAULT_TRANSLATION_OPTION_THRESHOLD)
+    , lazy_trans_opt(false)
   { }
 
   SearchOptions::
@@ -50,6 +51,7 @@ namespace Moses
 
     param.SetParameter(consensus, "consensus-decoding", false);
     param.SetParameter(disable_discarding, "disable-discarding", false);
+    param.SetParameter(lazy_trans_opt, "lazy-translation-options", false);
     
     // transformation to log of a few scores
     beam_width = TransformScore(beam_width);
@@ -35,6 +35,7 @@ namespace Moses
 
     float early_discarding_threshold;
     float trans_opt_threshold;
+    bool lazy_trans_opt; //! create translation options of longer spans on first use
 
     bool init(Parameter const& param);
     SearchOptions(Parameter const& param);
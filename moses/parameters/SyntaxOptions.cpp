@@ -15,6 +15,7 @@ namespace Moses {
     , default_non_term_only_for_empty_range(false)
     , source_label_overlap(SourceLabelOverlapAdd)
     , rule_limit(DEFAULT_MAX_TRANS_OPT_SIZE)
+    , s2t_span_threads(1)
   { }
 
   bool
@@ -24,6 +25,7 @@ namespace Moses {
     param.SetParameter(rule_limit, "rule-limit", DEFAULT_MAX_TRANS_OPT_SIZE);
     param.SetParameter(s2t_parsing_algo, "s2t-parsing-algorithm", 
                        RecursiveCYKPlus);
+    param.SetParameter<size_t>(s2t_span_threads, "s2t-span-threads", 1);
     param.SetParameter(default_non_term_only_for_empty_range,
                        "default-non-term-for-empty-range-only", false);
     param.SetParameter(source_label_overlap, "source-label-overlap", 
@@ -22,6 +22,7 @@ namespace Moses
     UnknownLHSList unknown_lhs;
     SourceLabelOverlap source_label_overlap; // m_sourceLabelOverlap;
     size_t rule_limit;
+    size_t s2t_span_threads; // threads per sentence for S2T chart search
 
     SyntaxOptions();
 
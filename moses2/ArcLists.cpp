@@ -113,6 +113,15 @@ void ArcLists::Delete(const HypothesisBase *hypo)
   delete arcList;
 }
 
+void ArcLists::Merge(ArcLists &other)
+{
+  BOOST_FOREACH(const Coll::value_type &collPair, other.m_coll) {
+    bool inserted = m_coll.insert(collPair).second;
+    UTIL_THROW_IF2(!inserted, "Hypothesis is in two arc lists");
+  }
+  other.m_coll.clear();
+}
+
 std::string ArcLists::Debug(const System &system) const
 {
   stringstream strm;
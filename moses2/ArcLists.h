@@ -28,6 +28,9 @@ public:
   void Sort();
   void Delete(const HypothesisBase *hypo);
 
+  // Take over the arc lists of other, which must be for other hypotheses.
+  void Merge(ArcLists &other);
+
   const ArcList &GetArcList(const HypothesisBase *hypo) const;
 
   std::string Debug(const System &system) const;
@@ -74,6 +74,10 @@ extern "C" EXPORT MosesApiErrorCode __stdcall EngineVersion() {
 	return MS_API_OK;
 }
 
+// A driver for the API above. It is only built with MOSES2_DLL_MAIN, since
+// in moses2_lib it would be linked as the main of other programs, such as
+// the unit tests.
+#ifdef MOSES2_DLL_MAIN
 int main(int argc, char** argv)
 {
 	assert(argc >= 2);
@@ -105,4 +109,5 @@ int main(int argc, char** argv)
 	assert(ret == MS_API_OK);
 
 	cerr << "Finished" << endl;
-}
\ No newline at end of file
+}
+#endif
@@ -56,7 +56,7 @@ void HypothesisColl::Add(
 
   if (GetSize() > maxStackSize * 2) {
     //cerr << "maxStackSize=" << maxStackSize << " " << GetSize() << endl;
-    PruneHypos(mgr, mgr.arcLists);
+    PruneHypos(mgr, arcLists);
   }
 
   SCORE futureScore = hypo->GetFutureScore();
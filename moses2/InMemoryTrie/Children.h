@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <boost/unordered_map.hpp>
+
+namespace Moses2
+{
+
+// Containers for the children of an InMemoryTrie node, picked at compile
+// time through the ChildrenPolicy template parameter. Each maps a key to a
+// child pointer and provides find(), insert() and forEach().
+
+// Hash map from key to child. Works for any hashable key and inserts in
+// constant time; the default.
+template<class KeyClass, class NodePtr>
+class HashedChildren
+{
+public:
+  NodePtr find(const KeyClass &key) const {
+    typename Coll::const_iterator iter = m_coll.find(key);
+    return iter == m_coll.end() ? NULL : iter->second;
+  }
+
+  void insert(const KeyClass &key, NodePtr node) {
+    m_coll[key] = node;
+  }
+
+  template<class Func>
+  void forEach(Func &func) const {
+    typename Coll::const_iterator iter;
+    for (iter = m_coll.begin(); iter != m_coll.end(); ++iter) {
+      func(iter->first, iter->second);
+    }
+  }
+
+  size_t size() const {
+    return m_coll.size();
+  }
+
+protected:
+  typedef boost::unordered_map<KeyClass, NodePtr> Coll;
+  Coll m_coll;
+};
+
+// Vector of (key, child) pairs kept sorted by key. Much smaller than a hash
+// map and fast to search for the small fan-outs of deep nodes, but inserting
+// is linear in the number of children.
+template<class KeyClass, class NodePtr>
+class SortedChildren
+{
+public:
+  NodePtr find(const KeyClass &key) const {
+    typename Coll::const_iterator iter = lower_bound(key);
+    return (iter == m_coll.end() || iter->first != key) ? NULL : iter->second;
+  }
+
+  void insert(const KeyClass &key, NodePtr node) {
+    typename Coll::iterator iter = m_coll.begin() + (lower_bound(key) - m_coll.begin());
+    if (iter != m_coll.end() && iter->first == key) {
+      iter->second = node;
+    } else {
+      m_coll.insert(iter, std::make_pair(key, node));
+    }
+  }
+
+  template<class Func>
+  void forEach(Func &func) const {
+    for (size_t i = 0; i < m_coll.size(); ++i) {
+      func(m_coll[i].first, m_coll[i].second);
+    }
+  }
+
+  size_t size() const {
+    return m_coll.size();
+  }
+
+protected:
+  typedef std::vector<std::pair<KeyClass, NodePtr> > Coll;
+  Coll m_coll;
+
+  struct KeyLess {
+    bool operator()(const std::pair<KeyClass, NodePtr> &a, const KeyClass &b) const {
+      return a.first < b;
+    }
+  };
+
+  typename Coll::const_iterator lower_bound(const KeyClass &key) const {
+    if (m_coll.size() <= 8) {
+      typename Coll::const_iterator iter = m_coll.begin();
+      while (iter != m_coll.end() && iter->first < key) {
+        ++iter;
+      }
+      return iter;
+    }
+    return std::lower_bound(m_coll.begin(), m_coll.end(), key, KeyLess());
+  }
+};
+
+// Direct array of Fanout children, indexed by the key itself. For integral
+// keys that are known to be smaller than Fanout, e.g. bytes or the ids of a
+// small vocabulary. Use as FixedFanout<N>::Children.
+template<size_t Fanout>
+struct FixedFanout {
+  template<class KeyClass, class NodePtr>
+  class Children
+  {
+  public:
+    Children() {
+      std::fill(m_coll, m_coll + Fanout, NodePtr(NULL));
+    }
+
+    NodePtr find(const KeyClass &key) const {
+      size_t ind = static_cast<size_t>(key);
+      return ind < Fanout ? m_coll[ind] : NULL;
+    }
+
+    void insert(const KeyClass &key, NodePtr node) {
+      size_t ind = static_cast<size_t>(key);
+      assert(ind < Fanout);
+      m_coll[ind] = node;
+    }
+
+    template<class Func>
+    void forEach(Func &func) const {
+      for (size_t i = 0; i < Fanout; ++i) {
+        if (m_coll[i]) {
+          func(static_cast<KeyClass>(i), m_coll[i]);
+        }
+      }
+    }
+
+    size_t size() const {
+      return Fanout - std::count(m_coll, m_coll + Fanout, NodePtr(NULL));
+    }
+
+  protected:
+    NodePtr m_coll[Fanout];
+  };
+};
+
+}
+
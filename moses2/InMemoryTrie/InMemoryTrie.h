@@ -2,58 +2,105 @@
 
 #include <vector>
 #include "Node.h"
+#include "NodeAllocator.h"
 
 namespace Moses2
 {
 
-template<class KeyClass, class ValueClass>
+// Trie from sequences of keys to values. How the children of a node are
+// stored (HashedChildren, SortedChildren, FixedFanout<N>::Children) and how
+// nodes are allocated (HeapNodeAllocator, PooledNodeAllocator) are chosen
+// at compile time.
+template<class KeyClass, class ValueClass,
+         template<class, class> class ChildrenPolicy = HashedChildren,
+         template<class> class AllocatorPolicy = HeapNodeAllocator>
 class InMemoryTrie
 {
 public:
+  typedef Moses2::Node<KeyClass, ValueClass, ChildrenPolicy> Node;
+
   InMemoryTrie() {
   }
-  Node<KeyClass, ValueClass>* insert(const std::vector<KeyClass>& word,
-                                     const ValueClass& value);
-  const Node<KeyClass, ValueClass>* getNode(
+  ~InMemoryTrie() {
+    m_alloc.clear(root);
+  }
+  Node* insert(const std::vector<KeyClass>& word,
+               const ValueClass& value);
+  const Node* getNode(
     const std::vector<KeyClass>& words) const;
-  const Node<KeyClass, ValueClass> &getNode(const std::vector<KeyClass>& words,
-      size_t &stoppedAtInd) const;
-  std::vector<const Node<KeyClass, ValueClass>*> getNodes(
+  const Node &getNode(const std::vector<KeyClass>& words,
+                      size_t &stoppedAtInd) const;
+  std::vector<const Node*> getNodes(
     const std::vector<KeyClass>& words, size_t &stoppedAtInd) const;
+
+  // Calls callback(depth, node) for the root (depth 0) and for the node of
+  // each prefix of [begin, end) that is in the trie, longest last. Returns
+  // the length of the longest prefix found. Allocates nothing, unlike
+  // getNodes().
+  template<class Iterator, class Callback>
+  size_t walkPrefixes(Iterator begin, Iterator end, Callback &callback) const;
+
+  template<class Callback>
+  size_t walkPrefixes(const std::vector<KeyClass>& words, Callback &callback) const {
+    return walkPrefixes(words.begin(), words.end(), callback);
+  }
+
 private:
-  Node<KeyClass, ValueClass> root;
+  Node root;
+  AllocatorPolicy<Node> m_alloc;
+
+  struct CollectNodes {
+    std::vector<const Node*> &nodes;
+    CollectNodes(std::vector<const Node*> &vnodes) : nodes(vnodes) {}
+    void operator()(size_t depth, const Node &node) {
+      nodes.push_back(&node);
+    }
+  };
+
+  // nodes are owned by m_alloc
+  InMemoryTrie(const InMemoryTrie&);
+  InMemoryTrie &operator=(const InMemoryTrie&);
 };
 
-template<class KeyClass, class ValueClass>
-Node<KeyClass, ValueClass>* InMemoryTrie<KeyClass, ValueClass>::insert(
+template<class KeyClass, class ValueClass,
+         template<class, class> class ChildrenPolicy,
+         template<class> class AllocatorPolicy>
+typename InMemoryTrie<KeyClass, ValueClass, ChildrenPolicy, AllocatorPolicy>::Node*
+InMemoryTrie<KeyClass, ValueClass, ChildrenPolicy, AllocatorPolicy>::insert(
   const std::vector<KeyClass>& word, const ValueClass& value)
 {
-  Node<KeyClass, ValueClass>* cNode = &root;
+  Node* cNode = &root;
   for (size_t i = 0; i < word.size(); ++i) {
     KeyClass cKey = word[i];
-    cNode = cNode->addSubnode(cKey);
+    cNode = cNode->addSubnode(cKey, m_alloc);
   }
   cNode->setValue(value);
   return cNode;
 }
 
-template<class KeyClass, class ValueClass>
-const Node<KeyClass, ValueClass>* InMemoryTrie<KeyClass, ValueClass>::getNode(
+template<class KeyClass, class ValueClass,
+         template<class, class> class ChildrenPolicy,
+         template<class> class AllocatorPolicy>
+const typename InMemoryTrie<KeyClass, ValueClass, ChildrenPolicy, AllocatorPolicy>::Node*
+InMemoryTrie<KeyClass, ValueClass, ChildrenPolicy, AllocatorPolicy>::getNode(
   const std::vector<KeyClass>& words) const
 {
   size_t stoppedAtInd;
-  const Node<KeyClass, ValueClass> &ret = getNode(words, stoppedAtInd);
+  const Node &ret = getNode(words, stoppedAtInd);
   if (stoppedAtInd < words.size()) {
     return NULL;
   }
   return &ret;
 }
 
-template<class KeyClass, class ValueClass>
-const Node<KeyClass, ValueClass> &InMemoryTrie<KeyClass, ValueClass>::getNode(
+template<class KeyClass, class ValueClass,
+         template<class, class> class ChildrenPolicy,
+         template<class> class AllocatorPolicy>
+const typename InMemoryTrie<KeyClass, ValueClass, ChildrenPolicy, AllocatorPolicy>::Node &
+InMemoryTrie<KeyClass, ValueClass, ChildrenPolicy, AllocatorPolicy>::getNode(
   const std::vector<KeyClass>& words, size_t &stoppedAtInd) const
 {
-  const Node<KeyClass, ValueClass> *prevNode = &root, *newNode;
+  const Node *prevNode = &root, *newNode;
   for (size_t i = 0; i < words.size(); ++i) {
     const KeyClass &cKey = words[i];
     newNode = prevNode->findSub(cKey);
@@ -65,31 +112,40 @@ const Node<KeyClass, ValueClass> &InMemoryTrie<KeyClass, ValueClass>::getNode(
   }
 
   stoppedAtInd = words.size();
-  return *newNode;
+  return *prevNode;
 }
 
-template<class KeyClass, class ValueClass>
-std::vector<const Node<KeyClass, ValueClass>*> InMemoryTrie<KeyClass, ValueClass>::getNodes(
+template<class KeyClass, class ValueClass,
+         template<class, class> class ChildrenPolicy,
+         template<class> class AllocatorPolicy>
+std::vector<const typename InMemoryTrie<KeyClass, ValueClass, ChildrenPolicy, AllocatorPolicy>::Node*>
+InMemoryTrie<KeyClass, ValueClass, ChildrenPolicy, AllocatorPolicy>::getNodes(
   const std::vector<KeyClass>& words, size_t &stoppedAtInd) const
 {
-  std::vector<const Node<KeyClass, ValueClass>*> ret;
-  const Node<KeyClass, ValueClass> *prevNode = &root, *newNode;
-  ret.push_back(prevNode);
+  std::vector<const Node*> ret;
+  CollectNodes collect(ret);
+  stoppedAtInd = walkPrefixes(words, collect);
+  return ret;
+}
 
-  for (size_t i = 0; i < words.size(); ++i) {
-    const KeyClass &cKey = words[i];
-    newNode = prevNode->findSub(cKey);
-    if (newNode == NULL) {
-      stoppedAtInd = i;
-      return ret;
-    } else {
-      ret.push_back(newNode);
+template<class KeyClass, class ValueClass,
+         template<class, class> class ChildrenPolicy,
+         template<class> class AllocatorPolicy>
+template<class Iterator, class Callback>
+size_t InMemoryTrie<KeyClass, ValueClass, ChildrenPolicy, AllocatorPolicy>::walkPrefixes(
+  Iterator begin, Iterator end, Callback &callback) const
+{
+  const Node *node = &root;
+  size_t depth = 0;
+  callback(depth, *node);
+  for (Iterator iter = begin; iter != end; ++iter) {
+    node = node->findSub(*iter);
+    if (node == NULL) {
+      break;
     }
-    prevNode = newNode;
+    callback(++depth, *node);
   }
-
-  stoppedAtInd = words.size();
-  return ret;
+  return depth;
 }
 
 }
@@ -0,0 +1,232 @@
+#include "InMemoryTrie.h"
+
+#define BOOST_TEST_MODULE InMemoryTrie
+#include <boost/test/unit_test.hpp>
+#include <boost/mpl/list.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+using namespace Moses2;
+
+namespace
+{
+
+typedef unsigned int Key;
+typedef std::vector<Key> Keys;
+
+template<template<class, class> class ChildrenPolicy,
+         template<class> class AllocatorPolicy>
+struct Policies {
+  typedef InMemoryTrie<Key, int, ChildrenPolicy, AllocatorPolicy> Trie;
+};
+
+typedef boost::mpl::list<
+  Policies<HashedChildren, HeapNodeAllocator>,
+  Policies<SortedChildren, HeapNodeAllocator>,
+  Policies<FixedFanout<64>::Children, HeapNodeAllocator>,
+  Policies<HashedChildren, PooledNodeAllocator>,
+  Policies<SortedChildren, PooledNodeAllocator>,
+  Policies<FixedFanout<64>::Children, PooledNodeAllocator>
+  > AllPolicies;
+
+Keys MakeKeys(Key a, Key b = 64, Key c = 64)
+{
+  Keys ret(1, a);
+  if (b < 64) ret.push_back(b);
+  if (c < 64) ret.push_back(c);
+  return ret;
+}
+
+struct Visit {
+  std::vector<std::pair<size_t, int> > visited;
+  template<class NodeT>
+  void operator()(size_t depth, const NodeT &node) {
+    visited.push_back(std::make_pair(depth, node.getValue()));
+  }
+};
+
+struct CollectKeys {
+  std::vector<Key> keys;
+  template<class NodePtr>
+  void operator()(const Key &key, NodePtr) {
+    keys.push_back(key);
+  }
+};
+
+// Counts live instances to check what allocators destroy.
+struct Counted {
+  static int live;
+  int value;
+  Counted() : value(7) {
+    ++live;
+  }
+  ~Counted() {
+    --live;
+  }
+};
+int Counted::live = 0;
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(insert_and_find, P, AllPolicies)
+{
+  typename P::Trie trie;
+  trie.insert(MakeKeys(3), 1);
+  trie.insert(MakeKeys(3, 5), 2);
+  trie.insert(MakeKeys(3, 5, 63), 3);
+  trie.insert(MakeKeys(0, 5), 4);
+  // overwrite
+  trie.insert(MakeKeys(3, 5), 5);
+
+  BOOST_REQUIRE(trie.getNode(MakeKeys(3)));
+  BOOST_CHECK_EQUAL(1, trie.getNode(MakeKeys(3))->getValue());
+  BOOST_CHECK_EQUAL(5, trie.getNode(MakeKeys(3, 5))->getValue());
+  BOOST_CHECK_EQUAL(3, trie.getNode(MakeKeys(3, 5, 63))->getValue());
+  BOOST_CHECK_EQUAL(4, trie.getNode(MakeKeys(0, 5))->getValue());
+  BOOST_CHECK(!trie.getNode(MakeKeys(5)));
+  BOOST_CHECK(!trie.getNode(MakeKeys(3, 6)));
+
+  size_t stoppedAtInd;
+  const typename P::Trie::Node &node = trie.getNode(MakeKeys(3, 5, 62), stoppedAtInd);
+  BOOST_CHECK_EQUAL(2U, stoppedAtInd);
+  BOOST_CHECK_EQUAL(5, node.getValue());
+
+  std::vector<const typename P::Trie::Node*> nodes = trie.getNodes(MakeKeys(0, 5, 1), stoppedAtInd);
+  BOOST_CHECK_EQUAL(2U, stoppedAtInd);
+  BOOST_REQUIRE_EQUAL(3U, nodes.size());
+  BOOST_CHECK_EQUAL(4, nodes[2]->getValue());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(walk_prefixes, P, AllPolicies)
+{
+  typename P::Trie trie;
+  trie.insert(MakeKeys(1), 10);
+  trie.insert(MakeKeys(1, 2, 3), 30);
+
+  // The node of (1, 2) exists without a value of its own.
+  Visit visit;
+  BOOST_CHECK_EQUAL(3U, trie.walkPrefixes(MakeKeys(1, 2, 3), visit));
+  BOOST_REQUIRE_EQUAL(4U, visit.visited.size());
+  for (size_t i = 0; i < visit.visited.size(); ++i) {
+    BOOST_CHECK_EQUAL(i, visit.visited[i].first);
+  }
+  BOOST_CHECK_EQUAL(10, visit.visited[1].second);
+  BOOST_CHECK_EQUAL(30, visit.visited[3].second);
+
+  // Stops at the first key that is missing, even if a later one would match.
+  Visit partial;
+  Keys query = MakeKeys(1, 4, 3);
+  BOOST_CHECK_EQUAL(1U, trie.walkPrefixes(query.begin(), query.end(), partial));
+  BOOST_CHECK_EQUAL(2U, partial.visited.size());
+
+  // Only the root for an empty range or an unknown first key.
+  Visit none;
+  BOOST_CHECK_EQUAL(0U, trie.walkPrefixes(query.begin(), query.begin(), none));
+  BOOST_CHECK_EQUAL(0U, trie.walkPrefixes(MakeKeys(9), none));
+  BOOST_CHECK_EQUAL(2U, none.visited.size());
+}
+
+BOOST_AUTO_TEST_CASE(sorted_children)
+{
+  // Searched linearly up to 8 children and by binary search above that.
+  typedef SortedChildren<Key, int*> Children;
+  int nodes[40];
+  Children children;
+  for (Key i = 0; i < 20; ++i) {
+    Key key = (i * 7) % 20 * 2;
+    children.insert(key, &nodes[key]);
+    BOOST_REQUIRE_EQUAL(i + 1, children.size());
+    for (Key k = 0; k < 40; ++k) {
+      bool inserted = false;
+      for (Key j = 0; j <= i; ++j) {
+        inserted |= ((j * 7) % 20 * 2 == k);
+      }
+      BOOST_CHECK_EQUAL(inserted ? &nodes[k] : NULL, children.find(k));
+    }
+  }
+  BOOST_CHECK(!children.find(41));
+
+  children.insert(6, &nodes[7]);
+  BOOST_CHECK_EQUAL(20U, children.size());
+  BOOST_CHECK_EQUAL(&nodes[7], children.find(6));
+
+  CollectKeys collect;
+  children.forEach(collect);
+  BOOST_REQUIRE_EQUAL(20U, collect.keys.size());
+  BOOST_CHECK(std::adjacent_find(collect.keys.begin(), collect.keys.end(), std::greater_equal<Key>())
+              == collect.keys.end());
+}
+
+BOOST_AUTO_TEST_CASE(fixed_fanout)
+{
+  typedef FixedFanout<8>::Children<Key, int*> Children;
+  int nodes[8];
+  Children children;
+  BOOST_CHECK_EQUAL(0U, children.size());
+  children.insert(7, &nodes[7]);
+  children.insert(0, &nodes[0]);
+  BOOST_CHECK_EQUAL(2U, children.size());
+  BOOST_CHECK_EQUAL(&nodes[7], children.find(7));
+  BOOST_CHECK_EQUAL(&nodes[0], children.find(0));
+  BOOST_CHECK(!children.find(3));
+  // keys past the fan-out are never there
+  BOOST_CHECK(!children.find(8));
+  BOOST_CHECK(!children.find(1000));
+
+  CollectKeys collect;
+  children.forEach(collect);
+  BOOST_REQUIRE_EQUAL(2U, collect.keys.size());
+  BOOST_CHECK_EQUAL(0U, collect.keys[0]);
+  BOOST_CHECK_EQUAL(7U, collect.keys[1]);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_node_allocator)
+{
+  const size_t num = 2 * PooledNodeAllocator<Counted>::BlockSize + 3;
+  {
+    PooledNodeAllocator<Counted> alloc;
+    std::vector<Counted*> got;
+    for (size_t i = 0; i < num; ++i) {
+      got.push_back(alloc.allocate());
+      BOOST_CHECK_EQUAL(7, got.back()->value);
+      got.back()->value = i;
+    }
+    BOOST_CHECK_EQUAL(static_cast<int>(num), Counted::live);
+    for (size_t i = 0; i < num; ++i) {
+      BOOST_CHECK_EQUAL(static_cast<int>(i), got[i]->value);
+    }
+    Counted root;
+    alloc.clear(root);
+    BOOST_CHECK_EQUAL(1, Counted::live);
+
+    // usable again after clear
+    alloc.allocate();
+    BOOST_CHECK_EQUAL(2, Counted::live);
+  }
+  // the destructor releases what is left
+  BOOST_CHECK_EQUAL(0, Counted::live);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_trie_spans_blocks)
+{
+  typedef InMemoryTrie<Key, int, SortedChildren, PooledNodeAllocator> Trie;
+  Trie trie;
+  // 64 + 64 * 64 + 64 * 64 * 2 nodes, several blocks
+  for (Key a = 0; a < 64; ++a) {
+    for (Key b = 0; b < 64; ++b) {
+      for (Key c = 0; c < 2; ++c) {
+        trie.insert(MakeKeys(a, b, c), a * 128 + b * 2 + c);
+      }
+    }
+  }
+  for (Key a = 0; a < 64; a += 7) {
+    for (Key b = 0; b < 64; b += 5) {
+      BOOST_REQUIRE(trie.getNode(MakeKeys(a, b, 1)));
+      BOOST_CHECK_EQUAL(static_cast<int>(a * 128 + b * 2 + 1), trie.getNode(MakeKeys(a, b, 1))->getValue());
+      BOOST_CHECK(!trie.getNode(MakeKeys(a, b, 2)));
+    }
+  }
+}
@@ -3,83 +3,62 @@
 #include <vector>
 #include <boost/unordered_map.hpp>
 #include <boost/foreach.hpp>
+#include "Children.h"
 
 namespace Moses2
 {
 
-template<class KeyClass, class ValueClass>
+// Node of an InMemoryTrie. The nodes below it are owned by the trie's
+// allocator, not by the node.
+template<class KeyClass, class ValueClass,
+         template<class, class> class ChildrenPolicy = HashedChildren>
 class Node
 {
 public:
+  typedef ChildrenPolicy<KeyClass, Node*> Children;
+
   Node() {
   }
   Node(const ValueClass& value) :
     m_value(value) {
   }
-  ~Node();
   void setKey(const KeyClass& key);
   void setValue(const ValueClass& value) {
     m_value = value;
   }
-  Node* findSub(const KeyClass& key);
-  const Node* findSub(const KeyClass& key) const;
-  Node *addSubnode(const KeyClass& cKey) {
+  Node* findSub(const KeyClass& key) {
+    return subNodes.find(key);
+  }
+  const Node* findSub(const KeyClass& key) const {
+    return subNodes.find(key);
+  }
+  template<class Allocator>
+  Node *addSubnode(const KeyClass& cKey, Allocator &alloc) {
     Node *node = findSub(cKey);
     if (node) {
       return node;
     } else {
-      node = new Node();
-      subNodes[cKey] = node;
+      node = alloc.allocate();
+      subNodes.insert(cKey, node);
       return node;
     }
   }
 
-  std::vector<Node*> getSubnodes();
+  // func(key, node) for every child
+  template<class Func>
+  void forEachSubnode(Func &func) const {
+    subNodes.forEach(func);
+  }
+
   const ValueClass &getValue() const {
     return m_value;
   }
 
 private:
-  boost::unordered_map<KeyClass, Node*> subNodes;
+  Children subNodes;
   ValueClass m_value;
 
 };
 
-template<class KeyClass, class ValueClass>
-Node<KeyClass, ValueClass>::~Node()
-{
-  typename boost::unordered_map<KeyClass, Node*>::iterator iter;
-  for (iter = subNodes.begin(); iter != subNodes.end(); ++iter) {
-    Node *node = iter->second;
-    delete node;
-  }
-}
-
-template<class KeyClass, class ValueClass>
-const Node<KeyClass, ValueClass>* Node<KeyClass, ValueClass>::findSub(
-  const KeyClass& cKey) const
-{
-  typename boost::unordered_map<KeyClass, Node*>::const_iterator iter;
-  iter = subNodes.find(cKey);
-  if (iter != subNodes.end()) {
-    Node *node = iter->second;
-    return node;
-  }
-  return NULL;
-}
-
-template<class KeyClass, class ValueClass>
-Node<KeyClass, ValueClass>* Node<KeyClass, ValueClass>::findSub(
-  const KeyClass& cKey)
-{
-  typename boost::unordered_map<KeyClass, Node*>::iterator iter;
-  iter = subNodes.find(cKey);
-  if (iter != subNodes.end()) {
-    Node *node = iter->second;
-    return node;
-  }
-  return NULL;
-}
-
 }
 
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace Moses2
+{
+
+// Allocators for the nodes of an InMemoryTrie, picked at compile time
+// through the AllocatorPolicy template parameter. allocate() returns a
+// default-constructed node, clear() destroys every node allocated below the
+// given root.
+
+// One heap allocation per node.
+template<class NodeT>
+class HeapNodeAllocator
+{
+public:
+  NodeT *allocate() {
+    return new NodeT();
+  }
+
+  void clear(NodeT &root) {
+    Deleter deleter;
+    root.forEachSubnode(deleter);
+  }
+
+protected:
+  struct Deleter {
+    template<class KeyClass>
+    void operator()(const KeyClass &key, NodeT *node) {
+      node->forEachSubnode(*this);
+      delete node;
+    }
+  };
+};
+
+// Nodes are carved out of blocks of BlockSize nodes and all released
+// together, which saves the per-node malloc overhead and keeps nodes that
+// were inserted together close in memory.
+template<class NodeT>
+class PooledNodeAllocator
+{
+public:
+  static const size_t BlockSize = 4096;
+
+  PooledNodeAllocator()
+    :m_used(BlockSize)
+  {}
+
+  ~PooledNodeAllocator() {
+    Release();
+  }
+
+  NodeT *allocate() {
+    if (m_used == BlockSize) {
+      m_blocks.push_back(static_cast<NodeT*>(malloc(sizeof(NodeT) * BlockSize)));
+      if (m_blocks.back() == NULL) {
+        m_blocks.pop_back();
+        throw std::bad_alloc();
+      }
+      m_used = 0;
+    }
+    NodeT *ret = new (m_blocks.back() + m_used) NodeT();
+    ++m_used;
+    return ret;
+  }
+
+  void clear(NodeT &root) {
+    Release();
+  }
+
+protected:
+  std::vector<NodeT*> m_blocks;
+  size_t m_used; // nodes constructed in the last block
+
+  void Release() {
+    for (size_t i = 0; i < m_blocks.size(); ++i) {
+      size_t num = (i + 1 == m_blocks.size()) ? m_used : BlockSize;
+      for (size_t j = 0; j < num; ++j) {
+        m_blocks[i][j].~NodeT();
+      }
+      free(m_blocks[i]);
+    }
+    m_blocks.clear();
+    m_used = BlockSize;
+  }
+
+private:
+  PooledNodeAllocator(const PooledNodeAllocator&);
+  PooledNodeAllocator &operator=(const PooledNodeAllocator&);
+};
+
+}
+
@@ -0,0 +1,111 @@
+// Compares the child and allocator policies of InMemoryTrie on random
+// n-grams over a small vocabulary.
+// Usage: in_memory_trie_benchmark [n-grams] [order]
+#include "InMemoryTrie.h"
+#include "util/usage.hh"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+namespace Moses2
+{
+namespace
+{
+
+typedef unsigned int Key;
+const size_t VocabSize = 64;
+
+struct SumDepths {
+  size_t sum;
+  SumDepths() : sum(0) {}
+  template<class NodeT>
+  void operator()(size_t depth, const NodeT &node) {
+    sum += depth + node.getValue();
+  }
+};
+
+template<class Trie>
+size_t Test(const char *name, const std::vector<std::vector<Key> > &ngrams,
+            const std::vector<std::vector<Key> > &queries)
+{
+  size_t meaningless = 0;
+  double start = util::CPUTime();
+  {
+    Trie trie;
+    for (size_t i = 0; i < ngrams.size(); ++i) {
+      trie.insert(ngrams[i], i);
+    }
+    double inserted = util::CPUTime();
+
+    for (size_t i = 0; i < queries.size(); ++i) {
+      const typename Trie::Node *node = trie.getNode(queries[i]);
+      meaningless += node ? node->getValue() : 0;
+    }
+    double looked_up = util::CPUTime();
+
+    for (size_t i = 0; i < queries.size(); ++i) {
+      size_t stoppedAtInd;
+      std::vector<const typename Trie::Node*> nodes = trie.getNodes(queries[i], stoppedAtInd);
+      meaningless += nodes.size() + nodes.back()->getValue();
+    }
+    double got_nodes = util::CPUTime();
+
+    SumDepths walk;
+    for (size_t i = 0; i < queries.size(); ++i) {
+      meaningless += trie.walkPrefixes(queries[i], walk);
+    }
+    meaningless += walk.sum;
+    double walked = util::CPUTime();
+
+    std::cout << name
+              << '\t' << (inserted - start)
+              << '\t' << (looked_up - inserted)
+              << '\t' << (got_nodes - looked_up)
+              << '\t' << (walked - got_nodes);
+    start = util::CPUTime();
+  }
+  std::cout << '\t' << (util::CPUTime() - start) << std::endl;
+  return meaningless;
+}
+
+std::vector<std::vector<Key> > Random(boost::random::mt19937 &rng, size_t num, size_t order)
+{
+  // Squaring a uniform draw skews towards low ids, so that the nodes near
+  // the root have many children and the deep ones few, as with real n-grams.
+  boost::random::uniform_int_distribution<Key> dist(0, VocabSize - 1);
+  std::vector<std::vector<Key> > ret(num);
+  for (size_t i = 0; i < num; ++i) {
+    ret[i].resize(order);
+    for (size_t j = 0; j < order; ++j) {
+      Key k = dist(rng);
+      ret[i][j] = k * k / VocabSize;
+    }
+  }
+  return ret;
+}
+
+} // namespace
+} // namespace Moses2
+
+int main(int argc, char *argv[])
+{
+  using namespace Moses2;
+  size_t num = argc > 1 ? strtoul(argv[1], NULL, 10) : 200000;
+  size_t order = argc > 2 ? strtoul(argv[2], NULL, 10) : 5;
+
+  boost::random::mt19937 rng;
+  std::vector<std::vector<Key> > ngrams = Random(rng, num, order);
+  std::vector<std::vector<Key> > queries = Random(rng, num, order);
+
+  size_t meaningless = 0;
+  std::cout << "#CPU seconds\n#policy\tinsert\tgetNode\tgetNodes\twalkPrefixes\tdestroy\n";
+  meaningless += Test<InMemoryTrie<Key, size_t, HashedChildren, HeapNodeAllocator> >("hashed,heap", ngrams, queries);
+  meaningless += Test<InMemoryTrie<Key, size_t, HashedChildren, PooledNodeAllocator> >("hashed,pooled", ngrams, queries);
+  meaningless += Test<InMemoryTrie<Key, size_t, SortedChildren, HeapNodeAllocator> >("sorted,heap", ngrams, queries);
+  meaningless += Test<InMemoryTrie<Key, size_t, SortedChildren, PooledNodeAllocator> >("sorted,pooled", ngrams, queries);
+  meaningless += Test<InMemoryTrie<Key, size_t, FixedFanout<VocabSize>::Children, PooledNodeAllocator> >("fixed,pooled", ngrams, queries);
+  std::cerr << "Meaningless: " << meaningless << '\n';
+}
@@ -111,7 +111,7 @@ KENLM<Model>::KENLM(size_t startInd, const std::string &line,
                     const std::string &file, FactorType factorType,
                     util::LoadMethod load_method) :
   StatefulFeatureFunction(startInd, line), m_path(file), m_factorType(
-    factorType), m_load_method(load_method)
+    factorType), m_load_method(load_method), m_numa(util::NUMA_DEFAULT)
 {
   ReadParameters();
 }
@@ -136,9 +136,35 @@ void KENLM<Model>::Load(System &system)
   FactorCollection &collection = system.GetVocab();
   MappingBuilder builder(collection, system, m_lmIdLookup);
   config.enumerate_vocab = &builder;
-  config.load_method = m_load_method;
+  config.load_method = util::PlacedLoadMethod(m_load_method, m_numa);
+
+  if (m_numa == util::NUMA_REPLICATE) {
+    // Load each copy with its memory preferring the node.  The vocabulary
+    // ids are the same in every copy so the mapping is built once.
+    for (std::size_t node = 0; node < util::NumaNodeCount(); ++node) {
+      util::ScopedNumaPolicy policy(node);
+      m_replicas.push_back(boost::shared_ptr<Model>(new Model(m_path.c_str(), config)));
+      config.enumerate_vocab = NULL;
+    }
+    m_ngram = m_replicas.front();
+    if (m_replicas.size() == 1) m_replicas.clear();
+  } else if (m_numa == util::NUMA_INTERLEAVE) {
+    util::ScopedNumaPolicy policy(-1);
+    m_ngram.reset(new Model(m_path.c_str(), config));
+  } else {
+    m_ngram.reset(new Model(m_path.c_str(), config));
+  }
+}
 
-  m_ngram.reset(new Model(m_path.c_str(), config));
+template<class Model>
+void KENLM<Model>::SetParameter(const std::string& key,
+                                const std::string& value)
+{
+  if (key == "numa") {
+    m_numa = util::ParseNumaPlacement(value);
+  } else {
+    StatefulFeatureFunction::SetParameter(key, value);
+  }
 }
 
 template<class Model>
@@ -254,32 +280,33 @@ void KENLM<Model>::EvaluateWhenApplied(const ManagerBase &mgr,
   const std::size_t begin = hypo.GetCurrTargetWordsRange().GetStartPos();
   //[begin, end) in STL-like fashion.
   const std::size_t end = hypo.GetCurrTargetWordsRange().GetEndPos() + 1;
-  const std::size_t adjust_end = std::min(end, begin + m_ngram->Order() - 1);
+  const Model &model = GetModel();
+  const std::size_t adjust_end = std::min(end, begin + model.Order() - 1);
 
   std::size_t position = begin;
   typename Model::State aux_state;
   typename Model::State *state0 = &stateCast.state, *state1 = &aux_state;
 
-  float score = m_ngram->Score(in_state, TranslateID(hypo.GetWord(position)),
-                               *state0);
+  float score = model.Score(in_state, TranslateID(hypo.GetWord(position)),
+                            *state0);
   ++position;
   for (; position < adjust_end; ++position) {
-    score += m_ngram->Score(*state0, TranslateID(hypo.GetWord(position)),
-                            *state1);
+    score += model.Score(*state0, TranslateID(hypo.GetWord(position)),
+                         *state1);
     std::swap(state0, state1);
   }
 
   if (hypo.GetBitmap().IsComplete()) {
     // Score end of sentence.
-    std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
+    std::vector<lm::WordIndex> indices(model.Order() - 1);
     const lm::WordIndex *last = LastIDs(hypo, &indices.front());
-    score += m_ngram->FullScoreForgotState(&indices.front(), last,
-                                           m_ngram->GetVocabulary().EndSentence(), stateCast.state).prob;
+    score += model.FullScoreForgotState(&indices.front(), last,
+                                        model.GetVocabulary().EndSentence(), stateCast.state).prob;
   } else if (adjust_end < end) {
     // Get state after adding a long phrase.
-    std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
+    std::vector<lm::WordIndex> indices(model.Order() - 1);
     const lm::WordIndex *last = LastIDs(hypo, &indices.front());
-    m_ngram->GetState(&indices.front(), last, stateCast.state);
+    model.GetState(&indices.front(), last, stateCast.state);
   } else if (state0 != &stateCast.state) {
     // Short enough phrase that we can just reuse the state.
     stateCast.state = *state0;
@@ -309,7 +336,7 @@ void KENLM<Model>::CalcScore(const Phrase<Moses2::Word> &phrase, float &fullScor
   if (!phrase.GetSize()) return;
 
   lm::ngram::ChartState discarded_sadly;
-  lm::ngram::RuleScore<Model> scorer(*m_ngram, discarded_sadly);
+  lm::ngram::RuleScore<Model> scorer(GetModel(), discarded_sadly);
 
   size_t position;
   if (m_bos == phrase[0][m_factorType]) {
@@ -352,7 +379,7 @@ void KENLM<Model>::CalcScore(const Phrase<SCFG::Word> &phrase, float &fullScore,
   if (!phrase.GetSize()) return;
 
   lm::ngram::ChartState discarded_sadly;
-  lm::ngram::RuleScore<Model> scorer(*m_ngram, discarded_sadly);
+  lm::ngram::RuleScore<Model> scorer(GetModel(), discarded_sadly);
 
   size_t position;
   if (m_bos == phrase[0][m_factorType]) {
@@ -418,7 +445,7 @@ void KENLM<Model>::EvaluateWhenApplied(const SCFG::Manager &mgr,
                                        FFState &state) const
 {
   LanguageModelChartStateKenLM &newState = static_cast<LanguageModelChartStateKenLM&>(state);
-  lm::ngram::RuleScore<Model> ruleScore(*m_ngram, newState.GetChartState());
+  lm::ngram::RuleScore<Model> ruleScore(GetModel(), newState.GetChartState());
   const SCFG::TargetPhraseImpl &target = hypo.GetTargetPhrase();
   const AlignmentInfo::NonTermIndexMap &nonTermIndexMap =
     target.GetAlignNonTerm().GetNonTermIndexMap();
@@ -525,6 +552,8 @@ FeatureFunction *ConstructKenLM(size_t startInd, const std::string &lineOrig)
         load_method = util::READ;
       } else if (value == "parallel_read") {
         load_method = util::PARALLEL_READ;
+      } else if (value == "direct_read") {
+        load_method = util::DIRECT_READ;
       } else {
         UTIL_THROW2("Unknown KenLM load method " << value);
       }
@@ -8,6 +8,7 @@
 #include <boost/shared_ptr.hpp>
 #include "../FF/StatefulFeatureFunction.h"
 #include "lm/model.hh"
+#include "util/numa.hh"
 #include "../legacy/Factor.h"
 #include "../legacy/Util2.h"
 #include "../Word.h"
@@ -33,6 +34,8 @@ public:
 
   virtual void Load(System &system);
 
+  virtual void SetParameter(const std::string& key, const std::string& value);
+
   virtual FFState* BlankState(MemPool &pool, const System &sys) const;
 
   //! return the state associated with the empty hypothesis for a given sentence
@@ -66,6 +69,16 @@ protected:
 
   boost::shared_ptr<Model> m_ngram;
 
+  // numa=replicate: one copy of the model per NUMA node, m_ngram being the
+  // first.  Empty otherwise.
+  util::NumaPlacement m_numa;
+  std::vector<boost::shared_ptr<Model> > m_replicas;
+
+  // The copy on the node of the calling thread.
+  const Model &GetModel() const {
+    return m_replicas.empty() ? *m_ngram : *m_replicas[util::CurrentNumaNode()];
+  }
+
   void CalcScore(const Phrase<Moses2::Word> &phrase, float &fullScore, float &ngramScore,
                  std::size_t &oovCount) const;
 
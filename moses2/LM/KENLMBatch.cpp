@@ -314,6 +314,8 @@ void KENLMBatch::SetParameter(const std::string& key,
       m_load_method = util::READ;
     } else if (value == "parallel_read") {
       m_load_method = util::PARALLEL_READ;
+    } else if (value == "direct_read") {
+      m_load_method = util::DIRECT_READ;
     } else {
       UTIL_THROW2("Unknown KenLM load method " << value);
     }
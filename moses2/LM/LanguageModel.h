@@ -74,7 +74,7 @@ protected:
   FactorType m_factorType;
   size_t m_order;
 
-  InMemoryTrie<const Factor*, LMScores> m_root;
+  InMemoryTrie<const Factor*, LMScores, HashedChildren, PooledNodeAllocator> m_root;
   SCORE m_oov;
   const Factor *m_bos;
   const Factor *m_eos;
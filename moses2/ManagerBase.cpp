@@ -30,6 +30,7 @@ ManagerBase::ManagerBase(System &sys, const TranslationTask &task,
   ,m_systemPool(NULL)
   ,m_hypoRecycler(NULL)
   ,m_input(NULL)
+  ,m_threadScratch(false)
 {
 }
 
@@ -41,6 +42,13 @@ ManagerBase::~ManagerBase()
   GetHypoRecycler().Clear();
 }
 
+thread_local ManagerScratch *ManagerBase::s_scratch = NULL;
+
+void ManagerBase::SetThreadScratch(ManagerScratch *scratch)
+{
+  s_scratch = scratch;
+}
+
 void ManagerBase::InitPools()
 {
   m_pool = &system.GetManagerPool();
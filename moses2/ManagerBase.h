@@ -30,6 +30,17 @@ class InputType;
 class OutputCollector;
 class HypothesisBase;
 
+// Pools, hypothesis recycler and arc lists used instead of the manager's own
+// on a thread that searches part of the manager's sentence.  Whatever is
+// allocated from them must live as long as the manager.
+struct ManagerScratch {
+  virtual ~ManagerScratch() {}
+
+  MemPool pool, systemPool;
+  Recycler<HypothesisBase*> hypoRecycler;
+  ArcLists arcLists;
+};
+
 class ManagerBase
 {
 public:
@@ -46,15 +57,23 @@ public:
   virtual std::string OutputTransOpt() = 0;
 
   MemPool &GetPool() const {
-    return *m_pool;
+    ManagerScratch *scratch = GetScratch();
+    return scratch ? scratch->pool : *m_pool;
   }
 
   MemPool &GetSystemPool() const {
-    return *m_systemPool;
+    ManagerScratch *scratch = GetScratch();
+    return scratch ? scratch->systemPool : *m_systemPool;
   }
 
   Recycler<HypothesisBase*> &GetHypoRecycler() const {
-    return *m_hypoRecycler;
+    ManagerScratch *scratch = GetScratch();
+    return scratch ? scratch->hypoRecycler : *m_hypoRecycler;
+  }
+
+  ArcLists &GetArcLists() const {
+    ManagerScratch *scratch = GetScratch();
+    return scratch ? scratch->arcLists : arcLists;
   }
 
   const InputType &GetInput() const {
@@ -75,6 +94,21 @@ protected:
 
   void InitPools();
 
+  // Once set, the accessors above return the scratch of the calling thread
+  // if it has one, see SetThreadScratch.  The flag spares the sequential
+  // search the thread-local lookup.
+  bool m_threadScratch;
+
+  // The scratch of the calling thread, NULL to use the manager's own.
+  static void SetThreadScratch(ManagerScratch *scratch);
+
+  ManagerScratch *GetScratch() const {
+    return m_threadScratch ? s_scratch : NULL;
+  }
+
+private:
+  static thread_local ManagerScratch *s_scratch;
+
 };
 
 }
@@ -23,6 +23,7 @@ namespace SCFG
 void InputPaths::Init(const InputType &input, const ManagerBase &mgr)
 {
   const Sentence &sentence = static_cast<const Sentence&>(input);
+  const SCFG::Manager &scfgMgr = static_cast<const SCFG::Manager&>(mgr);
   MemPool &pool = mgr.GetPool();
   size_t numPt = mgr.system.mappings.size();
   size_t size = sentence.GetSize();
@@ -33,11 +34,15 @@ void InputPaths::Init(const InputType &input, const ManagerBase &mgr)
   m_matrix->Init(NULL);
 
   for (size_t startPos = 0; startPos < size; ++startPos) {
+    // All paths from startPos use the pool of the thread that searches them,
+    // see Manager::GetSpanPool.
+    MemPool &spanPool = scfgMgr.GetSpanPool(startPos);
+
     // create path for 0 length string
     Range range(startPos, startPos - 1);
     SubPhrase<SCFG::Word> subPhrase = sentence.GetSubPhrase(startPos, 0);
 
-    SCFG::InputPath *path = new (pool.Allocate<SCFG::InputPath>()) SCFG::InputPath(pool,
+    SCFG::InputPath *path = new (pool.Allocate<SCFG::InputPath>()) SCFG::InputPath(spanPool,
         subPhrase, range, numPt, NULL);
     //cerr << "path=" << *path << endl;
     m_inputPaths.push_back(path);
@@ -56,7 +61,7 @@ void InputPaths::Init(const InputType &input, const ManagerBase &mgr)
       Range range(startPos, endPos);
 
       SCFG::InputPath *path = new (pool.Allocate<SCFG::InputPath>())
-      SCFG::InputPath(pool, subPhrase, range, numPt, prefixPath);
+      SCFG::InputPath(spanPool, subPhrase, range, numPt, prefixPath);
       //cerr << "path=" << *path << endl;
       m_inputPaths.push_back(path);
 
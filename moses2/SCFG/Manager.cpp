@@ -5,6 +5,11 @@
  *      Author: hieu
  */
 #include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#ifdef WITH_THREADS
+#include <boost/thread.hpp>
+#endif
+#include <algorithm>
 #include <cstdlib>
 #include <vector>
 #include <sstream>
@@ -55,12 +60,30 @@ void Manager::Decode()
   size_t inputSize = sentence.GetSize();
   //cerr << "inputSize=" << inputSize << endl;
 
+#ifdef WITH_THREADS
+  // The workers must exist before the paths, which take their pools.
+  const size_t spanThreads = std::min(system.options.syntax.span_threads, inputSize);
+  if (spanThreads > 1) {
+    for (size_t i = 0; i < spanThreads; ++i) {
+      m_spanWorkers.push_back(boost::shared_ptr<SpanWorker>(new SpanWorker));
+    }
+    m_threadScratch = true;
+  }
+#endif
+
   m_inputPaths.Init(sentence, *this);
   //cerr << "CREATED m_inputPaths" << endl;
 
   m_stacks.Init(*this, inputSize);
   //cerr << "CREATED m_stacks" << endl;
 
+#ifdef WITH_THREADS
+  if (!m_spanWorkers.empty()) {
+    DecodeByWidth();
+    return;
+  }
+#endif
+
   for (int startPos = inputSize - 1; startPos >= 0; --startPos) {
     //cerr << endl << "startPos=" << startPos << endl;
     SCFG::InputPath &initPath = *m_inputPaths.GetMatrix().GetValue(startPos, 0);
@@ -98,15 +121,116 @@ void Manager::Decode()
   //m_stacks.OutputStacks();
 }
 
+#ifdef WITH_THREADS
+// Alternative to the search in Decode that visits the chart width by width.
+// The spans of one width depend only on narrower spans, so they are searched
+// concurrently, the spans starting at startPos by worker startPos % threads.
+// A worker allocates from its own pools and writes only to the paths and
+// stacks of its spans, so every span sees the same sequence of operations as
+// in the sequential search and the output is the same.
+//
+// The worker threads are started once per sentence and meet this thread at
+// a barrier before and after each width.
+void Manager::DecodeByWidth()
+{
+  const SCFG::Sentence &sentence = static_cast<const SCFG::Sentence&>(GetInput());
+  size_t inputSize = sentence.GetSize();
+
+  for (int startPos = inputSize - 1; startPos >= 0; --startPos) {
+    SCFG::InputPath &initPath = *m_inputPaths.GetMatrix().GetValue(startPos, 0);
+    InitActiveChart(initPath);
+  }
+
+  size_t phraseSize = 0;
+  boost::barrier barrier(m_spanWorkers.size() + 1);
+  boost::thread_group threads;
+  for (size_t i = 0; i < m_spanWorkers.size(); ++i) {
+    threads.create_thread(boost::bind(&Manager::RunSpanWorker, this, i,
+                                      boost::cref(phraseSize),
+                                      boost::ref(barrier)));
+  }
+
+  for (phraseSize = 1; phraseSize <= inputSize; ++phraseSize) {
+    size_t numSpans = inputSize - phraseSize + 1;
+
+    barrier.wait();
+    barrier.wait();
+
+    BOOST_FOREACH(const boost::shared_ptr<SpanWorker> &worker, m_spanWorkers) {
+      arcLists.Merge(worker->arcLists);
+    }
+
+    // Wider spans read these stacks from several threads, so make sure the
+    // lazily sorted hypotheses have been created.  LookupUnary normally has
+    // done it already.
+    for (size_t startPos = 0; startPos < numSpans; ++startPos) {
+      const Stack &stack = m_stacks.GetStack(startPos, phraseSize);
+      BOOST_FOREACH(const Stack::Coll::value_type &valPair, stack.GetColl()) {
+        valPair.second->GetSortedAndPrunedHypos(*this, arcLists);
+      }
+    }
+  }
+
+  // A width of zero tells the workers to finish.
+  phraseSize = 0;
+  barrier.wait();
+  threads.join_all();
+}
+
+// Thread body for DecodeByWidth: search this worker's spans of each width
+// that DecodeByWidth sets, until it sets a width of zero.
+void Manager::RunSpanWorker(size_t workerInd, const size_t &phraseSize,
+                            boost::barrier &barrier)
+{
+  SetThreadScratch(m_spanWorkers[workerInd].get());
+  while (true) {
+    barrier.wait();
+    if (phraseSize == 0) {
+      break;
+    }
+    SearchSpans(workerInd, phraseSize);
+    barrier.wait();
+  }
+  SetThreadScratch(NULL);
+}
+
+void Manager::SearchSpans(size_t workerInd, size_t phraseSize)
+{
+  const SCFG::Sentence &sentence = static_cast<const SCFG::Sentence&>(GetInput());
+  size_t numSpans = sentence.GetSize() - phraseSize + 1;
+  for (size_t startPos = workerInd; startPos < numSpans;
+       startPos += m_spanWorkers.size()) {
+    SCFG::InputPath &path = *m_inputPaths.GetMatrix().GetValue(startPos, phraseSize);
+    Stack &stack = m_stacks.GetStack(startPos, phraseSize);
+
+    Lookup(path);
+    Decode(path, stack);
+    LookupUnary(path);
+  }
+}
+#endif
+
+MemPool &Manager::GetSpanPool(size_t startPos) const
+{
+  if (m_spanWorkers.empty()) {
+    return GetPool();
+  }
+  return m_spanWorkers[startPos % m_spanWorkers.size()]->pool;
+}
+
 void Manager::InitActiveChart(SCFG::InputPath &path)
 {
   size_t numPt = system.mappings.size();
   //cerr << "numPt=" << numPt << endl;
 
+  // Entries extending these are copied with the same pool, so it must be the
+  // pool of the thread that searches the spans starting here.
+  MemPool &pool = GetSpanPool(path.range.GetStartPos());
+
   for (size_t i = 0; i < numPt; ++i) {
     const PhraseTable &pt = *system.mappings[i];
     //cerr << "START InitActiveChart" << endl;
-    pt.InitActiveChart(GetPool(), *this, path);
+    pt.InitActiveChart(pool, *this, path);
     //cerr << "FINISHED InitActiveChart" << endl;
   }
 }
@@ -156,19 +280,20 @@ void Manager::Decode(SCFG::InputPath &path, Stack &stack)
   // clear cube pruning data
   //std::vector<QueueItem*> &container = Container(m_queue);
   //container.clear();
+  CubePruningState &cube = GetCubePruningState();
   Recycler<HypothesisBase*> &hypoRecycler = GetHypoRecycler();
-  while (!m_queue.empty()) {
-    QueueItem *item = m_queue.top();
-    m_queue.pop();
+  while (!cube.queue.empty()) {
+    QueueItem *item = cube.queue.top();
+    cube.queue.pop();
     // recycle unused hypos from queue
     Hypothesis *hypo = item->hypo;
     hypoRecycler.Recycle(hypo);
 
     // recycle queue item
-    m_queueItemRecycler.push_back(item);
+    cube.queueItemRecycler.push_back(item);
   }
 
-  m_seenPositions.clear();
+  cube.seenPositions.clear();
 
   // init queue
   BOOST_FOREACH(const InputPath::Coll::value_type &valPair, path.targetPhrases) {
@@ -180,21 +305,21 @@ void Manager::Decode(SCFG::InputPath &path, Stack &stack)
 
   // MAIN LOOP
   size_t pops = 0;
-  while (!m_queue.empty() && pops < system.options.cube.pop_limit) {
+  while (!cube.queue.empty() && pops < system.options.cube.pop_limit) {
     //cerr << "pops=" << pops << endl;
-    QueueItem *item = m_queue.top();
-    m_queue.pop();
+    QueueItem *item = cube.queue.top();
+    cube.queue.pop();
 
     // add hypo to stack
     Hypothesis *hypo = item->hypo;
 
     //cerr << "hypo=" << *hypo << " " << endl;
-    stack.Add(hypo, GetHypoRecycler(), arcLists);
+    stack.Add(hypo, hypoRecycler, GetArcLists());
     //cerr << "Added " << *hypo << " " << endl;
 
-    item->CreateNext(GetSystemPool(), GetPool(), *this, m_queue, m_seenPositions, path);
+    item->CreateNext(GetSystemPool(), GetPool(), *this, cube.queue, cube.seenPositions, path);
     //cerr << "Created next " << endl;
-    m_queueItemRecycler.push_back(item);
+    cube.queueItemRecycler.push_back(item);
 
     ++pops;
   }
@@ -207,13 +332,14 @@ void Manager::CreateQueue(
   const SCFG::TargetPhrases &tps)
 {
   MemPool &pool = GetPool();
+  CubePruningState &cube = GetCubePruningState();
 
   SeenPosition *seenItem = new (pool.Allocate<SeenPosition>()) SeenPosition(pool, symbolBind, tps, symbolBind.numNT);
-  bool unseen = m_seenPositions.Add(seenItem);
+  bool unseen = cube.seenPositions.Add(seenItem);
   assert(unseen);
 
-  QueueItem *item = QueueItem::Create(GetPool(), *this);
-  item->Init(GetPool(), symbolBind, tps, seenItem->hypoIndColl);
+  QueueItem *item = QueueItem::Create(pool, *this);
+  item->Init(pool, symbolBind, tps, seenItem->hypoIndColl);
   for (size_t i = 0; i < symbolBind.coll.size(); ++i) {
     const SymbolBindElement &ele = symbolBind.coll[i];
     if (ele.hypos) {
@@ -226,7 +352,7 @@ void Manager::CreateQueue(
 
   //cerr << "hypo=" << item->hypo->Debug(system) << endl;
 
-  m_queue.push(item);
+  cube.queue.push(item);
 }
 
 ///////////////////////////////////////////////////////////////
@@ -251,7 +377,7 @@ void Manager::ExpandHypo(
     hypo->Init(*this, path, symbolBind, tp, prevHyposIndices);
     hypo->EvaluateWhenApplied();
 
-    stack.Add(hypo, hypoRecycler, arcLists);
+    stack.Add(hypo, hypoRecycler, GetArcLists());
 
     ++ind;
   }
@@ -11,6 +11,11 @@
 #include <cstddef>
 #include <string>
 #include <deque>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#ifdef WITH_THREADS
+#include <boost/thread/barrier.hpp>
+#endif
 #include "../ManagerBase.h"
 #include "Stacks.h"
 #include "InputPaths.h"
@@ -25,6 +30,18 @@ class SymbolBind;
 class TargetPhraseImpl;
 class SymbolBindElement;
 
+// Cube pruning state for the search of one span.
+struct CubePruningState {
+  Queue queue;
+  SeenPositions seenPositions;
+  QueueItemRecycler queueItemRecycler;
+};
+
+// Pools and cube pruning state of one thread of the width-parallel search.
+struct SpanWorker : public ManagerScratch {
+  CubePruningState cube;
+};
+
 class Manager: public Moses2::ManagerBase
 {
 public:
@@ -42,14 +59,23 @@ public:
   }
 
   QueueItemRecycler &GetQueueItemRecycler() {
-    return m_queueItemRecycler;
+    return GetCubePruningState().queueItemRecycler;
   }
 
+  // Pool for the rules and active chart of the spans starting at startPos.
+  // With the width-parallel search, this belongs to the thread that searches
+  // those spans.
+  MemPool &GetSpanPool(size_t startPos) const;
+
   const Stacks &GetStacks() const {
     return m_stacks;
   }
 
 protected:
+  // Declared first so that the pools outlive the stacks and paths that use
+  // them.  Empty unless chart-span-threads > 1.
+  std::vector<boost::shared_ptr<SpanWorker> > m_spanWorkers;
+
   Stacks m_stacks;
   SCFG::InputPaths m_inputPaths;
 
@@ -69,11 +95,20 @@ protected:
     size_t ind,
     const std::vector<const SymbolBindElement*> ntEles);
 
+  void DecodeByWidth();
+#ifdef WITH_THREADS
+  void RunSpanWorker(size_t workerInd, const size_t &phraseSize,
+                     boost::barrier &barrier);
+#endif
+  void SearchSpans(size_t workerInd, size_t phraseSize);
+
   // cube pruning
-  Queue m_queue;
-  SeenPositions m_seenPositions;
+  CubePruningState m_cube;
 
-  QueueItemRecycler m_queueItemRecycler;
+  CubePruningState &GetCubePruningState() {
+    SpanWorker *worker = static_cast<SpanWorker*>(GetScratch());
+    return worker ? worker->cube : m_cube;
+  }
 
   void CreateQueue(
     const SCFG::InputPath &path,
@@ -0,0 +1,110 @@
+#include "Manager.h"
+#include "../System.h"
+#include "../TranslationTask.h"
+#include "../legacy/Parameter.h"
+#include "util/exception.hh"
+
+#define BOOST_TEST_MODULE SCFGManager
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <fstream>
+#include <string>
+
+using namespace Moses2;
+
+namespace
+{
+
+namespace fs = boost::filesystem;
+
+// A rule table, glue grammar and configuration in a directory that goes
+// away with it. The pop limit is low enough for cube pruning to matter.
+struct LoadedModel {
+  fs::path dir;
+  Parameter params;
+  boost::scoped_ptr<System> system;
+
+  LoadedModel() : dir(fs::temp_directory_path() / fs::unique_path()) {
+    fs::create_directories(dir);
+    const std::string rules = (dir / "rule-table").string();
+    std::ofstream(rules.c_str())
+        << "a [X] ||| A [X] ||| 0.5 ||| ||| \n"
+        << "b [X] ||| B [X] ||| 0.5 ||| ||| \n"
+        << "b c [X] ||| C B [X] ||| 0.7 ||| ||| \n"
+        << "c [X] ||| C [X] ||| 0.5 ||| ||| \n"
+        << "d [X] ||| D [X] ||| 0.6 ||| ||| \n"
+        << "d e [X] ||| E D [X] ||| 0.4 ||| ||| \n"
+        << "e [X] ||| E [X] ||| 0.5 ||| ||| \n"
+        << "[X][X] [X][X] [X] ||| [X][X] [X][X] [X] ||| 0.3 ||| 0-0 1-1 ||| \n"
+        << "[X][X] [X][X] [X] ||| [X][X] [X][X] [X] ||| 0.2 ||| 0-1 1-0 ||| \n"
+        << "a [X][X] [X] ||| [X][X] A [X] ||| 0.4 ||| 1-0 ||| \n";
+
+    const std::string glue = (dir / "glue-grammar").string();
+    std::ofstream(glue.c_str())
+        << "<s> [X] ||| <s> [S] ||| 1 ||| ||| \n"
+        << "[X][S] </s> [X] ||| [X][S] </s> [S] ||| 1 ||| 0-0 ||| \n"
+        << "[X][S] [X][X] [X] ||| [X][S] [X][X] [S] ||| 2.718 ||| 0-0 1-1 ||| \n";
+
+    const std::string ini = (dir / "moses.ini").string();
+    std::ofstream(ini.c_str())
+        << "[search-algorithm]\n3\n"
+        << "[input-factors]\n0\n"
+        << "[mapping]\n0 T 0\n1 T 1\n"
+        << "[max-chart-span]\n20\n1000\n"
+        << "[cube-pruning-pop-limit]\n8\n"
+        << "[non-terminals]\nX\n"
+        << "[n-best-list]\n/dev/null\n20\n"
+        << "[feature]\n"
+        << "UnknownWordPenalty\nWordPenalty\nPhrasePenalty\n"
+        << "PhraseDictionaryMemory name=TM0 num-features=1 path=" << rules
+        << " input-factor=0 output-factor=0\n"
+        << "PhraseDictionaryMemory name=Glue num-features=1 path=" << glue
+        << " input-factor=0 output-factor=0\n"
+        << "[weight]\n"
+        << "UnknownWordPenalty0= 1\nWordPenalty0= -0.5\nPhrasePenalty0= 0.2\n"
+        << "TM0= 0.5\nGlue= 1\n";
+
+    UTIL_THROW_IF2(!params.LoadParam(ini), "Cannot load " << ini);
+    system.reset(new System(params));
+  }
+
+  ~LoadedModel() {
+    fs::remove_all(dir);
+  }
+
+  std::string Decode(const std::string &line, size_t spanThreads) {
+    system->options.syntax.span_threads = spanThreads;
+    TranslationTask task(*system, line, 0);
+    return task.ReturnTranslation(true);
+  }
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(scfg_manager, LoadedModel)
+
+BOOST_AUTO_TEST_CASE(span_threads_match_sequential)
+{
+  // "f" is unknown
+  const std::string line = "a b c d e f a d b";
+  const std::string want = Decode(line, 1);
+  BOOST_REQUIRE(want.find("A B C D E f A D B") != std::string::npos);
+
+  // including more threads than spans of the widest widths
+  const size_t threads[] = {2, 3, 16};
+  for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t) {
+    BOOST_TEST_CHECKPOINT(threads[t] << " threads");
+    BOOST_CHECK_EQUAL(want, Decode(line, threads[t]));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(single_word)
+{
+  const std::string want = Decode("a", 1);
+  BOOST_REQUIRE(want.find("A") != std::string::npos);
+  BOOST_CHECK_EQUAL(want, Decode("a", 4));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -15,6 +15,7 @@
 #include "FF/FeatureFunction.h"
 #include "FF/FeatureFunctions.h"
 #include "legacy/Util2.h"
+#include "util/inner_product.hh"
 
 using namespace std;
 
@@ -100,38 +101,36 @@ void Scores::PlusEquals(const System &system,
                         const FeatureFunction &featureFunction, const std::vector<SCORE> &scores)
 {
   assert(scores.size() == featureFunction.GetNumScores());
-
-  const Weights &weights = system.weights;
-
-  size_t ffStartInd = featureFunction.GetStartInd();
-  for (size_t i = 0; i < scores.size(); ++i) {
-    SCORE incrScore = scores[i];
-    if (system.options.nbest.nbest_size) {
-      m_scores[ffStartInd + i] += incrScore;
-    }
-    //cerr << "ffStartInd=" << ffStartInd << " " << i << endl;
-    SCORE weight = weights[ffStartInd + i];
-    m_total += incrScore * weight;
+  if (scores.empty()) {
+    return;
   }
+  const SCORE *weights = system.weights.GetWeightsPtr(featureFunction.GetStartInd());
+  PlusEquals(system, featureFunction, &scores[0],
+             util::InnerProduct(&scores[0], weights, scores.size()));
 }
 
 void Scores::PlusEquals(const System &system,
                         const FeatureFunction &featureFunction, SCORE scores[])
 {
-  //assert(scores.size() == featureFunction.GetNumScores());
-
-  const Weights &weights = system.weights;
+  if (featureFunction.GetNumScores() == 0) {
+    return;
+  }
+  const SCORE *weights = system.weights.GetWeightsPtr(featureFunction.GetStartInd());
+  PlusEquals(system, featureFunction, scores,
+             util::InnerProduct(scores, weights, featureFunction.GetNumScores()));
+}
 
-  size_t ffStartInd = featureFunction.GetStartInd();
-  for (size_t i = 0; i < featureFunction.GetNumScores(); ++i) {
-    SCORE incrScore = scores[i];
-    if (system.options.nbest.nbest_size) {
-      m_scores[ffStartInd + i] += incrScore;
+void Scores::PlusEquals(const System &system,
+                        const FeatureFunction &featureFunction, const SCORE scores[],
+                        SCORE weightedScore)
+{
+  if (system.options.nbest.nbest_size) {
+    size_t ffStartInd = featureFunction.GetStartInd();
+    for (size_t i = 0; i < featureFunction.GetNumScores(); ++i) {
+      m_scores[ffStartInd + i] += scores[i];
     }
-    //cerr << "ffStartInd=" << ffStartInd << " " << i << endl;
-    SCORE weight = weights[ffStartInd + i];
-    m_total += incrScore * weight;
   }
+  m_total += weightedScore;
 }
 
 void Scores::PlusEquals(const System &system, const Scores &other)
@@ -178,21 +177,19 @@ void Scores::Assign(const System &system,
                     const FeatureFunction &featureFunction, const std::vector<SCORE> &scores)
 {
   assert(scores.size() == featureFunction.GetNumScores());
-
-  const Weights &weights = system.weights;
+  if (scores.empty()) {
+    return;
+  }
 
   size_t ffStartInd = featureFunction.GetStartInd();
-  for (size_t i = 0; i < scores.size(); ++i) {
-    SCORE incrScore = scores[i];
-
-    if (system.options.nbest.nbest_size) {
+  if (system.options.nbest.nbest_size) {
+    for (size_t i = 0; i < scores.size(); ++i) {
       assert(m_scores[ffStartInd + i] == 0);
-      m_scores[ffStartInd + i] = incrScore;
+      m_scores[ffStartInd + i] = scores[i];
     }
-    //cerr << "ffStartInd=" << ffStartInd << " " << i << endl;
-    SCORE weight = weights[ffStartInd + i];
-    m_total += incrScore * weight;
   }
+  const SCORE *weights = system.weights.GetWeightsPtr(ffStartInd);
+  m_total += util::InnerProduct(&scores[0], weights, scores.size());
 }
 
 void Scores::CreateFromString(const std::string &str,
@@ -250,20 +247,11 @@ void Scores::OutputBreakdown(std::ostream &out, const System &system) const
 SCORE Scores::CalcWeightedScore(const System &system,
                                 const FeatureFunction &featureFunction, SCORE scores[])
 {
-  SCORE ret = 0;
-
-  const Weights &weights = system.weights;
-
-  size_t ffStartInd = featureFunction.GetStartInd();
-  for (size_t i = 0; i < featureFunction.GetNumScores(); ++i) {
-    SCORE incrScore = scores[i];
-
-    //cerr << "ffStartInd=" << ffStartInd << " " << i << endl;
-    SCORE weight = weights[ffStartInd + i];
-    ret += incrScore * weight;
+  if (featureFunction.GetNumScores() == 0) {
+    return 0;
   }
-
-  return ret;
+  const SCORE *weights = system.weights.GetWeightsPtr(featureFunction.GetStartInd());
+  return util::InnerProduct(scores, weights, featureFunction.GetNumScores());
 }
 
 SCORE Scores::CalcWeightedScore(const System &system,
@@ -51,6 +51,11 @@ public:
   void PlusEquals(const System &system, const FeatureFunction &featureFunction,
                   SCORE scores[]);
 
+  // weightedScore is the scores already multiplied by the weights, e.g. by
+  // util::InnerProducts() for a block of target phrases
+  void PlusEquals(const System &system, const FeatureFunction &featureFunction,
+                  const SCORE scores[], SCORE weightedScore);
+
   void PlusEquals(const System &system, const Scores &scores);
 
   void MinusEquals(const System &system, const Scores &scores);
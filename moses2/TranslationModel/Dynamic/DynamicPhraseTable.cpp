@@ -36,7 +36,7 @@ using namespace std;
 
 namespace Moses2
 {
-thread_local DynamicPhraseTable::PBNODE DynamicPhraseTable::m_rootPb;
+thread_local DynamicPhraseTable::FROZENPBNODE DynamicPhraseTable::m_rootPb;
 
 ////////////////////////////////////////////////////////////////////////
 
@@ -48,7 +48,6 @@ DynamicPhraseTable::DynamicPhraseTable(size_t startInd, const std::string &line)
 
 DynamicPhraseTable::~DynamicPhraseTable()
 {
-  m_rootPb.CleanNode();
 }
 
 void DynamicPhraseTable::CreatePTForInput(const ManagerBase &mgr, string phraseTableString)
@@ -66,6 +65,7 @@ void DynamicPhraseTable::CreatePTForInput(const ManagerBase &mgr, string phraseT
     //cerr << "m_rootSCFG=" << m_rootSCFG << endl;
   }
 
+  PBNODE root;
   vector<string> toks;
   size_t lineNum = 0;
   istringstream  strme(phraseTableString);
@@ -104,7 +104,7 @@ void DynamicPhraseTable::CreatePTForInput(const ManagerBase &mgr, string phraseT
       system.featureFunctions.EvaluateInIsolation(pool, system, *source,
           *target);
       //cerr << "EvaluateInIsolation:" << target->Debug(system) << endl;
-      m_rootPb.AddRule(m_input, *source, target);
+      root.AddRule(m_input, *source, target);
 
       //cerr << "target=" << target->Debug(system) << endl;
     } else {
@@ -113,7 +113,8 @@ void DynamicPhraseTable::CreatePTForInput(const ManagerBase &mgr, string phraseT
   }
 
   if (system.isPb) {
-    m_rootPb.SortAndPrune(m_tableLimit, pool, system);
+    root.SortAndPrune(m_tableLimit, pool, system);
+    root.Freeze(pool, m_rootPb);
     //cerr << "root=" << &m_rootPb << endl;
   } else {
     throw std::runtime_error("Must be a phrase-based model");
@@ -144,7 +145,8 @@ TargetPhrases* DynamicPhraseTable::Lookup(const Manager &mgr, MemPool &pool,
 }
 
 void DynamicPhraseTable::CleanUpAfterSentenceProcessing(const System &system, const InputType &input) const {
-   m_rootPb.CleanNode(); //TODO  : clean this
+  // the nodes are in the manager's pool, which is released with the manager
+  m_rootPb = FROZENPBNODE();
 }
 
 void DynamicPhraseTable::InitActiveChart(
@@ -9,7 +9,7 @@
 #include "../PhraseTable.h"
 #include "../../legacy/Util2.h"
 #include "../../SCFG/InputPath.h"
-#include "DynamicPhraseTableNode.h"
+#include "../Memory/Node.h"
 #include "../../PhraseBased/PhraseImpl.h"
 #include "../../PhraseBased/TargetPhraseImpl.h"
 #include "../../PhraseBased/TargetPhrases.h"
@@ -22,8 +22,9 @@ namespace Moses2
 
 class DynamicPhraseTable: public PhraseTable
 {
-  typedef DynamicPhraseTableNS::Node<Word, Phrase<Word>, TargetPhraseImpl, TargetPhrases> PBNODE;
-  typedef DynamicPhraseTableNS::Node<SCFG::Word, Phrase<SCFG::Word>, SCFG::TargetPhraseImpl, SCFG::TargetPhrases> SCFGNODE;
+  typedef PtMem::Node<Word, Phrase<Word>, TargetPhraseImpl, TargetPhrases> PBNODE;
+  typedef PtMem::Node<SCFG::Word, Phrase<SCFG::Word>, SCFG::TargetPhraseImpl, SCFG::TargetPhrases> SCFGNODE;
+  typedef PBNODE::Frozen FROZENPBNODE;
 
 //////////////////////////////////////
   class ActiveChartEntryMem : public SCFG::ActiveChartEntry
@@ -69,7 +70,8 @@ public:
   virtual void CleanUpAfterSentenceProcessing(const System &system, const InputType &input) const;
 
 protected:
-  thread_local static PBNODE m_rootPb;
+  // the table of the current input, frozen into the manager's pool
+  thread_local static FROZENPBNODE m_rootPb;
 
   void LookupGivenNode(
     MemPool &pool,
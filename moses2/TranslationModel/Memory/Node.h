@@ -5,6 +5,8 @@
  *      Author: hieu
  */
 #pragma once
+#include <algorithm>
+#include <vector>
 #include <boost/unordered_map.hpp>
 #include <boost/foreach.hpp>
 #include "../../PhraseBased/TargetPhrases.h"
@@ -18,15 +20,79 @@ class System;
 namespace PtMem
 {
 
+template<class WORD, class SP, class TP, class TPS>
+class Node;
+
+// Read-only trie node, created by Node::Freeze once the table is loaded and
+// pruned. The children of a node sit in one contiguous array sorted by word
+// hash, with the hashes in a parallel array so that a lookup only touches
+// the child it descends into. All arrays are allocated from a MemPool.
+template<class WORD, class TPS>
+class FrozenNode
+{
+  template<class, class, class, class> friend class Node;
+public:
+  FrozenNode()
+    :m_keys(NULL)
+    ,m_children(NULL)
+    ,m_numChildren(0)
+    ,m_targetPhrases(NULL)
+  {}
+
+  template<class SP>
+  TPS *Find(const std::vector<FactorType> &factors, const SP &source) const {
+    assert(source.GetSize());
+    const FrozenNode *node = this;
+    for (size_t pos = 0; pos < source.GetSize(); ++pos) {
+      node = node->Find(factors, source[pos]);
+      if (node == NULL) {
+        return NULL;
+      }
+    }
+    return node->m_targetPhrases;
+  }
+
+  const FrozenNode *Find(const std::vector<FactorType> &factors, const WORD &word) const {
+    size_t key = word.hash(factors);
+    const size_t *end = m_keys + m_numChildren;
+    const size_t *iter;
+    if (m_numChildren <= 8) {
+      iter = std::find(m_keys, end, key);
+    } else {
+      iter = std::lower_bound(m_keys, end, key);
+    }
+    if (iter == end || *iter != key) {
+      return NULL;
+    }
+    return m_children + (iter - m_keys);
+  }
+
+  const TPS *GetTargetPhrases() const {
+    return m_targetPhrases;
+  }
+
+  size_t GetNumChildren() const {
+    return m_numChildren;
+  }
+
+protected:
+  const size_t *m_keys;
+  const FrozenNode *m_children;
+  size_t m_numChildren;
+  TPS *m_targetPhrases;
+};
+
+// Trie used while loading. Freeze() turns it into FrozenNodes for lookup.
 template<class WORD, class SP, class TP, class TPS>
 class Node
 {
 public:
   typedef boost::unordered_map<size_t, Node> Children;
+  typedef FrozenNode<WORD, TPS> Frozen;
 
   Node()
     :m_targetPhrases(NULL)
-    ,m_unsortedTPS(NULL)
+    ,m_source(NULL)
   {}
 
   ~Node()
@@ -67,28 +133,61 @@ public:
     return m_targetPhrases;
   }
 
-  void SortAndPrune(size_t tableLimit, MemPool &pool, System &system) {
+  void SortAndPrune(size_t tableLimit, MemPool &pool, const System &system) {
     BOOST_FOREACH(typename Children::value_type &val, m_children) {
       Node &child = val.second;
       child.SortAndPrune(tableLimit, pool, system);
     }
 
     // prune target phrases in this node
-    if (m_unsortedTPS) {
-      m_targetPhrases = new (pool.Allocate<TPS>()) TPS(pool, m_unsortedTPS->size());
+    if (!m_unsortedTPS.empty()) {
+      m_targetPhrases = new (pool.Allocate<TPS>()) TPS(pool, m_unsortedTPS.size());
 
-      for (size_t i = 0; i < m_unsortedTPS->size(); ++i) {
-        TP *tp = (*m_unsortedTPS)[i];
+      for (size_t i = 0; i < m_unsortedTPS.size(); ++i) {
+        TP *tp = m_unsortedTPS[i];
         m_targetPhrases->AddTargetPhrase(*tp);
       }
 
       m_targetPhrases->SortAndPrune(tableLimit);
       system.featureFunctions.EvaluateAfterTablePruning(system.GetSystemPool(), *m_targetPhrases, *m_source);
 
-      delete m_unsortedTPS;
+      std::vector<TP*>().swap(m_unsortedTPS);
     }
   }
 
+  // Copy the sorted and pruned trie into out, with all arrays allocated
+  // from pool, and empty this node so it can be reused.
+  void Freeze(MemPool &pool, Frozen &out) {
+    std::vector<std::pair<size_t, Node*> > sorted;
+    sorted.reserve(m_children.size());
+    BOOST_FOREACH(typename Children::value_type &val, m_children) {
+      sorted.push_back(std::make_pair(val.first, &val.second));
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    out.m_targetPhrases = m_targetPhrases;
+    out.m_numChildren = sorted.size();
+    if (sorted.size()) {
+      size_t *keys = (size_t*) pool.Allocate(sizeof(size_t) * sorted.size());
+      Frozen *children = (Frozen*) pool.Allocate(sizeof(Frozen) * sorted.size());
+      for (size_t i = 0; i < sorted.size(); ++i) {
+        keys[i] = sorted[i].first;
+        new (children + i) Frozen();
+      }
+      // all siblings are allocated before descending, so each node's
+      // children are contiguous and close to their own children
+      for (size_t i = 0; i < sorted.size(); ++i) {
+        sorted[i].second->Freeze(pool, children[i]);
+      }
+      out.m_keys = keys;
+      out.m_children = children;
+    }
+
+    Children().swap(m_children);
+    m_targetPhrases = NULL;
+    m_source = NULL;
+  }
+
   const Children &GetChildren() const {
     return m_children;
   }
@@ -103,16 +202,15 @@ protected:
   Children m_children;
   TPS *m_targetPhrases;
   Phrase<WORD> *m_source;
-  std::vector<TP*> *m_unsortedTPS;
+  std::vector<TP*> m_unsortedTPS;
 
   Node &AddRule(const std::vector<FactorType> &factors, SP &source, TP *target, size_t pos) {
     if (pos == source.GetSize()) {
-      if (m_unsortedTPS == NULL) {
-        m_unsortedTPS = new std::vector<TP*>();
+      if (m_unsortedTPS.empty()) {
         m_source = &source;
       }
 
-      m_unsortedTPS->push_back(target);
+      m_unsortedTPS.push_back(target);
       return *this;
     } else {
       const WORD &word = source[pos];
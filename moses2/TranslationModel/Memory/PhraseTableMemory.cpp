@@ -6,7 +6,9 @@
  */
 
 #include <cassert>
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
+#include <boost/thread.hpp>
 #include "PhraseTableMemory.h"
 #include "../../PhraseBased/PhraseImpl.h"
 #include "../../Phrase.h"
@@ -38,88 +40,133 @@ namespace Moses2
 
 PhraseTableMemory::PhraseTableMemory(size_t startInd, const std::string &line)
   :PhraseTable(startInd, line)
-  ,m_rootPb(NULL)
-  ,m_rootSCFG(NULL)
+  ,m_loadThreads(1)
 {
   ReadParameters();
 }
 
 PhraseTableMemory::~PhraseTableMemory()
 {
-  delete m_rootPb;
-  delete m_rootSCFG;
+  RemoveAllInColl(m_loadPools);
 }
 
-void PhraseTableMemory::Load(System &system)
+void PhraseTableMemory::SetParameter(const std::string& key, const std::string& value)
 {
-  FactorCollection &vocab = system.GetVocab();
-  MemPool &systemPool = system.GetSystemPool();
-  MemPool tmpSourcePool;
+  if (key == "load-threads") {
+    m_loadThreads = Scan<size_t>(value);
+    UTIL_THROW_IF2(m_loadThreads == 0, "load-threads must be at least 1");
+  } else {
+    PhraseTable::SetParameter(key, value);
+  }
+}
 
+void PhraseTableMemory::Load(System &system)
+{
   if (system.isPb) {
-    m_rootPb = new PBNODE();
+    Load<PBNODE, PhraseImpl, TargetPhraseImpl>(system, m_rootPb);
   } else {
-    m_rootSCFG = new SCFGNODE();
-    //cerr << "m_rootSCFG=" << m_rootSCFG << endl;
+    Load<SCFGNODE, SCFG::PhraseImpl, SCFG::TargetPhraseImpl>(system, m_rootSCFG);
   }
+}
 
-  vector<string> toks;
+// The file is read in batches of lines. With load-threads > 1 each thread
+// parses a slice of the batch into its own pools, and the rules are then
+// added to the trie on this thread in file order, so the resulting table is
+// the same for any number of threads.
+template<class NODE, class SP, class TP>
+void PhraseTableMemory::Load(System &system, typename NODE::Frozen &frozen)
+{
+  MemPool &systemPool = system.GetSystemPool();
+  const size_t numThreads = m_loadThreads;
+
+  // source phrases are only needed until the table is pruned
+  std::vector<MemPool*> sourcePools;
+  std::vector<MemPool*> targetPools;
+  for (size_t t = 0; t < numThreads; ++t) {
+    sourcePools.push_back(new MemPool());
+    if (numThreads == 1) {
+      targetPools.push_back(&systemPool);
+    } else {
+      m_loadPools.push_back(new MemPool());
+      targetPools.push_back(m_loadPools.back());
+    }
+  }
+
+  NODE root;
+  const size_t batchSize = 10000 * numThreads;
+  vector<string> lines;
+  vector<vector<pair<SP*, TP*> > > rules(numThreads);
+  vector<string> errors(numThreads);
   size_t lineNum = 0;
   InputFileStream strme(m_path);
   string line;
-  while (getline(strme, line)) {
-    if (++lineNum % 1000000 == 0) {
-      cerr << lineNum << " ";
+  bool more = true;
+  while (more) {
+    lines.clear();
+    while (lines.size() < batchSize && (more = static_cast<bool>(getline(strme, line)))) {
+      lines.push_back(line);
+      if (++lineNum % 1000000 == 0) {
+        cerr << lineNum << " ";
+      }
     }
-    toks.clear();
-    TokenizeMultiCharSeparator(toks, line, "|||");
-    UTIL_THROW_IF2(toks.size() < 3, "Wrong format");
-    //cerr << "line=" << line << endl;
-    //cerr << "system.isPb=" << system.isPb << endl;
-
-    if (system.isPb) {
-      PhraseImpl *source = PhraseImpl::CreateFromString(tmpSourcePool, vocab, system,
-                           toks[0]);
-      //cerr << "created soure" << endl;
-      TargetPhraseImpl *target = TargetPhraseImpl::CreateFromString(systemPool, *this, system,
-                                 toks[1]);
-      //cerr << "created target" << endl;
-      target->GetScores().CreateFromString(toks[2], *this, system, true);
-      //cerr << "created scores:" << *target << endl;
 
-      if (toks.size() >= 4) {
-        //cerr << "alignstr=" << toks[3] << endl;
-        target->SetAlignmentInfo(toks[3]);
+    const size_t sliceSize = (lines.size() + numThreads - 1) / numThreads;
+    if (numThreads == 1) {
+      ParseRules(system, *sourcePools[0], *targetPools[0], lines, 0, lines.size(),
+                 rules[0], errors[0]);
+    } else {
+      boost::thread_group threads;
+      for (size_t t = 0; t < numThreads; ++t) {
+        size_t begin = std::min(t * sliceSize, lines.size());
+        size_t end = std::min(begin + sliceSize, lines.size());
+        threads.create_thread(boost::bind(&PhraseTableMemory::ParseRules<SP, TP>, this,
+                                          boost::cref(system),
+                                          boost::ref(*sourcePools[t]),
+                                          boost::ref(*targetPools[t]),
+                                          boost::cref(lines), begin, end,
+                                          boost::ref(rules[t]),
+                                          boost::ref(errors[t])));
       }
+      threads.join_all();
+    }
 
-      // properties
-      if (toks.size() == 7) {
-        //target->properties = (char*) system.systemPool.Allocate(toks[6].size() + 1);
-        //strcpy(target->properties, toks[6].c_str());
+    for (size_t t = 0; t < numThreads; ++t) {
+      UTIL_THROW_IF2(!errors[t].empty(), errors[t]);
+      for (size_t i = 0; i < rules[t].size(); ++i) {
+        root.AddRule(m_input, *rules[t][i].first, rules[t][i].second);
       }
+      rules[t].clear();
+    }
+  }
 
-      system.featureFunctions.EvaluateInIsolation(systemPool, system, *source,
-          *target);
-      //cerr << "EvaluateInIsolation:" << *target << endl;
-      m_rootPb->AddRule(m_input, *source, target);
-
-      //cerr << "target=" << target->Debug(system) << endl;
-    } else {
-      SCFG::PhraseImpl *source = SCFG::PhraseImpl::CreateFromString(tmpSourcePool, vocab, system,
-                                 toks[0]);
-      //cerr << "created source:" << *source << endl;
-      SCFG::TargetPhraseImpl *target = SCFG::TargetPhraseImpl::CreateFromString(systemPool, *this,
-                                       system, toks[1]);
-
-      //cerr << "created target " << *target << " source=" << *source << endl;
+  root.SortAndPrune(m_tableLimit, systemPool, system);
+  root.Freeze(systemPool, frozen);
+  RemoveAllInColl(sourcePools);
+}
 
+template<class SP, class TP>
+void PhraseTableMemory::ParseRules(const System &system, MemPool &sourcePool,
+                                   MemPool &targetPool,
+                                   const std::vector<std::string> &lines,
+                                   size_t begin, size_t end,
+                                   std::vector<std::pair<SP*, TP*> > &rules,
+                                   std::string &error) const
+{
+  FactorCollection &vocab = system.GetVocab();
+  vector<string> toks;
+  try {
+    for (size_t i = begin; i < end; ++i) {
+      toks.clear();
+      TokenizeMultiCharSeparator(toks, lines[i], "|||");
+      UTIL_THROW_IF2(toks.size() < 3, "Wrong format");
+
+      SP *source = SP::CreateFromString(sourcePool, vocab, system, toks[0]);
+      TP *target = TP::CreateFromString(targetPool, *this, system, toks[1]);
       target->GetScores().CreateFromString(toks[2], *this, system, true);
-      //cerr << "created scores:" << *target << endl;
 
-      //vector<SCORE> scores = Tokenize<SCORE>(toks[2]);
-      //target->sortScore = (scores.size() >= 3) ? TransformScore(scores[2]) : 0;
-
-      target->SetAlignmentInfo(toks[3]);
+      if (toks.size() >= 4) {
+        target->SetAlignmentInfo(toks[3]);
+      }
 
       // properties
       if (toks.size() == 7) {
@@ -127,34 +174,21 @@ void PhraseTableMemory::Load(System &system)
         //strcpy(target->properties, toks[6].c_str());
       }
 
-      system.featureFunctions.EvaluateInIsolation(systemPool, system, *source,
+      system.featureFunctions.EvaluateInIsolation(targetPool, system, *source,
           *target);
-      //cerr << "EvaluateInIsolation:" << *target << endl;
-      m_rootSCFG->AddRule(m_input, *source, target);
+      rules.push_back(make_pair(source, target));
     }
+  } catch (const std::exception &e) {
+    // reported by the loading thread
+    error = e.what();
   }
-
-  if (system.isPb) {
-    m_rootPb->SortAndPrune(m_tableLimit, systemPool, system);
-    //cerr << "root=" << &m_rootPb << endl;
-  } else {
-    m_rootSCFG->SortAndPrune(m_tableLimit, systemPool, system);
-    //cerr << "root=" << &m_rootPb << endl;
-  }
-  /*
-  BOOST_FOREACH(const PtMem::Node<Word>::Children::value_type &valPair, m_rootPb.GetChildren()) {
-    const Word &word = valPair.first;
-    cerr << word << " ";
-  }
-  cerr << endl;
-  */
 }
 
 TargetPhrases* PhraseTableMemory::Lookup(const Manager &mgr, MemPool &pool,
     InputPath &inputPath) const
 {
   const SubPhrase<Moses2::Word> &phrase = inputPath.subPhrase;
-  TargetPhrases *tps = m_rootPb->Find(m_input, phrase);
+  TargetPhrases *tps = m_rootPb.Find(m_input, phrase);
   return tps;
 }
 
@@ -164,7 +198,7 @@ void PhraseTableMemory::InitActiveChart(
   SCFG::InputPath &path) const
 {
   size_t ptInd = GetPtInd();
-  ActiveChartEntryMem *chartEntry = new (pool.Allocate<ActiveChartEntryMem>()) ActiveChartEntryMem(pool, *m_rootSCFG);
+  ActiveChartEntryMem *chartEntry = new (pool.Allocate<ActiveChartEntryMem>()) ActiveChartEntryMem(pool, m_rootSCFG);
   path.AddActiveChartEntry(ptInd, chartEntry);
   //cerr << "InitActiveChart=" << path << endl;
 }
@@ -220,11 +254,10 @@ void PhraseTableMemory::LookupGivenNode(
 {
   const ActiveChartEntryMem &prevEntryCast = static_cast<const ActiveChartEntryMem&>(prevEntry);
 
-  const SCFGNODE &prevNode = prevEntryCast.node;
-  UTIL_THROW_IF2(&prevNode == NULL, "node == NULL");
+  const FROZENSCFGNODE &prevNode = prevEntryCast.node;
 
   size_t ptInd = GetPtInd();
-  const SCFGNODE *nextNode = prevNode.Find(m_input, wordSought);
+  const FROZENSCFGNODE *nextNode = prevNode.Find(m_input, wordSought);
 
   /*
   if (outPath.range.GetStartPos() == 1 || outPath.range.GetStartPos() == 2) {
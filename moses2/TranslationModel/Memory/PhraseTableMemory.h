@@ -24,22 +24,24 @@ class PhraseTableMemory: public PhraseTable
 {
   typedef PtMem::Node<Word, Phrase<Word>, TargetPhraseImpl, TargetPhrases> PBNODE;
   typedef PtMem::Node<SCFG::Word, Phrase<SCFG::Word>, SCFG::TargetPhraseImpl, SCFG::TargetPhrases> SCFGNODE;
+  typedef PBNODE::Frozen FROZENPBNODE;
+  typedef SCFGNODE::Frozen FROZENSCFGNODE;
 
 //////////////////////////////////////
   class ActiveChartEntryMem : public SCFG::ActiveChartEntry
   {
     typedef SCFG::ActiveChartEntry Parent;
   public:
-    const PhraseTableMemory::SCFGNODE &node;
+    const PhraseTableMemory::FROZENSCFGNODE &node;
 
-    ActiveChartEntryMem(MemPool &pool, const PhraseTableMemory::SCFGNODE &vnode)
+    ActiveChartEntryMem(MemPool &pool, const PhraseTableMemory::FROZENSCFGNODE &vnode)
       :Parent(pool)
       ,node(vnode)
     {}
 
     ActiveChartEntryMem(
       MemPool &pool,
-      const PhraseTableMemory::SCFGNODE &vnode,
+      const PhraseTableMemory::FROZENSCFGNODE &vnode,
       const ActiveChartEntry &prevEntry)
       :Parent(prevEntry)
       ,node(vnode)
@@ -52,6 +54,7 @@ public:
   virtual ~PhraseTableMemory();
 
   virtual void Load(System &system);
+  virtual void SetParameter(const std::string& key, const std::string& value);
   virtual TargetPhrases *Lookup(const Manager &mgr, MemPool &pool,
                                 InputPath &inputPath) const;
 
@@ -67,8 +70,21 @@ public:
               SCFG::InputPath &path) const;
 
 protected:
-  PBNODE    *m_rootPb;
-  SCFGNODE  *m_rootSCFG;
+  FROZENPBNODE    m_rootPb;
+  FROZENSCFGNODE  m_rootSCFG;
+
+  size_t m_loadThreads;
+  // target phrases parsed by the loader threads, kept for the table's life
+  std::vector<MemPool*> m_loadPools;
+
+  template<class NODE, class SP, class TP>
+  void Load(System &system, typename NODE::Frozen &root);
+
+  template<class SP, class TP>
+  void ParseRules(const System &system, MemPool &sourcePool, MemPool &targetPool,
+                  const std::vector<std::string> &lines, size_t begin, size_t end,
+                  std::vector<std::pair<SP*, TP*> > &rules,
+                  std::string &error) const;
 
   void LookupGivenNode(
     MemPool &pool,
@@ -0,0 +1,117 @@
+#include "PhraseTableMemory.h"
+#include "../../System.h"
+#include "../../TranslationTask.h"
+#include "../../legacy/Parameter.h"
+#include "util/exception.hh"
+
+#define BOOST_TEST_MODULE PhraseTableMemory
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <string>
+
+using namespace Moses2;
+
+namespace
+{
+
+namespace fs = boost::filesystem;
+
+const char *words[] = {"a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l"};
+const size_t numWords = sizeof(words) / sizeof(words[0]);
+
+// A phrase table in a directory that goes away with it. The node for "a" has
+// more children than are scanned linearly, the others have fewer.
+class TempTable
+{
+public:
+  TempTable() : m_dir(fs::temp_directory_path() / fs::unique_path()) {
+    fs::create_directories(m_dir);
+    std::ofstream out(Path().c_str());
+    for (size_t i = 0; i < numWords; ++i) {
+      const std::string upper = Upper(words[i]);
+      out << words[i] << " ||| " << upper << " ||| 0." << i + 1 << "\n"
+          << words[i] << " ||| " << upper << upper << " ||| 0.0" << i + 1 << "\n";
+    }
+    for (size_t i = 1; i < numWords; ++i) {
+      out << "a " << words[i] << " ||| " << Upper(words[i]) << "-A ||| 0.9\n";
+    }
+    out << "a b c ||| ABC ||| 0.95\n"
+        << "a l k ||| LK-A ||| 0.8\n";
+  }
+
+  ~TempTable() {
+    fs::remove_all(m_dir);
+  }
+
+  std::string Path() const {
+    return (m_dir / "phrase-table").string();
+  }
+
+  // Decodes each line with the table loaded by loadThreads threads, and
+  // returns the 1-best or n-best output.
+  std::string Decode(const char *lines[], size_t numLines, size_t loadThreads, bool nbest) const {
+    const std::string ini = (m_dir / "moses.ini").string();
+    std::ofstream(ini.c_str())
+        << "[search-algorithm]\n1\n"
+        << "[input-factors]\n0\n"
+        << "[mapping]\n0 T 0\n"
+        << "[distortion-limit]\n3\n"
+        << "[n-best-list]\n/dev/null\n5\n"
+        << "[feature]\n"
+        << "UnknownWordPenalty\nWordPenalty\nPhrasePenalty\nDistortion\n"
+        << "PhraseDictionaryMemory name=TM0 num-features=1 path=" << Path()
+        << " input-factor=0 output-factor=0 load-threads=" << loadThreads << "\n"
+        << "[weight]\n"
+        << "UnknownWordPenalty0= 1\nWordPenalty0= -0.5\nPhrasePenalty0= 0.2\n"
+        << "Distortion0= 0.3\nTM0= 1\n";
+
+    Parameter params;
+    UTIL_THROW_IF2(!params.LoadParam(ini), "Cannot load " << ini);
+    System system(params);
+    std::string ret;
+    for (size_t i = 0; i < numLines; ++i) {
+      TranslationTask task(system, lines[i], i);
+      ret += task.ReturnTranslation(nbest);
+    }
+    return ret;
+  }
+
+private:
+  fs::path m_dir;
+
+  static std::string Upper(const std::string &word) {
+    std::string ret(word);
+    for (size_t i = 0; i < ret.size(); ++i) {
+      ret[i] = ret[i] - 'a' + 'A';
+    }
+    return ret;
+  }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(lookups)
+{
+  TempTable table;
+  // "z" is unknown
+  const char *lines[] = {"a b c d", "a l k a g z", "k j a b", "c"};
+  const std::string got = table.Decode(lines, 4, 1, false);
+  BOOST_CHECK_EQUAL("ABC D \nLK-A G-A z \nK J B-A \nC \n", got);
+}
+
+BOOST_AUTO_TEST_CASE(load_threads_give_same_table)
+{
+  TempTable table;
+  const char *lines[] = {"a b c d", "a l k a g z", "k j a b", "l a e a f"};
+  const std::string want = table.Decode(lines, 4, 1, true);
+  BOOST_REQUIRE(!want.empty());
+
+  // including more threads than lines
+  const size_t threads[] = {2, 3, 64};
+  for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t) {
+    BOOST_TEST_CHECKPOINT(threads[t] << " threads");
+    BOOST_CHECK_EQUAL(want, table.Decode(lines, 4, threads[t], true));
+  }
+}
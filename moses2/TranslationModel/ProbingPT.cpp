@@ -9,6 +9,7 @@
 #include "probingpt/querying.h"
 #include "probingpt/probing_hash_utils.h"
 #include "util/exception.hh"
+#include "util/inner_product.hh"
 #include "../System.h"
 #include "../Scores.h"
 #include "../Phrase.h"
@@ -19,6 +20,7 @@
 #include "../PhraseBased/PhraseImpl.h"
 #include "../PhraseBased/TargetPhraseImpl.h"
 #include "../PhraseBased/Manager.h"
+#include "../PhraseBased/InputPaths.h"
 #include "../PhraseBased/TargetPhrases.h"
 #include "../SCFG/InputPath.h"
 #include "../SCFG/Manager.h"
@@ -153,6 +155,8 @@ void ProbingPT::SetParameter(const std::string& key, const std::string& value)
       load_method = util::READ;
     } else if (value == "parallel_read") {
       load_method = util::PARALLEL_READ;
+    } else if (value == "direct_read") {
+      load_method = util::DIRECT_READ;
     } else {
       UTIL_THROW2("load method not supported" << value);
     }
@@ -163,14 +167,15 @@ void ProbingPT::SetParameter(const std::string& key, const std::string& value)
 
 void ProbingPT::CreateAlignmentMap(System &system, const std::string path)
 {
-  const std::vector< std::vector<unsigned char> > &probingAlignColl = m_engine->getAlignments();
-  m_aligns.resize(probingAlignColl.size(), NULL);
+  // read straight from the mapped file
+  m_aligns.resize(m_engine->getNumAlignments(), NULL);
 
-  for (size_t i = 0; i < probingAlignColl.size(); ++i) {
+  for (size_t i = 0; i < m_aligns.size(); ++i) {
     AlignmentInfo::CollType aligns;
 
-    const std::vector<unsigned char> &probingAligns = probingAlignColl[i];
-    for (size_t j = 0; j < probingAligns.size(); j += 2) {
+    size_t size;
+    const unsigned char *probingAligns = m_engine->getAlignment(i, size);
+    for (size_t j = 0; j < size; j += 2) {
       size_t startPos = probingAligns[j];
       size_t endPos = probingAligns[j+1];
       //cerr << "startPos=" << startPos << " " << endPos << endl;
@@ -185,13 +190,66 @@ void ProbingPT::CreateAlignmentMap(System &system, const std::string path)
 
 void ProbingPT::Lookup(const Manager &mgr, InputPathsBase &inputPaths) const
 {
-  BOOST_FOREACH(InputPathBase *pathBase, inputPaths) {
-    InputPath *path = static_cast<InputPath*>(pathBase);
+  // Spans are looked up shortest first. A span is only probed if the span
+  // one word shorter with the same start is in the table, as a source phrase
+  // or as a prefix mark, and all probes for one length go to the table as a
+  // single prefetched batch.
+  const Matrix<InputPath*> &matrix = static_cast<InputPaths&>(inputPaths).GetMatrix();
+  size_t numStarts = matrix.GetRows();
+  size_t maxLength = matrix.GetCols();
+
+  // per start position: key of the longest span looked up so far, and
+  // whether that span was in the table
+  uint64_t *keys = (uint64_t*) alloca(numStarts * sizeof(uint64_t));
+  bool *inTable = (bool*) alloca(numStarts * sizeof(bool));
+  std::fill(keys, keys + numStarts, 0);
+  std::fill(inTable, inTable + numStarts, true);
+
+  InputPath **batchPaths = (InputPath**) alloca(numStarts * sizeof(InputPath*));
+  uint64_t *batchKeys = (uint64_t*) alloca(numStarts * sizeof(uint64_t));
+  std::pair<bool, uint64_t> *results =
+    (std::pair<bool, uint64_t>*) alloca(numStarts * sizeof(std::pair<bool, uint64_t>));
+
+  for (size_t length = 1; length <= maxLength; ++length) {
+    size_t batchSize = 0;
+    for (size_t startPos = 0; startPos < numStarts; ++startPos) {
+      InputPath *path = matrix.GetValue(startPos, length - 1);
+      if (path == NULL || !inTable[startPos]) {
+        continue;
+      }
+
+      uint64_t probingId = GetSourceProbingId(path->subPhrase.Back());
+      if (probingId == m_unkId) {
+        inTable[startPos] = false;
+        continue;
+      }
+      keys[startPos] += probingId << (length - 1);
+
+      // entries in the cache have rules, so are known to be in the table
+      CachePb::const_iterator iter = m_cachePb.find(keys[startPos]);
+      if (iter != m_cachePb.end()) {
+        if (SatisfyBackoff(mgr, *path)) {
+          path->AddTargetPhrases(*this, iter->second);
+        }
+        continue;
+      }
 
-    if (SatisfyBackoff(mgr, *path)) {
-      TargetPhrases *tpsPtr;
-      tpsPtr = Lookup(mgr, mgr.GetPool(), *path);
-      path->AddTargetPhrases(*this, tpsPtr);
+      batchPaths[batchSize] = path;
+      batchKeys[batchSize] = keys[startPos];
+      ++batchSize;
+    }
+
+    m_engine->query(batchKeys, batchSize, results);
+
+    for (size_t i = 0; i < batchSize; ++i) {
+      InputPath *path = batchPaths[i];
+      if (!results[i].first) {
+        inTable[path->range.GetStartPos()] = false;
+      } else if (results[i].second != NONE && SatisfyBackoff(mgr, *path)) {
+        TargetPhrases *tps = CreateTargetPhrases(mgr.GetPool(), mgr.system,
+                             path->subPhrase, results[i].second);
+        path->AddTargetPhrases(*this, tps);
+      }
     }
   }
 }
@@ -227,7 +285,7 @@ TargetPhrases* ProbingPT::Lookup(const Manager &mgr, MemPool &pool,
   }
 
   // query pt
-  TargetPhrases *tps = CreateTargetPhrases(pool, mgr.system, sourcePhrase,
+  TargetPhrases *tps = CreateTargetPhrasesForKey(pool, mgr.system, sourcePhrase,
                        keyStruct.second);
   return tps;
 }
@@ -253,45 +311,73 @@ std::pair<bool, uint64_t> ProbingPT::GetKey(const Phrase<Moses2::Word> &sourcePh
 
 }
 
-TargetPhrases *ProbingPT::CreateTargetPhrases(MemPool &pool,
+TargetPhrases *ProbingPT::CreateTargetPhrasesForKey(MemPool &pool,
     const System &system, const Phrase<Moses2::Word> &sourcePhrase, uint64_t key) const
 {
-  TargetPhrases *tps = NULL;
-
   //Actual lookup
   std::pair<bool, uint64_t> query_result; // 1st=found, 2nd=target file offset
   query_result = m_engine->query(key);
   //cerr << "key2=" << query_result.second << endl;
 
-  if (query_result.first) {
-    const char *offset = m_engine->memTPS + query_result.second;
-    uint64_t *numTP = (uint64_t*) offset;
+  if (!query_result.first || query_result.second == NONE) {
+    // not in pt, or only a prefix of other source phrases
+    return NULL;
+  }
 
-    tps = new (pool.Allocate<TargetPhrases>()) TargetPhrases(pool, *numTP);
+  return CreateTargetPhrases(pool, system, sourcePhrase, query_result.second);
+}
 
-    offset += sizeof(uint64_t);
-    for (size_t i = 0; i < *numTP; ++i) {
-      TargetPhraseImpl *tp = CreateTargetPhrase(pool, system, offset);
-      assert(tp);
-      const FeatureFunctions &ffs = system.featureFunctions;
-      ffs.EvaluateInIsolation(pool, system, sourcePhrase, *tp);
+TargetPhrases *ProbingPT::CreateTargetPhrases(MemPool &pool,
+    const System &system, const Phrase<Moses2::Word> &sourcePhrase,
+    uint64_t tpsOffset) const
+{
+  const char *offset = m_engine->memTPS + tpsOffset;
+  uint64_t *numTP = (uint64_t*) offset;
+
+  TargetPhrases *tps = new (pool.Allocate<TargetPhrases>()) TargetPhrases(pool, *numTP);
+
+  // the rule scores of all target phrases as one dense block, one column
+  // per score, so that they are weighted in one pass.  From the pool rather
+  // than the stack since there is no bound on the number of target phrases.
+  size_t numScores = GetNumScores();
+  TargetPhraseImpl **created = pool.Allocate<TargetPhraseImpl*>(*numTP);
+  const SCORE **ruleScores = pool.Allocate<const SCORE*>(*numTP);
+  SCORE *block = pool.Allocate<SCORE>(*numTP * numScores);
+  SCORE *weighted = pool.Allocate<SCORE>(*numTP);
+
+  offset += sizeof(uint64_t);
+  for (size_t i = 0; i < *numTP; ++i) {
+    created[i] = CreateTargetPhrase(pool, system, offset, ruleScores[i]);
+    assert(created[i]);
+    for (size_t j = 0; j < numScores; ++j) {
+      block[j * *numTP + i] = ruleScores[i][j];
+    }
+  }
 
-      tps->AddTargetPhrase(*tp);
+  util::InnerProducts(block, *numTP, numScores,
+                      system.weights.GetWeightsPtr(GetStartInd()), weighted);
 
-    }
+  const FeatureFunctions &ffs = system.featureFunctions;
+  for (size_t i = 0; i < *numTP; ++i) {
+    TargetPhraseImpl *tp = created[i];
+    tp->GetScores().PlusEquals(system, *this, ruleScores[i], weighted[i]);
+    ffs.EvaluateInIsolation(pool, system, sourcePhrase, *tp);
 
-    tps->SortAndPrune(m_tableLimit);
-    system.featureFunctions.EvaluateAfterTablePruning(pool, *tps, sourcePhrase);
-    //cerr << *tps << endl;
+    tps->AddTargetPhrase(*tp);
   }
 
+  tps->SortAndPrune(m_tableLimit);
+  system.featureFunctions.EvaluateAfterTablePruning(pool, *tps, sourcePhrase);
+  //cerr << *tps << endl;
+
   return tps;
 }
 
 TargetPhraseImpl *ProbingPT::CreateTargetPhrase(
   MemPool &pool,
   const System &system,
-  const char *&offset) const
+  const char *&offset,
+  const SCORE *&ruleScores) const
 {
   probingpt::TargetPhraseInfo *tpInfo = (probingpt::TargetPhraseInfo*) offset;
   size_t numRealWords = tpInfo->numWords / m_output.size();
@@ -308,27 +394,26 @@ TargetPhraseImpl *ProbingPT::CreateTargetPhrase(
   size_t totalNumScores = m_engine->num_scores + m_engine->num_lex_scores;
 
   if (m_engine->logProb) {
-    // set pt score for rule
-    tp->GetScores().PlusEquals(system, *this, scores);
+    // pt score for rule
+    ruleScores = scores;
 
     // save scores for other FF, eg. lex RO. Just give the offset
     if (m_engine->num_lex_scores) {
       tp->scoreProperties = scores + m_engine->num_scores;
     }
   } else {
-    // log score 1st
-    SCORE *logScores = (SCORE*) alloca(totalNumScores * sizeof(SCORE));
+    // log score 1st. Kept in the pool, as the caller needs the rule scores
+    SCORE *logScores = pool.Allocate<SCORE>(totalNumScores);
     for (size_t i = 0; i < totalNumScores; ++i) {
       logScores[i] = FloorScore(TransformScore(scores[i]));
     }
 
-    // set pt score for rule
-    tp->GetScores().PlusEquals(system, *this, logScores);
+    // pt score for rule
+    ruleScores = logScores;
 
     // save scores for other FF, eg. lex RO.
-    tp->scoreProperties = pool.Allocate<SCORE>(m_engine->num_lex_scores);
-    for (size_t i = 0; i < m_engine->num_lex_scores; ++i) {
-      tp->scoreProperties[i] = logScores[i + m_engine->num_scores];
+    if (m_engine->num_lex_scores) {
+      tp->scoreProperties = logScores + m_engine->num_scores;
     }
   }
 
@@ -435,7 +520,7 @@ void ProbingPT::CreateCache(System &system)
       }
       cerr << "key=" << retStruct.second << " " << key << endl;
       */
-      TargetPhrases *tps = CreateTargetPhrases(pool, system, *sourcePhrase, key);
+      TargetPhrases *tps = CreateTargetPhrasesForKey(pool, system, *sourcePhrase, key);
       assert(tps);
 
       m_cachePb[key] = tps;
@@ -631,9 +716,11 @@ SCFG::TargetPhraseImpl *ProbingPT::CreateTargetPhraseSCFG(
     tp->GetScores().PlusEquals(system, *this, logScores);
 
     // save scores for other FF, eg. lex RO.
-    tp->scoreProperties = pool.Allocate<SCORE>(m_engine->num_lex_scores);
-    for (size_t i = 0; i < m_engine->num_lex_scores; ++i) {
-      tp->scoreProperties[i] = logScores[i + m_engine->num_scores];
+    if (m_engine->num_lex_scores) {
+      tp->scoreProperties = pool.Allocate<SCORE>(m_engine->num_lex_scores);
+      for (size_t i = 0; i < m_engine->num_lex_scores; ++i) {
+        tp->scoreProperties[i] = logScores[i + m_engine->num_scores];
+      }
     }
   }
 
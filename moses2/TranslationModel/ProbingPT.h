@@ -109,10 +109,13 @@ protected:
 
   TargetPhrases *Lookup(const Manager &mgr, MemPool &pool,
                         InputPath &inputPath) const;
+  TargetPhrases *CreateTargetPhrasesForKey(MemPool &pool, const System &system,
+      const Phrase<Moses2::Word> &sourcePhrase, uint64_t key) const;
   TargetPhrases *CreateTargetPhrases(MemPool &pool, const System &system,
-                                     const Phrase<Moses2::Word> &sourcePhrase, uint64_t key) const;
+                                     const Phrase<Moses2::Word> &sourcePhrase, uint64_t tpsOffset) const;
+  // the rule scores are returned in ruleScores, not yet added to the phrase
   TargetPhraseImpl *CreateTargetPhrase(MemPool &pool, const System &system,
-                                       const char *&offset) const;
+                                       const char *&offset, const SCORE *&ruleScores) const;
 
   inline const std::pair<bool, const Factor*> *GetTargetFactor(uint32_t probingId) const {
     if (probingId >= m_targetVocab.size()) {
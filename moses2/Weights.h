@@ -28,6 +28,12 @@ public:
 
   std::vector<SCORE> GetWeights(const FeatureFunction &ff) const;
 
+  // contiguous weights from startInd on, for util::InnerProduct().
+  // startInd may be the end, for a feature function without scores.
+  const SCORE *GetWeightsPtr(size_t startInd) const {
+    return m_weights.data() + startInd;
+  }
+
   void SetWeights(const FeatureFunctions &ffs, const std::string &ffName, const std::vector<float> &weights);
 
 protected:
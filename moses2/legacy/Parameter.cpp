@@ -318,6 +318,8 @@ Parameter::Parameter()
            "maximum num. of source word chart rules can consume (default 10)");
   AddParam(chart_opts, "non-terminals",
            "list of non-term symbols, space separated");
+  AddParam(chart_opts, "chart-span-threads",
+           "number of threads that search the spans of one width in parallel within a sentence (default 1, i.e. the sequential search)");
   //AddParam(chart_opts, "rule-limit",
   //    "a little like table limit. But for chart decoding rules. Default is DEFAULT_MAX_TRANS_OPT_SIZE");
   //AddParam(chart_opts, "source-label-overlap",
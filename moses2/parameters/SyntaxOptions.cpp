@@ -15,6 +15,7 @@ SyntaxOptions::SyntaxOptions()
   , default_non_term_only_for_empty_range(false)
   , source_label_overlap(SourceLabelOverlapAdd)
   , rule_limit(DEFAULT_MAX_TRANS_OPT_SIZE)
+  , span_threads(1)
 {}
 
 bool SyntaxOptions::init(Parameter const& param)
@@ -26,6 +27,7 @@ bool SyntaxOptions::init(Parameter const& param)
                      "default-non-term-for-empty-range-only", false);
   param.SetParameter(source_label_overlap, "source-label-overlap",
                      SourceLabelOverlapAdd);
+  param.SetParameter(span_threads, "chart-span-threads", size_t(1));
   return true;
 }
 
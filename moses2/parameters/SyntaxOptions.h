@@ -27,6 +27,7 @@ struct
   UnknownLHSList unknown_lhs;
   SourceLabelOverlap source_label_overlap; // m_sourceLabelOverlap;
   size_t rule_limit;
+  size_t span_threads; // threads searching the spans of one width in parallel
 
   SyntaxOptions();
 
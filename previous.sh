@@ -0,0 +1,2 @@
+#!/bin/sh
+./bjam -j2 --no-xmlrpc-c -q moses//dynamic_cache_based_test search//stats_test util//numa_test moses-cmd//moses
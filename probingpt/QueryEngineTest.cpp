@@ -0,0 +1,153 @@
+#include "querying.h"
+#include "storing.h"
+#include "util/exception.hh"
+
+#define BOOST_TEST_MODULE QueryEngine
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace probingpt;
+
+namespace
+{
+
+namespace fs = boost::filesystem;
+
+// A text phrase table in a directory that goes away with it.
+class TempTable
+{
+public:
+  template <size_t N> explicit TempTable(const char *(&lines)[N])
+    : m_dir(fs::temp_directory_path() / fs::unique_path()) {
+    fs::create_directories(m_dir);
+    std::ofstream out((m_dir / "phrase-table").string().c_str());
+    for (size_t i = 0; i < N; ++i) {
+      out << lines[i] << '\n';
+    }
+  }
+
+  ~TempTable() {
+    fs::remove_all(m_dir);
+  }
+
+  std::string Path() const {
+    return (m_dir / "probing").string();
+  }
+
+  void Binarize() const {
+    createProbingPT((m_dir / "phrase-table").string(), Path(), 2, 0, true, 0, false);
+  }
+
+private:
+  fs::path m_dir;
+};
+
+typedef std::vector<unsigned char> Alignment;
+
+Alignment MakeAlignment(const unsigned char *begin, size_t size)
+{
+  return Alignment(begin, begin + size);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(alignments_round_trip)
+{
+  const char *lines[] = {
+    "a ||| x ||| 0.5 0.5 ||| 0-0 ||| 1 1 1",
+    "a ||| x y ||| 0.25 0.5 ||| 0-0 0-1 ||| 1 1 1",
+    "a b ||| y x ||| 0.5 0.25 ||| 0-1 1-0 ||| 1 1 1",
+    "b ||| y ||| 0.5 0.5 ||| 0-0 ||| 1 1 1",
+    "c d e ||| z ||| 0.5 0.5 ||| 2-0 ||| 1 1 1",
+    "f ||| w ||| 0.5 0.5 ||| 200-255 ||| 1 1 1"
+  };
+  TempTable table(lines);
+  table.Binarize();
+  QueryEngine engine(table.Path().c_str(), util::READ);
+
+  // Ids are handed out as alignments are first seen, including the empty
+  // non-terminal alignment of every rule, so compare them as a set.
+  std::set<Alignment> expected;
+  expected.insert(Alignment());
+  const unsigned char aligns[][4] = {
+    {0, 0}, {0, 0, 0, 1}, {0, 1, 1, 0}, {2, 0}, {200, 255}
+  };
+  const size_t sizes[] = {2, 4, 4, 2, 2};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+    expected.insert(MakeAlignment(aligns[i], sizes[i]));
+  }
+
+  BOOST_REQUIRE_EQUAL(expected.size(), engine.getNumAlignments());
+  std::set<Alignment> got;
+  for (uint64_t i = 0; i < engine.getNumAlignments(); ++i) {
+    size_t size;
+    const unsigned char *align = engine.getAlignment(i, size);
+    got.insert(MakeAlignment(align, size));
+  }
+  BOOST_CHECK(got == expected);
+}
+
+BOOST_AUTO_TEST_CASE(alignment_position_too_large)
+{
+  const char *lines[] = {
+    "a ||| x ||| 0.5 0.5 ||| 0-256 ||| 1 1 1"
+  };
+  TempTable table(lines);
+  BOOST_CHECK_THROW(table.Binarize(), util::Exception);
+}
+
+BOOST_AUTO_TEST_CASE(prefix_marks)
+{
+  const char *lines[] = {
+    "a ||| x ||| 0.5 0.5 ||| 0-0 ||| 1 1 1",
+    "a b c ||| x y z ||| 0.5 0.5 ||| 0-0 1-1 2-2 ||| 1 1 1",
+    "a d ||| x w ||| 0.5 0.5 ||| 0-0 1-1 ||| 1 1 1",
+    "e f g ||| v ||| 0.5 0.5 ||| 0-0 ||| 1 1 1"
+  };
+  TempTable table(lines);
+  table.Binarize();
+  QueryEngine engine(table.Path().c_str(), util::READ);
+
+  // source phrase, then whether it is in the table and whether it has rules
+  const char *phrases[] = {
+    "a", "a b", "a b c", "a d", "e", "e f", "e f g",
+    "b", "b c", "a c", "a b c d", "f g", "g"
+  };
+  const bool found[] = {
+    true, true, true, true, true, true, true,
+    false, false, false, false, false, false
+  };
+  const bool rules[] = {
+    true, false, true, true, false, false, true,
+    false, false, false, false, false, false
+  };
+  const size_t num = sizeof(phrases) / sizeof(phrases[0]);
+
+  std::vector<uint64_t> keys;
+  for (size_t i = 0; i < num; ++i) {
+    BOOST_TEST_CHECKPOINT(phrases[i]);
+    keys.push_back(getKey(getVocabIDs(phrases[i])));
+    const std::pair<bool, uint64_t> single = engine.query(keys.back());
+    BOOST_CHECK_EQUAL(found[i], single.first);
+    if (single.first) {
+      BOOST_CHECK_EQUAL(rules[i], single.second != NONE);
+    }
+  }
+
+  // a batch finds what the keys do one at a time
+  std::vector<std::pair<bool, uint64_t> > batch(num);
+  engine.query(&keys[0], num, &batch[0]);
+  for (size_t i = 0; i < num; ++i) {
+    BOOST_TEST_CHECKPOINT(phrases[i]);
+    const std::pair<bool, uint64_t> single = engine.query(keys[i]);
+    BOOST_CHECK_EQUAL(single.first, batch[i].first);
+    if (single.first) {
+      BOOST_CHECK_EQUAL(single.second, batch[i].second);
+    }
+  }
+}
@@ -4,12 +4,13 @@
  *  Created on: 19 Jan 2016
  *      Author: hieu
  */
+#include <limits>
 #include <boost/foreach.hpp>
 #include "StoreTarget.h"
 #include "line_splitter.h"
 #include "probing_hash_utils.h"
-#include "OutputFileStream.h"
 #include "moses2/legacy/Util2.h"
+#include "util/exception.hh"
 
 using namespace std;
 
@@ -88,19 +89,36 @@ void StoreTarget::Save(const target_text &rule)
 
 void StoreTarget::SaveAlignment()
 {
+  // order by id
+  std::vector<const std::vector<size_t>*> byId(m_aligns.size());
+  BOOST_FOREACH(Alignments::value_type &valPair, m_aligns) {
+    byId[valPair.second] = &valPair.first;
+  }
+
   std::string path = m_basePath + "/Alignments.dat";
-  probingpt::OutputFileStream file(path);
+  std::ofstream file(path.c_str(), std::ios::out | std::ios::binary);
 
-  BOOST_FOREACH(Alignments::value_type &valPair, m_aligns) {
-    file << valPair.second << "\t";
+  AlignmentsHeader header;
+  header.numAligns = byId.size();
+  file.write((char*) &header, sizeof(AlignmentsHeader));
 
-    const std::vector<size_t> &aligns = valPair.first;
-    BOOST_FOREACH(size_t align, aligns) {
-      file << align << " ";
+  uint64_t offset = 0;
+  for (size_t i = 0; i < byId.size(); ++i) {
+    file.write((char*) &offset, sizeof(uint64_t));
+    offset += byId[i]->size();
+  }
+  file.write((char*) &offset, sizeof(uint64_t));
+
+  for (size_t i = 0; i < byId.size(); ++i) {
+    BOOST_FOREACH(size_t align, *byId[i]) {
+      UTIL_THROW_IF2(align > std::numeric_limits<unsigned char>::max(),
+                     "Alignment position " << align << " does not fit in a byte");
+      unsigned char pos = align;
+      file.write((char*) &pos, sizeof(pos));
     }
-    file << endl;
   }
 
+  file.close();
 }
 
 void StoreTarget::Append(const line_text &line, bool log_prob, bool scfg)
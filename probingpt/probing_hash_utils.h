@@ -14,7 +14,7 @@
 namespace probingpt
 {
 
-#define API_VERSION 15
+#define API_VERSION 17
 
 //Hash table entry
 struct Entry {
@@ -32,6 +32,8 @@ struct Entry {
   uint64_t value;
 };
 
+// value of an entry that only marks a prefix of longer source phrases and
+// has no target phrases of its own
 #define NONE       std::numeric_limits<uint64_t>::max()
 
 //Define table
@@ -43,6 +45,13 @@ char * readTable(const char * filename, util::LoadMethod load_method, util::scop
 
 uint64_t getKey(const uint64_t source_phrase[], size_t size);
 
+// Alignments.dat is mapped as is: the number of alignments N, N + 1
+// offsets into the data that follows, then the data. Alignment i is the
+// (source, target) position pairs in bytes offsets[i] to offsets[i + 1].
+struct AlignmentsHeader {
+  uint64_t numAligns;
+};
+
 struct TargetPhraseInfo {
   uint32_t alignTerm;
   uint32_t alignNonTerm;
@@ -24,7 +24,7 @@ QueryEngine::QueryEngine(const char * filepath, util::LoadMethod load_method)
   read_map(source_vocabids, path_to_source_vocabid.c_str());
 
   // alignments
-  read_alignments(alignPath);
+  read_alignments(alignPath, load_method);
 
   // target phrase
   string targetCollPath = basepath + "/TargetColl.dat";
@@ -119,28 +119,40 @@ std::pair<bool, uint64_t> QueryEngine::query(uint64_t key)
   return ret;
 }
 
-void QueryEngine::read_alignments(const std::string &alignPath)
+void QueryEngine::query(const uint64_t *keys, size_t num,
+                        std::pair<bool, uint64_t> *results) const
 {
-  std::ifstream strm(alignPath.c_str());
-
-  string line;
-  while (getline(strm, line)) {
-    vector<string> toks = Moses2::Tokenize(line, "\t ");
-    UTIL_THROW_IF2(toks.size() == 0, "Corrupt alignment file");
-
-    uint32_t alignInd = Moses2::Scan<uint32_t>(toks[0]);
-    if (alignInd >= alignColl.size()) {
-      alignColl.resize(alignInd + 1);
-    }
+  Table::ConstIterator *entries =
+    (Table::ConstIterator*) alloca(num * sizeof(Table::ConstIterator));
+  for (size_t i = 0; i < num; ++i) {
+    entries[i] = table.Ideal(keys[i]);
+#ifdef __GNUC__
+    __builtin_prefetch(entries[i], 0, 0);
+#endif
+  }
 
-    Alignments &aligns = alignColl[alignInd];
-    for (size_t i = 1; i < toks.size(); ++i) {
-      size_t pos = Moses2::Scan<size_t>(toks[i]);
-      aligns.push_back(pos);
+  for (size_t i = 0; i < num; ++i) {
+    results[i].first = table.FindFromIdeal(keys[i], entries[i]);
+    if (results[i].first) {
+      results[i].second = entries[i]->value;
     }
   }
 }
 
+void QueryEngine::read_alignments(const std::string &alignPath, util::LoadMethod load_method)
+{
+  const char *mem = readTable(alignPath.c_str(), load_method, fileAlign_, memoryAlign_);
+  UTIL_THROW_IF2(memoryAlign_.size() < sizeof(AlignmentsHeader), "Corrupt alignment file");
+
+  numAligns = ((const AlignmentsHeader*) mem)->numAligns;
+  UTIL_THROW_IF2(memoryAlign_.size() < sizeof(AlignmentsHeader) + (numAligns + 1) * sizeof(uint64_t),
+                 "Corrupt alignment file");
+  alignOffsets = (const uint64_t*) (mem + sizeof(AlignmentsHeader));
+  alignData = (const unsigned char*) (alignOffsets + numAligns + 1);
+  UTIL_THROW_IF2((const char*) alignData + alignOffsets[numAligns] != mem + memoryAlign_.size(),
+                 "Corrupt alignment file");
+}
+
 void QueryEngine::file_exits(const std::string &basePath)
 {
   if (!Moses2::FileExists(basePath + "/Alignments.dat")) {
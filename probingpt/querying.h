@@ -19,8 +19,12 @@ class QueryEngine
 {
   std::map<uint64_t, std::string> source_vocabids;
 
-  typedef std::vector<unsigned char> Alignments;
-  std::vector<Alignments> alignColl;
+  // alignments, mapped
+  util::scoped_fd fileAlign_;
+  util::scoped_memory memoryAlign_;
+  uint64_t numAligns;
+  const uint64_t *alignOffsets;
+  const unsigned char *alignData;
 
   Table table;
   char *mem; //Memory for the table, necessary so that we can correctly destroy the object
@@ -37,7 +41,7 @@ class QueryEngine
   util::scoped_fd fileTPS_;
   util::scoped_memory memoryTPS_;
 
-  void read_alignments(const std::string &alignPath);
+  void read_alignments(const std::string &alignPath, util::LoadMethod load_method);
   void file_exits(const std::string &basePath);
 
 public:
@@ -51,12 +55,23 @@ public:
 
   std::pair<bool, uint64_t> query(uint64_t key);
 
+  // Looks up keys[0..num) into results[0..num). The buckets of all keys are
+  // prefetched before any is probed so that the cache misses overlap.
+  void query(const uint64_t *keys, size_t num,
+             std::pair<bool, uint64_t> *results) const;
+
   const std::map<uint64_t, std::string> &getSourceVocab() const {
     return source_vocabids;
   }
 
-  const std::vector<Alignments> &getAlignments() const {
-    return alignColl;
+  uint64_t getNumAlignments() const {
+    return numAligns;
+  }
+
+  // alignment ind as size bytes of (source, target) position pairs
+  const unsigned char *getAlignment(uint64_t ind, size_t &size) const {
+    size = alignOffsets[ind + 1] - alignOffsets[ind];
+    return alignData + alignOffsets[ind];
   }
 
   uint64_t getKey(uint64_t source_phrase[], size_t size) const;
@@ -77,8 +77,9 @@ void createProbingPT(const std::string &phrasetable_path,
 
   StoreTarget storeTarget(basepath);
 
-  //Get uniq lines:
-  unsigned long uniq_entries = countUniqueSource(phrasetable_path);
+  //Get uniq lines, and the number of entries needed including prefix marks:
+  size_t numEntries;
+  countUniqueSource(phrasetable_path, numEntries);
 
   //Source phrase vocabids
   StoreVocab<uint64_t> sourceVocab(basepath + "/source_vocabids");
@@ -87,7 +88,7 @@ void createProbingPT(const std::string &phrasetable_path,
   util::FilePiece filein(phrasetable_path.c_str());
 
   //Init the probing hash table
-  size_t size = Table::Size(uniq_entries, 1.2);
+  size_t size = Table::Size(numEntries, 1.2);
   char * mem = new char[size];
   memset(mem, 0, size);
   Table sourceEntries(mem, size);
@@ -144,10 +145,8 @@ void createProbingPT(const std::string &phrasetable_path,
         //The key is the sum of hashes of individual words bitshifted by their position in the phrase.
         //Probably not entirerly correct, but fast and seems to work fine in practise.
         std::vector<uint64_t> vocabid_source = getVocabIDs(prevSource);
-        if (scfg) {
-          // storing prefixes?
-          sourcePhrases.Add(sourceEntries, vocabid_source);
-        }
+        // mark its prefixes so lookups can stop extending a span early
+        sourcePhrases.Add(sourceEntries, vocabid_source);
         sourceEntry.key = getKey(vocabid_source);
 
         /*
@@ -204,6 +203,7 @@ void createProbingPT(const std::string &phrasetable_path,
 
       //The key is the sum of hashes of individual words. Probably not entirerly correct, but fast
       std::vector<uint64_t> vocabid_source = getVocabIDs(prevSource);
+      sourcePhrases.Add(sourceEntries, vocabid_source);
       sourceEntry.key = getKey(vocabid_source);
 
       //Put into table
@@ -229,7 +229,7 @@ void createProbingPT(const std::string &phrasetable_path,
   std::ofstream configfile;
   configfile.open((basepath + "/config").c_str());
   configfile << "API_VERSION\t" << API_VERSION << '\n';
-  configfile << "uniq_entries\t" << uniq_entries << '\n';
+  configfile << "uniq_entries\t" << numEntries << '\n';
   configfile << "num_scores\t" << num_scores << '\n';
   configfile << "num_lex_scores\t" << num_lex_scores << '\n';
   configfile << "log_prob\t" << log_prob << '\n';
@@ -237,12 +237,14 @@ void createProbingPT(const std::string &phrasetable_path,
 #endif
 }
 
-size_t countUniqueSource(const std::string &path)
+size_t countUniqueSource(const std::string &path, size_t &numEntries)
 {
   size_t ret = 0;
+  numEntries = 0;
   InputFileStream strme(path);
 
   std::string line, prevSource;
+  std::vector<std::string> prevWords;
   while (std::getline(strme, line)) {
     std::vector<std::string> toks = Moses2::TokenizeMultiCharSeparator(line, "|||");
     assert(toks.size() != 0);
@@ -250,6 +252,19 @@ size_t countUniqueSource(const std::string &path)
     if (prevSource != toks[0]) {
       prevSource = toks[0];
       ++ret;
+
+      // the table is sorted, so a prefix is new unless the previous source
+      // phrase starts with it. May overcount prefixes that are also source
+      // phrases, which only costs some space.
+      std::vector<std::string> words = Moses2::Tokenize(prevSource, " ");
+      size_t common = 0;
+      while (common < words.size() && common < prevWords.size()
+             && words[common] == prevWords[common]) {
+        ++common;
+      }
+      size_t numPrefixes = words.empty() ? 0 : words.size() - 1;
+      numEntries += 1 + numPrefixes - std::min(common, numPrefixes);
+      prevWords.swap(words);
     }
   }
 
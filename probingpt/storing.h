@@ -57,7 +57,9 @@ std::string Debug(const std::vector<T> &vec)
   return strm.str();
 }
 
-size_t countUniqueSource(const std::string &path);
+// Returns the number of unique source phrases. numEntries is set to the
+// number of hash table entries they need, including prefix marks.
+size_t countUniqueSource(const std::string &path, size_t &numEntries);
 
 class CacheItem
 {
@@ -2,6 +2,7 @@
 #define SEARCH_CONTEXT__
 
 #include "search/config.hh"
+#include "search/stats.hh"
 #include "search/vertex.hh"
 
 #include <boost/pool/object_pool.hpp>
@@ -10,7 +11,7 @@ namespace search {
 
 class ContextBase {
   public:
-    explicit ContextBase(const Config &config) : config_(config) {}
+    explicit ContextBase(const Config &config) : config_(config), stats_(NULL) {}
 
     VertexNode *NewVertexNode() {
       VertexNode *ret = vertex_node_pool_.construct();
@@ -28,10 +29,18 @@ class ContextBase {
 
     const Config &GetConfig() const { return config_; }
 
+    // Statistics collection is off unless a Stats object is provided.  The
+    // caller retains ownership.
+    void SetStats(Stats *stats) { stats_ = stats; }
+
+    Stats *GetStats() const { return stats_; }
+
   private:
     boost::object_pool<VertexNode> vertex_node_pool_;
 
     Config config_;
+
+    Stats *stats_;
 };
 
 template <class Model> class Context : public ContextBase {
@@ -17,14 +17,17 @@ template <class Model> void FastScore(const Context<Model> &context, Arity victi
   lm::ngram::ChartState *before = &between[before_idx], *after = &between[before_idx + 1];
 
   float adjustment = 0.0;
+  unsigned int lm_calls = 0;
   const lm::ngram::ChartState &previous_reveal = previous_vertex.State();
   const PartialVertex &update_nt = update.NT()[victim];
   const lm::ngram::ChartState &update_reveal = update_nt.State();
   if ((update_reveal.left.length > previous_reveal.left.length) || (update_reveal.left.full && !previous_reveal.left.full)) {
     adjustment += lm::ngram::RevealAfter(context.LanguageModel(), before->left, before->right, update_reveal.left, previous_reveal.left.length);
+    ++lm_calls;
   }
   if ((update_reveal.right.length > previous_reveal.right.length) || (update_nt.RightFull() && !previous_vertex.RightFull())) {
     adjustment += lm::ngram::RevealBefore(context.LanguageModel(), update_reveal.right, previous_reveal.right.length, update_nt.RightFull(), after->left, after->right);
+    ++lm_calls;
   }
   if (update_nt.Complete()) {
     if (update_reveal.left.full) {
@@ -32,6 +35,7 @@ template <class Model> void FastScore(const Context<Model> &context, Arity victi
     } else {
       assert(update_reveal.left.length == update_reveal.right.length);
       adjustment += lm::ngram::Subsume(context.LanguageModel(), before->left, before->right, after->left, after->right, update_reveal.left.length);
+      ++lm_calls;
     }
     before->right = after->right;
     // Shift the others shifted one down, covering after.
@@ -40,12 +44,15 @@ template <class Model> void FastScore(const Context<Model> &context, Arity victi
     }
   }
   update.SetScore(update.GetScore() + adjustment * context.LMWeight());
+  if (Stats *stats = context.GetStats()) stats->Count().lm_calls += lm_calls;
 }
 
 } // namespace
 
 template <class Model> PartialEdge EdgeGenerator::Pop(Context<Model> &context) {
   assert(!generate_.empty());
+  Stats *stats = context.GetStats();
+  if (stats) ++stats->Count().pops;
   PartialEdge top = generate_.top();
   generate_.pop();
   PartialVertex *const top_nt = top.NT();
@@ -76,6 +83,10 @@ template <class Model> PartialEdge EdgeGenerator::Pop(Context<Model> &context) {
   PartialVertex old_value(top_nt[victim]);
   PartialVertex alternate_changed;
   if (top_nt[victim].Split(alternate_changed)) {
+    if (stats) {
+      ++stats->Count().splits;
+      ++stats->Count().pushes;
+    }
     PartialEdge alternate(partial_edge_pool_, arity, incomplete + 1);
     alternate.SetScore(top.GetScore() + alternate_changed.Bound() - old_value.Bound());
 
@@ -100,6 +111,7 @@ template <class Model> PartialEdge EdgeGenerator::Pop(Context<Model> &context) {
   FastScore(context, victim, victim - victim_completed, incomplete, old_value, top);
   // TODO: dedupe?
   generate_.push(top);
+  if (stats) ++stats->Count().pushes;
   assert(lowest_niceness != 254 || top.GetScore() == before);
 
   // Invalid indicates no new hypothesis generated.
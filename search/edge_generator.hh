@@ -2,6 +2,7 @@
 #define SEARCH_EDGE_GENERATOR__
 
 #include "search/edge.hh"
+#include "search/stats.hh"
 #include "search/types.hh"
 
 #include <queue>
@@ -34,6 +35,8 @@ class EdgeGenerator {
     template <class Model> PartialEdge Pop(Context<Model> &context);
 
     template <class Model, class Output> void Search(Context<Model> &context, Output &output) {
+      Stats *stats = context.GetStats();
+      if (stats) stats->Count().pushes += generate_.size();
       unsigned to_pop = context.PopLimit();
       while (to_pop > 0 && !generate_.empty()) {
         PartialEdge got(Pop(context));
@@ -42,6 +45,10 @@ class EdgeGenerator {
           --to_pop;
         }
       }
+      if (stats) {
+        stats->Count().hypotheses += context.PopLimit() - to_pop;
+        if (!to_pop) ++stats->Count().pop_limit_hits;
+      }
       output.FinishedSearch();
     }
 
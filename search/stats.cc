@@ -0,0 +1,82 @@
+#include "search/stats.hh"
+
+#include "util/usage.hh"
+
+#include <cassert>
+#include <ostream>
+
+namespace search {
+
+void Stats::BeginCell(size_t start, size_t end) {
+  assert(!in_cell_);
+  in_cell_ = true;
+  begin_.start = start;
+  begin_.end = end;
+  begin_.counters = current_;
+  begin_time_ = util::WallTime();
+}
+
+void Stats::EndCell() {
+  assert(in_cell_);
+  in_cell_ = false;
+  double seconds = util::WallTime() - begin_time_;
+  ++cells_;
+  seconds_ += seconds;
+  if (seconds > max_cell_seconds_) max_cell_seconds_ = seconds;
+  if (!keep_cells_) return;
+  CellStats cell;
+  cell.start = begin_.start;
+  cell.end = begin_.end;
+  cell.seconds = seconds;
+  const Counters &before = begin_.counters;
+  cell.counters.pops = current_.pops - before.pops;
+  cell.counters.pushes = current_.pushes - before.pushes;
+  cell.counters.splits = current_.splits - before.splits;
+  cell.counters.lm_calls = current_.lm_calls - before.lm_calls;
+  cell.counters.rules_scored = current_.rules_scored - before.rules_scored;
+  cell.counters.hypotheses = current_.hypotheses - before.hypotheses;
+  cell.counters.pop_limit_hits = current_.pop_limit_hits - before.pop_limit_hits;
+  cell_list_.push_back(cell);
+}
+
+void Stats::Add(const Stats &other) {
+  current_.Add(other.current_);
+  sentences_ += other.sentences_;
+  cells_ += other.cells_;
+  seconds_ += other.seconds_;
+  if (other.max_cell_seconds_ > max_cell_seconds_) max_cell_seconds_ = other.max_cell_seconds_;
+}
+
+namespace {
+void WriteCounters(std::ostream &out, const Counters &c) {
+  out << "\"pops\":" << c.pops
+      << ",\"pushes\":" << c.pushes
+      << ",\"splits\":" << c.splits
+      << ",\"lm_calls\":" << c.lm_calls
+      << ",\"rules_scored\":" << c.rules_scored
+      << ",\"hypotheses\":" << c.hypotheses
+      << ",\"pop_limit_hits\":" << c.pop_limit_hits;
+}
+} // namespace
+
+void Stats::WriteJSON(std::ostream &out) const {
+  out << '{';
+  WriteCounters(out, current_);
+  out << ",\"sentences\":" << sentences_
+      << ",\"cells\":" << cells_
+      << ",\"cell_seconds\":" << seconds_
+      << ",\"max_cell_seconds\":" << max_cell_seconds_;
+  if (keep_cells_) {
+    out << ",\"cell_list\":[";
+    for (std::vector<CellStats>::const_iterator i = cell_list_.begin(); i != cell_list_.end(); ++i) {
+      if (i != cell_list_.begin()) out << ',';
+      out << "{\"start\":" << i->start << ",\"end\":" << i->end << ',';
+      WriteCounters(out, i->counters);
+      out << ",\"seconds\":" << i->seconds << '}';
+    }
+    out << ']';
+  }
+  out << '}';
+}
+
+} // namespace search
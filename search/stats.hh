@@ -0,0 +1,95 @@
+#ifndef SEARCH_STATS__
+#define SEARCH_STATS__
+
+#include <iosfwd>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace search {
+
+// Counters for the hot paths of the search.  Collection is switched on by
+// giving the Context a Stats object; when it has none, each counter costs a
+// single predictable branch.
+struct Counters {
+  Counters() : pops(0), pushes(0), splits(0), lm_calls(0), rules_scored(0), hypotheses(0), pop_limit_hits(0) {}
+
+  void Add(const Counters &other) {
+    pops += other.pops;
+    pushes += other.pushes;
+    splits += other.splits;
+    lm_calls += other.lm_calls;
+    rules_scored += other.rules_scored;
+    hypotheses += other.hypotheses;
+    pop_limit_hits += other.pop_limit_hits;
+  }
+
+  // Partial edges taken off the queue.
+  uint64_t pops;
+  // Partial edges put on the queue, including the initial ones.
+  uint64_t pushes;
+  // Partial vertices split into a continuation and an alternative.
+  uint64_t splits;
+  // Calls to the language model to score revealed words.
+  uint64_t lm_calls;
+  // Rules scored by the language model before the search.
+  uint64_t rules_scored;
+  // Complete hypotheses produced.
+  uint64_t hypotheses;
+  // Searches that stopped because they reached the pop limit.
+  uint64_t pop_limit_hits;
+};
+
+struct CellStats {
+  size_t start, end;
+  Counters counters;
+  double seconds;
+};
+
+// Statistics for one sentence, or aggregated over many.
+class Stats {
+  public:
+    Stats() : sentences_(0), cells_(0), seconds_(0.0), max_cell_seconds_(0.0), in_cell_(false), keep_cells_(true) {}
+
+    // Do not record the individual cells, only the totals.
+    void KeepCells(bool keep) { keep_cells_ = keep; }
+
+    Counters &Count() { return current_; }
+
+    // Bracket the search for one chart cell to record its counters and wall
+    // time.
+    void BeginCell(size_t start, size_t end);
+    void EndCell();
+
+    void EndSentence() { ++sentences_; }
+
+    // Sum the totals of other into this.  Individual cells are not copied.
+    void Add(const Stats &other);
+
+    const Counters &Totals() const { return current_; }
+
+    const std::vector<CellStats> &Cells() const { return cell_list_; }
+
+    // Write a JSON object without a trailing newline.
+    void WriteJSON(std::ostream &out) const;
+
+  private:
+    Counters current_;
+
+    uint64_t sentences_, cells_;
+    double seconds_, max_cell_seconds_;
+
+    std::vector<CellStats> cell_list_;
+
+    // For the cell in progress.
+    bool in_cell_;
+    CellStats begin_;
+    double begin_time_;
+
+    bool keep_cells_;
+};
+
+} // namespace search
+
+#endif // SEARCH_STATS__
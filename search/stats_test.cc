@@ -0,0 +1,98 @@
+#include "search/stats.hh"
+
+#define BOOST_TEST_MODULE StatsTest
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <string>
+
+namespace search {
+namespace {
+
+void Count(Stats &stats, uint64_t pops, uint64_t splits) {
+  stats.Count().pops += pops;
+  stats.Count().pushes += pops + 1;
+  stats.Count().splits += splits;
+  ++stats.Count().hypotheses;
+}
+
+BOOST_AUTO_TEST_CASE(PerCell) {
+  Stats stats;
+  // Counted outside any cell: only in the totals.
+  Count(stats, 100, 0);
+  stats.BeginCell(0, 1);
+  Count(stats, 5, 2);
+  stats.EndCell();
+  stats.BeginCell(1, 3);
+  Count(stats, 7, 0);
+  stats.Count().pop_limit_hits = 1;
+  stats.EndCell();
+  stats.EndSentence();
+
+  BOOST_CHECK_EQUAL(112U, stats.Totals().pops);
+  BOOST_CHECK_EQUAL(115U, stats.Totals().pushes);
+  BOOST_CHECK_EQUAL(2U, stats.Totals().splits);
+  BOOST_CHECK_EQUAL(3U, stats.Totals().hypotheses);
+
+  BOOST_REQUIRE_EQUAL(2U, stats.Cells().size());
+  const CellStats &first = stats.Cells()[0];
+  BOOST_CHECK_EQUAL(0U, first.start);
+  BOOST_CHECK_EQUAL(1U, first.end);
+  BOOST_CHECK_EQUAL(5U, first.counters.pops);
+  BOOST_CHECK_EQUAL(6U, first.counters.pushes);
+  BOOST_CHECK_EQUAL(2U, first.counters.splits);
+  BOOST_CHECK_EQUAL(1U, first.counters.hypotheses);
+  BOOST_CHECK_EQUAL(0U, first.counters.pop_limit_hits);
+  BOOST_CHECK(first.seconds >= 0.0);
+
+  const CellStats &second = stats.Cells()[1];
+  BOOST_CHECK_EQUAL(1U, second.start);
+  BOOST_CHECK_EQUAL(3U, second.end);
+  BOOST_CHECK_EQUAL(7U, second.counters.pops);
+  BOOST_CHECK_EQUAL(0U, second.counters.splits);
+  BOOST_CHECK_EQUAL(1U, second.counters.pop_limit_hits);
+}
+
+BOOST_AUTO_TEST_CASE(AddTotalsOnly) {
+  Stats sentence;
+  sentence.BeginCell(0, 0);
+  Count(sentence, 3, 1);
+  sentence.EndCell();
+  sentence.EndSentence();
+
+  Stats all;
+  all.Add(sentence);
+  all.Add(sentence);
+  BOOST_CHECK_EQUAL(6U, all.Totals().pops);
+  BOOST_CHECK_EQUAL(2U, all.Totals().splits);
+  BOOST_CHECK(all.Cells().empty());
+
+  std::ostringstream out;
+  all.WriteJSON(out);
+  const std::string json = out.str();
+  BOOST_CHECK_EQUAL('{', json[0]);
+  BOOST_CHECK_EQUAL('}', json[json.size() - 1]);
+  BOOST_CHECK(json.find("\"pops\":6,") != std::string::npos);
+  BOOST_CHECK(json.find("\"splits\":2,") != std::string::npos);
+  BOOST_CHECK(json.find("\"sentences\":2,") != std::string::npos);
+  BOOST_CHECK(json.find("\"cells\":2,") != std::string::npos);
+  BOOST_CHECK(json.find("\"cell_list\":[]") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(WithoutCells) {
+  Stats stats;
+  stats.KeepCells(false);
+  stats.BeginCell(2, 4);
+  Count(stats, 1, 1);
+  stats.EndCell();
+  BOOST_CHECK(stats.Cells().empty());
+  BOOST_CHECK_EQUAL(1U, stats.Totals().splits);
+
+  std::ostringstream out;
+  stats.WriteJSON(out);
+  BOOST_CHECK(out.str().find("\"cells\":1,") != std::string::npos);
+  BOOST_CHECK(out.str().find("cell_list") == std::string::npos);
+}
+
+} // namespace
+} // namespace search
@@ -100,6 +100,16 @@ class FilePiece {
      */
     bool ReadLineOrEOF(StringPiece &to, char delim = '\n', bool strip_cr = true);
 
+    /** Read exactly amount bytes, e.g. a binary record following a text
+     * header.  Throws EndOfFileException if the file is shorter.
+     */
+    StringPiece ReadBytes(std::size_t amount) {
+      while (static_cast<std::size_t>(position_end_ - position_) < amount) {
+        Shift();
+      }
+      return Consume(position_ + amount);
+    }
+
     float ReadFloat();
     double ReadDouble();
     long int ReadLong();
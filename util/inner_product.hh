@@ -0,0 +1,94 @@
+#ifndef UTIL_INNER_PRODUCT_H
+#define UTIL_INNER_PRODUCT_H
+
+/* Dense weighted sums of float scores, as needed to score feature vectors
+ * against a weight vector.  Uses AVX (with FMA if available) or SSE when the
+ * compiler targets them, e.g. with -march=native, and a plain loop otherwise.
+ * The vector code adds in a different order than a plain loop, so results may
+ * differ from it in the last bits.
+ */
+
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define UTIL_INNER_PRODUCT_SSE
+#elif defined(__amd64) || defined(_M_X64) || defined(__SSE__)
+#include <xmmintrin.h>
+#define UTIL_INNER_PRODUCT_SSE
+#endif
+
+namespace util {
+
+namespace detail {
+#if defined(__AVX__)
+inline __m256 MultiplyAdd(__m256 a, __m256 b, __m256 sum) {
+#if defined(__FMA__)
+  return _mm256_fmadd_ps(a, b, sum);
+#else
+  return _mm256_add_ps(_mm256_mul_ps(a, b), sum);
+#endif
+}
+#endif
+} // namespace detail
+
+// Sum of a[i] * b[i] for i < n.  Neither array needs to be aligned.
+inline float InnerProduct(const float *a, const float *b, std::size_t n) {
+  std::size_t i = 0;
+  float ret = 0.0f;
+#ifdef UTIL_INNER_PRODUCT_SSE
+  __m128 sum4 = _mm_setzero_ps();
+#if defined(__AVX__)
+  __m256 sum8 = _mm256_setzero_ps();
+  for (; i + 8 <= n; i += 8) {
+    sum8 = detail::MultiplyAdd(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum8);
+  }
+  sum4 = _mm_add_ps(_mm256_castps256_ps128(sum8), _mm256_extractf128_ps(sum8, 1));
+#endif
+  for (; i + 4 <= n; i += 4) {
+    sum4 = _mm_add_ps(sum4, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, sum4);
+  ret = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+  for (; i < n; ++i) {
+    ret += a[i] * b[i];
+  }
+  return ret;
+}
+
+/* Scores a block of rows against weights in one pass: out[r] is the sum of
+ * block[c * rows + r] * weights[c] for c < cols.  The block is stored column
+ * by column, i.e. all the rows' values of one feature are contiguous, so that
+ * several rows are scored per instruction however few columns there are.
+ */
+inline void InnerProducts(const float *block, std::size_t rows, std::size_t cols, const float *weights, float *out) {
+  for (std::size_t r = 0; r < rows; ++r) {
+    out[r] = 0.0f;
+  }
+  for (std::size_t c = 0; c < cols; ++c) {
+    const float *column = block + c * rows;
+    const float weight = weights[c];
+    std::size_t r = 0;
+#if defined(__AVX__)
+    const __m256 weight8 = _mm256_set1_ps(weight);
+    for (; r + 8 <= rows; r += 8) {
+      _mm256_storeu_ps(out + r, detail::MultiplyAdd(_mm256_loadu_ps(column + r), weight8, _mm256_loadu_ps(out + r)));
+    }
+#endif
+#ifdef UTIL_INNER_PRODUCT_SSE
+    const __m128 weight4 = _mm_set1_ps(weight);
+    for (; r + 4 <= rows; r += 4) {
+      _mm_storeu_ps(out + r, _mm_add_ps(_mm_loadu_ps(out + r), _mm_mul_ps(_mm_loadu_ps(column + r), weight4)));
+    }
+#endif
+    for (; r < rows; ++r) {
+      out[r] += column[r] * weight;
+    }
+  }
+}
+
+} // namespace util
+
+#endif // UTIL_INNER_PRODUCT_H
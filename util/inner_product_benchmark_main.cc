@@ -0,0 +1,72 @@
+#include "util/inner_product.hh"
+#include "util/usage.hh"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace util {
+namespace {
+
+// What a plain per-option loop does, one score at a time.
+float Scalar(const float *scores, const float *weights, std::size_t n) {
+  float ret = 0.0f;
+  for (std::size_t i = 0; i < n; ++i) {
+    ret += scores[i] * weights[i];
+  }
+  return ret;
+}
+
+void Run(std::size_t options, std::size_t features, std::size_t repeats) {
+  std::vector<float> rows(options * features), columns(options * features), weights(features), out(options);
+  for (std::size_t f = 0; f < features; ++f) {
+    weights[f] = 1.0f / static_cast<float>(f + 1);
+    for (std::size_t o = 0; o < options; ++o) {
+      float value = static_cast<float>((o * 31 + f * 17) % 101) * -0.01f;
+      rows[o * features + f] = value;
+      columns[f * options + o] = value;
+    }
+  }
+
+  float meaningless = 0.0f;
+  double start = CPUTime();
+  for (std::size_t r = 0; r < repeats; ++r) {
+    for (std::size_t o = 0; o < options; ++o) {
+      out[o] = Scalar(&rows[o * features], &weights[0], features);
+    }
+    meaningless += out[r % options];
+  }
+  double scalar = CPUTime();
+  for (std::size_t r = 0; r < repeats; ++r) {
+    for (std::size_t o = 0; o < options; ++o) {
+      out[o] = InnerProduct(&rows[o * features], &weights[0], features);
+    }
+    meaningless += out[r % options];
+  }
+  double inner = CPUTime();
+  for (std::size_t r = 0; r < repeats; ++r) {
+    InnerProducts(&columns[0], options, features, &weights[0], &out[0]);
+    meaningless += out[r % options];
+  }
+  double block = CPUTime();
+
+  std::cout << options << '\t' << features
+            << '\t' << (scalar - start)
+            << '\t' << (inner - scalar)
+            << '\t' << (block - inner) << std::endl;
+  std::cerr << "Meaningless: " << meaningless << '\n';
+}
+
+} // namespace
+} // namespace util
+
+// Usage: inner_product_benchmark [options per span] [repeats]
+int main(int argc, char *argv[]) {
+  std::size_t options = argc > 1 ? strtoul(argv[1], NULL, 10) : 100;
+  std::size_t repeats = argc > 2 ? strtoul(argv[2], NULL, 10) : 100000;
+  std::cout << "#CPU seconds\n#options\tfeatures\tscalar\tInnerProduct\tInnerProducts\n";
+  const std::size_t features[] = {4, 5, 8, 15, 24, 32};
+  for (std::size_t i = 0; i < sizeof(features) / sizeof(features[0]); ++i) {
+    util::Run(options, features[i], repeats);
+  }
+}
@@ -0,0 +1,48 @@
+#include "util/inner_product.hh"
+
+#define BOOST_TEST_MODULE InnerProductTest
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <vector>
+
+namespace util { namespace {
+
+// Sizes around the vector widths, so every tail is taken.
+BOOST_AUTO_TEST_CASE(inner_product) {
+  for (std::size_t n = 0; n < 40; ++n) {
+    std::vector<float> a(n + 1), b(n + 1);
+    float expected = 0.0f;
+    for (std::size_t i = 0; i < n; ++i) {
+      a[i + 1] = static_cast<float>(i) * 0.25f - 3.0f;
+      b[i + 1] = 1.0f / static_cast<float>(i + 1);
+      expected += a[i + 1] * b[i + 1];
+    }
+    // Unaligned on purpose.
+    BOOST_CHECK_CLOSE(expected + 1.0f, InnerProduct(&a[0] + 1, &b[0] + 1, n) + 1.0f, 0.001);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(inner_products) {
+  const std::size_t cols = 5;
+  for (std::size_t rows = 0; rows < 20; ++rows) {
+    std::vector<float> block(rows * cols), weights(cols), row(cols), out(rows + 1, 7.0f);
+    for (std::size_t c = 0; c < cols; ++c) {
+      weights[c] = static_cast<float>(c) - 1.5f;
+      for (std::size_t r = 0; r < rows; ++r) {
+        block[c * rows + r] = static_cast<float>(r * cols + c) * 0.1f;
+      }
+    }
+    InnerProducts(block.empty() ? NULL : &block[0], rows, cols, &weights[0], &out[0]);
+    for (std::size_t r = 0; r < rows; ++r) {
+      for (std::size_t c = 0; c < cols; ++c) {
+        row[c] = block[c * rows + r];
+      }
+      BOOST_CHECK_CLOSE(InnerProduct(&row[0], &weights[0], cols), out[r], 0.001);
+    }
+    // Writes nothing past the rows.
+    BOOST_CHECK_EQUAL(7.0f, out[rows]);
+  }
+}
+
+}} // namespaces
@@ -319,6 +319,15 @@ void MapRead(LoadMethod method, int fd, uint64_t offset, std::size_t size, scope
       HugeMalloc(size, false, out);
       ParallelRead(fd, out.get(), size, offset);
       break;
+    case DIRECT_READ:
+      HugeMalloc(size, false, out);
+      {
+        ParallelReadConfig config;
+        config.direct = true;
+        config.io_uring = true;
+        ParallelRead(fd, out.get(), size, offset, config);
+      }
+      break;
   }
 }
 
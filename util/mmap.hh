@@ -139,6 +139,10 @@ typedef enum {
   READ,
   // malloc and read in parallel (recommended for Lustre)
   PARALLEL_READ,
+  // malloc and read in parallel, bypassing the page cache with O_DIRECT where
+  // the file system allows it.  Useful for models that are read once and
+  // should not evict everything else from the cache.
+  DIRECT_READ,
 } LoadMethod;
 
 void MapRead(LoadMethod method, int fd, uint64_t offset, std::size_t size, scoped_memory &out);
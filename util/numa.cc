@@ -0,0 +1,164 @@
+#include "util/numa.hh"
+
+#include "util/exception.hh"
+#include "util/file.hh"
+#include "util/file_piece.hh"
+
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__NR_set_mempolicy) && defined(__NR_get_mempolicy)
+#define UTIL_HAVE_MEMPOLICY
+#include <linux/mempolicy.h>
+#endif
+#endif
+
+namespace util {
+
+NumaPlacement ParseNumaPlacement(const StringPiece &value) {
+  if (value == "default") return NUMA_DEFAULT;
+  if (value == "interleave") return NUMA_INTERLEAVE;
+  if (value == "replicate") return NUMA_REPLICATE;
+  UTIL_THROW(Exception, "Unknown NUMA placement " << value << ".  Use default, interleave, or replicate.");
+}
+
+namespace {
+
+const std::size_t kMaxNodes = 16 * 8 * sizeof(unsigned long);
+
+#ifdef UTIL_HAVE_MEMPOLICY
+// Parse a kernel list like 0-3,8-11.
+void ParseList(const StringPiece &list, std::vector<std::size_t> &out) {
+  const char *i = list.data();
+  const char *end = list.data() + list.size();
+  while (i != end) {
+    std::size_t first = 0;
+    for (; i != end && *i >= '0' && *i <= '9'; ++i) first = first * 10 + (*i - '0');
+    std::size_t last = first;
+    if (i != end && *i == '-') {
+      last = 0;
+      for (++i; i != end && *i >= '0' && *i <= '9'; ++i) last = last * 10 + (*i - '0');
+    }
+    for (std::size_t n = first; n <= last; ++n) out.push_back(n);
+    if (i != end) ++i;
+  }
+}
+
+bool ReadList(const std::string &name, std::vector<std::size_t> &out) {
+  try {
+    scoped_fd file(OpenReadOrThrow(name.c_str()));
+    FilePiece in(file.release(), name.c_str());
+    ParseList(in.ReadLine(), out);
+  } catch (const util::Exception &) {
+    return false;
+  }
+  return true;
+}
+#endif
+
+struct Topology {
+  Topology() {
+#ifdef UTIL_HAVE_MEMPOLICY
+    std::vector<std::size_t> ids;
+    if (ReadList("/sys/devices/system/node/has_memory", ids) || ReadList("/sys/devices/system/node/online", ids)) {
+      for (std::size_t i = 0; i < ids.size(); ++i) {
+        if (ids[i] >= kMaxNodes) continue;
+        std::vector<std::size_t> cpus;
+        std::string name("/sys/devices/system/node/node");
+        name += ToDecimal(ids[i]);
+        ReadList(name + "/cpulist", cpus);
+        for (std::size_t c = 0; c < cpus.size(); ++c) {
+          if (cpus[c] >= cpu_to_node.size()) cpu_to_node.resize(cpus[c] + 1, 0);
+          cpu_to_node[cpus[c]] = node_ids.size();
+        }
+        node_ids.push_back(ids[i]);
+      }
+    }
+#endif
+    if (node_ids.empty()) node_ids.push_back(0);
+  }
+
+  static std::string ToDecimal(std::size_t value) {
+    std::string ret;
+    do {
+      ret.insert(ret.begin(), '0' + value % 10);
+      value /= 10;
+    } while (value);
+    return ret;
+  }
+
+  // Kernel ids of the nodes, which need not be contiguous.
+  std::vector<std::size_t> node_ids;
+  // CPU number to index in node_ids.
+  std::vector<std::size_t> cpu_to_node;
+};
+
+const Topology &GetTopology() {
+  static const Topology topology;
+  return topology;
+}
+
+} // namespace
+
+std::size_t NumaNodeCount() {
+  return GetTopology().node_ids.size();
+}
+
+std::size_t CurrentNumaNode() {
+#ifdef UTIL_HAVE_MEMPOLICY
+  const Topology &topology = GetTopology();
+  int cpu = sched_getcpu();
+  if (cpu >= 0 && static_cast<std::size_t>(cpu) < topology.cpu_to_node.size())
+    return topology.cpu_to_node[cpu];
+#endif
+  return 0;
+}
+
+LoadMethod PlacedLoadMethod(LoadMethod method, NumaPlacement placement) {
+  if (placement == NUMA_DEFAULT) return method;
+  switch (method) {
+    case LAZY:
+    case POPULATE_OR_LAZY:
+    case POPULATE_OR_READ:
+      return READ;
+    default:
+      return method;
+  }
+}
+
+ScopedNumaPolicy::ScopedNumaPolicy(int node) : set_(false), old_mode_(0) {
+  const Topology &topology = GetTopology();
+  UTIL_THROW_IF(node >= 0 && static_cast<std::size_t>(node) >= topology.node_ids.size(), Exception, "NUMA node " << node << " out of range");
+#ifdef UTIL_HAVE_MEMPOLICY
+  if (topology.node_ids.size() < 2) return;
+  if (syscall(__NR_get_mempolicy, &old_mode_, old_mask_, kMaxNodes, NULL, 0)) return;
+  unsigned long mask[16];
+  memset(mask, 0, sizeof(mask));
+  const std::size_t kBits = 8 * sizeof(unsigned long);
+  int mode;
+  if (node < 0) {
+    mode = MPOL_INTERLEAVE;
+    for (std::size_t i = 0; i < topology.node_ids.size(); ++i) {
+      mask[topology.node_ids[i] / kBits] |= 1UL << (topology.node_ids[i] % kBits);
+    }
+  } else {
+    // Preferred rather than bind so a full node spills instead of failing.
+    mode = MPOL_PREFERRED;
+    std::size_t id = topology.node_ids[node];
+    mask[id / kBits] |= 1UL << (id % kBits);
+  }
+  set_ = !syscall(__NR_set_mempolicy, mode, mask, kMaxNodes);
+#endif
+}
+
+ScopedNumaPolicy::~ScopedNumaPolicy() {
+#ifdef UTIL_HAVE_MEMPOLICY
+  if (set_) syscall(__NR_set_mempolicy, old_mode_, old_mask_, kMaxNodes);
+#endif
+}
+
+} // namespace util
@@ -0,0 +1,68 @@
+#ifndef UTIL_NUMA_H
+#define UTIL_NUMA_H
+/* Placement of large read-only models on machines with several NUMA nodes.
+ * Without a policy, a model lands on whichever node loaded it and threads on
+ * the other nodes pay for remote accesses on every probe.  Models can instead
+ * be interleaved across nodes, or replicated with one copy per node so that
+ * each thread reads its local copy.  Replication works best with the decoding
+ * threads pinned to CPUs.
+ *
+ * Policies are applied with the Linux system calls, so there is no dependency
+ * on libnuma.  Elsewhere everything behaves as if there were one node.
+ */
+
+#include "util/mmap.hh"
+#include "util/string_piece.hh"
+
+#include <cstddef>
+
+namespace util {
+
+typedef enum {
+  // Whatever the kernel does: usually the node of the loading thread.
+  NUMA_DEFAULT,
+  // Spread pages round-robin over all nodes.
+  NUMA_INTERLEAVE,
+  // One copy per node.
+  NUMA_REPLICATE,
+} NumaPlacement;
+
+// Parse default, interleave, or replicate.  Throws on anything else.
+NumaPlacement ParseNumaPlacement(const StringPiece &value);
+
+// Number of nodes with memory.  1 if NUMA is unsupported.
+std::size_t NumaNodeCount();
+
+// Node index in [0, NumaNodeCount()) of the CPU running the calling thread.
+// This is cheap enough to call per sentence or per feature evaluation.
+std::size_t CurrentNumaNode();
+
+// The policy only affects memory that is first touched while it is in force,
+// so a model mapped lazily or already in the page cache stays where it is.
+// Placement other than NUMA_DEFAULT therefore needs a private copy: this turns
+// the mmap-based load methods into READ, which allocates with HugeMalloc and
+// so also gives the copy huge pages.
+LoadMethod PlacedLoadMethod(LoadMethod method, NumaPlacement placement);
+
+// While in scope, memory allocated by the calling thread, and by threads it
+// starts, is interleaved (node < 0) or placed on the given node where it has
+// room.  The previous policy of the thread is restored on destruction.  Throws
+// if node is not below NumaNodeCount(), even where there is no NUMA support.
+class ScopedNumaPolicy {
+  public:
+    explicit ScopedNumaPolicy(int node);
+
+    ~ScopedNumaPolicy();
+
+  private:
+    bool set_;
+    int old_mode_;
+    unsigned long old_mask_[16];
+
+    ScopedNumaPolicy(const ScopedNumaPolicy &);
+    ScopedNumaPolicy &operator=(const ScopedNumaPolicy &);
+};
+
+} // namespace util
+
+#endif // UTIL_NUMA_H
@@ -0,0 +1,64 @@
+#include "util/numa.hh"
+
+#include "util/exception.hh"
+
+#define BOOST_TEST_MODULE NumaTest
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <vector>
+
+namespace util { namespace {
+
+BOOST_AUTO_TEST_CASE(parse) {
+  BOOST_CHECK_EQUAL(NUMA_DEFAULT, ParseNumaPlacement("default"));
+  BOOST_CHECK_EQUAL(NUMA_INTERLEAVE, ParseNumaPlacement("interleave"));
+  BOOST_CHECK_EQUAL(NUMA_REPLICATE, ParseNumaPlacement("replicate"));
+  BOOST_CHECK_THROW(ParseNumaPlacement(""), Exception);
+  BOOST_CHECK_THROW(ParseNumaPlacement("Interleave"), Exception);
+  BOOST_CHECK_THROW(ParseNumaPlacement("replicated"), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(load_method) {
+  // Nothing changes by default.
+  const LoadMethod all[] = {LAZY, POPULATE_OR_LAZY, POPULATE_OR_READ, READ, PARALLEL_READ, DIRECT_READ};
+  for (std::size_t i = 0; i < sizeof(all) / sizeof(all[0]); ++i) {
+    BOOST_CHECK_EQUAL(all[i], PlacedLoadMethod(all[i], NUMA_DEFAULT));
+  }
+  // Otherwise anything mapped becomes a private copy.
+  const NumaPlacement placed[] = {NUMA_INTERLEAVE, NUMA_REPLICATE};
+  for (std::size_t i = 0; i < 2; ++i) {
+    BOOST_CHECK_EQUAL(READ, PlacedLoadMethod(LAZY, placed[i]));
+    BOOST_CHECK_EQUAL(READ, PlacedLoadMethod(POPULATE_OR_LAZY, placed[i]));
+    BOOST_CHECK_EQUAL(READ, PlacedLoadMethod(POPULATE_OR_READ, placed[i]));
+    BOOST_CHECK_EQUAL(READ, PlacedLoadMethod(READ, placed[i]));
+    BOOST_CHECK_EQUAL(PARALLEL_READ, PlacedLoadMethod(PARALLEL_READ, placed[i]));
+    BOOST_CHECK_EQUAL(DIRECT_READ, PlacedLoadMethod(DIRECT_READ, placed[i]));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(topology) {
+  const std::size_t count = NumaNodeCount();
+  BOOST_REQUIRE(count >= 1);
+  BOOST_CHECK(CurrentNumaNode() < count);
+}
+
+// Whatever the machine, memory allocated under a policy is ordinary memory
+// and policies nest.
+BOOST_AUTO_TEST_CASE(scoped_policy) {
+  const std::size_t count = NumaNodeCount();
+  {
+    ScopedNumaPolicy interleave(-1);
+    std::vector<char> mem(1 << 20);
+    memset(&mem[0], 1, mem.size());
+    for (std::size_t node = 0; node < count; ++node) {
+      ScopedNumaPolicy preferred(node);
+      std::vector<char> local(1 << 20, 2);
+      BOOST_CHECK_EQUAL(2, local[local.size() - 1]);
+    }
+    BOOST_CHECK_EQUAL(1, mem[mem.size() - 1]);
+  }
+  BOOST_CHECK_THROW(ScopedNumaPolicy beyond(count), Exception);
+}
+
+}} // namespaces
@@ -1,69 +1,354 @@
 #include "util/parallel_read.hh"
 
+#include "util/ersatz_progress.hh"
 #include "util/file.hh"
+#include "util/scoped.hh"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__NR_io_uring_setup)
+#define UTIL_HAVE_IO_URING
+#include <linux/io_uring.h>
+#endif
 
 #ifdef WITH_THREADS
 #include "util/thread_pool.hh"
 
+#include <boost/thread/mutex.hpp>
+#endif
+
 namespace util {
+
+ParallelReadConfig::ParallelReadConfig()
+  : direct(false), io_uring(false), block(1ULL << 25) /* 32 MB */, queue_depth(16), threads(0), progress(NULL) {}
+
+namespace detail {
+
+typedef ReadRequest Request;
+
+void SplitRequests(int fd, int direct_fd, void *to, std::size_t amount, uint64_t offset, std::size_t block, std::vector<Request> &out) {
+  const std::size_t kAlign = 4096;
+  uint8_t *const begin = static_cast<uint8_t*>(to);
+  std::size_t head = 0, body = amount;
+  if (direct_fd != -1) {
+    head = (kAlign - offset % kAlign) % kAlign;
+    if (head >= amount || (reinterpret_cast<uintptr_t>(begin) + head) % kAlign) {
+      // Memory and file are not aligned alike: read normally.
+      head = 0;
+      direct_fd = -1;
+    } else {
+      body = (amount - head) / kAlign * kAlign;
+      if (block % kAlign) block += kAlign - block % kAlign;
+    }
+  }
+  Request request;
+  if (head) {
+    request.fd = fd;
+    request.to = begin;
+    request.size = head;
+    request.offset = offset;
+    out.push_back(request);
+  }
+  request.fd = (direct_fd == -1) ? fd : direct_fd;
+  for (std::size_t done = 0; done < body; done += block) {
+    request.to = begin + head + done;
+    request.size = std::min(block, body - done);
+    request.offset = offset + head + done;
+    out.push_back(request);
+  }
+  if (head + body < amount) {
+    request.fd = fd;
+    request.to = begin + head + body;
+    request.size = amount - head - body;
+    request.offset = offset + head + body;
+    out.push_back(request);
+  }
+}
+
 namespace {
 
-class Reader {
+#ifdef UTIL_HAVE_IO_URING
+// Minimal io_uring driver using the system calls directly, so there is no
+// dependency on liburing.
+class Ring {
   public:
-    explicit Reader(int fd) : fd_(fd) {}
+    Ring() : fd_(-1), sq_ring_(MAP_FAILED), cq_ring_(MAP_FAILED), sqes_(MAP_FAILED), entries_(0), queued_(0) {}
 
-    struct Request {
-      void *to;
-      std::size_t size;
-      uint64_t offset;
+    ~Ring() {
+      if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+      if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+      if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+      if (fd_ != -1) close(fd_);
+    }
 
-      bool operator==(const Request &other) const {
-        return (to == other.to) && (size == other.size) && (offset == other.offset);
+    // Returns false if the kernel does not provide io_uring, for example
+    // because it is too old or a sandbox disallows it.
+    bool Init(unsigned entries) {
+      struct io_uring_params params;
+      memset(&params, 0, sizeof(params));
+      fd_ = syscall(__NR_io_uring_setup, entries, &params);
+      if (fd_ < 0) {
+        fd_ = -1;
+        return false;
       }
-    };
+      sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+      cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+      const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+      if (single) sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+      sq_ring_ = mmap(NULL, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+      if (sq_ring_ == MAP_FAILED) return false;
+      cq_ring_ = single ? sq_ring_ : mmap(NULL, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+      if (cq_ring_ == MAP_FAILED) return false;
+      sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+      sqes_ = mmap(NULL, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+      if (sqes_ == MAP_FAILED) return false;
 
-    void operator()(const Request &request) {
-      util::ErsatzPRead(fd_, request.to, request.size, request.offset);
+      uint8_t *sq = static_cast<uint8_t*>(sq_ring_);
+      sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+      sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+      sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+      uint8_t *cq = static_cast<uint8_t*>(cq_ring_);
+      cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+      cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+      cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+      cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+      entries_ = params.sq_entries;
+      return true;
+    }
+
+    unsigned Entries() const { return entries_; }
+
+    // Queue a read of iov, which must stay valid until it completes.
+    void QueueRead(int fd, const struct iovec *iov, uint64_t offset, uint64_t user_data) {
+      unsigned tail = *sq_tail_;
+      unsigned index = tail & sq_mask_;
+      struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe*>(sqes_) + index;
+      memset(sqe, 0, sizeof(*sqe));
+      // READV rather than READ for kernels before 5.6.
+      sqe->opcode = IORING_OP_READV;
+      sqe->fd = fd;
+      sqe->addr = reinterpret_cast<uintptr_t>(iov);
+      sqe->len = 1;
+      sqe->off = offset;
+      sqe->user_data = user_data;
+      sq_array_[index] = index;
+      __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+      ++queued_;
+    }
+
+    // Submit what was queued and wait for at least one completion.
+    void SubmitAndWait() {
+      while (true) {
+        int ret = syscall(__NR_io_uring_enter, fd_, queued_, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret >= 0) {
+          queued_ -= std::min<unsigned>(queued_, ret);
+          return;
+        }
+        UTIL_THROW_IF(errno != EINTR && errno != EAGAIN && errno != EBUSY, ErrnoException, "io_uring_enter failed");
+      }
+    }
+
+    // Take the next completion, returning false if there is none.
+    bool Reap(uint64_t &user_data, int &result) {
+      unsigned head = *cq_head_;
+      if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) return false;
+      const struct io_uring_cqe &cqe = cqes_[head & cq_mask_];
+      user_data = cqe.user_data;
+      result = cqe.res;
+      __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+      return true;
     }
 
   private:
     int fd_;
+
+    void *sq_ring_, *cq_ring_, *sqes_;
+    std::size_t sq_ring_size_, cq_ring_size_, sqes_size_;
+
+    unsigned *sq_tail_, *sq_array_, sq_mask_;
+    unsigned *cq_head_, *cq_tail_, cq_mask_;
+    struct io_uring_cqe *cqes_;
+
+    unsigned entries_;
+    unsigned queued_;
+};
+
+
+// Queue a read of what the slot still needs, or at most max_read bytes of it.
+void QueueSlot(Ring &ring, int fd, const struct iovec &remaining, struct iovec &submit, uint64_t offset, unsigned slot, std::size_t max_read) {
+  submit = remaining;
+  if (max_read) submit.iov_len = std::min(submit.iov_len, max_read);
+  ring.QueueRead(fd, &submit, offset, slot);
+}
+#endif // UTIL_HAVE_IO_URING
+
+#ifdef WITH_THREADS
+struct Shared {
+  explicit Shared(ErsatzProgress &progress_in) : progress(progress_in) {}
+  boost::mutex mutex;
+  ErsatzProgress &progress;
 };
 
+class Reader {
+  public:
+    explicit Reader(Shared *shared) : shared_(shared) {}
+
+    typedef detail::Request Request;
+
+    void operator()(const Request &request) {
+      util::ErsatzPRead(request.fd, request.to, request.size, request.offset);
+      boost::unique_lock<boost::mutex> lock(shared_->mutex);
+      shared_->progress += request.size;
+    }
+
+  private:
+    Shared *shared_;
+};
+#endif // WITH_THREADS
+
 } // namespace
 
-void ParallelRead(int fd, void *to, std::size_t amount, uint64_t offset) {
-  Reader::Request poison;
+#ifdef UTIL_HAVE_IO_URING
+bool RingRead(const std::vector<Request> &requests, unsigned depth, std::size_t max_read, ErsatzProgress &progress) {
+  Ring ring;
+  if (!ring.Init(std::max(1U, depth))) return false;
+  depth = std::min<unsigned>(ring.Entries(), std::max<std::size_t>(1, requests.size()));
+  // In-flight requests: each slot's unread remainder and what of it was
+  // submitted.
+  std::vector<struct iovec> slots(depth), submitted(depth);
+  std::vector<std::size_t> slot_request(depth);
+  std::vector<uint64_t> slot_offset(depth);
+  std::vector<unsigned> free_slots;
+  for (unsigned i = 0; i < depth; ++i) free_slots.push_back(i);
+
+  // The first failure.  It is thrown only once nothing is in flight, since
+  // the kernel writes to the caller's buffers until the reads complete.
+  bool failed = false;
+  int failed_result = 0;
+  std::size_t failed_request = 0, failed_size = 0;
+  uint64_t failed_offset = 0;
+
+  std::size_t next = 0, outstanding = 0;
+  while ((!failed && next < requests.size()) || outstanding) {
+    for (; !failed && next < requests.size() && !free_slots.empty(); ++next) {
+      unsigned slot = free_slots.back();
+      free_slots.pop_back();
+      slots[slot].iov_base = requests[next].to;
+      slots[slot].iov_len = requests[next].size;
+      slot_request[slot] = next;
+      slot_offset[slot] = requests[next].offset;
+      QueueSlot(ring, requests[next].fd, slots[slot], submitted[slot], slot_offset[slot], slot, max_read);
+      ++outstanding;
+    }
+    ring.SubmitAndWait();
+    uint64_t slot;
+    int result;
+    while (ring.Reap(slot, result)) {
+      const Request &request = requests[slot_request[slot]];
+      if (!failed && (result == -EINTR || result == -EAGAIN)) {
+        QueueSlot(ring, request.fd, slots[slot], submitted[slot], slot_offset[slot], slot, max_read);
+        continue;
+      }
+      if (result > 0) {
+        progress += result;
+        if (!failed && static_cast<std::size_t>(result) < slots[slot].iov_len) {
+          // Short read: ask for the rest.
+          slots[slot].iov_base = static_cast<uint8_t*>(slots[slot].iov_base) + result;
+          slots[slot].iov_len -= result;
+          slot_offset[slot] += result;
+          QueueSlot(ring, request.fd, slots[slot], submitted[slot], slot_offset[slot], slot, max_read);
+          continue;
+        }
+      } else if (!failed) {
+        failed = true;
+        failed_result = result;
+        failed_request = slot_request[slot];
+        failed_size = slots[slot].iov_len;
+        failed_offset = slot_offset[slot];
+      }
+      --outstanding;
+      free_slots.push_back(slot);
+    }
+  }
+  if (failed) {
+    const Request &request = requests[failed_request];
+    if (failed_result < 0) {
+      errno = -failed_result;
+      UTIL_THROW_ARG(FDException, (request.fd), "while reading " << failed_size << " bytes at offset " << failed_offset << " with io_uring");
+    }
+    UTIL_THROW(EndOfFileException, " for reading " << failed_size << " bytes at " << failed_offset << " from " << NameFromFD(request.fd));
+  }
+  return true;
+}
+#else // UTIL_HAVE_IO_URING
+bool RingRead(const std::vector<Request> &, unsigned, std::size_t, ErsatzProgress &) {
+  return false;
+}
+#endif // UTIL_HAVE_IO_URING
+
+#ifdef WITH_THREADS
+void PoolRead(const std::vector<Request> &requests, unsigned threads, ErsatzProgress &progress) {
+  Request poison;
+  poison.fd = -1;
   poison.to = NULL;
   poison.size = 0;
   poison.offset = 0;
-  unsigned threads = boost::thread::hardware_concurrency();
+  if (!threads) threads = boost::thread::hardware_concurrency();
   if (!threads) threads = 2;
-  ThreadPool<Reader> pool(2 /* don't need much of a queue */, threads, fd, poison);
-  const std::size_t kBatch = 1ULL << 25; // 32 MB
-  Reader::Request request;
-  request.to = to;
-  request.size = kBatch;
-  request.offset = offset;
-  for (; amount > kBatch; amount -= kBatch) {
-    pool.Produce(request);
-    request.to = reinterpret_cast<uint8_t*>(request.to) + kBatch;
-    request.offset += kBatch;
+  Shared shared(progress);
+  ThreadPool<Reader> pool(2 /* don't need much of a queue */, threads, &shared, poison);
+  for (std::vector<Request>::const_iterator i = requests.begin(); i != requests.end(); ++i) {
+    pool.Produce(*i);
   }
-  request.size = amount;
-  if (request.size) {
-    pool.Produce(request);
+}
+#else // WITH_THREADS
+void PoolRead(const std::vector<Request> &requests, unsigned, ErsatzProgress &progress) {
+  for (std::vector<Request>::const_iterator i = requests.begin(); i != requests.end(); ++i) {
+    util::ErsatzPRead(i->fd, i->to, i->size, i->offset);
+    progress += i->size;
   }
 }
+#endif // WITH_THREADS
 
-} // namespace util
-
-#else // WITH_THREADS
+} // namespace detail
 
-namespace util {
 void ParallelRead(int fd, void *to, std::size_t amount, uint64_t offset) {
- util::ErsatzPRead(fd, to, amount, offset);
+  ParallelRead(fd, to, amount, offset, ParallelReadConfig());
 }
-} // namespace util
 
+void ParallelRead(int fd, void *to, std::size_t amount, uint64_t offset, const ParallelReadConfig &config) {
+  scoped_fd direct;
+#if defined(__linux__) && defined(O_DIRECT)
+  if (config.direct) {
+    // A second descriptor for the same file, since O_DIRECT can't always be
+    // set with fcntl.
+    std::string path("/proc/self/fd/");
+    char number[32];
+    snprintf(number, sizeof(number), "%d", fd);
+    path += number;
+    direct.reset(open(path.c_str(), O_RDONLY | O_DIRECT));
+  }
 #endif
+  std::vector<detail::ReadRequest> requests;
+  detail::SplitRequests(fd, direct.get(), to, amount, offset, std::max<std::size_t>(1, config.block), requests);
+  ErsatzProgress progress(amount, config.progress, "Reading " + NameFromFD(fd));
+  if (config.io_uring && detail::RingRead(requests, config.queue_depth, 0, progress)) return;
+  detail::PoolRead(requests, config.threads, progress);
+}
+
+} // namespace util
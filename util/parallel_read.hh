@@ -4,13 +4,81 @@
 /* Read pieces of a file in parallel.  This has a very specific use case:
  * reading files from Lustre is CPU bound so multiple threads actually
  * increases throughput.  Speed matters when an LM takes a terabyte.
+ *
+ * By default the reads go to a thread pool.  On Linux, the configurable
+ * version can instead submit them asynchronously with io_uring, keeping many
+ * requests in flight from one thread, which is what NVMe drives need to reach
+ * their bandwidth.  Where the kernel lacks io_uring or forbids it, the reads
+ * go to the thread pool.
  */
 
 #include <cstddef>
+#include <iosfwd>
+#include <vector>
 #include <stdint.h>
 
 namespace util {
+
+class ErsatzProgress;
+
+struct ParallelReadConfig {
+  ParallelReadConfig();
+
+  // Bypass the page cache with O_DIRECT (Linux only).  This applies to the
+  // part of the range that is aligned to 4096 bytes in both the file and
+  // memory, so destinations from HugeMalloc qualify; the unaligned ends are
+  // read normally.  Falls back to normal reads where O_DIRECT is refused.
+  bool direct;
+
+  // Read with io_uring (Linux only) instead of the thread pool.
+  bool io_uring;
+
+  // Bytes per read request.
+  std::size_t block;
+
+  // Requests in flight with io_uring.
+  unsigned queue_depth;
+
+  // Threads when io_uring is not available.  0 means the number of cores.
+  unsigned threads;
+
+  // Where to show a progress bar, NULL for none.
+  std::ostream *progress;
+};
+
+// Thread pool with the default settings.
 void ParallelRead(int fd, void *to, std::size_t amount, uint64_t offset);
+
+void ParallelRead(int fd, void *to, std::size_t amount, uint64_t offset, const ParallelReadConfig &config);
+
+// Exposed for testing.
+namespace detail {
+
+struct ReadRequest {
+  int fd;
+  void *to;
+  std::size_t size;
+  uint64_t offset;
+
+  bool operator==(const ReadRequest &other) const {
+    return (fd == other.fd) && (to == other.to) && (size == other.size) && (offset == other.offset);
+  }
+};
+
+// Split the range into requests of at most block bytes.  If direct_fd is
+// valid, the part aligned to 4096 bytes in both the file and memory is read
+// from it.
+void SplitRequests(int fd, int direct_fd, void *to, std::size_t amount, uint64_t offset, std::size_t block, std::vector<ReadRequest> &out);
+
+// Returns false without reading anything if io_uring is unavailable.  If
+// max_read is not 0, the kernel is asked for at most that many bytes at a
+// time so that requests complete in several short reads.
+bool RingRead(const std::vector<ReadRequest> &requests, unsigned depth, std::size_t max_read, ErsatzProgress &progress);
+
+void PoolRead(const std::vector<ReadRequest> &requests, unsigned threads, ErsatzProgress &progress);
+
+} // namespace detail
+
 } // namespace util
 
 #endif // UTIL_PARALLEL_READ__
@@ -0,0 +1,196 @@
+#include "util/parallel_read.hh"
+
+#include "util/ersatz_progress.hh"
+#include "util/file.hh"
+#include "util/mmap.hh"
+#include "util/scoped.hh"
+
+#define BOOST_TEST_MODULE ParallelReadTest
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <stdint.h>
+
+namespace util {
+namespace {
+
+const std::size_t kAlign = 4096;
+const std::size_t kFileSize = 7 * kAlign + 123;
+
+// Temporary file with a byte pattern that doesn't repeat every page.
+int MakeFile() {
+  scoped_fd file(MakeTemp("parallel_read_test"));
+  std::vector<uint8_t> data(kFileSize);
+  uint32_t state = 1;
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    state = state * 1103515245 + 12345;
+    data[i] = static_cast<uint8_t>(state >> 16);
+  }
+  WriteOrThrow(file.get(), &data[0], data.size());
+  return file.release();
+}
+
+std::vector<uint8_t> Expected(int fd, std::size_t amount, uint64_t offset) {
+  std::vector<uint8_t> ret(amount);
+  ErsatzPRead(fd, &ret[0], amount, offset);
+  return ret;
+}
+
+// Destination of amount bytes at to_align bytes past a page boundary.
+uint8_t *Destination(scoped_memory &mem, std::size_t amount, std::size_t to_align) {
+  HugeMalloc(amount + 2 * kAlign, true, mem);
+  uint8_t *page = static_cast<uint8_t*>(mem.get());
+  page += (kAlign - reinterpret_cast<uintptr_t>(page) % kAlign) % kAlign;
+  return page + to_align;
+}
+
+void CheckSame(const std::vector<uint8_t> &expected, const uint8_t *got) {
+  std::size_t i = std::mismatch(expected.begin(), expected.end(), got).first - expected.begin();
+  BOOST_CHECK_MESSAGE(i == expected.size(), "Byte " << i << " of " << expected.size() << " differs");
+}
+
+BOOST_AUTO_TEST_CASE(SplitHeadTail) {
+  scoped_memory mem;
+  const uint64_t offset = 100;
+  const std::size_t amount = 5 * kAlign;
+  // Same alignment in memory and file.
+  uint8_t *to = Destination(mem, amount, offset);
+  std::vector<detail::ReadRequest> requests;
+  detail::SplitRequests(3, 4, to, amount, offset, 5000, requests);
+  BOOST_REQUIRE_EQUAL(4U, requests.size());
+  // Head up to the first page boundary.
+  BOOST_CHECK_EQUAL(3, requests[0].fd);
+  BOOST_CHECK_EQUAL(kAlign - offset, requests[0].size);
+  BOOST_CHECK_EQUAL(offset, requests[0].offset);
+  BOOST_CHECK(to == requests[0].to);
+  // Body in whole pages, with the block size rounded up to a page.
+  BOOST_CHECK_EQUAL(4, requests[1].fd);
+  BOOST_CHECK_EQUAL(2 * kAlign, requests[1].size);
+  BOOST_CHECK_EQUAL(kAlign, requests[1].offset);
+  BOOST_CHECK_EQUAL(4, requests[2].fd);
+  BOOST_CHECK_EQUAL(2 * kAlign, requests[2].size);
+  BOOST_CHECK_EQUAL(3 * kAlign, requests[2].offset);
+  // Tail after the last page boundary.
+  BOOST_CHECK_EQUAL(3, requests[3].fd);
+  BOOST_CHECK_EQUAL(offset, requests[3].size);
+  BOOST_CHECK_EQUAL(5 * kAlign, requests[3].offset);
+  BOOST_CHECK(to + amount - offset == requests[3].to);
+}
+
+BOOST_AUTO_TEST_CASE(SplitMisaligned) {
+  scoped_memory mem;
+  const std::size_t amount = 5 * kAlign;
+  // Memory is one byte off from the file, so O_DIRECT can't be used.
+  uint8_t *to = Destination(mem, amount, 101);
+  std::vector<detail::ReadRequest> requests;
+  detail::SplitRequests(3, 4, to, amount, 100, 3 * kAlign, requests);
+  BOOST_REQUIRE_EQUAL(2U, requests.size());
+  BOOST_CHECK_EQUAL(3, requests[0].fd);
+  BOOST_CHECK_EQUAL(3 * kAlign, requests[0].size);
+  BOOST_CHECK_EQUAL(3, requests[1].fd);
+  BOOST_CHECK_EQUAL(2 * kAlign, requests[1].size);
+  BOOST_CHECK_EQUAL(100 + 3 * kAlign, requests[1].offset);
+}
+
+void CheckRead(int fd, std::size_t amount, uint64_t offset, std::size_t to_align, const ParallelReadConfig &config) {
+  scoped_memory mem;
+  uint8_t *to = Destination(mem, amount, to_align);
+  ParallelRead(fd, to, amount, offset, config);
+  CheckSame(Expected(fd, amount, offset), to);
+}
+
+BOOST_AUTO_TEST_CASE(Unaligned) {
+  scoped_fd file(MakeFile());
+  const uint64_t offsets[] = {0, 1, 100, kAlign - 1, kAlign, kAlign + 7};
+  const std::size_t amounts[] = {1, 99, kAlign, 3 * kAlign + 1, 6 * kAlign};
+  for (unsigned direct = 0; direct < 2; ++direct) {
+    for (unsigned io_uring = 0; io_uring < 2; ++io_uring) {
+      ParallelReadConfig config;
+      config.direct = direct;
+      config.io_uring = io_uring;
+      config.block = 5000;
+      config.queue_depth = 2;
+      config.threads = 2;
+      for (const uint64_t *offset = offsets; offset != offsets + sizeof(offsets) / sizeof(uint64_t); ++offset) {
+        for (const std::size_t *amount = amounts; amount != amounts + sizeof(amounts) / sizeof(std::size_t); ++amount) {
+          BOOST_TEST_CHECKPOINT("direct " << direct << " io_uring " << io_uring << " offset " << *offset << " amount " << *amount);
+          // Aligned like the file, so the middle can go through O_DIRECT.
+          CheckRead(file.get(), *amount, *offset, *offset % kAlign, config);
+          // And not.
+          CheckRead(file.get(), *amount, *offset, (*offset + 1) % kAlign, config);
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Default) {
+  scoped_fd file(MakeFile());
+  scoped_memory mem;
+  uint8_t *to = Destination(mem, kFileSize - 3, 0);
+  ParallelRead(file.get(), to, kFileSize - 3, 3);
+  CheckSame(Expected(file.get(), kFileSize - 3, 3), to);
+}
+
+BOOST_AUTO_TEST_CASE(ShortReads) {
+  scoped_fd file(MakeFile());
+  scoped_memory mem;
+  const std::size_t amount = kFileSize - 10;
+  uint8_t *to = Destination(mem, amount, 0);
+  std::vector<detail::ReadRequest> requests;
+  detail::SplitRequests(file.get(), -1, to, amount, 10, 3 * kAlign, requests);
+  ErsatzProgress progress;
+  // The kernel only gets asked for 1000 bytes at a time, so every request
+  // completes in several short reads that have to be resubmitted.
+  if (!detail::RingRead(requests, 2, 1000, progress)) {
+    BOOST_TEST_MESSAGE("io_uring is not available; not testing short reads");
+    return;
+  }
+  CheckSame(Expected(file.get(), amount, 10), to);
+}
+
+BOOST_AUTO_TEST_CASE(PastEnd) {
+  scoped_fd file(MakeFile());
+  scoped_memory mem;
+  const std::size_t amount = kFileSize + 2 * kAlign;
+  uint8_t *to = Destination(mem, amount, 0);
+  std::vector<detail::ReadRequest> requests;
+  detail::SplitRequests(file.get(), -1, to, amount, 0, kAlign, requests);
+  ErsatzProgress progress;
+  // The reads that hit the end fail while others are still in flight; the
+  // error comes out once they have completed.
+  bool threw = false;
+  try {
+    if (!detail::RingRead(requests, 4, 0, progress)) {
+      BOOST_TEST_MESSAGE("io_uring is not available; not testing failed reads");
+      threw = true;
+    }
+  } catch (const EndOfFileException &) {
+    threw = true;
+  }
+  BOOST_CHECK(threw);
+}
+
+BOOST_AUTO_TEST_CASE(Fallback) {
+  scoped_fd file(MakeFile());
+  // More entries than the kernel allows, so io_uring setup fails.
+  const unsigned depth = 1 << 20;
+  {
+    scoped_memory mem;
+    uint8_t *to = Destination(mem, kAlign, 0);
+    std::vector<detail::ReadRequest> requests;
+    detail::SplitRequests(file.get(), -1, to, kAlign, 0, kAlign, requests);
+    ErsatzProgress progress;
+    BOOST_CHECK(!detail::RingRead(requests, depth, 0, progress));
+  }
+  ParallelReadConfig config;
+  config.io_uring = true;
+  config.queue_depth = depth;
+  config.block = 3000;
+  CheckRead(file.get(), kFileSize - 1, 1, 1, config);
+}
+
+} // namespace
+} // namespace util
@@ -24,6 +24,19 @@
 #include <lzma.h>
 #endif
 
+#ifdef WITH_THREADS
+#include "util/pcqueue.hh"
+
+#include <boost/bind.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <atomic>
+#include <string>
+#include <vector>
+#endif
+
 namespace util {
 
 CompressedException::CompressedException() throw() {}
@@ -58,6 +71,13 @@ class ReadBase {
 
 namespace {
 
+// Readers may be opened on other threads while this is set.
+#ifdef WITH_THREADS
+std::atomic<std::size_t> background_threads(0);
+#else
+std::size_t background_threads = 0;
+#endif
+
 ReadBase *ReadFactory(int fd, uint64_t &raw_amount, const void *already_data, std::size_t already_size, bool require_compressed);
 
 // Completed file that other classes can thunk to.
@@ -272,6 +292,19 @@ class XZip {
       : stream_(), action_(LZMA_RUN) {
       memset(&stream_, 0, sizeof(stream_));
       SetInput(base, amount);
+#if defined(WITH_THREADS) && LZMA_VERSION >= 50040002
+      // liblzma decodes the blocks of multi-block files in parallel.
+      const std::size_t threads = background_threads;
+      if (threads > 1) {
+        lzma_mt mt;
+        memset(&mt, 0, sizeof(mt));
+        mt.threads = threads;
+        mt.memlimit_threading = UINT64_MAX;
+        mt.memlimit_stop = UINT64_MAX;
+        HandleError(lzma_stream_decoder_mt(&stream_, &mt));
+        return;
+      }
+#endif
       HandleError(lzma_stream_decoder(&stream_, UINT64_MAX, 0));
     }
 
@@ -399,6 +432,261 @@ ReadBase *ReadFactory(int fd, uint64_t &raw_amount, const void *already_data, co
   }
 }
 
+
+#ifdef WITH_THREADS
+/* Decompression in the background.  A reader thread fills jobs, each a run of
+ * decompressed output, in file order.  Usually it decompresses them itself.
+ * For gzip files made of BGZF blocks it only splits the raw input at block
+ * boundaries, since each block states its compressed size, and the blocks are
+ * inflated by worker threads.  Jobs reach Read in file order either way.
+ */
+class ReadAhead : public ReadBase {
+  public:
+    // header is what was read from fd to detect the format.
+    ReadAhead(int fd, const void *header, std::size_t header_size, uint64_t raw_amount, std::size_t threads)
+      : file_(fd),
+        workers_(BGZFBlockSize(header, header_size) && threads > 1 ? threads : 0),
+        job_count_(2 * std::max<std::size_t>(workers_, 1) + 2),
+        jobs_(new Job[job_count_]),
+        free_(job_count_ + 1), work_(job_count_ + workers_), ordered_(job_count_),
+        raw_amount_(raw_amount),
+        current_(NULL), offset_(0),
+        stop_(false) {
+      for (std::size_t i = 0; i < job_count_; ++i) {
+        free_.Produce(&jobs_[i]);
+      }
+      if (workers_) {
+        pending_.assign(static_cast<const uint8_t*>(header), static_cast<const uint8_t*>(header) + header_size);
+      } else {
+        ReplaceThis(ReadFactory(file_.release(), raw_amount_, header, header_size, false), tail_);
+      }
+      for (std::size_t i = 0; i < workers_; ++i) {
+        threads_.create_thread(boost::bind(&ReadAhead::Inflate, this));
+      }
+      threads_.create_thread(boost::bind(&ReadAhead::Fill, this));
+    }
+
+    ~ReadAhead() {
+      {
+        boost::unique_lock<boost::mutex> lock(stop_mutex_);
+        stop_ = true;
+      }
+      free_.Produce(NULL);
+      for (std::size_t i = 0; i < workers_; ++i) {
+        work_.Produce(NULL);
+      }
+      threads_.join_all();
+    }
+
+    std::size_t Read(void *to, std::size_t amount, ReadCompressed &thunk) {
+      if (!current_) {
+        current_ = ordered_.Consume();
+        WaitSemaphore(current_->done);
+        offset_ = 0;
+      }
+      UTIL_THROW_IF(!current_->error.empty(), CompressedException, current_->error);
+      ReadCount(thunk) = current_->raw_amount;
+      std::size_t sending = std::min(amount, current_->out.size() - offset_);
+      // An empty job is the end of the file and stays current.
+      if (!sending) return 0;
+      memcpy(to, &current_->out[offset_], sending);
+      offset_ += sending;
+      if (offset_ == current_->out.size()) {
+        free_.Produce(current_);
+        current_ = NULL;
+      }
+      return sending;
+    }
+
+  private:
+    struct Job {
+      Job() : done(0) {}
+
+      // Raw input for the workers: complete BGZF blocks.
+      std::vector<uint8_t> in;
+      std::vector<uint8_t> out;
+      // Raw bytes read from the file when the job was filled.
+      uint64_t raw_amount;
+      std::string error;
+      Semaphore done;
+    };
+
+    // Size of the BGZF block starting at from, which has at least length
+    // bytes, or 0 if it is not a BGZF block.
+    static std::size_t BGZFBlockSize(const void *from_void, std::size_t length) {
+      const uint8_t *from = static_cast<const uint8_t*>(from_void);
+      // gzip magic, deflate, and the FEXTRA flag.
+      if (length < kBGZFHeader || from[0] != 0x1f || from[1] != 0x8b || from[2] != 8 || !(from[3] & 4)) return 0;
+      const uint8_t *sub = from + 12;
+      const uint8_t *end = std::min(from + length, sub + (from[10] | (from[11] << 8)));
+      while (sub + 4 <= end) {
+        std::size_t sub_length = sub[2] | (sub[3] << 8);
+        if (sub[0] == 'B' && sub[1] == 'C' && sub_length == 2 && sub + 6 <= end) {
+          return (sub[4] | (sub[5] << 8)) + 1;
+        }
+        sub += 4 + sub_length;
+      }
+      return 0;
+    }
+
+    bool Stopping() {
+      boost::unique_lock<boost::mutex> lock(stop_mutex_);
+      return stop_;
+    }
+
+    // Read up to amount bytes, appending them to pending_.  Returns false if
+    // the file ended first.
+    bool ReadPending(std::size_t amount) {
+      std::size_t original = pending_.size();
+      pending_.resize(original + amount);
+      std::size_t got = ReadOrEOF(file_.get(), &pending_[original], amount);
+      raw_amount_ += got;
+      pending_.resize(original + got);
+      return got == amount;
+    }
+
+    // Move the next BGZF block to job.in.  Returns false at the end of the
+    // BGZF blocks, leaving what was read of the next header in pending_.
+    bool NextBlock(Job &job) {
+      if (pending_.size() < kBGZFHeader && !ReadPending(kBGZFHeader - pending_.size())) return false;
+      if (!BGZFBlockSize(&pending_[0], pending_.size())) {
+        // The extra field is 6 bytes in files written by bgzip, but may be
+        // longer, with the block size further in.
+        if (!(pending_[3] & 4) || pending_[0] != 0x1f || pending_[1] != 0x8b) return false;
+        std::size_t extra = pending_[10] | (pending_[11] << 8);
+        if (pending_.size() < 12 + extra && !ReadPending(12 + extra - pending_.size())) return false;
+      }
+      std::size_t size = BGZFBlockSize(&pending_[0], pending_.size());
+      if (!size) return false;
+      UTIL_THROW_IF(size < pending_.size() + 8, GZException, "Invalid BGZF block size " << size);
+      UTIL_THROW_IF(!ReadPending(size - pending_.size()), GZException, "Truncated BGZF block");
+      job.in.insert(job.in.end(), pending_.begin(), pending_.end());
+      // ISIZE, the size of the block's decompressed data.
+      const uint8_t *trailer = &pending_[size - 4];
+      job.out.resize(job.out.size() + (trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | (static_cast<std::size_t>(trailer[3]) << 24)));
+      pending_.clear();
+      return true;
+    }
+
+    // Reader thread.
+    void Fill() {
+      Job *job = NULL;
+      try {
+        bool blocks = workers_;
+        while ((job = free_.Consume()) && !Stopping()) {
+          job->in.clear();
+          job->out.clear();
+          job->error.clear();
+          if (blocks) {
+            while (job->out.size() < kJobSize && (blocks = NextBlock(*job))) {}
+            if (!blocks) {
+              // Not BGZF from here on: decompress the rest here.
+              ReplaceThis(ReadFactory(file_.release(), raw_amount_, pending_.empty() ? NULL : &pending_[0], pending_.size(), true), tail_);
+            }
+            if (!job->in.empty()) {
+              job->raw_amount = raw_amount_;
+              ordered_.Produce(job);
+              work_.Produce(job);
+              continue;
+            }
+          }
+          job->out.resize(kJobSize);
+          job->out.resize(tail_.ReadOrEOF(&job->out[0], kJobSize));
+          job->raw_amount = raw_amount_ + tail_.RawAmount();
+          ordered_.Produce(job);
+          job->done.post();
+          if (job->out.empty()) return;
+        }
+      } catch (const std::exception &e) {
+        job->error = e.what();
+        job->out.clear();
+        ordered_.Produce(job);
+        job->done.post();
+      }
+    }
+
+#ifdef HAVE_ZLIB
+    // Worker thread.
+    void Inflate() {
+      z_stream stream;
+      memset(&stream, 0, sizeof(stream));
+      // 16 for gzip decoding of each block, which also checks its CRC.
+      UTIL_THROW_IF(Z_OK != inflateInit2(&stream, 16 + 15), GZException, "Failed to initialize zlib.");
+      Job *job;
+      while ((job = work_.Consume())) {
+        try {
+          InflateJob(stream, *job);
+        } catch (const std::exception &e) {
+          job->error = e.what();
+        }
+        job->done.post();
+      }
+      inflateEnd(&stream);
+    }
+
+    static void InflateJob(z_stream &stream, Job &job) {
+      std::size_t in = 0, out = 0;
+      while (in < job.in.size()) {
+        const std::size_t size = BGZFBlockSize(&job.in[in], job.in.size() - in);
+        UTIL_THROW_IF(Z_OK != inflateReset(&stream), GZException, "Failed to reset zlib.");
+        stream.next_in = &job.in[in];
+        stream.avail_in = size;
+        // zlib wants somewhere to write even for an empty block.
+        uint8_t empty;
+        stream.next_out = (out == job.out.size()) ? &empty : &job.out[out];
+        stream.avail_out = job.out.size() - out;
+        int result = inflate(&stream, Z_FINISH);
+        UTIL_THROW_IF(result != Z_STREAM_END || stream.avail_in, GZException, "zlib encountered " << (stream.msg ? stream.msg : "an error ") << " code " << result << " in a BGZF block");
+        in += size;
+        out = job.out.size() - stream.avail_out;
+      }
+      UTIL_THROW_IF(out != job.out.size(), GZException, "BGZF blocks decompressed to " << out << " bytes instead of " << job.out.size());
+    }
+#else
+    void Inflate() {
+      Job *job;
+      while ((job = work_.Consume())) {
+        job->error = "This looks like a gzip file but gzip support was not compiled in.";
+        job->done.post();
+      }
+    }
+#endif
+
+    // Fixed header before the extra field, with the BGZF subfield.
+    static const std::size_t kBGZFHeader = 18;
+    // Decompressed bytes per job.
+    static const std::size_t kJobSize = 1 << 20;
+
+    scoped_fd file_;
+
+    const std::size_t workers_;
+    const std::size_t job_count_;
+    boost::scoped_array<Job> jobs_;
+
+    // Jobs ready to fill, NULL to stop.
+    PCQueue<Job*> free_;
+    // Jobs for the workers, NULL to stop.
+    PCQueue<Job*> work_;
+    // Filled jobs in file order.
+    PCQueue<Job*> ordered_;
+
+    // Owned by the reader thread.
+    std::vector<uint8_t> pending_;
+    uint64_t raw_amount_;
+    // Decompresses whatever is not split into blocks.
+    ReadCompressed tail_;
+
+    // Owned by Read.
+    Job *current_;
+    std::size_t offset_;
+
+    boost::mutex stop_mutex_;
+    bool stop_;
+
+    boost::thread_group threads_;
+};
+#endif // WITH_THREADS
+
 } // namespace
 
 bool ReadCompressed::DetectCompressedMagic(const void *from_void) {
@@ -413,16 +701,31 @@ ReadCompressed::ReadCompressed(std::istream &in) {
   Reset(in);
 }
 
-ReadCompressed::ReadCompressed() {}
+ReadCompressed::ReadCompressed() : raw_amount_(0) {}
 
 ReadCompressed::~ReadCompressed() {}
 
 void ReadCompressed::Reset(int fd) {
   raw_amount_ = 0;
   internal_.reset();
+#ifdef WITH_THREADS
+  const std::size_t threads = background_threads;
+  if (threads) {
+    scoped_fd hold(fd);
+    // Enough to recognize a BGZF block.
+    uint8_t header[18];
+    std::size_t got = util::ReadOrEOF(fd, header, sizeof(header));
+    internal_.reset(new ReadAhead(hold.release(), header, got, got, threads));
+    return;
+  }
+#endif
   internal_.reset(ReadFactory(fd, raw_amount_, NULL, 0, false));
 }
 
+void ReadCompressed::SetBackgroundThreads(std::size_t threads) {
+  background_threads = threads;
+}
+
 void ReadCompressed::Reset(std::istream &in) {
   internal_.reset();
   internal_.reset(new IStreamReader(in));
@@ -67,6 +67,17 @@ class ReadCompressed {
 
     uint64_t RawAmount() const { return raw_amount_; }
 
+    /* Decompress in the background for readers created from an fd (including
+     * FilePiece) after this call.  With 0, the default, decompression happens
+     * in Read.  Otherwise a thread reads ahead into a ring of buffers and
+     * gzip files made of BGZF blocks (as written by bgzip) are inflated on
+     * this many threads, as are multi-block xz files (as written by xz -T).
+     * Readers that are already open keep their setting, so this may be
+     * called while other threads open files.  It has no effect when
+     * compiled without threads.
+     */
+    static void SetBackgroundThreads(std::size_t threads);
+
   private:
     friend class ReadBase;
 
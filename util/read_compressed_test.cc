@@ -7,9 +7,16 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/scoped_ptr.hpp>
 
+#include <algorithm>
 #include <fstream>
+#include <iterator>
 #include <string>
 #include <cstdlib>
+#include <cstring>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 #if defined __MINGW32__
 #include <ctime>
@@ -66,7 +73,7 @@ void VerifyRead(ReadCompressed &reader) {
   BOOST_CHECK_EQUAL((std::size_t)0, reader.Read(&ignored, 1));
 }
 
-void TestRandom(const char *compressor) {
+void TestRandom(const char *compressor, std::size_t threads = 0) {
   std::string name(WriteRandom());
 
   char gzname[] = "tempXXXXXX";
@@ -86,29 +93,92 @@ void TestRandom(const char *compressor) {
   BOOST_CHECK_EQUAL(0, unlink(name.c_str()));
   BOOST_CHECK_EQUAL(0, unlink(gzname));
 
+  ReadCompressed::SetBackgroundThreads(threads);
   ReadCompressed reader(gzipped.release());
+  ReadCompressed::SetBackgroundThreads(0);
   VerifyRead(reader);
 }
 
 BOOST_AUTO_TEST_CASE(Uncompressed) {
   TestRandom("cat");
+  TestRandom("cat", 1);
 }
 
 #ifdef HAVE_ZLIB
 BOOST_AUTO_TEST_CASE(ReadGZ) {
   TestRandom("gzip");
+  TestRandom("gzip", 1);
+  TestRandom("gzip", 4);
+}
+
+// Write a gzip member, with the BGZF block size in the header if bgzf.
+void WriteMember(int fd, const char *data, std::size_t size, bool bgzf) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  BOOST_REQUIRE_EQUAL(Z_OK, deflateInit2(&stream, 6, Z_DEFLATED, 16 + 15, 8, Z_DEFAULT_STRATEGY));
+  unsigned char extra[6] = {'B', 'C', 2, 0, 0, 0};
+  gz_header header;
+  memset(&header, 0, sizeof(header));
+  header.extra = extra;
+  header.extra_len = sizeof(extra);
+  if (bgzf) BOOST_REQUIRE_EQUAL(Z_OK, deflateSetHeader(&stream, &header));
+  std::string out(deflateBound(&stream, size) + 64, 0);
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  stream.avail_in = size;
+  stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+  stream.avail_out = out.size();
+  BOOST_REQUIRE_EQUAL(Z_STREAM_END, deflate(&stream, Z_FINISH));
+  out.resize(out.size() - stream.avail_out);
+  BOOST_REQUIRE_EQUAL(Z_OK, deflateEnd(&stream));
+  if (bgzf) {
+    out[16] = (out.size() - 1) & 0xff;
+    out[17] = (out.size() - 1) >> 8;
+  }
+  WriteOrThrow(fd, out.data(), out.size());
+}
+
+// BGZF blocks, the empty block that ends files written by bgzip, and then an
+// ordinary gzip member.
+BOOST_AUTO_TEST_CASE(ReadBGZF) {
+  std::string name(WriteRandom());
+  std::string data;
+  {
+    std::ifstream in(name.c_str(), std::ios::binary);
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  BOOST_CHECK_EQUAL(0, unlink(name.c_str()));
+
+  char gzname[] = "tempXXXXXX";
+  scoped_fd gzipped(mkstemp(gzname));
+  BOOST_CHECK_EQUAL(0, unlink(gzname));
+  const std::size_t kBlock = 7000;
+  const std::size_t kSplit = data.size() - data.size() / 5;
+  for (std::size_t begin = 0; begin < kSplit; begin += kBlock) {
+    WriteMember(gzipped.get(), data.data() + begin, std::min(kBlock, kSplit - begin), true);
+  }
+  WriteMember(gzipped.get(), NULL, 0, true);
+  WriteMember(gzipped.get(), data.data() + kSplit, data.size() - kSplit, false);
+  SeekOrThrow(gzipped.get(), 0);
+
+  ReadCompressed::SetBackgroundThreads(4);
+  ReadCompressed reader(gzipped.release());
+  ReadCompressed::SetBackgroundThreads(0);
+  VerifyRead(reader);
 }
 #endif // HAVE_ZLIB
 
 #ifdef HAVE_BZLIB
 BOOST_AUTO_TEST_CASE(ReadBZ) {
   TestRandom("bzip2");
+  TestRandom("bzip2", 1);
 }
 #endif // HAVE_BZLIB
 
 #ifdef HAVE_XZLIB
 BOOST_AUTO_TEST_CASE(ReadXZ) {
   TestRandom("xz");
+  TestRandom("xz", 1);
+  TestRandom("xz --block-size=10000", 4);
 }
 #endif
 